@@ -28,15 +28,29 @@
 #ifndef COMPILER_H
 #define COMPILER_H
 
-#include "hash_map.h"
+#include <stdbool.h>    // bool
 #include "parser.h"
-#include "queue.h"
-#include "vm/opcodes.h"
+#include "vm/chunk.h"
+#include "vm/program.h"
 
-// Swap last 2 stack objects to fix order if first instruction is a binary operation
-void swap_last_operands(Opcode oc);
+// Size at which compile_program() starts a new module chunk. Both limits leave ample headroom below the reach of
+// 16-bit operands for the statement that crosses them.
+#define MODULE_CODE_LIMIT ((size_t)32768)
+#define MODULE_CONSTANT_LIMIT ((size_t)32768)
 
-// Translates lexer/parser tokens to VM instructions
-void compile(ConcoctNodeTree* tree, ConcoctHashMap* map);
+// Emit register-form instructions for expressions that fit in the VM registers (stack form otherwise)
+extern bool register_mode;
+
+// Fold operations on constants and propagate the constant values of globals at compile time (enabled by default)
+extern bool folding_mode;
+
+// Compile calls of small leaf functions to the expression they return (enabled by default)
+extern bool inline_mode;
+
+// Translates parser tree to VM instructions stored in chunk and returns true on success
+bool compile(const ConcoctNodeTree* tree, Chunk* chunk);
+
+// Translates parser tree to module chunks appended to program and returns true on success
+bool compile_program(const ConcoctNodeTree* tree, Program* program);
 
 #endif // COMPILER_H
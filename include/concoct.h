@@ -42,10 +42,20 @@ static const char ARG_PREFIX = '-';
 // Used to flag unused variables and silence compiler warnings
 #define UNUSED(x) (void)(x)
 
+// Branch prediction hints for checks that almost never (or almost always) succeed on hot paths
+#if defined(__GNUC__) || defined(__clang__)
+#define LIKELY(x) __builtin_expect(!!(x), 1)
+#define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define LIKELY(x) (x)
+#define UNLIKELY(x) (x)
+#endif
+
 void clean_exit(int status);
 void lex_file(const char* file_name);
 void lex_string(const char* input_string);
 void parse_file(const char* file_name);
+bool compile_file(const char* file_name);
 void parse_string(const char* input_string);
 void handle_options(int argc, char *argv[]);
 bool case_compare(const char* str1, const char* str2);
@@ -25,44 +25,22 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef QUEUE_H
-#define QUEUE_H
+#ifndef IR_H
+#define IR_H
 
-#include <stdbool.h> // bool
-#include <stddef.h>  // size_t
+#include <stdbool.h>    // bool
+#include <stddef.h>     // size_t
+#include "vm/chunk.h"
 
-#define MAX_QUEUE_CAPACITY ((size_t)256)
+// Optimize code through the SSA intermediate representation before the peephole optimizer runs (-O2, disabled by
+// default)
+extern bool ir_mode;
 
-typedef struct queue
-{
-  int front;
-  int back;
-  size_t count;
-  void* objects[MAX_QUEUE_CAPACITY];
-} Queue;
+// Optimizes the main program and the function bodies of chunk through the SSA intermediate representation and returns
+// number of operations eliminated or hoisted out of loops
+size_t optimize_ir(Chunk* chunk);
 
-// Initializes queue
-void init_queue(Queue* queue);
+// Prints in debug mode how many operations each pass over the intermediate representation eliminated or hoisted
+void print_ir_hits(void);
 
-// Returns true if queue is empty
-bool is_empty(const Queue* queue);
-
-// Returns true if queue is full
-bool is_full(const Queue* queue);
-
-// Returns size of queue
-size_t size(const Queue* queue);
-
-// Returns object at the back of queue
-void* back(const Queue* queue);
-
-// Returns object at the front of queue
-void* front(const Queue* queue);
-
-// Returns and removes next object from queue
-void dequeue(Queue* queue, void** object);
-
-// Inserts new object into queue
-void enqueue(Queue* queue, void* object);
-
-#endif // QUEUE_H
+#endif // IR_H
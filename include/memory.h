@@ -51,6 +51,7 @@ static const size_t GIGABYTE_BOUNDARY = 1073741824;
 typedef struct objstore
 {
   size_t capacity;
+  size_t next_slot; // no free slots exist below this index
   Object** objects;
 } ObjectStore;
 extern ObjectStore object_store;
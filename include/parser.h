@@ -56,6 +56,7 @@ typedef struct concoct_parser
   ConcoctToken current_token;
   size_t error_line;
   const char* error;
+  ConcoctNode* pending; // identifier read by a statement that turned out to be an expression (see cct_parse_assign())
 } ConcoctParser;
 
 ConcoctNode* cct_new_node(ConcoctNodeTree* tree, ConcoctToken token, const char* text);
@@ -66,6 +67,7 @@ ConcoctNode* cct_node_add_child(ConcoctNode* node, ConcoctNode* child);
 ConcoctNodeTree* cct_parse_program(ConcoctParser* parser);
 ConcoctNode* cct_parse_stat(ConcoctParser* parser);
 ConcoctNode* cct_parse_expr(ConcoctParser* parser);
+void cct_parser_skip_new_lines(ConcoctParser* parser);
 ConcoctToken cct_next_parser_token(ConcoctParser* parser);
 void cct_print_node(const ConcoctNode* node, size_t tab_level);
 
@@ -25,72 +25,26 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "debug.h"
-#include "queue.h"
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
 
-// Initializes queue
-void init_queue(Queue* queue)
-{
-  queue->count = 0;
-  queue->back = MAX_QUEUE_CAPACITY - 1;
-  queue->front = 0;
-  if(debug_mode)
-    debug_print("Queue initialized with %zu slots.", MAX_QUEUE_CAPACITY);
-  return;
-}
+#include <stdbool.h>    // bool
+#include <stddef.h>     // size_t
+#include "vm/chunk.h"
 
-// Returns true if queue is empty
-bool is_empty(const Queue* queue)
-{
-  return queue->count == 0;
-}
+// Fuse common instruction sequences into superinstructions after compilation (enabled by default)
+extern bool fusion_mode;
 
-// Returns true if queue is full
-bool is_full(const Queue* queue)
-{
-  return queue->count == MAX_QUEUE_CAPACITY;
-}
+// Remove redundant instructions and unreachable code after compilation (enabled by default)
+extern bool peephole_mode;
 
-// Returns size of queue
-size_t size(const Queue* queue)
-{
-  return queue->count;
-}
+// Rewrites common instruction sequences in chunk as superinstructions and returns number of fusions
+size_t fuse_superinstructions(Chunk* chunk);
 
-// Returns object at the back of queue
-void* back(const Queue* queue)
-{
-  if(is_empty(queue))
-    return NULL;
-  return queue->objects[queue->back];
-}
+// Applies the peephole rules and dead-code elimination to chunk and returns number of instructions removed
+size_t optimize_chunk(Chunk* chunk);
 
-// Returns object at the front of queue
-void* front(const Queue* queue)
-{
-  if(is_empty(queue))
-    return NULL;
-  return queue->objects[queue->front];
-}
+// Prints in debug mode how often each peephole rule applied and how many unreachable instructions were removed
+void print_peephole_hits(void);
 
-// Returns and removes next object from queue
-void dequeue(Queue* queue, void** object)
-{
-  if(is_empty(queue))
-    return;
-  *object = queue->objects[queue->front];
-  queue->front = (queue->front + 1) % MAX_QUEUE_CAPACITY;
-  queue->count--;
-  return;
-}
-
-// Inserts new object into queue
-void enqueue(Queue* queue, void* object)
-{
-  if(is_full(queue))
-    return;
-  queue->back = (queue->back + 1) % MAX_QUEUE_CAPACITY;
-  queue->objects[queue->back] = object;
-  queue->count++;
-  return;
-}
+#endif // PEEPHOLE_H
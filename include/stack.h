@@ -28,28 +28,82 @@
 #ifndef STACK_H
 #define STACK_H
 
-#include <stddef.h> // NULL, size_t
+#include <stdbool.h> // bool
+#include <stddef.h> // NULL, ptrdiff_t, size_t
+#include <stdio.h>  // fprintf(), stderr
+#include "concoct.h" // LIKELY(), UNLIKELY()
 #include "types.h"
 
-#define MAX_STACK_CAPACITY ((size_t)128)
+#define INITIAL_STACK_CAPACITY ((size_t)128)
 
+/*
+ * The operand stack is a heap buffer that grows geometrically. Capacity is reserved once per frame with
+ * reserve_stack() for the frame's worst-case depth, so push() itself never checks for overflow.
+ */
 typedef struct stack
 {
-  int16_t top;
+  ptrdiff_t top;
   size_t count;
-  void* objects[MAX_STACK_CAPACITY];
+  size_t capacity;
+  void** objects;
 } Stack;
 
 // Initializes stack
 void init_stack(Stack* stack);
 
+// Frees stack
+void free_stack(Stack* stack);
+
+// Grows stack to hold at least slots more objects and returns false if memory could not be allocated
+bool grow_stack(Stack* stack, size_t slots);
+
+// Ensures room for slots more objects and returns false if the stack could not grow
+static inline bool reserve_stack(Stack* stack, size_t slots)
+{
+  if(LIKELY(stack->capacity - stack->count >= slots))
+    return true;
+  return grow_stack(stack, slots);
+}
+
+/*
+ * The stack operations below sit on the interpreter hot path and are inlined into every instruction handler.
+ * They intentionally do not consult debug_mode. Stack activity is traced per instruction by the tracing
+ * interpreter loop instead (see include/vm/dispatch.h).
+ */
+
 // Returns object at top of stack without removal
-void* peek(const Stack* stack);
+static inline void* peek(const Stack* stack)
+{
+  if(UNLIKELY(stack->top == -1))
+    return NULL;
+  return stack->objects[stack->top];
+}
 
 // Returns and removes object at top of stack
-void* pop(Stack* stack);
+static inline void* pop(Stack* stack)
+{
+  if(UNLIKELY(stack->top == -1))
+  {
+    fprintf(stderr, "Stack underflow occurred!\n");
+    return NULL;
+  }
+  stack->count--;
+  return stack->objects[stack->top--];
+}
 
-// Pushes new object on top of stack
-void push(Stack* stack, void* object);
+// Returns and removes object at top of stack without an underflow check (verified code only)
+static inline void* pop_unchecked(Stack* stack)
+{
+  stack->count--;
+  return stack->objects[stack->top--];
+}
+
+// Pushes new object on top of stack (capacity must have been reserved)
+static inline void push(Stack* stack, void* object)
+{
+  stack->count++;
+  stack->objects[++stack->top] = object;
+  return;
+}
 
 #endif // STACK_H
@@ -55,6 +55,9 @@ typedef enum data_type
   CCT_TYPE_STRING
 } DataType;
 
+// Number of data types (CCT_TYPE_STRING must remain the last entry)
+#define DATA_TYPE_AMOUNT ((size_t)CCT_TYPE_STRING + 1)
+
 // Concoct object
 typedef struct object
 {
@@ -0,0 +1,92 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AOT_H
+#define AOT_H
+
+#include <stdbool.h>         // bool
+#include <stddef.h>          // size_t
+#include <stdio.h>           // FILE
+#include "types.h"           // BigNum, Decimal, Object
+#include "vm/instructions.h" // BinaryKernel
+#include "vm/program.h"      // Program
+
+/*
+ * Ahead-of-time compilation translates the verified bytecode of a program to a C translation unit that calls into
+ * the runtime, and builds it with the system C compiler. The top level of each module chunk becomes a C function,
+ * as does every function body. Jumps become gotos and calls become C calls.
+ *
+ * Values whose type is known at translation time stay unboxed in C locals. These are constants, the results of
+ * arithmetic and comparisons on them, and globals and locals assigned from them earlier in the same basic block.
+ * Straight-line numeric code therefore compiles to plain C arithmetic. Everything else pushes objects on vm.sp and
+ * runs the same instruction functions as the interpreter.
+ */
+
+// Writes the C translation of program to output and returns false if an instruction cannot be translated
+bool translate_program(const Program* program, const char* source_name, FILE* output);
+
+// Compiles the C file source with the system C compiler (CC or cc) and links it against the runtime into
+// executable. The compiler runs without a shell, so paths need no quoting. CONCOCT_INCLUDE_DIR and
+// CONCOCT_RUNTIME_LIBRARY override where the build put the runtime headers and library. Returns false if neither
+// says where the runtime is or the compiler failed.
+bool build_executable(const char* source, const char* executable);
+
+// Runtime support called by translated programs
+
+// Initializes the VM and binds the global slots of the program in order
+void aot_start(const char* const* global_names, size_t global_count);
+
+// Reports a runtime error on line and returns false
+bool aot_error(size_t line);
+
+// Reports division by zero during operation on line and returns false
+bool aot_division_by_zero(const char* operation, size_t line);
+
+// Boxes an integer computed from Numbers (Number if it fits and BigNum otherwise, like the Number kernels)
+Object* aot_box_integer(BigNum value);
+
+// Boxes a decimal
+Object* aot_box_decimal(Decimal value);
+
+// Pops two operands and applies number_kernel to two Numbers, decimal_kernel to two Decimals (either may be NULL)
+// and kernel otherwise, like a quickened instruction
+RunCode aot_binary(BinaryKernel number_kernel, BinaryKernel decimal_kernel, BinaryKernel kernel);
+
+// Applies typed_kernel to the top of the stack and constant if it has the type of constant and kernel otherwise.
+// The result replaces the top of the stack.
+RunCode aot_constant_binary(Object* constant, BinaryKernel typed_kernel, BinaryKernel kernel);
+
+// Reserves the stack of a call to a function with max_stack slots and counts the call against MAX_CALL_DEPTH
+bool aot_enter(size_t max_stack);
+
+// Replaces the running function with a callee taking arity arguments (the locals of its frame start at base)
+void aot_tail_call(size_t base, size_t arity);
+
+// Pops the return value, drops the frame starting at base and pushes the value in place of the arguments
+void aot_return(size_t base);
+
+#endif // AOT_H
@@ -0,0 +1,137 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <stdbool.h>    // bool
+#include <stddef.h>     // size_t
+#include <stdint.h>     // uint16_t, UINT16_MAX
+#include "types.h"      // Byte, Object
+#include "vm/opcodes.h" // Opcode
+
+#define INITIAL_CHUNK_CAPACITY ((size_t)64)
+#define INITIAL_CONSTANT_CAPACITY ((size_t)16)
+#define MAX_CONSTANT_AMOUNT ((size_t)UINT16_MAX + 1) // constant indexes are 16-bit operands
+
+#define MAX_FUNCTION_AMOUNT ((size_t)UINT16_MAX + 1) // function indexes are 16-bit operands
+#define MAX_LOCAL_AMOUNT ((size_t)UINT8_MAX + 1)     // local slots are 8-bit operands
+#define MAX_GLOBAL_AMOUNT ((size_t)UINT16_MAX + 1)   // global slots are 16-bit operands
+
+struct chunk;
+
+// Function callable with OP_CAL. Its code starts with OP_ENT at entry in chunk, which may be another chunk of the
+// same program. Arguments become the first locals of the frame.
+typedef struct function
+{
+  const char* name;     // name for disassembly
+  struct chunk* chunk;  // chunk holding the code
+  size_t entry;         // offset of the OP_ENT instruction
+  size_t arity;         // number of parameters
+  size_t local_count;   // number of local slots including the parameters
+  size_t max_stack;     // local slots plus maximum operand stack depth (valid once verified)
+} Function;
+
+// Code object containing a byte-encoded instruction stream, its constant pool, the functions it can call and the
+// global slots it uses. All grow on demand.
+typedef struct chunk
+{
+  size_t count;             // number of bytes used in code
+  size_t capacity;          // number of bytes allocated for code and lines
+  Byte* code;               // opcodes and their operands
+  size_t* lines;            // source line number of each byte in code
+  size_t constant_count;    // number of constants used
+  size_t constant_capacity; // number of constants allocated
+  Object** constants;       // constant pool
+  size_t function_count;    // number of functions used
+  size_t function_capacity; // number of functions allocated
+  Function* functions;      // function table indexed by OP_CAL
+  size_t global_count;      // number of global slots used
+  size_t global_capacity;   // number of global slots allocated
+  uint16_t* globals;        // global slots used by the code and the functions it calls (see bind_global())
+  size_t global_map_size;   // number of slots covered by global_map
+  bool* global_map;         // set at each slot in globals (indexed by slot)
+  bool has_error;           // set when the chunk could not grow during compilation
+  bool is_verified;         // set by verify_chunk() and cleared by any later write
+  size_t max_stack;         // maximum stack depth (valid once verified)
+  bool* unescaped;          // set at the offset of each instruction whose result never escapes (valid once verified)
+  size_t hotness;           // runs and loop back-edges taken since its native code was last compiled (see jit.h)
+  void* native;             // native code compiled by the JIT or NULL
+  size_t native_size;       // bytes mapped for native code
+  size_t* native_entries;   // offset of the native code of each instruction (indexed by offset in code)
+  size_t importers;         // loaded chunks whose function tables point into this one (see unload_chunk())
+} Chunk;
+
+// Initializes chunk
+void init_chunk(Chunk* chunk);
+
+// Releases chunk contents (constants remain owned by the object store)
+void free_chunk(Chunk* chunk);
+
+// Appends a byte to chunk
+void write_chunk(Chunk* chunk, Byte byte, size_t line);
+
+// Appends an opcode to chunk
+void write_opcode(Chunk* chunk, Opcode oc, size_t line);
+
+// Appends a 16-bit operand to chunk
+void write_short(Chunk* chunk, uint16_t value, size_t line);
+
+// Adds object to constant pool and returns its index
+uint16_t add_constant(Chunk* chunk, Object* object);
+
+// Adds function to the function table and returns its index
+uint16_t add_function(Chunk* chunk, const Function* function);
+
+// Records that chunk uses the global slot
+void add_global(Chunk* chunk, uint16_t slot);
+
+// Returns true if chunk uses the global slot
+static inline bool uses_global(const Chunk* chunk, uint16_t slot)
+{
+  return slot < chunk->global_map_size && chunk->global_map[slot];
+}
+
+// Reads a 16-bit operand
+static inline uint16_t read_short(const Byte* code)
+{
+  return (uint16_t)(code[0] | (code[1] << 8));
+}
+
+// Returns offset targeted by the jump instruction at offset or SIZE_MAX if it would leave the start of chunk
+size_t get_jump_target(const Chunk* chunk, size_t offset);
+
+// Points the jump instruction at offset to target and returns false if the distance does not fit its operand
+bool set_jump_target(Chunk* chunk, size_t offset, size_t target);
+
+// Prints a single instruction and returns offset of the next instruction
+size_t print_instruction(const Chunk* chunk, size_t offset);
+
+// Prints all instructions in chunk
+void print_chunk(const Chunk* chunk, const char* name);
+
+#endif // CHUNK_H
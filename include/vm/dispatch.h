@@ -0,0 +1,1220 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Interpreter loop template
+ *
+ * This file is intentionally not guarded against multiple inclusion. vm.c includes it once per interpreter
+ * variant after defining the following:
+ *
+ *   DISPATCH_NAME     name of the generated interpreter function
+ *   DISPATCH_TRACE    1 to generate the instrumented loop used by debug mode, 0 for the lean loop
+ *   DISPATCH_PROFILE  1 to count executed opcode sequences and stack and memory traffic (profile mode), 0 otherwise
+ *   DISPATCH_CHECKED  1 to guard every stack access for unverified chunks, 0 for chunks proven safe by the verifier
+ *   DISPATCH_COUNT    1 to count the objects pushed onto and popped from vm.sp (traffic mode), 0 otherwise
+ *
+ * Generic binary instructions quicken themselves: before running, they rewrite their opcode byte to the form
+ * specialized for the operand types on the stack (see get_quickened_opcode()). A specialized form checks a cheap
+ * type guard and, on a miss, reverts to the generic form and runs the generic kernel. That form respecializes
+ * for whatever types it sees next.
+ *
+ * The unchecked loop runs only chunks accepted by verify_chunk(). The verifier proved that no instruction
+ * underflows the stack and the VM reserved the chunk's maximum stack depth, so operands are popped without bounds
+ * checks and stack operations call their value kernels directly. The checked loop keeps those guards and grows the
+ * stack before every instruction instead. The unchecked loop also keeps results the verifier proved never escape in
+ * the scratch object of their stack slot (see SCRATCH_RESULT()), so chains of typed arithmetic allocate nothing.
+ *
+ * Calls push a Frame onto vm.frames, which only grows when a call nests deeper than any call before it, so calls
+ * and returns never allocate. The locals of the running function start at stack index base. A verified function
+ * declares its maximum stack depth, which OP_CAL reserves up front. OP_TCL reuses the running frame: it moves the
+ * arguments down to base and enters the callee without pushing a Frame, so tail recursion runs in constant space.
+ *
+ * The lean loop caches the top of the stack in the local tos (see cache_mode). It runs in two states. While cached
+ * is false, every value is in vm.sp. Loads and typed binary instructions leave their result in tos instead of
+ * pushing it, and cached becomes true. While cached is true, a second switch runs the instructions that consume or
+ * replace the top of the stack without touching vm.sp for it. A chain such as GET, ADDKN, ASN then never stores its
+ * intermediate values. Any other instruction spills tos to vm.sp first and then runs its uncached handler. Every jump
+ * leaves the cache empty, so both states agree wherever control flow merges.
+ *
+ * In jit_mode the lean loop counts the back-edges of the main program. Once the chunk is hot, the loop continues in
+ * native code from the back-edge and the interpreter resumes wherever the native code exits (see run_hot_loop()).
+ *
+ * Every opcode is defined once here. The TRACE_*(), PROFILE_*() and COUNT_*() hooks expand to nothing in the lean
+ * loop, so it carries no per-instruction debug_mode, profile_mode or traffic_mode checks. COUNT_*() counts what an
+ * instruction actually moves through vm.sp, including the pushes and pops of the helpers it calls and every spill
+ * of the cached top of the stack (nothing ever refills the cache from vm.sp). Frames moved in bulk by calls and
+ * returns are not counted.
+ */
+
+#if DISPATCH_TRACE
+#define TRACE_INSTRUCTION() print_instruction(chunk, (size_t)(instruction - chunk->code))
+#define TRACE_RESULT() \
+  do \
+  { \
+    if(vm.sp->count > 0) \
+      print_object_value(peek(vm.sp)); \
+    printf("Stack now contains %zu objects.\n", vm.sp->count); \
+  } while(0)
+#define TRACE_ASSIGNMENT() \
+  do \
+  { \
+    if(vm.sp->count > 0) \
+      print_object_value(peek(vm.sp)); \
+  } while(0)
+#define TRACE_VALUE(object) print_object_value(object)
+#define TRACE_REGISTERS() print_registers()
+#define TRACE_REGISTER(reg) \
+  do \
+  { \
+    if((reg) < REGISTER_AMOUNT && vm.rp[(reg)] != NULL) \
+    { \
+      printf("R%u = ", (reg)); \
+      print_object_value(vm.rp[(reg)]); \
+    } \
+  } while(0)
+#else
+#define TRACE_INSTRUCTION() OP_NOOP
+#define TRACE_RESULT() OP_NOOP
+#define TRACE_ASSIGNMENT() OP_NOOP
+#define TRACE_VALUE(object) OP_NOOP
+#define TRACE_REGISTERS() OP_NOOP
+#define TRACE_REGISTER(reg) OP_NOOP
+#endif // DISPATCH_TRACE
+
+#if DISPATCH_PROFILE
+#define PROFILE_START() reset_profile_history()
+#define PROFILE_INSTRUCTION() profile_instruction(chunk, (size_t)(instruction - chunk->code))
+#else
+#define PROFILE_START() OP_NOOP
+#define PROFILE_INSTRUCTION() OP_NOOP
+#endif // DISPATCH_PROFILE
+
+#if DISPATCH_COUNT
+#define COUNT_TRAFFIC(pop_count, push_count) (stack_traffic.pops += (pop_count), stack_traffic.pushes += (push_count))
+#define COUNT_SPILL() (stack_traffic.spills++)
+#else
+#define COUNT_TRAFFIC(pop_count, push_count) OP_NOOP
+#define COUNT_SPILL() OP_NOOP
+#endif // DISPATCH_COUNT
+
+// Pushes object onto vm.sp
+#define PUSH(object) \
+  do \
+  { \
+    COUNT_TRAFFIC(0, 1); \
+    push(vm.sp, (object)); \
+  } while(0)
+
+#if DISPATCH_CHECKED
+#define POP() (COUNT_TRAFFIC(1, 0), pop(vm.sp))
+#define HAS_TYPE(object, type) ((object) != NULL && (object)->datatype == (type))
+#define HAS_OPERANDS(amount) (vm.sp->count >= (amount))
+#define HAS_FUNCTION(index) ((index) < chunk->function_count)
+#define HAS_LOCAL(slot) (base + (slot) < vm.sp->count)
+#define HAS_FRAME() (vm.frame_count > entry_frames)
+#define HAS_GLOBAL(slot) ((slot) < vm.global_count)
+#define RESERVE_STACK() \
+  do \
+  { \
+    if(UNLIKELY(!reserve_stack(vm.sp, MAX_INSTRUCTION_PUSHES))) \
+      goto runtime_error; \
+  } while(0)
+#define JUMP_TO(target) \
+  do \
+  { \
+    if(UNLIKELY((target) >= chunk->count)) \
+      goto runtime_error; \
+    vm.ip = chunk->code + (target); \
+  } while(0)
+#define SCRATCH_RESULT() NULL
+#else
+#define POP() (COUNT_TRAFFIC(1, 0), pop_unchecked(vm.sp))
+#define HAS_TYPE(object, type) ((object)->datatype == (type))
+#define HAS_OPERANDS(amount) true
+#define HAS_FUNCTION(index) true
+#define HAS_LOCAL(slot) true
+#define HAS_FRAME() true
+#define HAS_GLOBAL(slot) true
+#define RESERVE_STACK() OP_NOOP
+#define JUMP_TO(target) (vm.ip = chunk->code + (target))
+// Object a typed kernel stores the result of the current instruction in: the scratch object of the slot the result
+// takes if the verifier proved it never escapes and NULL (a new object) otherwise. Its operands are already popped.
+#define SCRATCH_RESULT() (chunk->unescaped[instruction - chunk->code] ? get_scratch(vm.sp->count) : NULL)
+#endif // DISPATCH_CHECKED
+
+#if DISPATCH_CHECKED
+#define PUSH_RESULT() PUSH(result)
+#else
+// Leaves result in tos (the cache is empty whenever the uncached handlers run)
+#define PUSH_RESULT() \
+  do \
+  { \
+    if(LIKELY(caching)) \
+    { \
+      tos = result; \
+      cached = true; \
+    } \
+    else \
+      PUSH(result); \
+  } while(0)
+#endif // DISPATCH_CHECKED
+
+// Operand decoding
+#define READ_BYTE() (*vm.ip++)
+#define READ_SHORT() (vm.ip += 2, read_short(vm.ip - 2))
+#define READ_CONSTANT() (chunk->constants[READ_SHORT()])
+#define READ_RK() read_rk(chunk, READ_BYTE())
+
+// Reads a global slot operand
+#define READ_GLOBAL(slot) \
+  do \
+  { \
+    (slot) = READ_SHORT(); \
+    if(UNLIKELY(!HAS_GLOBAL(slot))) \
+      goto runtime_error; \
+  } while(0)
+
+// Moves the instruction pointer forward (JUMP) or back (LOOP) from the following instruction
+#define JUMP(distance) JUMP_TO((size_t)(vm.ip - chunk->code) + (distance))
+#if DISPATCH_CHECKED || DISPATCH_COUNT
+#define LOOP(distance) JUMP_TO((size_t)(vm.ip - chunk->code) - (distance))
+#else
+// Back-edges of the main program count towards compiling the chunk, and a hot loop continues as native code
+#define LOOP(distance) \
+  do \
+  { \
+    JUMP_TO((size_t)(vm.ip - chunk->code) - (distance)); \
+    if(UNLIKELY(jit_mode) && vm.frame_count == entry_frames && run_hot_loop(chunk) == RUN_ERROR) \
+    { \
+      instruction = vm.ip; \
+      goto runtime_error; \
+    } \
+  } while(0)
+#endif // DISPATCH_CHECKED
+
+// Pops the condition and branches when its truth value is when
+#define CONDITIONAL_JUMP(branch, when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    if(UNLIKELY(!HAS_OPERANDS(1))) \
+      goto runtime_error; \
+    if(is_truthy(POP()) == (when)) \
+      branch(distance); \
+  } while(0)
+
+// Shared Bool object for a truth value
+#define BOOL_OBJECT(truth) ((truth) ? vm.true_object : vm.false_object)
+
+// Jumps leaving the shared Bool object for when if the condition's truth value is when and pops it otherwise
+#define DECIDING_JUMP(when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    if(UNLIKELY(!HAS_OPERANDS(1))) \
+      goto runtime_error; \
+    if(is_truthy(POP()) == (when)) \
+    { \
+      PUSH(BOOL_OBJECT(when)); \
+      JUMP(distance); \
+    } \
+  } while(0)
+
+// Pops two operands and loops back when whether they are equal (see eql_objects()) is when
+#define COMPARE_LOOP(when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    operand2 = POP(); \
+    operand1 = POP(); \
+    CHECK_RUN(eql_objects(&result, operand1, operand2)); \
+    if(result->value.boolval == (when)) \
+      LOOP(distance); \
+  } while(0)
+
+// Pops the left operand of OP_JNLK or OP_LLTK and branches when whether it is less than the constant is when
+#define LESS_CONSTANT_JUMP(branch, when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    operand2 = READ_CONSTANT(); \
+    if(UNLIKELY(!HAS_OPERANDS(1))) \
+      goto runtime_error; \
+    operand1 = POP(); \
+    if(LIKELY(HAS_TYPE(operand1, CCT_TYPE_NUMBER) && operand2->datatype == CCT_TYPE_NUMBER)) \
+      is_less = operand1->value.numval < operand2->value.numval; \
+    else \
+      CHECK_RUN(op_less_constant(&is_less, operand1, operand2)); \
+    if(is_less == (when)) \
+      branch(distance); \
+  } while(0)
+
+// Stops execution if an instruction handler fails
+#define CHECK_RUN(handler) \
+  do \
+  { \
+    if(UNLIKELY((handler) == RUN_ERROR)) \
+      goto runtime_error; \
+  } while(0)
+
+// Specializes the current generic stack-form binary instruction for the two operands on top of the stack
+#define QUICKEN_STACK() \
+  do \
+  { \
+    if(quicken_mode && HAS_OPERANDS(2)) \
+      quicken_instruction(instruction, vm.sp->objects[vm.sp->top - 1], vm.sp->objects[vm.sp->top]); \
+  } while(0)
+
+// Specializes the current generic constant-operand instruction for the top of the stack and its constant
+#define QUICKEN_CONSTANT() \
+  do \
+  { \
+    if(quicken_mode && HAS_OPERANDS(1)) \
+      quicken_instruction(instruction, vm.sp->objects[vm.sp->top], chunk->constants[read_short(instruction + 1)]); \
+  } while(0)
+
+// Stack-form binary operation: pops both operands, applies kernel and pushes the result
+#define STACK_OPERATION(kernel) \
+  do \
+  { \
+    operand2 = POP(); \
+    operand1 = POP(); \
+    CHECK_RUN(kernel(&result, operand1, operand2)); \
+    PUSH(result); \
+    TRACE_RESULT(); \
+  } while(0)
+
+// Generic stack-form binary operation that quickens itself
+#define STACK_BINARY(kernel) \
+  do \
+  { \
+    QUICKEN_STACK(); \
+    STACK_OPERATION(kernel); \
+  } while(0)
+
+// Binary operation with a constant right operand (fused PSH + <op>) that quickens itself
+#define CONSTANT_BINARY(kernel) \
+  do \
+  { \
+    QUICKEN_CONSTANT(); \
+    operand2 = READ_CONSTANT(); \
+    operand1 = POP(); \
+    CHECK_RUN(kernel(&result, operand1, operand2)); \
+    PUSH(result); \
+    TRACE_RESULT(); \
+  } while(0)
+
+// Quickened stack-form binary operation guarded on both operands having the given type
+#define TYPED_BINARY(type, kernel, generic_kernel) \
+  do \
+  { \
+    operand2 = POP(); \
+    operand1 = POP(); \
+    result = SCRATCH_RESULT(); \
+    if(LIKELY(HAS_TYPE(operand1, type) && HAS_TYPE(operand2, type))) \
+      CHECK_RUN(kernel(&result, operand1, operand2)); \
+    else \
+    { \
+      *instruction = (Byte)get_generic_opcode((Opcode)*instruction); \
+      CHECK_RUN(generic_kernel(&result, operand1, operand2)); \
+    } \
+    PUSH_RESULT(); \
+    TRACE_RESULT(); \
+  } while(0)
+
+// Quickened constant-operand binary operation guarded on the left operand (the constant was checked when quickened)
+#define TYPED_CONSTANT_BINARY(type, kernel, generic_kernel) \
+  do \
+  { \
+    operand2 = READ_CONSTANT(); \
+    operand1 = POP(); \
+    result = SCRATCH_RESULT(); \
+    if(LIKELY(HAS_TYPE(operand1, type))) \
+      CHECK_RUN(kernel(&result, operand1, operand2)); \
+    else \
+    { \
+      *instruction = (Byte)get_generic_opcode((Opcode)*instruction); \
+      CHECK_RUN(generic_kernel(&result, operand1, operand2)); \
+    } \
+    PUSH_RESULT(); \
+    TRACE_RESULT(); \
+  } while(0)
+
+// Register-form binary operation: rA = B <op> C
+#define REGISTER_BINARY(kernel) \
+  do \
+  { \
+    reg1 = READ_BYTE(); \
+    operand1 = READ_RK(); \
+    operand2 = READ_RK(); \
+    CHECK_RUN(op_reg_binary(vm.rp, reg1, operand1, operand2, kernel)); \
+    TRACE_REGISTER(reg1); \
+  } while(0)
+
+#if !DISPATCH_CHECKED
+// Pushes the cached top of the stack onto vm.sp to make room for a new one or for an uncached handler
+#define SPILL() \
+  do \
+  { \
+    COUNT_SPILL(); \
+    PUSH(tos); \
+  } while(0)
+
+// Quickened binary operation whose right operand is cached in tos. The result replaces it.
+#define CACHED_TYPED_BINARY(type, kernel, generic_kernel) \
+  do \
+  { \
+    operand2 = tos; \
+    operand1 = POP(); \
+    result = SCRATCH_RESULT(); \
+    if(LIKELY(HAS_TYPE(operand1, type) && HAS_TYPE(operand2, type))) \
+      CHECK_RUN(kernel(&result, operand1, operand2)); \
+    else \
+    { \
+      *instruction = (Byte)get_generic_opcode((Opcode)*instruction); \
+      CHECK_RUN(generic_kernel(&result, operand1, operand2)); \
+    } \
+    tos = result; \
+  } while(0)
+
+// Quickened constant-operand binary operation whose left operand is cached in tos. The result replaces it.
+#define CACHED_TYPED_CONSTANT_BINARY(type, kernel, generic_kernel) \
+  do \
+  { \
+    operand2 = READ_CONSTANT(); \
+    operand1 = tos; \
+    result = SCRATCH_RESULT(); \
+    if(LIKELY(HAS_TYPE(operand1, type))) \
+      CHECK_RUN(kernel(&result, operand1, operand2)); \
+    else \
+    { \
+      *instruction = (Byte)get_generic_opcode((Opcode)*instruction); \
+      CHECK_RUN(generic_kernel(&result, operand1, operand2)); \
+    } \
+    tos = result; \
+  } while(0)
+
+// Consumes the condition cached in tos and branches when its truth value is when
+#define CACHED_JUMP(branch, when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    cached = false; \
+    if(is_truthy(tos) == (when)) \
+      branch(distance); \
+  } while(0)
+
+// Consumes the left operand of OP_JNLK or OP_LLTK cached in tos and branches like LESS_CONSTANT_JUMP()
+#define CACHED_LESS_CONSTANT_JUMP(branch, when) \
+  do \
+  { \
+    distance = READ_SHORT(); \
+    operand2 = READ_CONSTANT(); \
+    cached = false; \
+    if(LIKELY(HAS_TYPE(tos, CCT_TYPE_NUMBER) && operand2->datatype == CCT_TYPE_NUMBER)) \
+      is_less = tos->value.numval < operand2->value.numval; \
+    else \
+      CHECK_RUN(op_less_constant(&is_less, tos, operand2)); \
+    if(is_less == (when)) \
+      branch(distance); \
+  } while(0)
+#endif // !DISPATCH_CHECKED
+
+static RunCode DISPATCH_NAME(void)
+{
+  Chunk* chunk = vm.chunk;
+  Byte* instruction = NULL;
+  Object* operand1 = NULL;
+  Object* operand2 = NULL;
+  Object* result = NULL;
+  Byte reg1 = 0;
+  Byte reg2 = 0;
+  uint16_t distance = 0;
+  bool is_less = false;
+  uint16_t slot = 0;
+  uint16_t slot2 = 0;
+  const Function* function = NULL;
+  Frame* frame = NULL;
+  size_t base = 0;                      // stack index of the first local of the current frame
+  size_t entry_frames = vm.frame_count; // frames active before this chunk started
+  size_t entry_depth = vm.sp->count;    // stack depth before this chunk started
+#if !DISPATCH_CHECKED
+  const bool caching = cache_mode;
+  Object* tos = NULL; // top of the stack while cached is true
+  bool cached = false;
+#endif
+
+  PROFILE_START();
+  for(;;)
+  {
+    instruction = vm.ip;
+    RESERVE_STACK();
+    TRACE_INSTRUCTION();
+    PROFILE_INSTRUCTION();
+#if !DISPATCH_CHECKED
+    if(cached)
+    {
+      switch(READ_BYTE())
+      {
+        case OP_ADDD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, add_decimals, add_objects);
+          continue;
+        case OP_ADDKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, add_decimals, add_objects);
+          continue;
+        case OP_ADDKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, add_numbers, add_objects);
+          continue;
+        case OP_ADDN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, add_numbers, add_objects);
+          continue;
+        case OP_ADDS:
+          CACHED_TYPED_BINARY(CCT_TYPE_STRING, concat_strings, add_objects);
+          continue;
+        case OP_DIVD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, div_decimals, div_objects);
+          continue;
+        case OP_DIVKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, div_decimals, div_objects);
+          continue;
+        case OP_EQLKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, eql_numbers, eql_objects);
+          continue;
+        case OP_EQLN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, eql_numbers, eql_objects);
+          continue;
+        case OP_GTD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, gt_decimals, gt_objects);
+          continue;
+        case OP_GTED:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, gte_decimals, gte_objects);
+          continue;
+        case OP_GTEKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, gte_decimals, gte_objects);
+          continue;
+        case OP_GTEKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, gte_numbers, gte_objects);
+          continue;
+        case OP_GTEN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, gte_numbers, gte_objects);
+          continue;
+        case OP_GTKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, gt_decimals, gt_objects);
+          continue;
+        case OP_GTKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, gt_numbers, gt_objects);
+          continue;
+        case OP_GTN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, gt_numbers, gt_objects);
+          continue;
+        case OP_LTD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, lt_decimals, lt_objects);
+          continue;
+        case OP_LTED:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, lte_decimals, lte_objects);
+          continue;
+        case OP_LTEKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, lte_decimals, lte_objects);
+          continue;
+        case OP_LTEKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, lte_numbers, lte_objects);
+          continue;
+        case OP_LTEN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, lte_numbers, lte_objects);
+          continue;
+        case OP_LTKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, lt_decimals, lt_objects);
+          continue;
+        case OP_LTKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, lt_numbers, lt_objects);
+          continue;
+        case OP_LTN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, lt_numbers, lt_objects);
+          continue;
+        case OP_MULD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, mul_decimals, mul_objects);
+          continue;
+        case OP_MULKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, mul_decimals, mul_objects);
+          continue;
+        case OP_MULKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, mul_numbers, mul_objects);
+          continue;
+        case OP_MULN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, mul_numbers, mul_objects);
+          continue;
+        case OP_NEQKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, neq_numbers, neq_objects);
+          continue;
+        case OP_NEQN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, neq_numbers, neq_objects);
+          continue;
+        case OP_SUBD:
+          CACHED_TYPED_BINARY(CCT_TYPE_DECIMAL, sub_decimals, sub_objects);
+          continue;
+        case OP_SUBKD:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, sub_decimals, sub_objects);
+          continue;
+        case OP_SUBKN:
+          CACHED_TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, sub_numbers, sub_objects);
+          continue;
+        case OP_SUBN:
+          CACHED_TYPED_BINARY(CCT_TYPE_NUMBER, sub_numbers, sub_objects);
+          continue;
+        case OP_GET:
+          READ_GLOBAL(slot);
+          if(UNLIKELY(vm.globals[slot] == NULL))
+            CHECK_RUN(op_get(vm.sp, vm.globals, slot)); // reports the undefined global
+          SPILL();
+          tos = vm.globals[slot];
+          continue;
+        case OP_LDL:
+          reg1 = READ_BYTE();
+          SPILL();
+          tos = vm.sp->objects[base + reg1];
+          continue;
+        case OP_PSH:
+          SPILL();
+          tos = READ_CONSTANT();
+          continue;
+        case OP_ASN:
+          READ_GLOBAL(slot);
+          vm.globals[slot] = tos;
+          cached = false;
+          continue;
+        case OP_STL:
+          reg1 = READ_BYTE();
+          vm.sp->objects[base + reg1] = tos;
+          cached = false;
+          continue;
+        case OP_POP:
+          cached = false;
+          continue;
+        case OP_TST:
+          tos = BOOL_OBJECT(is_truthy(tos));
+          continue;
+        case OP_JMC:
+          CACHED_JUMP(JUMP, true);
+          continue;
+        case OP_JMZ:
+          CACHED_JUMP(JUMP, false);
+          continue;
+        case OP_JNLK:
+          CACHED_LESS_CONSTANT_JUMP(JUMP, false);
+          continue;
+        case OP_LLTK:
+          CACHED_LESS_CONSTANT_JUMP(LOOP, true);
+          continue;
+        case OP_LNZ:
+          CACHED_JUMP(LOOP, true);
+          continue;
+        case OP_LOZ:
+          CACHED_JUMP(LOOP, false);
+          continue;
+        default:
+          // Spill and run the uncached handler
+          vm.ip = instruction;
+          SPILL();
+          cached = false;
+          break;
+      }
+    }
+#endif
+    switch(READ_BYTE())
+    {
+      case OP_ADD:
+        STACK_BINARY(add_objects);
+        break;
+      case OP_ADDD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, add_decimals, add_objects);
+        break;
+      case OP_ADDK:
+        CONSTANT_BINARY(add_objects);
+        break;
+      case OP_ADDKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, add_decimals, add_objects);
+        break;
+      case OP_ADDKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, add_numbers, add_objects);
+        break;
+      case OP_ADDN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, add_numbers, add_objects);
+        break;
+      case OP_ADDS:
+        TYPED_BINARY(CCT_TYPE_STRING, concat_strings, add_objects);
+        break;
+      case OP_AND:
+        STACK_OPERATION(and_objects);
+        break;
+      case OP_ASN:
+        TRACE_ASSIGNMENT();
+        READ_GLOBAL(slot);
+        CHECK_RUN(op_asn(vm.sp, vm.globals, slot));
+        COUNT_TRAFFIC(1, 0);
+        break;
+      case OP_BND:
+        STACK_OPERATION(bnd_objects);
+        break;
+      case OP_BNT:
+        CHECK_RUN(op_bnt(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_BOR:
+        STACK_OPERATION(bor_objects);
+        break;
+      case OP_CAL:
+        distance = READ_SHORT();
+        if(UNLIKELY(!HAS_FUNCTION(distance)))
+          goto runtime_error;
+        function = &chunk->functions[distance];
+        if(UNLIKELY(!HAS_OPERANDS(function->arity)))
+          goto runtime_error;
+        if(UNLIKELY(vm.frame_count == vm.frame_capacity) && !grow_frames())
+          goto runtime_error;
+        if(UNLIKELY(!reserve_stack(vm.sp, function->max_stack)))
+          goto runtime_error;
+        frame = &vm.frames[vm.frame_count++];
+        frame->chunk = chunk;
+        frame->return_ip = vm.ip;
+        frame->base = base;
+        base = vm.sp->count - function->arity;
+        chunk = function->chunk;
+        vm.chunk = chunk;
+        vm.ip = chunk->code + function->entry;
+        break;
+      case OP_CLR:
+        CHECK_RUN(op_clr(vm.rp));
+        TRACE_REGISTERS();
+        break;
+      case OP_CLS:
+        CHECK_RUN(op_cls(vm.sp));
+        break;
+      case OP_CMP:
+        break;
+      case OP_DEC:
+        CHECK_RUN(op_dec(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_DIV:
+        STACK_BINARY(div_objects);
+        break;
+      case OP_DIVD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, div_decimals, div_objects);
+        break;
+      case OP_DIVK:
+        CONSTANT_BINARY(div_objects);
+        break;
+      case OP_DIVKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, div_decimals, div_objects);
+        break;
+      case OP_END:
+        vm.ip = instruction;
+        TRACE_REGISTERS();
+        return RUN_SUCCESS;
+      case OP_ENT:
+        reg1 = READ_BYTE();
+        if(UNLIKELY(!reserve_stack(vm.sp, reg1)))
+          goto runtime_error;
+        for(Byte i = 0; i < reg1; i++)
+          PUSH(vm.null_object);
+        break;
+      case OP_EQL:
+        STACK_BINARY(eql_objects);
+        break;
+      case OP_EQLK:
+        CONSTANT_BINARY(eql_objects);
+        break;
+      case OP_EQLKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, eql_numbers, eql_objects);
+        break;
+      case OP_EQLN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, eql_numbers, eql_objects);
+        break;
+      case OP_EXT:
+        break;
+      case OP_GET:
+        READ_GLOBAL(slot);
+#if DISPATCH_CHECKED
+        CHECK_RUN(op_get(vm.sp, vm.globals, slot));
+        COUNT_TRAFFIC(0, 1);
+#else
+        if(UNLIKELY(vm.globals[slot] == NULL))
+          CHECK_RUN(op_get(vm.sp, vm.globals, slot)); // reports the undefined global
+        result = vm.globals[slot];
+        PUSH_RESULT();
+#endif
+        TRACE_RESULT();
+        break;
+      case OP_GET2:
+        READ_GLOBAL(slot);
+        READ_GLOBAL(slot2);
+        CHECK_RUN(op_get(vm.sp, vm.globals, slot));
+        CHECK_RUN(op_get(vm.sp, vm.globals, slot2));
+        COUNT_TRAFFIC(0, 2);
+        TRACE_RESULT();
+        break;
+      case OP_GOPK:
+        READ_GLOBAL(slot);
+        operand2 = READ_CONSTANT(); // right operand
+        CHECK_RUN(op_gopk(vm.globals, slot, operand2, get_binary_kernel((Opcode)READ_BYTE())));
+        TRACE_VALUE(vm.globals[slot]);
+        break;
+      case OP_GT:
+        STACK_BINARY(gt_objects);
+        break;
+      case OP_GTD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, gt_decimals, gt_objects);
+        break;
+      case OP_GTE:
+        STACK_BINARY(gte_objects);
+        break;
+      case OP_GTED:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, gte_decimals, gte_objects);
+        break;
+      case OP_GTEK:
+        CONSTANT_BINARY(gte_objects);
+        break;
+      case OP_GTEKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, gte_decimals, gte_objects);
+        break;
+      case OP_GTEKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, gte_numbers, gte_objects);
+        break;
+      case OP_GTEN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, gte_numbers, gte_objects);
+        break;
+      case OP_GTK:
+        CONSTANT_BINARY(gt_objects);
+        break;
+      case OP_GTKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, gt_decimals, gt_objects);
+        break;
+      case OP_GTKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, gt_numbers, gt_objects);
+        break;
+      case OP_GTN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, gt_numbers, gt_objects);
+        break;
+      case OP_HLT:
+        vm.ip = instruction;
+        return RUN_SUCCESS;
+      case OP_INC:
+        CHECK_RUN(op_inc(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_JMC:
+        CONDITIONAL_JUMP(JUMP, true);
+        break;
+      case OP_JMF:
+        DECIDING_JUMP(false);
+        break;
+      case OP_JMP:
+        distance = READ_SHORT();
+        JUMP(distance);
+        break;
+      case OP_JMT:
+        DECIDING_JUMP(true);
+        break;
+      case OP_JMZ:
+        CONDITIONAL_JUMP(JUMP, false);
+        break;
+      case OP_JNLK:
+        LESS_CONSTANT_JUMP(JUMP, false);
+        break;
+      case OP_LDL:
+        reg1 = READ_BYTE();
+        if(UNLIKELY(!HAS_LOCAL(reg1)))
+          goto runtime_error;
+        result = vm.sp->objects[base + reg1];
+        PUSH_RESULT();
+        TRACE_RESULT();
+        break;
+      case OP_LLTK:
+        LESS_CONSTANT_JUMP(LOOP, true);
+        break;
+      case OP_LNE:
+        COMPARE_LOOP(false);
+        break;
+      case OP_LNZ:
+        CONDITIONAL_JUMP(LOOP, true);
+        break;
+      case OP_LOD:
+        CHECK_RUN(op_lod(vm.rp, vm.sp, READ_BYTE()));
+        COUNT_TRAFFIC(1, 0);
+        TRACE_REGISTERS();
+        break;
+      case OP_LOE:
+        COMPARE_LOOP(true);
+        break;
+      case OP_LOP:
+        distance = READ_SHORT();
+        LOOP(distance);
+        break;
+      case OP_LOZ:
+        CONDITIONAL_JUMP(LOOP, false);
+        break;
+      case OP_LT:
+        STACK_BINARY(lt_objects);
+        break;
+      case OP_LTD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, lt_decimals, lt_objects);
+        break;
+      case OP_LTE:
+        STACK_BINARY(lte_objects);
+        break;
+      case OP_LTED:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, lte_decimals, lte_objects);
+        break;
+      case OP_LTEK:
+        CONSTANT_BINARY(lte_objects);
+        break;
+      case OP_LTEKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, lte_decimals, lte_objects);
+        break;
+      case OP_LTEKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, lte_numbers, lte_objects);
+        break;
+      case OP_LTEN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, lte_numbers, lte_objects);
+        break;
+      case OP_LTK:
+        CONSTANT_BINARY(lt_objects);
+        break;
+      case OP_LTKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, lt_decimals, lt_objects);
+        break;
+      case OP_LTKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, lt_numbers, lt_objects);
+        break;
+      case OP_LTN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, lt_numbers, lt_objects);
+        break;
+      case OP_MOD:
+        STACK_OPERATION(mod_objects);
+        break;
+      case OP_MODK:
+        CONSTANT_BINARY(mod_objects);
+        break;
+      case OP_MOV:
+        reg1 = READ_BYTE(); // destination
+        reg2 = READ_BYTE(); // source
+        CHECK_RUN(op_mov(vm.rp, NULL, reg2, reg1));
+        TRACE_REGISTERS();
+        break;
+      case OP_MUL:
+        STACK_BINARY(mul_objects);
+        break;
+      case OP_MULD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, mul_decimals, mul_objects);
+        break;
+      case OP_MULK:
+        CONSTANT_BINARY(mul_objects);
+        break;
+      case OP_MULKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, mul_decimals, mul_objects);
+        break;
+      case OP_MULKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, mul_numbers, mul_objects);
+        break;
+      case OP_MULN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, mul_numbers, mul_objects);
+        break;
+      case OP_NEG:
+        CHECK_RUN(op_neg(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_NEQ:
+        STACK_BINARY(neq_objects);
+        break;
+      case OP_NEQK:
+        CONSTANT_BINARY(neq_objects);
+        break;
+      case OP_NEQKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, neq_numbers, neq_objects);
+        break;
+      case OP_NEQN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, neq_numbers, neq_objects);
+        break;
+      case OP_NOP:
+        OP_NOOP;
+        break;
+      case OP_NOT:
+        CHECK_RUN(op_not(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_NUL:
+        break;
+      case OP_OR:
+        STACK_OPERATION(or_objects);
+        break;
+      case OP_POP:
+        CHECK_RUN(op_pop(vm.sp, NULL));
+        COUNT_TRAFFIC(1, 0);
+        TRACE_RESULT();
+        break;
+      case OP_POS:
+        CHECK_RUN(op_pos(vm.sp));
+        COUNT_TRAFFIC(1, 1);
+        TRACE_RESULT();
+        break;
+      case OP_POW:
+        STACK_OPERATION(pow_objects);
+        break;
+      case OP_PSH:
+#if DISPATCH_CHECKED
+        CHECK_RUN(op_psh(vm.sp, READ_CONSTANT()));
+#else
+        result = READ_CONSTANT();
+        PUSH_RESULT();
+#endif
+        TRACE_RESULT();
+        break;
+      case OP_RADD:
+        REGISTER_BINARY(add_objects);
+        break;
+      case OP_RASN:
+        READ_GLOBAL(slot);
+        reg1 = READ_BYTE();
+        CHECK_RUN(op_rasn(vm.rp, vm.globals, slot, reg1));
+        break;
+      case OP_RDIV:
+        REGISTER_BINARY(div_objects);
+        break;
+      case OP_REQL:
+        REGISTER_BINARY(eql_objects);
+        break;
+      case OP_RET:
+        if(UNLIKELY(!HAS_OPERANDS(base + 1) || !HAS_FRAME()))
+          goto runtime_error;
+        result = POP();
+        frame = &vm.frames[--vm.frame_count];
+        vm.sp->count = base;
+        vm.sp->top = (ptrdiff_t)base - 1;
+        PUSH(result);
+        TRACE_RESULT();
+        base = frame->base;
+        chunk = frame->chunk;
+        vm.chunk = chunk;
+        vm.ip = frame->return_ip;
+        break;
+      case OP_RGET:
+        reg1 = READ_BYTE();
+        READ_GLOBAL(slot);
+        CHECK_RUN(op_rget(vm.rp, vm.globals, reg1, slot));
+        TRACE_REGISTER(reg1);
+        break;
+      case OP_RGT:
+        REGISTER_BINARY(gt_objects);
+        break;
+      case OP_RGTE:
+        REGISTER_BINARY(gte_objects);
+        break;
+      case OP_RLDK:
+        reg1 = READ_BYTE();
+        CHECK_RUN(op_mov(vm.rp, READ_CONSTANT(), REGISTER_AMOUNT, reg1));
+        TRACE_REGISTER(reg1);
+        break;
+      case OP_RLT:
+        REGISTER_BINARY(lt_objects);
+        break;
+      case OP_RLTE:
+        REGISTER_BINARY(lte_objects);
+        break;
+      case OP_RMOD:
+        REGISTER_BINARY(mod_objects);
+        break;
+      case OP_RMUL:
+        REGISTER_BINARY(mul_objects);
+        break;
+      case OP_RNEQ:
+        REGISTER_BINARY(neq_objects);
+        break;
+      case OP_RPOW:
+        REGISTER_BINARY(pow_objects);
+        break;
+      case OP_RSUB:
+        REGISTER_BINARY(sub_objects);
+        break;
+      case OP_SETK:
+        READ_GLOBAL(slot);
+        operand2 = READ_CONSTANT(); // value
+        CHECK_RUN(op_setk(vm.globals, slot, operand2));
+        TRACE_VALUE(operand2);
+        break;
+      case OP_SHL:
+        STACK_OPERATION(shl_objects);
+        break;
+      case OP_SHR:
+        STACK_OPERATION(shr_objects);
+        break;
+      case OP_SLE:
+        STACK_OPERATION(sle_objects);
+        break;
+      case OP_SLN:
+        STACK_OPERATION(sln_objects);
+        break;
+      case OP_STL:
+        reg1 = READ_BYTE();
+        if(UNLIKELY(!HAS_OPERANDS(1)))
+          goto runtime_error;
+        result = POP();
+        if(UNLIKELY(!HAS_LOCAL(reg1)))
+          goto runtime_error;
+        vm.sp->objects[base + reg1] = result;
+        break;
+      case OP_STR:
+        CHECK_RUN(op_str(vm.rp, vm.sp, READ_BYTE()));
+        COUNT_TRAFFIC(0, 1);
+        TRACE_REGISTERS();
+        TRACE_RESULT();
+        break;
+      case OP_SUB:
+        STACK_BINARY(sub_objects);
+        break;
+      case OP_SUBD:
+        TYPED_BINARY(CCT_TYPE_DECIMAL, sub_decimals, sub_objects);
+        break;
+      case OP_SUBK:
+        CONSTANT_BINARY(sub_objects);
+        break;
+      case OP_SUBKD:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_DECIMAL, sub_decimals, sub_objects);
+        break;
+      case OP_SUBKN:
+        TYPED_CONSTANT_BINARY(CCT_TYPE_NUMBER, sub_numbers, sub_objects);
+        break;
+      case OP_SUBN:
+        TYPED_BINARY(CCT_TYPE_NUMBER, sub_numbers, sub_objects);
+        break;
+      case OP_SYS:
+        //op_sys(vm.sp);
+        //TRACE_RESULT();
+        break;
+      case OP_TCL:
+        distance = READ_SHORT();
+        if(UNLIKELY(!HAS_FUNCTION(distance) || !HAS_FRAME()))
+          goto runtime_error;
+        function = &chunk->functions[distance];
+        if(UNLIKELY(!HAS_OPERANDS(base + function->arity)))
+          goto runtime_error;
+        memmove(&vm.sp->objects[base], &vm.sp->objects[vm.sp->count - function->arity],
+                function->arity * sizeof(Object*));
+        vm.sp->count = base + function->arity;
+        vm.sp->top = (ptrdiff_t)vm.sp->count - 1;
+        if(UNLIKELY(!reserve_stack(vm.sp, function->max_stack)))
+          goto runtime_error;
+        chunk = function->chunk;
+        vm.chunk = chunk;
+        vm.ip = chunk->code + function->entry;
+        break;
+      case OP_TST:
+        if(UNLIKELY(!HAS_OPERANDS(1)))
+          goto runtime_error;
+        PUSH(BOOL_OBJECT(is_truthy(POP())));
+        TRACE_RESULT();
+        break;
+      case OP_XCG:
+        reg1 = READ_BYTE();
+        reg2 = READ_BYTE();
+        CHECK_RUN(op_xcg(vm.rp, reg1, reg2));
+        TRACE_REGISTERS();
+        break;
+      case OP_XOR:
+        STACK_OPERATION(xor_objects);
+        break;
+      default:
+        fprintf(stderr, "Illegal instruction: %s (0x%02X)\n", get_mnemonic(*instruction), *instruction);
+        goto runtime_error;
+    }
+  }
+
+runtime_error:
+  fprintf(stderr, "Runtime error on line %zu!\n", chunk->lines[instruction - chunk->code]);
+  vm.ip = instruction;
+  // Unwind the frames of the failed calls along with their locals and operands
+  vm.frame_count = entry_frames;
+  if(vm.sp->count > entry_depth)
+  {
+    vm.sp->count = entry_depth;
+    vm.sp->top = (ptrdiff_t)entry_depth - 1;
+  }
+  return RUN_ERROR;
+}
+
+#undef TRACE_INSTRUCTION
+#undef TRACE_RESULT
+#undef TRACE_ASSIGNMENT
+#undef TRACE_VALUE
+#undef TRACE_REGISTERS
+#undef TRACE_REGISTER
+#undef PROFILE_START
+#undef PROFILE_INSTRUCTION
+#undef COUNT_TRAFFIC
+#undef COUNT_SPILL
+#undef PUSH
+#undef POP
+#undef HAS_TYPE
+#undef HAS_OPERANDS
+#undef HAS_FUNCTION
+#undef HAS_LOCAL
+#undef HAS_FRAME
+#undef HAS_GLOBAL
+#undef READ_GLOBAL
+#undef RESERVE_STACK
+#undef JUMP_TO
+#undef SCRATCH_RESULT
+#undef JUMP
+#undef LOOP
+#undef CONDITIONAL_JUMP
+#undef BOOL_OBJECT
+#undef DECIDING_JUMP
+#undef COMPARE_LOOP
+#undef LESS_CONSTANT_JUMP
+#undef READ_BYTE
+#undef READ_SHORT
+#undef READ_CONSTANT
+#undef READ_RK
+#undef CHECK_RUN
+#undef QUICKEN_STACK
+#undef QUICKEN_CONSTANT
+#undef STACK_OPERATION
+#undef STACK_BINARY
+#undef CONSTANT_BINARY
+#undef TYPED_BINARY
+#undef TYPED_CONSTANT_BINARY
+#undef REGISTER_BINARY
+#undef PUSH_RESULT
+#undef SPILL
+#undef CACHED_TYPED_BINARY
+#undef CACHED_TYPED_CONSTANT_BINARY
+#undef CACHED_JUMP
+#undef CACHED_LESS_CONSTANT_JUMP
@@ -28,15 +28,17 @@
 #ifndef INSTRUCTIONS_H
 #define INSTRUCTIONS_H
 
-#include "hash_map.h"
 #include "stack.h"
 #include "vm/vm.h"
 
 #define OP_NOOP (void)0
 
+// Binary operation kernel: computes operand1 <op> operand2 into result without touching the stack. Typed kernels
+// (add_numbers() and the like) reuse *result when it is not NULL, so it must be NULL unless it is a scratch object.
+typedef RunCode (*BinaryKernel)(Object** result, Object* operand1, Object* operand2);
+
 RunCode unary_operand_check(const Object* operand, char* operator);
-RunCode binary_operand_check(const Object* operand1, const Object* operand2, char* operator);
-RunCode binary_operand_check_str(const Object* operand1, const Object* operand2, char* operator);
+bool is_truthy(const Object* object);
 RunCode op_clr(Object** rp);
 RunCode op_cls(Stack* stack);
 RunCode op_lod(Object** rp, Stack* stack, Byte dst_reg);
@@ -44,10 +46,65 @@ RunCode op_mov(Object** rp, Object* object, Byte src_reg, Byte dst_reg);
 RunCode op_str(Object** rp, Stack* stack, Byte src_reg);
 RunCode op_xcg(Object** rp, Byte reg1, Byte reg2);
 RunCode op_pop(Stack* stack, const Object* object);
-RunCode op_psh(Stack* stack, char* value);
-RunCode op_asn(Stack* stack, ConcoctHashMap* map);
-RunCode op_and(Stack* stack);
+RunCode op_psh(Stack* stack, Object* constant);
+RunCode op_get(Stack* stack, Object* const* globals, uint16_t slot);
+RunCode op_asn(Stack* stack, Object** globals, uint16_t slot);
+RunCode op_rget(Object** rp, Object* const* globals, Byte dst_reg, uint16_t slot);
+RunCode op_rasn(Object** rp, Object** globals, uint16_t slot, Byte src_reg);
 RunCode op_not(Stack* stack);
+RunCode op_neg(Stack* stack);
+RunCode op_pos(Stack* stack);
+RunCode op_dec(Stack* stack);
+RunCode op_inc(Stack* stack);
+RunCode op_bnt(Stack* stack);
+RunCode and_objects(Object** result, Object* operand1, Object* operand2);
+RunCode or_objects(Object** result, Object* operand1, Object* operand2);
+RunCode eql_objects(Object** result, Object* operand1, Object* operand2);
+RunCode neq_objects(Object** result, Object* operand1, Object* operand2);
+RunCode sle_objects(Object** result, Object* operand1, Object* operand2);
+RunCode sln_objects(Object** result, Object* operand1, Object* operand2);
+RunCode gt_objects(Object** result, Object* operand1, Object* operand2);
+RunCode gte_objects(Object** result, Object* operand1, Object* operand2);
+RunCode lt_objects(Object** result, Object* operand1, Object* operand2);
+RunCode lte_objects(Object** result, Object* operand1, Object* operand2);
+RunCode add_objects(Object** result, Object* operand1, Object* operand2);
+RunCode sub_objects(Object** result, Object* operand1, Object* operand2);
+RunCode div_objects(Object** result, Object* operand1, Object* operand2);
+RunCode mul_objects(Object** result, Object* operand1, Object* operand2);
+RunCode mod_objects(Object** result, Object* operand1, Object* operand2);
+RunCode pow_objects(Object** result, Object* operand1, Object* operand2);
+RunCode bnd_objects(Object** result, Object* operand1, Object* operand2);
+RunCode bor_objects(Object** result, Object* operand1, Object* operand2);
+RunCode xor_objects(Object** result, Object* operand1, Object* operand2);
+RunCode shl_objects(Object** result, Object* operand1, Object* operand2);
+RunCode shr_objects(Object** result, Object* operand1, Object* operand2);
+RunCode add_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode sub_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode mul_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode eql_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode neq_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode gt_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode gte_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode lt_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode lte_numbers(Object** result, Object* operand1, Object* operand2);
+RunCode add_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode sub_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode mul_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode div_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode gt_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode gte_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode lt_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode lte_decimals(Object** result, Object* operand1, Object* operand2);
+RunCode concat_strings(Object** result, Object* operand1, Object* operand2);
+RunCode op_reg_binary(Object** rp, Byte dst_reg, Object* operand1, Object* operand2, BinaryKernel kernel);
+RunCode op_const_binary(Stack* stack, Object* constant, BinaryKernel kernel);
+RunCode op_setk(Object** globals, uint16_t slot, Object* constant);
+RunCode op_gopk(Object** globals, uint16_t slot, Object* constant, BinaryKernel kernel);
+RunCode op_less_constant(bool* is_less, Object* operand, Object* constant);
+BinaryKernel get_binary_kernel(Opcode oc);
+bool fold_binary(Opcode oc, Object** result, Object* operand1, Object* operand2);
+bool fold_unary(Opcode oc, Object** result, Object* operand);
+RunCode op_and(Stack* stack);
 RunCode op_or(Stack* stack);
 RunCode op_eql(Stack* stack);
 RunCode op_neq(Stack* stack);
@@ -57,10 +114,6 @@ RunCode op_gt(Stack* stack);
 RunCode op_gte(Stack* stack);
 RunCode op_lt(Stack* stack);
 RunCode op_lte(Stack* stack);
-RunCode op_neg(Stack* stack);
-RunCode op_pos(Stack* stack);
-RunCode op_dec(Stack* stack);
-RunCode op_inc(Stack* stack);
 RunCode op_add(Stack* stack);
 RunCode op_sub(Stack* stack);
 RunCode op_div(Stack* stack);
@@ -70,7 +123,6 @@ RunCode op_pow(Stack* stack);
 RunCode op_bnd(Stack* stack);
 RunCode op_bor(Stack* stack);
 RunCode op_xor(Stack* stack);
-RunCode op_bnt(Stack* stack);
 RunCode op_shl(Stack* stack);
 RunCode op_shr(Stack* stack);
 
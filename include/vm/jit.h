@@ -0,0 +1,68 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include "vm/chunk.h" // Chunk
+#include "vm/vm.h"    // RunCode
+
+// Hotness a chunk reaches before it is compiled to native code. Every run of the chunk and every loop back-edge its
+// main program takes adds one, so a program that runs once still compiles its hot loops. The iterations before that
+// quicken the instructions, so the native code is specialized for the types they saw.
+#define JIT_THRESHOLD ((size_t)1000)
+
+// Known limitation: the native code of each instruction is still a call into a C helper that works on the operand
+// stack, so on straight-line arithmetic and decimal code the JIT is no faster than the cached interpreter and is often
+// slower (see vm_benchmark). It pays off on loops, where it removes the dispatch and the hotness checks.
+
+// Compile verified chunks to native code once they reach jit_threshold (disabled by default)
+extern bool jit_mode;
+
+// Hotness at which a chunk is compiled (JIT_THRESHOLD by default)
+extern size_t jit_threshold;
+
+// Returns true if native code can be generated for this platform (x86-64 Linux)
+bool jit_available(void);
+
+// Compiles chunk to native code and returns false if the platform is unsupported or memory could not be mapped
+bool compile_native(Chunk* chunk);
+
+// Runs the native code of chunk and finishes in the interpreter from wherever the native code exits
+RunCode run_native(Chunk* chunk);
+
+// Counts a loop back-edge of the main program of chunk to vm.ip and, once the chunk is hot, runs the loop as native
+// code (on-stack replacement). Returns RUN_SUCCESS with vm.ip at the instruction the interpreter continues with, or
+// RUN_ERROR with vm.ip at the instruction that failed.
+RunCode run_hot_loop(Chunk* chunk);
+
+// Unmaps the native code of chunk
+void free_native(Chunk* chunk);
+
+#endif // JIT_H
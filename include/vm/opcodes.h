@@ -29,46 +29,97 @@
 #define OPCODES_H
 
 #include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include "types.h"   // DataType
 
 // Supported instruction set
 typedef enum opcode
 {
   OP_ADD, // add (+)
+  OP_ADDD, // add decimals (quickened ADD)
+  OP_ADDK, // add constant (fused PSH + ADD)
+  OP_ADDKD, // add decimal constant (quickened ADDK)
+  OP_ADDKN, // add number constant (quickened ADDK)
+  OP_ADDN, // add numbers (quickened ADD)
+  OP_ADDS, // concatenate strings (quickened ADD)
   OP_AND, // logical and (&&)
   OP_ASN, // assign (=)
   OP_BND, // bitwise and (&)
   OP_BNT, // bitwise not/ones' complement (~)
   OP_BOR, // bitwise or (|)
-  OP_CAL, // call
+  OP_CAL, // call function
   OP_CLR, // clear registers
   OP_CLS, // clear stack
   OP_CMP, // compare
   OP_DEC, // decrement (--)
   OP_DIV, // divide (/)
+  OP_DIVD, // divide decimals (quickened DIV)
+  OP_DIVK, // divide by constant (fused PSH + DIV)
+  OP_DIVKD, // divide by decimal constant (quickened DIVK)
   OP_END, // marks end of VM instructions
-  OP_ENT, // entry point
+  OP_ENT, // entry point (first instruction of a function)
   OP_EQL, // equal to (==)
+  OP_EQLK, // equal to constant (fused PSH + EQL)
+  OP_EQLKN, // equal to number constant (quickened EQLK)
+  OP_EQLN, // numbers equal to (quickened EQL)
   OP_EXT, // exit
+  OP_GET, // get (push value of global)
+  OP_GET2, // get two globals (fused GET + GET)
+  OP_GOPK, // update global with constant operand (fused GET + PSH + <op> + ASN)
   OP_GT,  // greater than (>)
+  OP_GTD, // decimal greater than (quickened GT)
   OP_GTE, // greater than or equal to (>=)
+  OP_GTED, // decimal greater than or equal to (quickened GTE)
+  OP_GTEK, // greater than or equal to constant (fused PSH + GTE)
+  OP_GTEKD, // greater than or equal to decimal constant (quickened GTEK)
+  OP_GTEKN, // greater than or equal to number constant (quickened GTEK)
+  OP_GTEN, // number greater than or equal to (quickened GTE)
+  OP_GTK, // greater than constant (fused PSH + GT)
+  OP_GTKD, // greater than decimal constant (quickened GTK)
+  OP_GTKN, // greater than number constant (quickened GTK)
+  OP_GTN, // number greater than (quickened GT)
   OP_HLT, // halt
   OP_INC, // increment (++)
-  OP_JMC, // jump conditional
-  OP_JMP, // jump
-  OP_JMZ, // jump zero
-  OP_LNE, // loop not equal
-  OP_LNZ, // loop not zero
+  OP_JMC, // jump conditional (forward if true)
+  OP_JMF, // jump if false, leaving false (forward, &&)
+  OP_JMP, // jump (forward)
+  OP_JMT, // jump if true, leaving true (forward, ||)
+  OP_JMZ, // jump zero (forward if false)
+  OP_JNLK, // jump if not less than constant (fused PSH + LT + JMZ)
+  OP_LDL, // load local (push value of local slot)
+  OP_LLTK, // loop if less than constant (fused PSH + LT + LNZ)
+  OP_LNE, // loop not equal (back if operands differ)
+  OP_LNZ, // loop not zero (back if true)
   OP_LOD, // load (from memory to register)
-  OP_LOE, // loop equal
-  OP_LOP, // loop
-  OP_LOZ, // loop zero
+  OP_LOE, // loop equal (back if operands are equal)
+  OP_LOP, // loop (back)
+  OP_LOZ, // loop zero (back if false)
   OP_LT,  // less than (<)
+  OP_LTD, // decimal less than (quickened LT)
   OP_LTE, // less than or equal to (<=)
+  OP_LTED, // decimal less than or equal to (quickened LTE)
+  OP_LTEK, // less than or equal to constant (fused PSH + LTE)
+  OP_LTEKD, // less than or equal to decimal constant (quickened LTEK)
+  OP_LTEKN, // less than or equal to number constant (quickened LTEK)
+  OP_LTEN, // number less than or equal to (quickened LTE)
+  OP_LTK, // less than constant (fused PSH + LT)
+  OP_LTKD, // less than decimal constant (quickened LTK)
+  OP_LTKN, // less than number constant (quickened LTK)
+  OP_LTN, // number less than (quickened LT)
   OP_MOD, // modulo (%)
+  OP_MODK, // modulo constant (fused PSH + MOD)
   OP_MOV, // move (from register to register)
   OP_MUL, // multiply (*)
+  OP_MULD, // multiply decimals (quickened MUL)
+  OP_MULK, // multiply by constant (fused PSH + MUL)
+  OP_MULKD, // multiply by decimal constant (quickened MULK)
+  OP_MULKN, // multiply by number constant (quickened MULK)
+  OP_MULN, // multiply numbers (quickened MUL)
   OP_NEG, // negative (unary -)
   OP_NEQ, // not equal to (!=)
+  OP_NEQK, // not equal to constant (fused PSH + NEQ)
+  OP_NEQKN, // not equal to number constant (quickened NEQK)
+  OP_NEQN, // numbers not equal to (quickened NEQ)
   OP_NOP, // no op
   OP_NOT, // logical not/negation (!)
   OP_NUL, // null
@@ -77,26 +128,132 @@ typedef enum opcode
   OP_POS, // positive
   OP_POW, // power/exponent (**)
   OP_PSH, // push
-  OP_RET, // return
+  OP_RADD, // register add (rA = B + C)
+  OP_RASN, // register assign (global = rA)
+  OP_RDIV, // register divide (rA = B / C)
+  OP_REQL, // register equal to (rA = B == C)
+  OP_RET, // return from function
+  OP_RGET, // register get (rA = value of global)
+  OP_RGT, // register greater than (rA = B > C)
+  OP_RGTE, // register greater than or equal to (rA = B >= C)
+  OP_RLDK, // register load constant (rA = constant)
+  OP_RLT, // register less than (rA = B < C)
+  OP_RLTE, // register less than or equal to (rA = B <= C)
+  OP_RMOD, // register modulo (rA = B % C)
+  OP_RMUL, // register multiply (rA = B * C)
+  OP_RNEQ, // register not equal to (rA = B != C)
+  OP_RPOW, // register power/exponent (rA = B ** C)
+  OP_RSUB, // register subtract (rA = B - C)
+  OP_SETK, // set global to constant (fused PSH + ASN)
   OP_SHL, // bitshift left (<<)
   OP_SHR, // bitshift right (>>)
   OP_SLE, // string length equal to ($=)
   OP_SLN, // string length not equal to ($!)
+  OP_STL, // store local (pop into local slot)
   OP_STR, // store (to memory from register)
   OP_SUB, // subtract (-)
+  OP_SUBD, // subtract decimals (quickened SUB)
+  OP_SUBK, // subtract constant (fused PSH + SUB)
+  OP_SUBKD, // subtract decimal constant (quickened SUBK)
+  OP_SUBKN, // subtract number constant (quickened SUBK)
+  OP_SUBN, // subtract numbers (quickened SUB)
   OP_SYS, // system
-  OP_TST, // test
+  OP_TCL, // tail call (call function in place of the running one)
+  OP_TST, // test (replace value with its truth value)
   OP_XCG, // exchange/swap
-  OP_XOR  // bitwise exclusive or (^)
+  OP_XOR // bitwise exclusive or (^)
 } Opcode;
 
+// Number of opcodes (OP_XOR must remain the last entry)
+#define OPCODE_AMOUNT ((size_t)OP_XOR + 1)
+
+// Maximum number of objects pushed by a single instruction (OP_GET2)
+#define MAX_INSTRUCTION_PUSHES ((size_t)2)
+
+/*
+ * Instructions are encoded as a single opcode byte followed by zero or more operand bytes. Operands are
+ * stored little-endian:
+ *
+ *   constant index  2 bytes  (OP_PSH)
+ *   global slot     2 bytes  (OP_ASN, OP_GET)
+ *   register        1 byte   (OP_LOD, OP_STR; OP_MOV and OP_XCG take 2)
+ *   jump offset     2 bytes  (OP_JMC, OP_JMF, OP_JMP, OP_JMT, OP_JMZ, OP_LNE, OP_LNZ, OP_LOE, OP_LOP, OP_LOZ)
+ *   function index  2 bytes  (OP_CAL, OP_TCL)
+ *   local slot      1 byte   (OP_LDL, OP_STL; OP_ENT takes the number of locals after the parameters)
+ *
+ * Global slots are resolved from names by the compiler (see bind_global()) and index the VM-wide globals vector, so
+ * reading or writing a global never hashes its name.
+ *
+ * Jump offsets are unsigned distances from the end of the jump instruction. The opcode gives the direction:
+ * jumps move forward and loops move back. Conditional forms pop their condition and branch on its truth value
+ * (see is_truthy()). OP_LOE and OP_LNE pop two operands and compare them as OP_EQL does. OP_JMF and OP_JMT
+ * implement && and ||: when the condition decides the result they replace it with the shared false or true object
+ * and jump, otherwise they pop it and the right operand is evaluated and converted by OP_TST.
+ *
+ * Functions use a frame on the operand stack. The caller pushes the arguments and OP_CAL makes them the first
+ * local slots of the new frame, where they stay in place. OP_ENT pushes null for the remaining locals and the
+ * operand stack of the function starts above them. OP_RET pops the return value, drops the frame and pushes the
+ * value in place of the arguments. OP_TCL replaces the running function with the callee: the arguments become the
+ * first locals of the same frame and the callee's OP_RET returns to the caller of the replaced function.
+ *
+ * Register-form instructions name their operands directly instead of using the stack:
+ *
+ *   OP_RADD..OP_RSUB  rA, B, C  destination register followed by two RK source bytes
+ *   OP_RGET           rA, g     destination register followed by a global slot
+ *   OP_RLDK           rA, k     destination register followed by a constant index
+ *   OP_RASN           g, rA     global slot followed by source register
+ *
+ * Superinstructions produced by the peephole pass (see peephole.h) fuse common sequences into one dispatch:
+ *
+ *   OP_ADDK..OP_SUBK  k          constant right operand; the left operand is popped from the stack
+ *   OP_GET2           g1, g2     globals pushed in order
+ *   OP_SETK           g, k       global followed by the constant assigned to it
+ *   OP_GOPK           g, k, op   global, constant right operand and the binary opcode applied
+ *   OP_JNLK, OP_LLTK  d, k       jump offset followed by the constant right operand of a comparison
+ *
+ * OP_JNLK and OP_LLTK pop the left operand and compare it with the constant as OP_LT does. OP_JNLK jumps forward when
+ * it is not less and OP_LLTK loops back when it is. The jump offset comes first, as in every other jump.
+ *
+ * A generic binary instruction rewrites itself in place to a form specialized for the operand types it observes
+ * (e.g. OP_ADD to OP_ADDN for two numbers). The compiler only emits quickened forms at -O2, where type inference
+ * proved the operand types (see ir.c). Quickened forms keep the operand layout of their generic form and revert to
+ * it when their type guard fails. The suffix names the operand type: N for Number, D for Decimal and S for String.
+ *
+ * An RK byte below REGISTER_AMOUNT names a register. Larger values name constant (RK - REGISTER_AMOUNT), so
+ * only the first 239 constants of a chunk can be used directly as operands.
+ */
+
 // Returns opcode constant based on numeric ID
 const char* get_mnemonic(Opcode oc);
 
+// Returns number of operand bytes following opcode
+size_t get_operand_length(Opcode oc);
+
 // Returns true if opcode is a unary operation
 bool is_unary_operation(Opcode oc);
 
 // Returns true if opcode is a binary operation
 bool is_binary_operation(Opcode oc);
 
+// Returns true if opcode is a register-form binary operation (rA = B <op> C)
+bool is_register_operation(Opcode oc);
+
+// Returns true if opcode is a binary operation with a constant right operand (fused PSH + <op>)
+bool is_constant_operation(Opcode oc);
+
+// Returns true if opcode transfers control to a jump offset (jumps and loops)
+bool is_jump_operation(Opcode oc);
+
+// Returns true if opcode jumps back (loops)
+bool is_loop_operation(Opcode oc);
+
+// Returns true if execution can continue with the instruction following opcode
+bool falls_through(Opcode oc);
+
+// Returns form of generic binary opcode specialized for the given operand types or oc if there is none
+Opcode get_quickened_opcode(Opcode oc, DataType type1, DataType type2);
+
+// Returns generic form of a quickened opcode or oc if it is not quickened
+Opcode get_generic_opcode(Opcode oc);
+
 #endif // OPCODES_H
@@ -0,0 +1,90 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>    // bool
+#include <stddef.h>     // size_t
+#include <stdint.h>     // uint64_t
+#include "vm/chunk.h"   // Chunk
+#include "vm/opcodes.h" // Opcode
+
+// Number of entries printed for each table of the profile report
+#define PROFILE_REPORT_LIMIT ((size_t)20)
+
+// Records opcode frequencies while interpreting when set (selects the profiling interpreter loop)
+extern bool profile_mode;
+
+// Instructions executed and the stack and memory traffic they caused. Loads read a constant, global, local or
+// register and stores write a global, local or register (so OP_LOD stores and OP_STR loads).
+typedef struct operation_counts
+{
+  uint64_t instructions;
+  uint64_t pushes;
+  uint64_t pops;
+  uint64_t loads;
+  uint64_t stores;
+} OperationCounts;
+
+// Counts the operand stack traffic of verified chunks while interpreting when set (selects a counting copy of the
+// lean loop, which never enters native code)
+extern bool traffic_mode;
+
+// Objects the lean loop and the helpers it calls pushed onto and popped from vm.sp in traffic mode, and how many of
+// the pushes spilled the cached top of the stack
+typedef struct stack_traffic
+{
+  uint64_t pushes;
+  uint64_t pops;
+  uint64_t spills;
+} StackTraffic;
+
+extern StackTraffic stack_traffic;
+
+// Allocates opcode counters
+void init_profile(void);
+
+// Frees opcode counters
+void free_profile(void);
+
+// Forgets the previously executed opcodes so sequences do not span separate runs
+void reset_profile_history(void);
+
+// Counts opcode along with the bigram and trigram it completes
+void profile_opcode(Opcode oc);
+
+// Counts the instruction at offset of chunk along with the sequences it completes and its stack and memory traffic
+void profile_instruction(const Chunk* chunk, size_t offset);
+
+// Returns the instructions counted since init_profile() and their traffic
+OperationCounts get_operation_counts(void);
+
+// Prints the stack and memory traffic and the most frequent opcodes, bigrams and trigrams
+void print_profile(size_t limit);
+
+#endif // PROFILE_H
@@ -0,0 +1,67 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include "hash_map.h" // ConcoctHashMap
+#include "vm/chunk.h"
+#include "vm/vm.h"    // RunCode
+
+/*
+ * A program is an ordered list of independently allocated chunks. The compiler starts a new module chunk whenever
+ * the current one approaches the limits of its 16-bit operands, so programs of any size compile without a hard cap.
+ * Module chunks run in order and share identifier bindings through the map passed to run_program(). Functions are
+ * compiled into the first chunk and later chunks call them there, so a chunk can only be released once no loaded
+ * chunk imports its functions (see Chunk.importers). Every other chunk can be released on its own once it has run.
+ */
+typedef struct program
+{
+  size_t count;    // number of chunks
+  size_t capacity; // number of chunk slots allocated
+  Chunk** chunks;  // chunks in execution order (NULL once unloaded)
+} Program;
+
+// Initializes program
+void init_program(Program* program);
+
+// Frees program and all chunks it still holds
+void free_program(Program* program);
+
+// Appends a new empty chunk to program and returns it (NULL if memory could not be allocated)
+Chunk* add_chunk(Program* program);
+
+// Frees the chunk at index, leaving an empty slot. Returns false and keeps the chunk if a loaded chunk still calls
+// functions compiled into it.
+bool unload_chunk(Program* program, size_t index);
+
+// Interprets the chunks of program in order and stops at the first runtime error
+RunCode run_program(Program* program, ConcoctHashMap* map);
+
+#endif // PROGRAM_H
@@ -0,0 +1,63 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include "vm/chunk.h"
+
+/*
+ * The verifier decodes a chunk before it runs and then follows every path through it (each offset is visited once,
+ * from the first jump or fallthrough that reaches it). It proves the properties the unchecked interpreter loop
+ * relies on:
+ *
+ *   - every opcode is supported and its operands lie within the chunk
+ *   - constant operands index the constant pool, identifiers are string constants and registers exist
+ *   - no instruction pops more objects than the stack holds, and the stack is empty at OP_END (balance)
+ *   - control never leaves the chunk or lands inside an instruction, and every path reaching an instruction does
+ *     so with the same stack depth
+ *
+ * A verified chunk records its maximum stack depth so the VM can reserve it once per frame. Chunks that fail
+ * verification (or were never verified) still run, but on the checked interpreter loop.
+ *
+ * It also runs an escape analysis over each basic block. A binary or constant-operand operation whose result is
+ * popped in the same block by an instruction that only reads it (another such operation, a conditional jump, OP_TST
+ * or OP_POP) is marked in Chunk.unescaped. The result never reaches a global, local, register, call or return, so the
+ * unchecked loop computes it into the scratch object of its stack slot (see get_scratch()) instead of the object
+ * store. Anything else is assumed to escape.
+ */
+
+// Verifies chunk and marks it safe for the unchecked interpreter loop on success
+bool verify_chunk(Chunk* chunk);
+
+// Stores the number of objects the instruction at offset of chunk pops and pushes, not counting the object OP_JMF and
+// OP_JMT leave when they jump. Returns false if its operands are invalid.
+bool get_stack_effect(const Chunk* chunk, size_t offset, size_t* pops, size_t* pushes);
+
+#endif // VERIFIER_H
@@ -31,23 +31,72 @@
 #include "hash_map.h"
 #include "stack.h"
 #include "types.h"      // BigNum, Byte
+#include "vm/chunk.h"   // Chunk
 #include "vm/opcodes.h" // Opcode
 
 #define REGISTER_AMOUNT ((uint8_t)17)
 static const uint8_t REGISTER_EMPTY = 127;
-static const size_t INSTRUCTION_STORE_SIZE = 128;
+
+typedef enum
+{
+  RUN_SUCCESS,
+  RUN_ERROR
+} RunCode;
+
+#define INITIAL_FRAME_CAPACITY ((size_t)64)
+#define MAX_CALL_DEPTH ((size_t)65536)
+#define INITIAL_GLOBAL_CAPACITY ((size_t)64)
+#define INITIAL_SCRATCH_AMOUNT ((size_t)64)
+
+// First character of globals holding compiler temporaries. Source code cannot spell such names, and their slots are
+// never loaded from or stored to the identifier map, so they do not show up in (or outlive) the caller's globals.
+#define HIDDEN_GLOBAL_PREFIX '$'
+
+// Call frame saved by OP_CAL and restored by OP_RET
+typedef struct frame
+{
+  Chunk* chunk;     // chunk of the caller
+  Byte* return_ip;  // instruction following the call
+  size_t base;      // stack index of the caller's first local
+} Frame;
 
 typedef struct vm
 {
-  Opcode* instructions;               // instructions to execute
+  RunCode (*dispatch)(void);          // loop for verified chunks selected at startup
+  RunCode (*dispatch_checked)(void);  // loop for unverified chunks
+  Chunk* chunk;                       // code object being executed
   Object* registers[REGISTER_AMOUNT]; // registers
   Object** rp;                        // register pointer
   Stack stack;                        // stack structure
   Stack* sp;                          // stack pointer/top item of stack
-  Opcode* ip;                         // instruction pointer/program counter
+  Byte* ip;                           // instruction pointer/program counter
+  Object* true_object;                // shared results of logical operations (never collected)
+  Object* false_object;
+  Object* null_object;                // initial value of locals (never collected)
+  Frame* frames;                      // contiguous call frame stack, grown geometrically
+  size_t frame_count;                 // number of active calls
+  size_t frame_capacity;              // number of frames allocated
+  Object** globals;                   // value of each global slot while a chunk using it runs (NULL if unbound)
+  char** global_names;                // identifier of each global slot
+  size_t global_count;                // number of global slots
+  size_t global_capacity;             // number of global slots allocated
+  ConcoctHashMap* global_slots;       // identifier -> global slot + 1
+  Object** scratch;                   // reusable result object of each stack slot (never in the object store)
+  size_t scratch_count;               // number of scratch objects allocated
 } VM;
 extern VM vm;
 
+// Allocates scratch objects up to stack slot and returns its object or NULL if memory could not be allocated
+Object* grow_scratch(size_t slot);
+
+// Returns the scratch object of stack slot or NULL if it could not be allocated. The unchecked loop computes results
+// the verifier proved never escape (see Chunk.unescaped) into it instead of allocating. The object is overwritten by
+// the next such result in the same slot, which can only happen after the instruction reading it has run.
+static inline Object* get_scratch(size_t slot)
+{
+  return slot < vm.scratch_count ? vm.scratch[slot] : grow_scratch(slot);
+}
+
 // Register names/indexes
 static const Byte R0 = 0;
 static const Byte R1 = 1;
@@ -66,32 +115,42 @@ static const Byte R13 = 13;
 static const Byte R14 = 14;
 static const Byte R15 = 15;
 static const Byte RS = 16;  // result
-extern Opcode** IP;         // instruction pointer
-extern Object** RP;         // register pointer
-extern Stack** SP;          // stack pointer
 
-typedef enum
-{
-  RUN_SUCCESS,
-  RUN_ERROR
-} RunCode;
+// Number of constants that register-form instructions can name directly through an RK operand byte
+static const uint16_t RK_CONSTANT_AMOUNT = 256 - REGISTER_AMOUNT;
 
-// Clears instructions
-void clear_instructions(void);
+// Rewrite generic binary instructions to type-specialized forms as they execute (enabled by default)
+extern bool quicken_mode;
 
-// Reverses instructions since they should be in a LIFO arrangement
-void reverse_instructions(size_t ic);
+// Keep the top of the stack in a local of the lean interpreter loop instead of vm.sp (enabled by default)
+extern bool cache_mode;
+
+extern Byte** IP;           // instruction pointer
+extern Object** RP;         // register pointer
+extern Stack** SP;          // stack pointer
 
 // Prints register values
 void print_registers(void);
 
-// Initializes virtual machine
+// Initializes virtual machine and selects its interpreter loop (see select_dispatch())
 void init_vm(void);
 
+// Selects the tracing interpreter loop in debug mode, the profiling loop in profile mode, the counting copy of the
+// lean loop in traffic mode and the lean loop otherwise
+void select_dispatch(void);
+
 // Stops virtual machine
 void stop_vm(void);
 
-// Interprets code
-RunCode interpret(ConcoctHashMap* map);
+// Grows the call frame stack and returns false if MAX_CALL_DEPTH is reached or memory could not be allocated
+bool grow_frames(void);
+
+// Returns the global slot of identifier name, allocating it on first use, and records that chunk uses it. Sets the
+// error flag of chunk if no slot is left.
+uint16_t bind_global(Chunk* chunk, const char* name);
+
+// Interprets chunk using map for identifier bindings. Globals live in slots while the chunk runs; map is only read
+// when the chunk starts and updated when it stops (hidden globals are left out of it).
+RunCode interpret(Chunk* chunk, ConcoctHashMap* map);
 
 #endif // VM_H
@@ -72,7 +72,10 @@ char cct_get_char_from_stream(ConcoctCharStream* stream)
       char ch = stream->input.string_input[stream->index - 1];
       return ch;
     }
-    return (char)getc(stream->input.file_input);
+    int ch = getc(stream->input.file_input);
+    if(ch == EOF)
+      return '\0';
+    return (char)ch;
   }
   return '\0';
 }
@@ -25,224 +25,1602 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <stdio.h>    // fprintf()
+#include <stdint.h>   // UINT16_MAX
+#include <stdio.h>    // fprintf(), snprintf()
+#include <stdlib.h>   // free(), realloc()
+#include <string.h>   // strcmp()
 #include "compiler.h"
-#include "debug.h"    // debug_mode, debug_print()
+#include "debug.h"    // debug_mode
+#include "ir.h"       // ir_mode, optimize_ir(), print_ir_hits()
 #include "memory.h"   // new_object(), new_object_by_type()
-#include "queue.h"
-#include "vm/vm.h"    // interpret(), reverse_instructions()
+#include "peephole.h" // fuse_superinstructions(), fusion_mode, optimize_chunk(), peephole_mode
+#include "vm/chunk.h" // add_constant(), print_chunk(), set_jump_target(), write_opcode(), write_short()
+#include "vm/instructions.h" // fold_binary(), fold_unary(), is_truthy()
+#include "vm/verifier.h" // verify_chunk()
+#include "vm/vm.h"    // HIDDEN_GLOBAL_PREFIX, RK_CONSTANT_AMOUNT, REGISTER_AMOUNT, RS, vm
 
-// Swap last 2 stack objects to fix order if first instruction is a binary operation
-void swap_last_operands(Opcode oc)
+bool register_mode = false;
+bool folding_mode = true;
+bool inline_mode = true;
+
+// Number of globals whose constant value the compiler tracks at once
+#define MAX_KNOWN_AMOUNT ((size_t)256)
+
+// Size of a PSH instruction (opcode and 16-bit constant index)
+#define PSH_SIZE ((size_t)3)
+
+// Number of functions of a program considered for inlining
+#define MAX_INLINE_AMOUNT ((size_t)256)
+
+// Largest expression (in parse tree nodes) a function may return to be inlined, and most nodes inlining it may add
+// to the program (its size times the number of calls to it)
+#define MAX_INLINE_NODES ((size_t)16)
+#define MAX_INLINE_GROWTH ((size_t)128)
+
+// Forward jumps waiting for the offset they leave a loop through (break) or continue it at (continue)
+typedef struct jump_list
+{
+  size_t count;
+  size_t capacity;
+  size_t* offsets;
+} JumpList;
+
+// Loop being compiled, linked to the loop enclosing it
+typedef struct loop
+{
+  struct loop* enclosing;
+  size_t depth;        // number of enclosing loops
+  JumpList breaks;
+  JumpList continues;
+} Loop;
+
+// Function being compiled. Its parameters and every identifier it assigns are locals held in the slots of its frame;
+// any other identifier it reads is a global.
+typedef struct scope
+{
+  const char* names[MAX_LOCAL_AMOUNT];
+  size_t count; // number of locals (parameters first)
+} Scope;
+
+// Function being compiled or NULL while compiling top-level statements
+static Scope* scope = NULL;
+
+// Global holding a known constant. A top-level assignment of a constant makes the value known to the statements that
+// follow it, up to the next top-level statement that assigns the global again. Functions cannot assign globals, so
+// only their bodies (which may run at any time) still read it from the global.
+typedef struct known_global
+{
+  const char* name;
+  Object* value;
+} KnownGlobal;
+
+static KnownGlobal known[MAX_KNOWN_AMOUNT];
+static size_t known_count = 0;
+
+// Function whose calls compile to the expression it returns (see find_inlinable()). Its body is a single return (or
+// final expression) without calls, so it is a leaf and never recursive.
+typedef struct inline_function
+{
+  const ConcoctNode* declaration;
+  const ConcoctNode* expression;
+} InlineFunction;
+
+static InlineFunction inlinable[MAX_INLINE_AMOUNT];
+static size_t inlinable_count = 0;
+
+// Call whose function is being inlined. A parameter of the function compiles to the matching argument of the call,
+// which is compiled in the context of the enclosing call (NULL outside any inlined call).
+typedef struct inlined_call
+{
+  const ConcoctNode* call;
+  const InlineFunction* function;
+  struct inlined_call* enclosing;
+} InlinedCall;
+
+static InlinedCall* inlined = NULL;
+
+// Walk over an inlined expression in evaluation order checking that errors are reported in the order of the call
+typedef struct error_order
+{
+  const InlinedCall* call;
+  size_t next;      // next parameter whose argument can fail, in parameter order (arity once all are read)
+  bool has_failed;  // the expression evaluated something of its own that can fail
+} ErrorOrder;
+
+// Returns binary opcode for operator token or OP_NOP if token is not a binary operator
+static Opcode get_binary_opcode(ConcoctTokenType type)
+{
+  switch(type)
+  {
+    case CCT_TOKEN_ADD:               return OP_ADD;
+    case CCT_TOKEN_BIN_AND:           return OP_BND;
+    case CCT_TOKEN_BIN_OR:            return OP_BOR;
+    case CCT_TOKEN_BIN_XOR:           return OP_XOR;
+    case CCT_TOKEN_DIV:               return OP_DIV;
+    case CCT_TOKEN_EQUAL:             return OP_EQL;
+    case CCT_TOKEN_EXP:               return OP_POW;
+    case CCT_TOKEN_GREATER:           return OP_GT;
+    case CCT_TOKEN_GREATER_EQUAL:     return OP_GTE;
+    case CCT_TOKEN_LESS:              return OP_LT;
+    case CCT_TOKEN_LESS_EQUAL:        return OP_LTE;
+    case CCT_TOKEN_MOD:               return OP_MOD;
+    case CCT_TOKEN_MUL:               return OP_MUL;
+    case CCT_TOKEN_NOT_EQUAL:         return OP_NEQ;
+    case CCT_TOKEN_SHL:               return OP_SHL;
+    case CCT_TOKEN_SHR:               return OP_SHR;
+    case CCT_TOKEN_STRLEN_EQUAL:      return OP_SLE;
+    case CCT_TOKEN_STRLEN_NOT_EQUAL:  return OP_SLN;
+    case CCT_TOKEN_SUB:               return OP_SUB;
+    default:                          return OP_NOP;
+  }
+}
+
+// Returns unary opcode for operator token or OP_NOP if token is not a unary operator
+static Opcode get_unary_opcode(ConcoctTokenType type)
+{
+  switch(type)
+  {
+    case CCT_TOKEN_ADD:          return OP_POS;
+    case CCT_TOKEN_BIN_NOT:      return OP_BNT;
+    case CCT_TOKEN_DEC:          return OP_DEC;
+    case CCT_TOKEN_INC:          return OP_INC;
+    case CCT_TOKEN_NOT:          return OP_NOT;
+    case CCT_TOKEN_UNARY_MINUS:  return OP_NEG;
+    default:                     return OP_NOP;
+  }
+}
+
+// Returns opcode applied by compound assignment token or OP_NOP for plain assignment
+static Opcode get_assign_opcode(ConcoctTokenType type)
+{
+  switch(type)
+  {
+    case CCT_TOKEN_ADD_ASSIGN:  return OP_ADD;
+    case CCT_TOKEN_DIV_ASSIGN:  return OP_DIV;
+    case CCT_TOKEN_EXP_ASSIGN:  return OP_POW;
+    case CCT_TOKEN_MOD_ASSIGN:  return OP_MOD;
+    case CCT_TOKEN_MUL_ASSIGN:  return OP_MUL;
+    case CCT_TOKEN_SUB_ASSIGN:  return OP_SUB;
+    default:                    return OP_NOP;
+  }
+}
+
+// Returns constant index of identifier name, reusing an existing entry in the constant pool if possible
+static uint16_t identifier_constant(Chunk* chunk, const char* name)
 {
-  Object* object1 = NULL;
-  Object* object2 = NULL;
-  if(!is_binary_operation(oc))
+  for(size_t i = 0; i < chunk->constant_count; i++)
+  {
+    const Object* constant = chunk->constants[i];
+    if(constant->datatype == CCT_TYPE_STRING && strcmp(constant->value.strobj.strval, name) == 0)
+      return (uint16_t)i;
+  }
+  return add_constant(chunk, new_object_by_type((void *)name, CCT_TYPE_STRING));
+}
+
+// Emits an instruction followed by a 16-bit operand (constant index or global slot)
+static void emit_constant_op(Chunk* chunk, Opcode oc, uint16_t index, size_t line)
+{
+  write_opcode(chunk, oc, line);
+  write_short(chunk, index, line);
+  return;
+}
+
+// Returns the copy of name held by the constant pool of chunk, which lives as long as the chunk (NULL if the pool
+// is full)
+static const char* intern_name(Chunk* chunk, const char* name)
+{
+  uint16_t index = identifier_constant(chunk, name);
+
+  if(chunk->has_error)
+    return NULL;
+  return chunk->constants[index]->value.strobj.strval;
+}
+
+// Returns the local slot of name in the current function or -1 if name is not a local
+static int resolve_local(const char* name)
+{
+  if(scope == NULL)
+    return -1;
+  for(size_t i = 0; i < scope->count; i++)
+  {
+    if(strcmp(scope->names[i], name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// Adds name to the locals of the current function unless it already is one
+static bool declare_local(const char* name, size_t line)
+{
+  if(resolve_local(name) >= 0)
+    return true;
+  if(scope->count == MAX_LOCAL_AMOUNT)
+  {
+    fprintf(stderr, "Too many locals in function on line %zu (limit is %zu)!\n", line, (size_t)MAX_LOCAL_AMOUNT);
+    return false;
+  }
+  scope->names[scope->count++] = name;
+  return true;
+}
+
+// Returns the known constant value of global name or NULL if it is not known where code is being compiled
+static Object* find_known(const char* name)
+{
+  if(scope != NULL)
+    return NULL;
+  for(size_t i = 0; i < known_count; i++)
+  {
+    if(strcmp(known[i].name, name) == 0)
+      return known[i].value;
+  }
+  return NULL;
+}
+
+// Forgets the known value of global name
+static void forget_known(const char* name)
+{
+  for(size_t i = 0; i < known_count; i++)
+  {
+    if(strcmp(known[i].name, name) == 0)
+    {
+      known[i] = known[--known_count];
+      return;
+    }
+  }
+  return;
+}
+
+// Makes value the known value of global name (dropped if too many globals are known already)
+static void remember_known(const char* name, Object* value)
+{
+  forget_known(name);
+  if(known_count < MAX_KNOWN_AMOUNT)
+    known[known_count++] = (KnownGlobal){ name, value };
+  return;
+}
+
+// Forgets the known value of every global the statement assigns
+static void forget_assigned(const ConcoctNode* node)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_ASSIGN:
+    case CCT_TOKEN_ADD_ASSIGN:
+    case CCT_TOKEN_DIV_ASSIGN:
+    case CCT_TOKEN_EXP_ASSIGN:
+    case CCT_TOKEN_MOD_ASSIGN:
+    case CCT_TOKEN_MUL_ASSIGN:
+    case CCT_TOKEN_SUB_ASSIGN:
+    case CCT_TOKEN_FOR:
+      if(node->child_count > 0 && node->children[0]->token.type == CCT_TOKEN_IDENTIFIER)
+        forget_known(node->children[0]->text);
+      break;
+    default:
+      break;
+  }
+  for(size_t i = 0; i < node->child_count; i++)
+    forget_assigned(node->children[i]);
+  return;
+}
+
+// Returns the constant pushed by the code in [start, chunk->count) or NULL unless that code is a single PSH
+static Object* get_pushed_constant(const Chunk* chunk, size_t start)
+{
+  if(chunk->has_error || chunk->count != start + PSH_SIZE || chunk->code[start] != OP_PSH)
+    return NULL;
+  return chunk->constants[read_short(&chunk->code[start + 1])];
+}
+
+// Replaces the code in [start, chunk->count) with a PSH of constant
+static void replace_with_constant(Chunk* chunk, size_t start, Object* constant, size_t line)
+{
+  chunk->count = start;
+  emit_constant_op(chunk, OP_PSH, add_constant(chunk, constant), line);
+  return;
+}
+
+// Emits a read of identifier name from its local slot or from the global map, or a push of its known value
+static void emit_get(Chunk* chunk, const char* name, size_t line)
+{
+  int slot = resolve_local(name);
+  Object* value = folding_mode ? find_known(name) : NULL;
+
+  if(value != NULL)
+  {
+    emit_constant_op(chunk, OP_PSH, add_constant(chunk, value), line);
     return;
-  if(debug_mode)
-    debug_print("Swapping top 2 objects of stack...");
-  object1 = pop(vm.sp);
-  object2 = pop(vm.sp);
-  push(vm.sp, object1);
-  push(vm.sp, object2);
+  }
+  if(slot < 0)
+  {
+    emit_constant_op(chunk, OP_GET, bind_global(chunk, name), line);
+    return;
+  }
+  write_opcode(chunk, OP_LDL, line);
+  write_chunk(chunk, (Byte)slot, line);
   return;
 }
 
-// Translates lexer/parser tokens to VM instructions
-void compile(ConcoctNodeTree* tree, ConcoctHashMap* map)
+// Emits a store of the top of the stack to identifier name. Inside a function every assigned identifier is a local.
+static bool emit_set(Chunk* chunk, const char* name, size_t line)
+{
+  if(scope == NULL)
+  {
+    emit_constant_op(chunk, OP_ASN, bind_global(chunk, name), line);
+    return true;
+  }
+  if(!declare_local(name, line))
+    return false;
+  write_opcode(chunk, OP_STL, line);
+  write_chunk(chunk, (Byte)resolve_local(name), line);
+  return true;
+}
+
+// Returns true if node is a literal constant
+static bool is_literal(const ConcoctNode* node)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_CHAR:
+    case CCT_TOKEN_FALSE:
+    case CCT_TOKEN_FLOAT:
+    case CCT_TOKEN_INT:
+    case CCT_TOKEN_NULL:
+    case CCT_TOKEN_STRING:
+    case CCT_TOKEN_TRUE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Creates the object for a literal node
+static Object* new_literal(const ConcoctNode* node)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_CHAR:   return new_object_by_type(node->text, CCT_TYPE_BYTE);
+    case CCT_TOKEN_FALSE:  return new_object("false");
+    case CCT_TOKEN_FLOAT:
+    case CCT_TOKEN_INT:    return new_object(node->text);
+    case CCT_TOKEN_NULL:   return new_object("null");
+    case CCT_TOKEN_STRING: return new_object_by_type(node->text, CCT_TYPE_STRING);
+    case CCT_TOKEN_TRUE:   return new_object("true");
+    default:               return NULL;
+  }
+}
+
+// Emits a jump with a placeholder offset and returns the offset of the jump instruction for patch_jump()
+static size_t emit_jump(Chunk* chunk, Opcode oc, size_t line)
+{
+  size_t offset = chunk->count;
+  write_opcode(chunk, oc, line);
+  write_short(chunk, UINT16_MAX, line);
+  return offset;
+}
+
+// Points the jump at offset to target and reports an error if the jump is too long for its operand
+static bool patch_jump(Chunk* chunk, size_t offset, size_t target)
+{
+  if(chunk->has_error)
+    return false;
+  if(!set_jump_target(chunk, offset, target))
+  {
+    fprintf(stderr, "Jump on line %zu is too long (%zu bytes)!\n", chunk->lines[offset],
+            target > offset ? target - offset : offset - target);
+    return false;
+  }
+  return true;
+}
+
+// Emits a loop back to target
+static bool emit_loop(Chunk* chunk, Opcode oc, size_t target, size_t line)
+{
+  return patch_jump(chunk, emit_jump(chunk, oc, line), target);
+}
+
+// Adds the jump at offset to list
+static bool add_jump(JumpList* list, size_t offset)
+{
+  size_t* offsets = NULL;
+
+  if(list->count == list->capacity)
+  {
+    list->capacity = list->capacity == 0 ? 8 : list->capacity * 2;
+    offsets = realloc(list->offsets, list->capacity * sizeof(size_t));
+    if(offsets == NULL)
+    {
+      fprintf(stderr, "Unable to allocate memory for loop jumps!\n");
+      return false;
+    }
+    list->offsets = offsets;
+  }
+  list->offsets[list->count++] = offset;
+  return true;
+}
+
+// Points every jump in list to target
+static bool patch_jumps(Chunk* chunk, const JumpList* list, size_t target)
+{
+  for(size_t i = 0; i < list->count; i++)
+  {
+    if(!patch_jump(chunk, list->offsets[i], target))
+      return false;
+  }
+  return true;
+}
+
+static bool compile_expression(const ConcoctNode* node, Chunk* chunk);
+
+// Returns the index of the function called name in the function table of chunk or -1 if there is none
+static int find_function(const Chunk* chunk, const char* name)
+{
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(strcmp(chunk->functions[i].name, name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// Returns number of nodes in the tree under node
+static size_t count_nodes(const ConcoctNode* node)
 {
-  ConcoctNode* root = tree->root;
-  Queue queue;
-  Queue* pqueue = &queue;
-  size_t ic = 0; // instruction count
+  size_t count = 1;
+  for(size_t i = 0; i < node->child_count; i++)
+    count += count_nodes(node->children[i]);
+  return count;
+}
 
-  if(root == NULL)
+// Returns number of calls to the function called name in the tree under node
+static size_t count_calls(const ConcoctNode* node, const char* name)
+{
+  size_t count = node->token.type == CCT_TOKEN_LEFT_PAREN && strcmp(node->text, name) == 0 ? 1 : 0;
+  for(size_t i = 0; i < node->child_count; i++)
+    count += count_calls(node->children[i], name);
+  return count;
+}
+
+// Returns true if the expression under node calls a function
+static bool has_call(const ConcoctNode* node)
+{
+  if(node->token.type == CCT_TOKEN_LEFT_PAREN)
+    return true;
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    if(has_call(node->children[i]))
+      return true;
+  }
+  return false;
+}
+
+// Returns number of reads of identifier name in the expression under node
+static size_t count_reads(const ConcoctNode* node, const char* name)
+{
+  size_t count = node->token.type == CCT_TOKEN_IDENTIFIER && strcmp(node->text, name) == 0 ? 1 : 0;
+  for(size_t i = 0; i < node->child_count; i++)
+    count += count_reads(node->children[i], name);
+  return count;
+}
+
+// Returns true if statement node is an expression (including a call) whose value is discarded, or returned when it
+// ends a function
+static bool is_expression_statement(const ConcoctNode* node)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_NEWLINE:
+    case CCT_TOKEN_LEFT_BRACE:
+    case CCT_TOKEN_IF:
+    case CCT_TOKEN_WHILE:
+    case CCT_TOKEN_DO:
+    case CCT_TOKEN_FOR:
+    case CCT_TOKEN_BREAK:
+    case CCT_TOKEN_CONTINUE:
+    case CCT_TOKEN_RETURN:
+    case CCT_TOKEN_FUNC:
+    case CCT_TOKEN_ASSIGN:
+    case CCT_TOKEN_ADD_ASSIGN:
+    case CCT_TOKEN_DIV_ASSIGN:
+    case CCT_TOKEN_EXP_ASSIGN:
+    case CCT_TOKEN_MOD_ASSIGN:
+    case CCT_TOKEN_MUL_ASSIGN:
+    case CCT_TOKEN_SUB_ASSIGN:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Returns the expression returned by a function whose body is a single return statement or expression without calls,
+// or NULL
+static const ConcoctNode* get_leaf_expression(const ConcoctNode* declaration)
+{
+  const ConcoctNode* body = declaration->children[declaration->child_count - 1];
+  const ConcoctNode* expression = NULL;
+
+  if(body->child_count != 1)
+    return NULL;
+  body = body->children[0];
+  if(body->token.type == CCT_TOKEN_RETURN && body->child_count == 1)
+    expression = body->children[0];
+  else if(is_expression_statement(body))
+    expression = body;
+  return expression == NULL || has_call(expression) ? NULL : expression;
+}
+
+// Returns the parameter index of identifier name in the function of call or -1 if it is not a parameter
+static int find_parameter(const InlinedCall* call, const char* name)
+{
+  const ConcoctNode* declaration = call->function->declaration;
+
+  for(size_t i = 0; i + 1 < declaration->child_count; i++)
+  {
+    if(strcmp(declaration->children[i]->text, name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// Finds the functions declared among the top-level statements of root whose calls are inlined. A function qualifies
+// if it returns a small expression without calls that reads every parameter, and the code added by inlining all of
+// its calls stays within MAX_INLINE_GROWTH.
+static void find_inlinable(const ConcoctNode* root)
+{
+  inlinable_count = 0;
+  if(!inline_mode || root->token.type != CCT_TOKEN_NEWLINE)
     return;
+  for(size_t i = 0; i < root->child_count && inlinable_count < MAX_INLINE_AMOUNT; i++)
+  {
+    const ConcoctNode* node = root->children[i];
+    const ConcoctNode* expression = NULL;
+    size_t size = 0;
+    bool reads_parameters = true;
+    if(node->token.type != CCT_TOKEN_FUNC)
+      continue;
+    expression = get_leaf_expression(node);
+    if(expression == NULL)
+      continue;
+    size = count_nodes(expression);
+    if(size > MAX_INLINE_NODES || size * count_calls(root, node->text) > MAX_INLINE_GROWTH)
+      continue;
+    // Dropping an argument nobody reads would also drop the errors it reports
+    for(size_t j = 0; reads_parameters && j + 1 < node->child_count; j++)
+      reads_parameters = count_reads(expression, node->children[j]->text) > 0;
+    if(reads_parameters)
+      inlinable[inlinable_count++] = (InlineFunction){ node, expression };
+  }
+  return;
+}
 
-  // Use a level-order algorithm to walk the parser tree
-  init_queue(pqueue);
-  enqueue(pqueue, root);
-  while(!is_empty(pqueue))
+static bool can_inline(const ConcoctNode* node, const InlineFunction** function);
+
+// Returns true if evaluating the expression under node in the caller can report a runtime error. Only literals,
+// locals and globals known to hold a constant never fail.
+static bool can_fail(const ConcoctNode* node)
+{
+  if(is_literal(node))
+    return false;
+  if(node->token.type == CCT_TOKEN_IDENTIFIER)
+    return resolve_local(node->text) < 0 && (!folding_mode || find_known(node->text) == NULL);
+  return true;
+}
+
+// Advances order->next past the parameters whose arguments cannot fail
+static void skip_safe_arguments(ErrorOrder* order)
+{
+  const ConcoctNode* call = order->call->call;
+
+  while(order->next < call->child_count && !can_fail(call->children[order->next]))
+    order->next++;
+  return;
+}
+
+// Returns true if the errors of the expression under node follow those of the arguments like they do for the call.
+// The call evaluates its arguments from left to right before the function body, so the first read of an argument that
+// can fail has to come in parameter order, and before anything of the expression that can fail itself or is skipped
+// by && or || (conditional).
+static bool keeps_error_order(const ConcoctNode* node, ErrorOrder* order, bool conditional)
+{
+  int parameter = -1;
+
+  if(is_literal(node))
+    return true;
+  if(node->token.type == CCT_TOKEN_IDENTIFIER)
   {
-    ConcoctNode* current = NULL;
-    dequeue(pqueue, (void **)&current);
-    // ToDo: Add remaining cases
-    switch(current->token.type)
+    parameter = find_parameter(order->call, node->text);
+    if(parameter < 0)
     {
-      case CCT_TOKEN_ADD:
-        vm.instructions[ic] = OP_ADD;
-        ic++;
-        break;
-      case CCT_TOKEN_ADD_ASSIGN:
-        vm.instructions[ic] = OP_ADD;
-        ic++;
-        vm.instructions[ic] = OP_ASN;
-        ic++;
-        break;
-      case CCT_TOKEN_AND:
-        vm.instructions[ic] = OP_AND;
-        ic++;
-        break;
-      case CCT_TOKEN_ASSIGN:
-        vm.instructions[ic] = OP_ASN; // this operation should precede an identifier (CCT_TOKEN_IDENTIFIER)
-        ic++;
-        break;
-      case CCT_TOKEN_BIN_AND:
-        vm.instructions[ic] = OP_BND;
-        ic++;
-        break;
-      case CCT_TOKEN_BIN_OR:
-        vm.instructions[ic] = OP_BOR;
-        ic++;
-        break;
-      case CCT_TOKEN_BIN_XOR:
-        vm.instructions[ic] = OP_XOR;
-        ic++;
-        break;
-      case CCT_TOKEN_CHAR:
-        push(vm.sp, new_object_by_type(current->text, CCT_TYPE_BYTE));
-        break;
-      case CCT_TOKEN_DEC:
-        vm.instructions[ic] = OP_DEC;
-        ic++;
-        break;
-      case CCT_TOKEN_DIV:
-        vm.instructions[ic] = OP_DIV;
-        ic++;
-        break;
-      case CCT_TOKEN_DIV_ASSIGN:
-        // OP_DIV + OP_ASN
-        break;
-      case CCT_TOKEN_EQUAL:
-        vm.instructions[ic] = OP_EQL;
-        ic++;
-        break;
-      case CCT_TOKEN_EXP:
-        vm.instructions[ic] = OP_POW;
-        ic++;
-        break;
-      case CCT_TOKEN_EXP_ASSIGN:
-        // OP_POW + OP_ASN
-        break;
-      case CCT_TOKEN_FALSE:
-        push(vm.sp, new_object("false"));
-        break;
-      case CCT_TOKEN_FLOAT:
-        push(vm.sp, new_object_by_type(current->text, CCT_TYPE_DECIMAL));
-        break;
-      case CCT_TOKEN_GREATER:
-        vm.instructions[ic] = OP_GT;
-        ic++;
-        break;
-      case CCT_TOKEN_GREATER_EQUAL:
-        vm.instructions[ic] = OP_GTE;
-        ic++;
-        break;
-      case CCT_TOKEN_IDENTIFIER:
-        if(!cct_hash_map_has_key(map, current->text))
-        {
-          push(vm.sp, new_object_by_type(current->text, CCT_TYPE_STRING));
-        }
-        else
-        {
-          // Identifier already exists. Flag the original object for garbage collection and delete the value.
-          Object* object = cct_hash_map_get(map, current->text);
-          object->is_flagged=true;
-          cct_hash_map_delete_entry(map, current->text);
-        }
-        break;
-      case CCT_TOKEN_INC:
-        vm.instructions[ic] = OP_INC;
-        ic++;
-        break;
-      case CCT_TOKEN_INT:
-        push(vm.sp, new_object(current->text));
-        break;
-      case CCT_TOKEN_LESS:
-        vm.instructions[ic] = OP_LT;
-        ic++;
-        break;
-      case CCT_TOKEN_LESS_EQUAL:
-        vm.instructions[ic] = OP_LTE;
-        ic++;
-        break;
-      case CCT_TOKEN_MOD:
-        vm.instructions[ic] = OP_MOD;
-        ic++;
-        break;
-      case CCT_TOKEN_MOD_ASSIGN:
-        // OP_MOD + OP_ASN
-        break;
-      case CCT_TOKEN_MUL:
-        vm.instructions[ic] = OP_MUL;
-        ic++;
-        break;
-      case CCT_TOKEN_MUL_ASSIGN:
-        // OP_MUL + OP_ASN
-        break;
-      case CCT_TOKEN_NOT:
-        vm.instructions[ic] = OP_NOT;
-        ic++;
-        break;
-      case CCT_TOKEN_NOT_EQUAL:
-        vm.instructions[ic] = OP_NEQ;
-        ic++;
-        break;
-      case CCT_TOKEN_NEWLINE:
-        // Ignore whitespace
-        break;
-      case CCT_TOKEN_OR:
-        vm.instructions[ic] = OP_OR;
-        ic++;
-        break;
-      case CCT_TOKEN_SHL:
-        vm.instructions[ic] = OP_SHL;
-        ic++;
-        break;
-      case CCT_TOKEN_SHR:
-        vm.instructions[ic] = OP_SHR;
-        ic++;
-        break;
-      case CCT_TOKEN_STRING:
-        push(vm.sp, new_object_by_type(current->text, CCT_TYPE_STRING));
-        break;
-      case CCT_TOKEN_STRLEN_EQUAL:
-        vm.instructions[ic] = OP_SLE;
-        ic++;
-        break;
-      case CCT_TOKEN_STRLEN_NOT_EQUAL:
-        vm.instructions[ic] = OP_SLN;
-        ic++;
-        break;
-      case CCT_TOKEN_SUB:
-        vm.instructions[ic] = OP_SUB;
-        ic++;
-        break;
-      case CCT_TOKEN_SUB_ASSIGN:
-        // OP_SUB + OP_ASN
-        break;
-      case CCT_TOKEN_TRUE:
-        push(vm.sp, new_object("true"));
-        break;
-      case CCT_TOKEN_UNARY_MINUS:
-        vm.instructions[ic] = OP_NEG;
-        ic++;
-        break;
-      default:
-        fprintf(stderr, "Unable to handle token: %s\n", cct_token_type_to_string(current->token.type));
-        break;
+      order->has_failed = order->has_failed || can_fail(node);
+      return true;
     }
-    for(size_t i = 0; i < current->child_count; i++)
-      enqueue(pqueue, current->children[i]);
+    if((size_t)parameter != order->next)
+      return (size_t)parameter < order->next || !can_fail(order->call->call->children[parameter]);
+    if(order->has_failed || conditional)
+      return false;
+    order->next++;
+    skip_safe_arguments(order);
+    return true;
+  }
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    bool skippable = conditional
+                     || (i > 0 && (node->token.type == CCT_TOKEN_AND || node->token.type == CCT_TOKEN_OR));
+    if(!keeps_error_order(node->children[i], order, skippable))
+      return false;
   }
+  order->has_failed = true;
+  return true;
+}
+
+// Returns true if evaluating the expression under node has no effect besides computing its value (or an error), so
+// moving it into an inlined expression cannot change what the program does
+static bool is_pure(const ConcoctNode* node)
+{
+  const InlineFunction* function = NULL;
+
+  if(node->token.type == CCT_TOKEN_LEFT_PAREN)
+    return can_inline(node, &function);
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    if(!is_pure(node->children[i]))
+      return false;
+  }
+  return true;
+}
 
-  if(ic > 0)
+// Returns true if the call node can compile to the expression returned by its function, which is stored in function.
+// Arguments replace the parameters they are passed for, so an argument read more than once must be a literal or an
+// identifier and any other must be pure. Arguments that can fail must still report their errors first and in order
+// (see keeps_error_order()). The other identifiers of the expression are globals, which must not be hidden by locals
+// of the caller.
+static bool can_inline(const ConcoctNode* node, const InlineFunction** function)
+{
+  const ConcoctNode* declaration = NULL;
+  InlinedCall call = { node, NULL, NULL };
+  ErrorOrder order = { &call, 0, false };
+
+  *function = NULL;
+  for(size_t i = 0; i < inlinable_count && *function == NULL; i++)
+  {
+    if(strcmp(inlinable[i].declaration->text, node->text) == 0)
+      *function = &inlinable[i];
+  }
+  if(*function == NULL)
+    return false;
+  declaration = (*function)->declaration;
+  if(node->child_count + 1 != declaration->child_count)
+    return false; // reported by compile_call()
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    const ConcoctNode* argument = node->children[i];
+    if(!is_literal(argument) && argument->token.type != CCT_TOKEN_IDENTIFIER
+       && (count_reads((*function)->expression, declaration->children[i]->text) > 1 || !is_pure(argument)))
+      return false;
+  }
+  call.function = *function;
+  skip_safe_arguments(&order);
+  if(!keeps_error_order((*function)->expression, &order, false))
+    return false;
+  for(size_t i = 0; scope != NULL && i < scope->count; i++)
   {
-    reverse_instructions(ic);
-    swap_last_operands(vm.instructions[0]);
-    vm.instructions[ic] = OP_END; // append end instruction
-    interpret(map);
+    if(find_parameter(&call, scope->names[i]) < 0 && count_reads((*function)->expression, scope->names[i]) > 0)
+      return false;
   }
+  return true;
+}
+
+// Compiles the argument passed for parameter index of the call being inlined
+static bool compile_argument(size_t index, Chunk* chunk)
+{
+  InlinedCall* call = inlined;
+  bool compiled = false;
+
+  inlined = call->enclosing;
+  compiled = compile_expression(call->call->children[index], chunk);
+  inlined = call;
+  return compiled;
+}
+
+// Compiles a call as the expression its function returns. Compiling it in place folds the constant arguments into
+// it like any other expression.
+static bool compile_inlined(const ConcoctNode* node, const InlineFunction* function, Chunk* chunk)
+{
+  InlinedCall call = { node, function, inlined };
+  bool compiled = false;
 
+  inlined = &call;
+  compiled = compile_expression(function->expression, chunk);
+  inlined = call.enclosing;
+  return compiled;
+}
+
+// Compiles a call with oc (OP_CAL, or OP_TCL for a call in tail position). The arguments are left on the stack, where
+// they become the first locals of the callee's frame. Calls of small leaf functions are inlined instead (see
+// find_inlinable()).
+//
+//   <argument1>, ..., <argumentN>, CAL function
+//   inlined: <returned expression>, [RET]
+static bool compile_call(const ConcoctNode* node, Chunk* chunk, Opcode oc)
+{
+  size_t line = node->token.line_number;
+  int index = find_function(chunk, node->text);
+  const InlineFunction* function = NULL;
+
+  if(index < 0)
+  {
+    fprintf(stderr, "Call to undefined function '%s' on line %zu.\n", node->text, line);
+    return false;
+  }
+  if(node->child_count != chunk->functions[index].arity)
+  {
+    fprintf(stderr, "Function '%s' takes %zu arguments but %zu were given on line %zu.\n", node->text,
+            chunk->functions[index].arity, node->child_count, line);
+    return false;
+  }
+  if(can_inline(node, &function))
+  {
+    if(!compile_inlined(node, function, chunk))
+      return false;
+    if(oc == OP_TCL)
+      write_opcode(chunk, OP_RET, line);
+    return true;
+  }
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    if(!compile_expression(node->children[i], chunk))
+      return false;
+  }
+  emit_constant_op(chunk, oc, (uint16_t)index, line);
+  return true;
+}
+
+// Replaces the code for the operands of oc starting at start with a PSH of the result of oc if every operand is a
+// constant and returns true. Operations that would fail at run time are not folded, so their instruction still reports
+// the error on its line.
+static bool fold_operation(Chunk* chunk, Opcode oc, size_t start, size_t arity, size_t line)
+{
+  Object* operands[2] = { NULL, NULL };
+  uint16_t indexes[2] = { 0, 0 };
+  Object* result = NULL;
+
+  if(chunk->has_error || chunk->count != start + arity * PSH_SIZE)
+    return false;
+  for(size_t i = 0; i < arity; i++)
+  {
+    if(chunk->code[start + i * PSH_SIZE] != OP_PSH)
+      return false;
+    indexes[i] = read_short(&chunk->code[start + i * PSH_SIZE + 1]);
+    operands[i] = chunk->constants[indexes[i]];
+  }
+  if(arity == 1 ? !fold_unary(oc, &result, operands[0]) : !fold_binary(oc, &result, operands[0], operands[1]))
+    return false;
+
+  // Operand constants only referenced by the dropped code are removed from the end of the pool
+  for(size_t i = arity; i-- > 0;)
+  {
+    if((size_t)indexes[i] + 1 == chunk->constant_count)
+      chunk->constant_count--;
+  }
+  replace_with_constant(chunk, start, result, line);
+  return true;
+}
+
+// Compiles && or || whose left operand is a constant in place of the code for it starting at start. If the left
+// operand decides the result, the right one is still compiled for its errors but its code is dropped. The result is
+// one of the VM's shared Bool objects like at run time.
+//
+//   PSH <decided result> or <right>, TST
+static bool compile_constant_logical(const ConcoctNode* node, Chunk* chunk, size_t start, bool decided)
+{
+  size_t line = node->token.line_number;
+  Object* right = NULL;
+
+  chunk->count = start;
+  if(!compile_expression(node->children[1], chunk))
+    return false;
+  if(decided)
+  {
+    replace_with_constant(chunk, start, node->token.type == CCT_TOKEN_OR ? vm.true_object : vm.false_object, line);
+    return true;
+  }
+  right = get_pushed_constant(chunk, start);
+  if(right != NULL)
+    replace_with_constant(chunk, start, is_truthy(right) ? vm.true_object : vm.false_object, line);
+  else
+    write_opcode(chunk, OP_TST, line);
+  return true;
+}
+
+// Compiles && or || so the right operand is only evaluated when the left one does not decide the result. The
+// result is one of the VM's shared Bool objects, so no object is allocated for it.
+//
+//   <left>, JMF end (&&) or JMT end (||), <right>, TST, end:
+static bool compile_logical(const ConcoctNode* node, Chunk* chunk)
+{
+  size_t line = node->token.line_number;
+  size_t start = chunk->count;
+  size_t end_jump = 0;
+  bool decides = node->token.type == CCT_TOKEN_OR;
+  Object* left = NULL;
+
+  if(!compile_expression(node->children[0], chunk))
+    return false;
+  left = folding_mode ? get_pushed_constant(chunk, start) : NULL;
+  if(left != NULL)
+    return compile_constant_logical(node, chunk, start, is_truthy(left) == decides);
+  end_jump = emit_jump(chunk, decides ? OP_JMT : OP_JMF, line);
+  if(!compile_expression(node->children[1], chunk))
+    return false;
+  write_opcode(chunk, OP_TST, line);
+  return patch_jump(chunk, end_jump, chunk->count);
+}
+
+// Compiles an expression so its value is left on top of the stack
+static bool compile_expression(const ConcoctNode* node, Chunk* chunk)
+{
+  size_t line = node->token.line_number;
+  size_t start = chunk->count;
+  Opcode oc = OP_NOP;
+
+  if(is_literal(node))
+  {
+    Object* object = new_literal(node);
+    if(object == NULL)
+      return false;
+    emit_constant_op(chunk, OP_PSH, add_constant(chunk, object), line);
+    return true;
+  }
+  if(node->token.type == CCT_TOKEN_IDENTIFIER)
+  {
+    if(inlined != NULL && find_parameter(inlined, node->text) >= 0)
+      return compile_argument((size_t)find_parameter(inlined, node->text), chunk);
+    emit_get(chunk, node->text, line);
+    return true;
+  }
+  if(node->token.type == CCT_TOKEN_LEFT_PAREN)
+    return compile_call(node, chunk, OP_CAL);
+
+  if(node->child_count == 2 && (node->token.type == CCT_TOKEN_AND || node->token.type == CCT_TOKEN_OR))
+    return compile_logical(node, chunk);
+
+  // Operands are emitted left to right so the right operand ends up on top of the stack
+  if(node->child_count == 1)
+    oc = get_unary_opcode(node->token.type);
+  else if(node->child_count == 2)
+    oc = get_binary_opcode(node->token.type);
+  if(oc == OP_NOP)
+  {
+    fprintf(stderr, "Unable to handle token: %s\n", cct_token_type_to_string(node->token.type));
+    return false;
+  }
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    if(!compile_expression(node->children[i], chunk))
+      return false;
+  }
+  if(folding_mode && fold_operation(chunk, oc, start, node->child_count, line))
+    return true;
+  write_opcode(chunk, oc, line);
+  return true;
+}
+
+// Returns register form of a binary opcode or OP_NOP if it only exists in stack form
+static Opcode get_register_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADD:  return OP_RADD;
+    case OP_DIV:  return OP_RDIV;
+    case OP_EQL:  return OP_REQL;
+    case OP_GT:   return OP_RGT;
+    case OP_GTE:  return OP_RGTE;
+    case OP_LT:   return OP_RLT;
+    case OP_LTE:  return OP_RLTE;
+    case OP_MOD:  return OP_RMOD;
+    case OP_MUL:  return OP_RMUL;
+    case OP_NEQ:  return OP_RNEQ;
+    case OP_POW:  return OP_RPOW;
+    case OP_SUB:  return OP_RSUB;
+    default:      return OP_NOP;
+  }
+}
+
+// Returns register opcode for a binary expression node or OP_NOP if the node has no register form
+static Opcode get_register_node_opcode(const ConcoctNode* node)
+{
+  if(node->child_count != 2)
+    return OP_NOP;
+  return get_register_opcode(get_binary_opcode(node->token.type));
+}
+
+// Allocates the next free temporary register (R0-R15, RS is never handed out)
+static bool allocate_register(Byte* next_reg, Byte* reg)
+{
+  if(*next_reg >= RS)
+    return false;
+  *reg = (*next_reg)++;
+  return true;
+}
+
+// Makes constant a register operand. It becomes an RK constant reference when its constant pool index fits in an
+// operand byte and is loaded into a temporary register otherwise.
+static bool compile_register_constant(Object* constant, size_t line, Chunk* chunk, Byte* next_reg, Byte* rk)
+{
+  uint16_t index = add_constant(chunk, constant);
+
+  if(index < RK_CONSTANT_AMOUNT)
+  {
+    *rk = (Byte)(REGISTER_AMOUNT + index);
+    return true;
+  }
+  if(!allocate_register(next_reg, rk))
+    return false;
+  write_opcode(chunk, OP_RLDK, line);
+  write_chunk(chunk, *rk, line);
+  write_short(chunk, index, line);
+  return true;
+}
+
+static bool compile_register_operand(const ConcoctNode* node, Chunk* chunk, Byte* next_reg, Byte* rk);
+
+// Compiles left <oc> right into the lowest free register and returns it in rk. Two RK constant operands are folded
+// into the constant result like in the stack form.
+static bool compile_register_binary(Opcode oc, const ConcoctNode* left, const ConcoctNode* right, size_t line, Chunk* chunk,
+                                    Byte* next_reg, Byte* rk)
+{
+  Byte base = *next_reg;
+  Byte rk1 = 0;
+  Byte rk2 = 0;
+  Object* result = NULL;
+
+  if(!compile_register_operand(left, chunk, next_reg, &rk1) || !compile_register_operand(right, chunk, next_reg, &rk2))
+    return false;
+
+  // Temporaries are released in stack order, so both operand registers are free once the result is computed
+  *next_reg = base;
+  if(folding_mode && rk1 >= REGISTER_AMOUNT && rk2 >= REGISTER_AMOUNT && !chunk->has_error
+     && fold_binary(oc, &result, chunk->constants[rk1 - REGISTER_AMOUNT], chunk->constants[rk2 - REGISTER_AMOUNT]))
+  {
+    if((size_t)(rk2 - REGISTER_AMOUNT) + 1 == chunk->constant_count)
+      chunk->constant_count--;
+    if((size_t)(rk1 - REGISTER_AMOUNT) + 1 == chunk->constant_count)
+      chunk->constant_count--;
+    return compile_register_constant(result, line, chunk, next_reg, rk);
+  }
+  if(!allocate_register(next_reg, rk))
+    return false;
+  write_opcode(chunk, get_register_opcode(oc), line);
+  write_chunk(chunk, *rk, line);
+  write_chunk(chunk, rk1, line);
+  write_chunk(chunk, rk2, line);
+  return true;
+}
+
+// Compiles an expression operand for a register-form instruction. Literals and globals with a known value become
+// constants; everything else is computed into a temporary register.
+static bool compile_register_operand(const ConcoctNode* node, Chunk* chunk, Byte* next_reg, Byte* rk)
+{
+  size_t line = node->token.line_number;
+  Object* object = NULL;
+
+  if(is_literal(node))
+  {
+    object = new_literal(node);
+    if(object == NULL)
+      return false;
+    return compile_register_constant(object, line, chunk, next_reg, rk);
+  }
+  if(node->token.type == CCT_TOKEN_IDENTIFIER)
+  {
+    object = folding_mode ? find_known(node->text) : NULL;
+    if(object != NULL)
+      return compile_register_constant(object, line, chunk, next_reg, rk);
+    if(!allocate_register(next_reg, rk))
+      return false;
+    write_opcode(chunk, OP_RGET, line);
+    write_chunk(chunk, *rk, line);
+    write_short(chunk, bind_global(chunk, node->text), line);
+    return true;
+  }
+  if(get_register_node_opcode(node) == OP_NOP)
+    return false;
+  return compile_register_binary(get_binary_opcode(node->token.type), node->children[0], node->children[1], line, chunk,
+                                 next_reg, rk);
+}
+
+// Attempts to compile an assignment in register form. Only expressions made entirely of register-capable binary
+// operations, literals and identifiers qualify; on failure the chunk is rolled back so the stack form can be emitted.
+static bool compile_register_assignment(const ConcoctNode* node, Chunk* chunk, uint16_t slot)
+{
+  size_t line = node->token.line_number;
+  size_t count = chunk->count;
+  size_t constant_count = chunk->constant_count;
+  const ConcoctNode* expression = node->children[1];
+  Opcode oc = get_assign_opcode(node->token.type);
+  Byte next_reg = R0;
+  Byte result = 0;
+  bool compiled = false;
+
+  if(oc != OP_NOP) // compound assignment (x <op>= expression)
+  {
+    if(get_register_opcode(oc) != OP_NOP)
+      compiled = compile_register_binary(oc, node->children[0], expression, line, chunk, &next_reg, &result);
+  }
+  else if(get_register_node_opcode(expression) != OP_NOP)
+    compiled = compile_register_operand(expression, chunk, &next_reg, &result);
+
+  // A folded constant result is assigned by the stack form, which fuses into SETK
+  if(!compiled || result >= REGISTER_AMOUNT || chunk->has_error)
+  {
+    chunk->count = count;
+    chunk->constant_count = constant_count;
+    chunk->has_error = false;
+    return false;
+  }
+  write_opcode(chunk, OP_RASN, line);
+  write_short(chunk, slot, line);
+  write_chunk(chunk, result, line);
+  return true;
+}
+
+// Returns true if node is one of the top-level statements of the program
+static bool is_top_level(const ConcoctNode* node)
+{
+  return node->parent != NULL && node->parent->parent == NULL && node->parent->token.type == CCT_TOKEN_NEWLINE;
+}
+
+// Compiles an assignment (=, +=, -=, *=, /=, %=, **=)
+static bool compile_assignment(const ConcoctNode* node, Chunk* chunk)
+{
+  size_t line = node->token.line_number;
+  const ConcoctNode* identifier = node->children[0];
+  Opcode oc = get_assign_opcode(node->token.type);
+  size_t start = 0;
+  Object* value = NULL;
+
+  if(node->child_count != 2 || identifier->token.type != CCT_TOKEN_IDENTIFIER)
+  {
+    fprintf(stderr, "Invalid assignment target on line %zu.\n", line);
+    return false;
+  }
+  // Register instructions only address globals, so functions always use the stack form
+  if(register_mode && scope == NULL
+     && compile_register_assignment(node, chunk, bind_global(chunk, identifier->text)))
+    return true;
+  if(oc != OP_NOP)
+    emit_get(chunk, identifier->text, line);
+  start = chunk->count;
+  if(!compile_expression(node->children[1], chunk))
+    return false;
+  if(oc != OP_NOP)
+    write_opcode(chunk, oc, line);
+  else if(folding_mode && scope == NULL && is_top_level(node))
+  {
+    value = get_pushed_constant(chunk, start);
+    if(value != NULL)
+      remember_known(identifier->text, value);
+  }
+  return emit_set(chunk, identifier->text, line);
+}
+
+// Starts compiling a loop nested in enclosing (NULL at the top level)
+static void begin_loop(Loop* loop, Loop* enclosing)
+{
+  loop->enclosing = enclosing;
+  loop->depth = enclosing == NULL ? 0 : enclosing->depth + 1;
+  loop->breaks = (JumpList){ 0, 0, NULL };
+  loop->continues = (JumpList){ 0, 0, NULL };
   return;
 }
+
+// Patches the pending jumps of loop (unless compilation already failed) and releases them
+static bool end_loop(Chunk* chunk, Loop* loop, bool compiled, size_t continue_target)
+{
+  compiled = compiled && patch_jumps(chunk, &loop->continues, continue_target)
+             && patch_jumps(chunk, &loop->breaks, chunk->count);
+  free(loop->breaks.offsets);
+  free(loop->continues.offsets);
+  return compiled;
+}
+
+// Compiles condition as a branch taken when its truth value is when. The branch loops back to *target, or jumps
+// forward through a jump added to jumps if target is NULL. && and || branch on each operand in turn instead of
+// computing a Bool. Loops on equality with a non-constant right operand use OP_LOE/OP_LNE; constant ones fuse
+// better as <op>K + OP_LNZ.
+static bool compile_branch(const ConcoctNode* condition, Chunk* chunk, bool when, const size_t* target, JumpList* jumps)
+{
+  size_t line = condition->token.line_number;
+  ConcoctTokenType type = condition->token.type;
+  JumpList skip = { 0, 0, NULL };
+  bool compiled = false;
+  Opcode oc = OP_NOP;
+
+  if(condition->child_count == 2 && (type == CCT_TOKEN_AND || type == CCT_TOKEN_OR))
+  {
+    // The left operand decides the result when it is false for && and true for ||
+    bool decides = type == CCT_TOKEN_OR;
+    if(decides == when)
+      return compile_branch(condition->children[0], chunk, when, target, jumps)
+             && compile_branch(condition->children[1], chunk, when, target, jumps);
+    compiled = compile_branch(condition->children[0], chunk, decides, NULL, &skip)
+               && compile_branch(condition->children[1], chunk, when, target, jumps)
+               && patch_jumps(chunk, &skip, chunk->count);
+    free(skip.offsets);
+    return compiled;
+  }
+  if(target != NULL && condition->child_count == 2 && !is_literal(condition->children[1]))
+  {
+    if(type == CCT_TOKEN_EQUAL)
+      oc = when ? OP_LOE : OP_LNE;
+    else if(type == CCT_TOKEN_NOT_EQUAL)
+      oc = when ? OP_LNE : OP_LOE;
+  }
+  if(oc != OP_NOP)
+  {
+    if(!compile_expression(condition->children[0], chunk) || !compile_expression(condition->children[1], chunk))
+      return false;
+    return emit_loop(chunk, oc, *target, line);
+  }
+  if(!compile_expression(condition, chunk))
+    return false;
+  if(target != NULL)
+    return emit_loop(chunk, when ? OP_LNZ : OP_LOZ, *target, line);
+  return add_jump(jumps, emit_jump(chunk, when ? OP_JMC : OP_JMZ, line));
+}
+
+static bool compile_statement(const ConcoctNode* node, Chunk* chunk, Loop* loop);
+
+// Compiles an if statement
+//
+//   <condition>, JMZ else, <then>, [JMP end, else: <else>], end:
+static bool compile_if(const ConcoctNode* node, Chunk* chunk, Loop* loop)
+{
+  JumpList else_jumps = { 0, 0, NULL };
+  size_t end_jump = 0;
+  bool compiled = compile_branch(node->children[0], chunk, false, NULL, &else_jumps)
+                  && compile_statement(node->children[1], chunk, loop);
+
+  if(compiled && node->child_count < 3)
+    compiled = patch_jumps(chunk, &else_jumps, chunk->count);
+  else if(compiled)
+  {
+    end_jump = emit_jump(chunk, OP_JMP, node->token.line_number);
+    compiled = patch_jumps(chunk, &else_jumps, chunk->count) && compile_statement(node->children[2], chunk, loop)
+               && patch_jump(chunk, end_jump, chunk->count);
+  }
+  free(else_jumps.offsets);
+  return compiled;
+}
+
+// Compiles a while loop with its condition at the bottom, so each iteration dispatches a single jump. In -O2 mode
+// the loop is entered through a copy of the condition instead of a jump to it, so code hoisted out of the body only
+// runs if the body does (see ir.h).
+//
+//   JMP condition, body: <body>, condition: <condition>, LNZ body
+//   -O2: <condition>, JMZ end, body: <body>, condition: <condition>, LNZ body, end:
+static bool compile_while(const ConcoctNode* node, Chunk* chunk, Loop* enclosing)
+{
+  JumpList exits = { 0, 0, NULL };
+  size_t condition_jump = 0;
+  size_t body = 0;
+  size_t condition = 0;
+  bool compiled = true;
+  Loop loop;
+
+  if(ir_mode)
+    compiled = compile_branch(node->children[0], chunk, false, NULL, &exits);
+  else
+    condition_jump = emit_jump(chunk, OP_JMP, node->token.line_number);
+  body = chunk->count;
+  begin_loop(&loop, enclosing);
+  compiled = compiled && compile_statement(node->children[1], chunk, &loop);
+  condition = chunk->count;
+  compiled = compiled && (ir_mode || patch_jump(chunk, condition_jump, condition))
+             && compile_branch(node->children[0], chunk, true, &body, NULL)
+             && patch_jumps(chunk, &exits, chunk->count);
+  free(exits.offsets);
+  return end_loop(chunk, &loop, compiled, condition);
+}
+
+// Compiles a do-while loop
+//
+//   body: <body>, <condition>, LNZ body
+static bool compile_do_while(const ConcoctNode* node, Chunk* chunk, Loop* enclosing)
+{
+  size_t body = chunk->count;
+  size_t condition = 0;
+  bool compiled = false;
+  Loop loop;
+
+  begin_loop(&loop, enclosing);
+  compiled = compile_statement(node->children[0], chunk, &loop);
+  condition = chunk->count;
+  compiled = compiled && compile_branch(node->children[1], chunk, true, &body, NULL);
+  return end_loop(chunk, &loop, compiled, condition);
+}
+
+// Compiles a for-in loop. There are no collection types yet, so the loop counts the identifier from 0 up to (but
+// excluding) the value of the expression. The bound is evaluated once and kept in a hidden identifier named after the
+// loop depth, which source code cannot spell. At the top level it is a hidden global (see HIDDEN_GLOBAL_PREFIX), so
+// it never reaches the caller's map; inside a function the counter and the bound are locals.
+//
+//   <bound>, ASN $for, PSH 0, ASN i, JMP condition, body: <body>, GET i, PSH 1, ADD, ASN i,
+//   condition: GET i, GET $for, LT, LNZ body
+//
+// In -O2 mode the loop is entered through a copy of the condition (GET i, GET $for, LT, JMZ end) as in
+// compile_while().
+static bool compile_for(const ConcoctNode* node, Chunk* chunk, Loop* enclosing)
+{
+  size_t line = node->token.line_number;
+  const char* name = node->children[0]->text;
+  const char* bound = NULL;
+  char bound_name[32];
+  size_t condition_jump = 0;
+  size_t body = 0;
+  size_t next = 0;
+  bool compiled = false;
+  Loop loop;
+
+  begin_loop(&loop, enclosing);
+  snprintf(bound_name, sizeof(bound_name), "%cfor%zu", HIDDEN_GLOBAL_PREFIX, loop.depth);
+  bound = intern_name(chunk, bound_name);
+  if(bound == NULL || !compile_expression(node->children[1], chunk) || !emit_set(chunk, bound, line))
+    return end_loop(chunk, &loop, false, 0);
+  emit_constant_op(chunk, OP_PSH, add_constant(chunk, new_object("0")), line);
+  if(!emit_set(chunk, name, line))
+    return end_loop(chunk, &loop, false, 0);
+  if(ir_mode)
+  {
+    emit_get(chunk, name, line);
+    emit_get(chunk, bound, line);
+    write_opcode(chunk, OP_LT, line);
+    condition_jump = emit_jump(chunk, OP_JMZ, line);
+  }
+  else
+    condition_jump = emit_jump(chunk, OP_JMP, line);
+  body = chunk->count;
+  compiled = compile_statement(node->children[2], chunk, &loop);
+
+  // GET, PSH, ADD, ASN of the same identifier fuses into a single GOPK
+  next = chunk->count;
+  emit_get(chunk, name, line);
+  emit_constant_op(chunk, OP_PSH, add_constant(chunk, new_object("1")), line);
+  write_opcode(chunk, OP_ADD, line);
+  compiled = compiled && emit_set(chunk, name, line) && (ir_mode || patch_jump(chunk, condition_jump, chunk->count));
+  emit_get(chunk, name, line);
+  emit_get(chunk, bound, line);
+  write_opcode(chunk, OP_LT, line);
+  compiled = compiled && emit_loop(chunk, OP_LNZ, body, line)
+             && (!ir_mode || patch_jump(chunk, condition_jump, chunk->count));
+  return end_loop(chunk, &loop, compiled, next);
+}
+
+// Compiles break or continue as a forward jump patched when the enclosing loop is complete
+static bool compile_loop_exit(const ConcoctNode* node, Chunk* chunk, Loop* loop)
+{
+  bool is_break = node->token.type == CCT_TOKEN_BREAK;
+
+  if(loop == NULL)
+  {
+    fprintf(stderr, "Cannot use '%s' outside of a loop on line %zu.\n", is_break ? "break" : "continue",
+            node->token.line_number);
+    return false;
+  }
+  return add_jump(is_break ? &loop->breaks : &loop->continues, emit_jump(chunk, OP_JMP, node->token.line_number));
+}
+
+// Compiles leaving the function with the value of expression. Returning the result of a call is a tail call, which
+// runs the callee in the frame of the returning function.
+//
+//   <expression>, RET or <argument1>, ..., <argumentN>, TCL function
+static bool compile_result(const ConcoctNode* expression, Chunk* chunk, size_t line)
+{
+  if(expression->token.type == CCT_TOKEN_LEFT_PAREN)
+    return compile_call(expression, chunk, OP_TCL);
+  if(!compile_expression(expression, chunk))
+    return false;
+  write_opcode(chunk, OP_RET, line);
+  return true;
+}
+
+// Compiles a return statement, which leaves the function with the value of its expression
+static bool compile_return(const ConcoctNode* node, Chunk* chunk)
+{
+  if(scope == NULL)
+  {
+    fprintf(stderr, "Cannot use 'return' outside of a function on line %zu.\n", node->token.line_number);
+    return false;
+  }
+  return compile_result(node->children[0], chunk, node->token.line_number);
+}
+
+// Compiles a statement (loop is the innermost loop being compiled or NULL)
+static bool compile_statement(const ConcoctNode* node, Chunk* chunk, Loop* loop)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_NEWLINE:    // program root
+    case CCT_TOKEN_LEFT_BRACE: // compound statement
+      for(size_t i = 0; i < node->child_count; i++)
+      {
+        if(!compile_statement(node->children[i], chunk, loop))
+          return false;
+      }
+      return true;
+    case CCT_TOKEN_IF:
+      return compile_if(node, chunk, loop);
+    case CCT_TOKEN_WHILE:
+      return compile_while(node, chunk, loop);
+    case CCT_TOKEN_DO:
+      return compile_do_while(node, chunk, loop);
+    case CCT_TOKEN_FOR:
+      return compile_for(node, chunk, loop);
+    case CCT_TOKEN_BREAK:
+    case CCT_TOKEN_CONTINUE:
+      return compile_loop_exit(node, chunk, loop);
+    case CCT_TOKEN_RETURN:
+      return compile_return(node, chunk);
+    case CCT_TOKEN_FUNC:       // bodies are compiled after the top-level code by compile_functions()
+      if(scope == NULL && is_top_level(node))
+        return true;
+      fprintf(stderr, "Functions can only be declared at the top level (line %zu).\n", node->token.line_number);
+      return false;
+    case CCT_TOKEN_ASSIGN:
+    case CCT_TOKEN_ADD_ASSIGN:
+    case CCT_TOKEN_DIV_ASSIGN:
+    case CCT_TOKEN_EXP_ASSIGN:
+    case CCT_TOKEN_MOD_ASSIGN:
+    case CCT_TOKEN_MUL_ASSIGN:
+    case CCT_TOKEN_SUB_ASSIGN:
+      return compile_assignment(node, chunk);
+    default:                   // expression (or call) statement discards its value
+      if(!compile_expression(node, chunk))
+        return false;
+      write_opcode(chunk, OP_POP, node->token.line_number);
+      return true;
+  }
+}
+
+// Adds the functions declared among the top-level statements of root to the function table of chunk. Their bodies
+// are compiled later, so calls may precede declarations and functions may call each other.
+static bool declare_functions(const ConcoctNode* root, Chunk* chunk)
+{
+  for(size_t i = 0; i < root->child_count; i++)
+  {
+    const ConcoctNode* node = root->children[i];
+    Function function = { NULL, chunk, 0, 0, 0, 0 };
+    if(node->token.type != CCT_TOKEN_FUNC)
+      continue;
+    if(find_function(chunk, node->text) >= 0)
+    {
+      fprintf(stderr, "Function '%s' on line %zu is already declared.\n", node->text, node->token.line_number);
+      return false;
+    }
+    function.name = intern_name(chunk, node->text);
+    function.arity = node->child_count - 1;
+    if(function.name == NULL || function.arity > MAX_LOCAL_AMOUNT)
+      return false;
+    add_function(chunk, &function);
+    if(chunk->has_error)
+      return false;
+  }
+  return true;
+}
+
+// Adds every identifier the statement assigns to the locals of the current function
+static bool declare_assigned(const ConcoctNode* node)
+{
+  switch(node->token.type)
+  {
+    case CCT_TOKEN_ASSIGN:
+    case CCT_TOKEN_ADD_ASSIGN:
+    case CCT_TOKEN_DIV_ASSIGN:
+    case CCT_TOKEN_EXP_ASSIGN:
+    case CCT_TOKEN_MOD_ASSIGN:
+    case CCT_TOKEN_MUL_ASSIGN:
+    case CCT_TOKEN_SUB_ASSIGN:
+    case CCT_TOKEN_FOR:
+      if(node->child_count > 0 && node->children[0]->token.type == CCT_TOKEN_IDENTIFIER
+         && !declare_local(node->children[0]->text, node->token.line_number))
+        return false;
+      break;
+    default:
+      break;
+  }
+  for(size_t i = 0; i < node->child_count; i++)
+  {
+    if(!declare_assigned(node->children[i]))
+      return false;
+  }
+  return true;
+}
+
+// Compiles the statements of a function body. A final expression statement is returned implicitly, so a call there
+// is a tail call like a returned one.
+static bool compile_body(const ConcoctNode* body, Chunk* chunk)
+{
+  const ConcoctNode* last = NULL;
+
+  if(body->child_count == 0)
+    return true;
+  for(size_t i = 0; i + 1 < body->child_count; i++)
+  {
+    if(!compile_statement(body->children[i], chunk, NULL))
+      return false;
+  }
+  last = body->children[body->child_count - 1];
+  if(is_expression_statement(last))
+    return compile_result(last, chunk, last->token.line_number);
+  return compile_statement(last, chunk, NULL);
+}
+
+// Compiles the body of function after the code already in chunk. Locals are known before the body is compiled, so a
+// read of an identifier the function assigns later never falls back to the global. A body that does not end in a
+// return or an expression returns null.
+//
+//   entry: ENT locals, <body>, PSH null, RET
+static bool compile_function(const ConcoctNode* node, Chunk* chunk, Function* function)
+{
+  size_t line = node->token.line_number;
+  const ConcoctNode* body = node->children[node->child_count - 1];
+  size_t entry = chunk->count;
+  Scope function_scope;
+  bool compiled = true;
+
+  function_scope.count = 0;
+  scope = &function_scope;
+  for(size_t i = 0; compiled && i < function->arity; i++)
+  {
+    if(resolve_local(node->children[i]->text) >= 0)
+    {
+      fprintf(stderr, "Parameter '%s' of function '%s' is repeated on line %zu.\n", node->children[i]->text,
+              function->name, line);
+      compiled = false;
+    }
+    else
+      compiled = declare_local(node->children[i]->text, line);
+  }
+  compiled = compiled && declare_assigned(body);
+  write_opcode(chunk, OP_ENT, line);
+  write_chunk(chunk, 0, line);
+  compiled = compiled && compile_body(body, chunk);
+  emit_constant_op(chunk, OP_PSH, add_constant(chunk, new_object("null")), line);
+  write_opcode(chunk, OP_RET, line);
+
+  // Hidden loop bounds are declared while the body compiles, so the number of locals is only final now
+  if(compiled && !chunk->has_error)
+    chunk->code[entry + 1] = (Byte)(function_scope.count - function->arity);
+  function->entry = entry;
+  function->local_count = function_scope.count;
+  scope = NULL;
+  return compiled;
+}
+
+// Compiles the bodies of the functions declared among the top-level statements of root
+static bool compile_functions(const ConcoctNode* root, Chunk* chunk)
+{
+  for(size_t i = 0; i < root->child_count; i++)
+  {
+    const ConcoctNode* node = root->children[i];
+    if(node->token.type != CCT_TOKEN_FUNC)
+      continue;
+    if(!compile_function(node, chunk, &chunk->functions[find_function(chunk, node->text)]))
+      return false;
+  }
+  return true;
+}
+
+// Terminates chunk, appends the bodies of the functions declared in functions (if not NULL), optimizes it (through
+// the intermediate representation in -O2 mode), fuses superinstructions and verifies it
+static bool finish_chunk(Chunk* chunk, size_t line, const char* name, const ConcoctNode* functions)
+{
+  write_opcode(chunk, OP_END, line);
+  if(functions != NULL && !compile_functions(functions, chunk))
+    return false;
+  if(chunk->has_error)
+    return false;
+  if(ir_mode)
+    optimize_ir(chunk);
+  if(peephole_mode)
+    optimize_chunk(chunk);
+  if(fusion_mode)
+    fuse_superinstructions(chunk);
+  verify_chunk(chunk);
+  if(debug_mode)
+  {
+    print_chunk(chunk, name);
+    if(ir_mode)
+      print_ir_hits();
+    print_peephole_hits();
+  }
+  return true;
+}
+
+// Compiles a top-level statement. Globals it assigns anywhere lose their known value before it is compiled, since a
+// loop may read a global before assigning it.
+static bool compile_top_level(const ConcoctNode* node, Chunk* chunk)
+{
+  forget_assigned(node);
+  return compile_statement(node, chunk, NULL);
+}
+
+// Returns line number of the last node in tree
+static size_t get_last_line(const ConcoctNodeTree* tree)
+{
+  if(tree->node_count == 0)
+    return 0;
+  return tree->nodes[tree->node_count - 1]->token.line_number;
+}
+
+// Translates parser tree to VM instructions stored in chunk and returns true on success
+bool compile(const ConcoctNodeTree* tree, Chunk* chunk)
+{
+  if(tree == NULL || tree->root == NULL)
+    return false;
+  if(!declare_functions(tree->root, chunk))
+    return false;
+  find_inlinable(tree->root);
+
+  // Walk the parser tree depth-first, emitting each node after its operands (post-order)
+  known_count = 0;
+  if(tree->root->token.type != CCT_TOKEN_NEWLINE)
+    return compile_statement(tree->root, chunk, NULL) && finish_chunk(chunk, get_last_line(tree), "program", tree->root);
+  for(size_t i = 0; i < tree->root->child_count; i++)
+  {
+    if(!compile_top_level(tree->root->children[i], chunk))
+      return false;
+  }
+  return finish_chunk(chunk, get_last_line(tree), "program", tree->root);
+}
+
+// Copies the function table of host to chunk, so calls from chunk run the bodies compiled into host. The globals
+// those bodies use are bound whenever chunk runs, and host stays loaded as long as chunk is (see unload_chunk()).
+static bool import_functions(Chunk* chunk, Chunk* host)
+{
+  for(size_t i = 0; i < host->function_count; i++)
+    add_function(chunk, &host->functions[i]);
+  if(chunk->function_count > 0)
+    host->importers++;
+  for(size_t i = 0; i < host->global_count; i++)
+    add_global(chunk, host->globals[i]);
+  return !chunk->has_error;
+}
+
+// Translates parser tree to module chunks appended to program and returns true on success. Functions are compiled
+// into the first module chunk, which has to stay loaded while later modules run.
+bool compile_program(const ConcoctNodeTree* tree, Program* program)
+{
+  const ConcoctNode* root = NULL;
+  Chunk* host = NULL;
+  Chunk* chunk = NULL;
+
+  if(tree == NULL || tree->root == NULL)
+    return false;
+  root = tree->root;
+  chunk = add_chunk(program);
+  if(chunk == NULL)
+    return false;
+  if(root->token.type != CCT_TOKEN_NEWLINE)
+    return compile(tree, chunk);
+  host = chunk;
+  if(!declare_functions(root, host))
+    return false;
+  find_inlinable(root);
+  known_count = 0;
+
+  // Top-level statements are self-contained, so a new module chunk can start between any two of them
+  for(size_t i = 0; i < root->child_count; i++)
+  {
+    if(chunk->count >= MODULE_CODE_LIMIT || chunk->constant_count >= MODULE_CONSTANT_LIMIT)
+    {
+      if(!finish_chunk(chunk, chunk->lines[chunk->count - 1], "module", chunk == host ? root : NULL))
+        return false;
+      chunk = add_chunk(program);
+      if(chunk == NULL || !import_functions(chunk, host))
+        return false;
+    }
+    if(!compile_top_level(root->children[i], chunk))
+      return false;
+  }
+  return finish_chunk(chunk, get_last_line(tree), "module", chunk == host ? root : NULL);
+}
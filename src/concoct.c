@@ -30,40 +30,46 @@
 #include <signal.h>      // signal(), SIGINT
 #include <stdbool.h>     // false, true
 #include <stddef.h>      // size_t
-#include <stdio.h>       // FILE, fclose(), fflush(), fgets(), fprintf(), printf(), puts(), stdin, stderr, stdout
-#include <stdlib.h>      // exit(), EXIT_FAILURE, EXIT_SUCCESS
-#include <string.h>      // memcpy(), memset(), strcasecmp()/stricmp(), strcspn(), strerror(), strlen()
+#include <stdio.h>       // FILE, fclose(), fflush(), fgets(), fprintf(), printf(), puts(), sprintf(), stdin, stderr,
+                         // stdout
+#include <stdlib.h>      // exit(), EXIT_FAILURE, EXIT_SUCCESS, free(), malloc()
+#include <string.h>      // memcpy(), memset(), strcasecmp()/stricmp(), strcmp(), strcpy(), strcspn(), strerror(),
+                         // strlen(), strpbrk(), strrchr()
 #include "char_stream.h"
-#include "compiler.h"
+#include "compiler.h"    // folding_mode, inline_mode, register_mode
 #include "concoct.h"
 #include "debug.h"
 #include "hash_map.h"
+#include "ir.h"          // ir_mode
 #include "lexer.h"
 #ifndef _WIN32
 #include "linenoise.h"
 #endif // _WIN32
 #include "parser.h"
+#include "peephole.h"    // fusion_mode, peephole_mode
 #include "types.h"
 #include "version.h"     // VERSION
+#include "vm/aot.h"      // build_executable(), translate_program()
+#include "vm/jit.h"      // jit_available(), jit_mode
+#include "vm/profile.h"  // profile_mode
 #include "vm/vm.h"
 
+// Compile the input file to a native executable instead of interpreting it (-c)
+static bool aot_mode = false;
+
 int main(int argc, char** argv)
 {
   char *input_file = NULL;
   int nonopt_count = 0;
 
-  if(argc > 1)
+  // Options can be combined freely, so they are all handled first and the single file argument is taken after
+  handle_options(argc, argv);
+  for(int i = 1; i < argc; i++)
   {
-    for(int i = 1; i < argc; i++)
+    if(argv[i][0] != ARG_PREFIX)
     {
-      // Check for command-line options
-      if(argv[i][0] == ARG_PREFIX)
-        handle_options(argc, argv);
-      else
-      {
-        nonopt_count++;
-        input_file = argv[i];
-      }
+      nonopt_count++;
+      input_file = argv[i];
     }
   }
 
@@ -86,16 +92,13 @@ int main(int argc, char** argv)
   if(nonopt_count == 0)
     interactive_mode();
 
-  if(argc > 3)
-  {
-    fprintf(stderr, "Too many arguments!\n");
-    clean_exit(EXIT_FAILURE);
-  }
-
   if(input_file)
   {
     lex_file(input_file);
-    parse_file(input_file);
+    if(aot_mode && !compile_file(input_file))
+      clean_exit(EXIT_FAILURE);
+    if(!aot_mode)
+      parse_file(input_file);
   }
   else
   {
@@ -138,7 +141,11 @@ void parse_file(const char* file_name)
   {
     if(debug_mode)
       cct_print_node(node_tree->root, 0);
-    compile(node_tree, map);
+    Program program;
+    init_program(&program);
+    if(compile_program(node_tree, &program))
+      run_program(&program, map);
+    free_program(&program);
   }
   else
     fprintf(stderr, "Parsing error: [%zu] %s, got %s\n", parser->error_line, parser->error, cct_token_type_to_string(parser->current_token.type));
@@ -150,6 +157,85 @@ void parse_file(const char* file_name)
   return;
 }
 
+// Compiles file to C and builds a native executable named after it (without its extension)
+bool compile_file(const char* file_name)
+{
+  FILE* input_file = fopen(file_name, "r");
+  FILE* output_file = NULL;
+  ConcoctCharStream* char_stream = NULL;
+  ConcoctLexer* file_lexer = NULL;
+  ConcoctParser* parser = NULL;
+  ConcoctNodeTree* node_tree = NULL;
+  Program program;
+  size_t length = strlen(file_name);
+  const char* extension = strrchr(file_name, '.');
+  char* executable = NULL;
+  char* source = NULL;
+  bool built = false;
+
+  if(input_file == NULL)
+  {
+    fprintf(stderr, "Error opening %s: %s\n", file_name, strerror(errno));
+    return false;
+  }
+  // Strip the extension of the input file, or append one if there is none to strip
+  if(extension != NULL && strpbrk(extension, "/\\") == NULL && extension != file_name)
+    length = (size_t)(extension - file_name);
+  executable = malloc(length + 5);
+  source = malloc(length + 7);
+  if(executable == NULL || source == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory for output file names.\n");
+    free(executable);
+    free(source);
+    fclose(input_file);
+    return false;
+  }
+  memcpy(executable, file_name, length);
+  strcpy(executable + length, length == strlen(file_name) ? ".out" : "");
+  sprintf(source, "%s.c", executable);
+  // An input named like prog.c would be overwritten by its own translation
+  if(strcmp(source, file_name) == 0)
+  {
+    fprintf(stderr, "Refusing to overwrite %s with its C translation. Use another extension for Concoct files.\n",
+            file_name);
+    free(executable);
+    free(source);
+    fclose(input_file);
+    return false;
+  }
+
+  char_stream = cct_new_file_char_stream(input_file);
+  file_lexer = cct_new_lexer(char_stream);
+  parser = cct_new_parser(file_lexer);
+  node_tree = cct_parse_program(parser);
+  init_program(&program);
+  if(parser->error != NULL)
+    fprintf(stderr, "Parsing error: [%zu] %s, got %s\n", parser->error_line, parser->error, cct_token_type_to_string(parser->current_token.type));
+  else if(compile_program(node_tree, &program))
+  {
+    output_file = fopen(source, "w");
+    if(output_file == NULL)
+      fprintf(stderr, "Error opening %s: %s\n", source, strerror(errno));
+    else
+    {
+      built = translate_program(&program, file_name, output_file);
+      built = fclose(output_file) == 0 && built;
+      built = built && build_executable(source, executable);
+      if(built)
+        printf("Compiled %s to %s (C source in %s).\n", file_name, executable, source);
+    }
+  }
+  free_program(&program);
+  fclose(input_file);
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(node_tree);
+  free(executable);
+  free(source);
+  return built;
+}
+
 // Parses string
 void parse_string(const char* input_string)
 {
@@ -162,7 +248,11 @@ void parse_string(const char* input_string)
   {
     if(debug_mode)
       cct_print_node(node_tree->root, 0);
-    compile(node_tree, map);
+    Program program;
+    init_program(&program);
+    if(compile_program(node_tree, &program))
+      run_program(&program, map);
+    free_program(&program);
   }
   else
     fprintf(stderr, "Parsing error: [%zu] %s, got %s\n", parser->error_line, parser->error, cct_token_type_to_string(parser->current_token.type));
@@ -252,26 +342,64 @@ void lex_string(const char* input_string)
   return;
 }
 
-// Handle command-line options
+// Handle all command-line options, in any order and combination
 void handle_options(int argc, char *argv[])
 {
   for(int i = 1; i < argc; i++)
   {
+    // The only option longer than one letter
+    if(argv[i][0] == ARG_PREFIX && strcmp(&argv[i][1], "O2") == 0)
+    {
+      ir_mode = true;
+      continue;
+    }
     if(argv[i][0] == ARG_PREFIX && strlen(argv[i]) == 2)
     {
       switch(argv[i][1])
       {
+        case 'c':
+          aot_mode = true;
+          break;
         case 'd':
           debug_mode = true;
           break;
+        case 'e':
+          peephole_mode = false;
+          break;
+        case 'g':
+          quicken_mode = false;
+          break;
         case 'h':
           print_usage();
           exit(EXIT_SUCCESS);
           break;
+        case 'i':
+          inline_mode = false;
+          break;
+        case 'j':
+          jit_mode = jit_available();
+          if(!jit_mode)
+            fprintf(stderr, "JIT compilation is not supported on this platform.\n");
+          break;
+        case 'k':
+          cache_mode = false;
+          break;
         case 'l':
           print_license();
           exit(EXIT_SUCCESS);
           break;
+        case 'n':
+          folding_mode = false;
+          break;
+        case 'p':
+          profile_mode = true;
+          break;
+        case 'r':
+          register_mode = true;
+          break;
+        case 'u':
+          fusion_mode = false;
+          break;
         case 'v':
           print_version();
           exit(EXIT_SUCCESS);
@@ -324,11 +452,23 @@ void print_license(void)
 void print_usage(void)
 {
   print_version();
-  printf("Usage: concoct [%c<option>] [file]\n", ARG_PREFIX);
+  printf("Usage: concoct [%c<option> ...] [file]\n", ARG_PREFIX);
   puts("Options:");
+  printf("%cc: compile file to a native executable through C\n", ARG_PREFIX);
   printf("%cd: debug mode\n", ARG_PREFIX);
+  printf("%ce: disable peephole optimization and dead-code elimination\n", ARG_PREFIX);
+  printf("%cg: disable quickening (generic instructions only)\n", ARG_PREFIX);
   printf("%ch: print usage\n", ARG_PREFIX);
+  printf("%ci: disable inlining of small functions\n", ARG_PREFIX);
+  printf("%cj: compile hot chunks to native code (x86-64 Linux)\n", ARG_PREFIX);
+  printf("%ck: disable top-of-stack caching\n", ARG_PREFIX);
   printf("%cl: print license\n", ARG_PREFIX);
+  printf("%cn: disable constant folding and propagation\n", ARG_PREFIX);
+  printf("%cO2: optimize through an SSA intermediate representation (value numbering, loop-invariant code motion)\n",
+         ARG_PREFIX);
+  printf("%cp: profile opcode sequences\n", ARG_PREFIX);
+  printf("%cr: compile expressions to register instructions\n", ARG_PREFIX);
+  printf("%cu: disable superinstructions (unfused instructions)\n", ARG_PREFIX);
   printf("%cv: print version\n", ARG_PREFIX);
   return;
 }
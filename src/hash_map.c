@@ -142,12 +142,21 @@ void cct_hash_map_set(ConcoctHashMap* map, const char* key, void* value)
   }
   else
   {
-    // Traverses the linked list to find where to put new node
-    while(node->next != NULL)
+    // Traverses the linked list to find an existing entry for the key or where to put new node
+    while(node != NULL)
     {
+      if(node->hash == hash && strcmp(node->key, key) == 0)
+      {
+        node->value = value;
+        return;
+      }
+      if(node->next == NULL)
+      {
+        node->next = cct_new_hash_map_node(key, value, hash);
+        return;
+      }
       node = node->next;
     }
-    node->next = cct_new_hash_map_node(key, value, hash);
   }
 
   return;
@@ -0,0 +1,2596 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>          // SIZE_MAX, UINT8_MAX, uint64_t
+#include <stdio.h>           // snprintf()
+#include <stdlib.h>          // calloc(), free(), malloc(), qsort(), realloc()
+#include <string.h>          // memcmp(), memcpy()
+#include "debug.h"           // debug_print()
+#include "ir.h"
+#include "vm/instructions.h" // fold_binary(), fold_unary(), is_truthy()
+#include "vm/opcodes.h"      // falls_through(), get_operand_length(), get_quickened_opcode(), is_binary_operation(),
+                             // is_jump_operation()
+#include "vm/vm.h"           // bind_global(), HIDDEN_GLOBAL_PREFIX, vm
+
+bool ir_mode = false;
+
+/*
+ * The optimizer lifts the code of each region of a chunk (the main program and every function body) into a control
+ * flow graph of basic blocks. Each block is a list of instructions that are also values in SSA form: a value is
+ * defined once, by one instruction, and arguments refer to values instead of stack slots. Identifiers stay in memory,
+ * so reading one is a load and assigning one is a store. The value on the stack where the operands of && and || join
+ * is the only value that depends on the path taken; it becomes a parameter of the block (a phi). Constants are values
+ * without a block.
+ *
+ * Four passes run over the graph:
+ *
+ *   value numbering  Walks the dominator tree with a scoped table of the values already computed. An operation whose
+ *                    operands have the same value numbers as one that dominates it is replaced by it (common
+ *                    subexpression elimination). Each identifier carries a version that changes whenever a path may
+ *                    assign it, so loads of the same version are equal and a load following a store has the number
+ *                    of the stored value (copy propagation). Operations on constants are folded, including those on
+ *                    identifiers known to hold a constant.
+ *   type inference   Computes the set of data types each value may have from the types of constants, the result
+ *                    rules of the VM's kernels and, for the locals of a function, the values stored to them.
+ *                    Operations that cannot fail for any of the types they may see no longer count as failing for the
+ *                    passes below.
+ *   loop-invariant   Hoists operations of a loop whose operands do not change in it to a preheader block that runs
+ *   code motion      once before the loop. Only operations every iteration computes before anything that may fail or
+ *                    have side effects are hoisted, in their original order, so run-time errors stay the same. Loops
+ *                    are entered through a copy of their condition in this mode (see compile_while()), so the
+ *                    preheader only runs if the body does.
+ *   dead code        Drops loads, tests and operations that cannot fail nothing uses any more and stores to locals
+ *                    nothing reads.
+ *
+ * The graph is then lowered back to stack code. A value used once, by an instruction of its own block that needs it
+ * on top of the stack without anything else running in between, is computed in place. Any other value is stored in a
+ * temporary: a hidden local inside a function or a hidden global (see HIDDEN_GLOBAL_PREFIX) named after its number
+ * in the main program, which the identifier map never sees. Values whose live ranges do not overlap share a
+ * temporary. A binary operation whose operands are proven to have the same type is emitted in the quickened form for
+ * it, so it runs the typed kernel from its first execution. The form keeps its type guard. Regions the optimizer cannot lift (register instructions, for example) are copied unchanged.
+ */
+
+#define NO_INDEX SIZE_MAX             // no value, block, loop or temporary
+#define IMPLICIT_BOOL (SIZE_MAX - 1)  // stack entry for the shared Bool left by OP_JMF or OP_JMT when they jump
+#define LOAD_KEY ((size_t)OPCODE_AMOUNT) // kind of the value table entry of a load
+#define VARIABLE_AMOUNT (MAX_LOCAL_AMOUNT + MAX_GLOBAL_AMOUNT) // locals first, then globals
+#define TYPE_BIT(type) ((TypeSet)(1u << (type)))
+#define ANY_TYPE ((TypeSet)((1u << DATA_TYPE_AMOUNT) - 1))
+#define NUMERIC_TYPES (TYPE_BIT(CCT_TYPE_BYTE) | TYPE_BIT(CCT_TYPE_NUMBER) | TYPE_BIT(CCT_TYPE_BIGNUM) \
+                       | TYPE_BIT(CCT_TYPE_DECIMAL))
+
+// Set of the data types a value may have (bit 1 << type for each)
+typedef uint8_t TypeSet;
+
+// Value of the intermediate representation. Instructions are values too, including stores and the exits of blocks,
+// which produce nothing.
+//
+//   OP_PSH          constant (no block)           OP_NOP          block parameter
+//   OP_GET, OP_LDL  load of a global or local     OP_ASN, OP_STL  store of argument 0 to a global or local
+//   OP_TST, unary and binary opcodes              OP_CAL          call of function operand
+//   OP_JMP, OP_JMC, OP_JMZ, OP_JMF, OP_JMT, OP_LOE, OP_LNE, OP_RET, OP_TCL, OP_END  exit of a block
+typedef struct ir_value
+{
+  Opcode opcode;
+  uint16_t operand;    // constant index, global or local slot, or function index
+  size_t line;
+  size_t block;        // block computing the value (NO_INDEX for constants)
+  size_t first;        // index of its first argument in the argument list
+  size_t arity;        // number of arguments
+  size_t variable;     // identifier a load or store accesses
+  size_t number;       // value number (the first value known to be equal to this one)
+  size_t replacement;  // value used in place of this one or NO_INDEX
+  size_t uses;         // number of arguments referring to the value
+  size_t user;         // value using it (the last one if there are several)
+  size_t position;     // position in the emitted code
+  size_t temporary;    // temporary holding the value between its computation and its uses or NO_INDEX
+  TypeSet types;       // data types the value may have
+  bool is_safe;        // load that cannot fail because the identifier was assigned or read before
+  bool is_total;       // operation that cannot fail for any of the types its operands may have
+  bool is_pending;     // left on the stack for a later instruction while lowering
+  bool is_inline;      // computed where its only user needs it on the stack
+  bool is_hoisted;
+} IrValue;
+
+// Basic block. Control enters at the top and leaves through the exit, its last instruction.
+typedef struct ir_block
+{
+  size_t start;         // offsets of its instructions before optimization
+  size_t end;
+  size_t* values;       // instructions in order
+  size_t count;
+  size_t capacity;
+  size_t target;        // block the exit jumps to or NO_INDEX
+  size_t next;          // block control continues with when the exit does not jump or NO_INDEX
+  size_t parameter;     // value on the stack when control enters or NO_INDEX
+  size_t* predecessors;
+  size_t predecessor_count;
+  size_t predecessor_capacity;
+  size_t* stack;        // values left on the stack by the exit (while lifting)
+  size_t height;
+  size_t depth;         // stack depth control enters with (while lifting)
+  size_t idom;          // immediate dominator
+  size_t order;         // reverse post-order index
+  size_t loop;          // innermost loop containing the block or NO_INDEX
+  size_t offset;        // offset of the lowered code
+  size_t layout;        // index in the lowered code
+  bool is_reached;
+  bool is_lifted;
+} IrBlock;
+
+// Natural loop
+typedef struct ir_loop
+{
+  size_t header;
+  size_t parent;        // innermost loop enclosing it or NO_INDEX
+  size_t* blocks;
+  size_t size;          // number of blocks
+  size_t first;         // positions of the first and last instruction in the lowered code
+  size_t last;
+} IrLoop;
+
+// Region being optimized
+typedef struct graph
+{
+  Chunk* chunk;
+  const Function* function; // function whose body is optimized or NULL for the main program
+  size_t start;             // offsets of the region
+  size_t end;
+  IrValue* values;
+  size_t value_count;
+  size_t value_capacity;
+  size_t* arguments;
+  size_t argument_count;
+  size_t argument_capacity;
+  IrBlock* blocks;
+  size_t block_count;
+  size_t block_capacity;
+  size_t* order;            // reached blocks in reverse post-order
+  size_t order_count;
+  size_t* layout;           // blocks in the order of the lowered code
+  size_t layout_count;
+  IrLoop* loops;
+  size_t loop_count;
+  size_t* variables;        // dense index of each identifier key or NO_INDEX (shared by the regions of a chunk)
+  size_t* variable_keys;    // identifier key of each dense index
+  size_t variable_count;
+  size_t temporary_count;
+  bool has_error;
+} Graph;
+
+// Entry of the value table: the value number of an operation on value numbers or of a load of an identifier version
+typedef struct number_entry
+{
+  size_t kind;          // opcode or LOAD_KEY
+  size_t left;          // number of the first operand or identifier
+  size_t right;         // number of the second operand, version of the identifier or NO_INDEX
+  size_t number;
+  size_t next;          // next entry of the bucket
+} NumberEntry;
+
+// Previous state of an identifier restored when value numbering leaves a dominator subtree
+typedef struct variable_state
+{
+  size_t variable;
+  size_t version;
+  bool is_defined;
+} VariableState;
+
+// State of value numbering
+typedef struct numbering
+{
+  NumberEntry* entries;     // stack of entries (later ones hide earlier ones with the same key)
+  size_t entry_count;
+  size_t entry_capacity;
+  size_t* buckets;
+  size_t bucket_mask;
+  size_t* constants;        // first constant value of each content hash bucket chain
+  size_t* constant_next;    // next constant of the same chain (indexed by value)
+  size_t* versions;         // current version of each identifier
+  bool* is_defined;         // identifier assigned or read on every path to the current block
+  VariableState* undo;
+  size_t undo_count;
+  size_t undo_capacity;
+  size_t version_count;
+  size_t* visits;           // last search that visited each block
+  size_t visit;
+  size_t* pending;
+} Numbering;
+
+// Interval of positions a temporary value lives in
+typedef struct live_range
+{
+  size_t start;
+  size_t end;
+  size_t value;
+} LiveRange;
+
+static size_t numbering_hits = 0;
+static size_t folding_hits = 0;
+static size_t hoisting_hits = 0;
+static size_t typing_hits = 0;
+
+// Returns array grown to hold more than count elements of size bytes (NULL if memory ran out, which marks the graph)
+static void* grow(Graph* graph, void* array, size_t* capacity, size_t count, size_t size)
+{
+  size_t new_capacity = 0;
+  void* grown = NULL;
+
+  if(count < *capacity)
+    return array;
+  new_capacity = *capacity == 0 ? 8 : *capacity * 2;
+  grown = realloc(array, new_capacity * size);
+  if(grown == NULL)
+  {
+    graph->has_error = true;
+    return NULL;
+  }
+  *capacity = new_capacity;
+  return grown;
+}
+
+// Adds a value without arguments and returns its index (NO_INDEX if memory ran out)
+static size_t add_value(Graph* graph, Opcode oc, uint16_t operand, size_t line, size_t block)
+{
+  IrValue* values = grow(graph, graph->values, &graph->value_capacity, graph->value_count, sizeof(IrValue));
+  size_t index = graph->value_count;
+
+  if(values == NULL)
+    return NO_INDEX;
+  graph->values = values;
+  graph->values[index] = (IrValue){ oc, operand, line, block, graph->argument_count, 0, NO_INDEX, index, NO_INDEX, 0,
+                                    NO_INDEX, 0, NO_INDEX, ANY_TYPE, false, false, false, false, false };
+  graph->value_count++;
+  return index;
+}
+
+// Adds argument to the value created last
+static bool add_argument(Graph* graph, size_t value, size_t argument)
+{
+  size_t* arguments = grow(graph, graph->arguments, &graph->argument_capacity, graph->argument_count, sizeof(size_t));
+
+  if(arguments == NULL)
+    return false;
+  graph->arguments = arguments;
+  graph->arguments[graph->argument_count++] = argument;
+  graph->values[value].arity++;
+  return true;
+}
+
+// Returns argument i of value
+static size_t get_argument(const Graph* graph, size_t value, size_t i)
+{
+  return graph->arguments[graph->values[value].first + i];
+}
+
+// Appends value to the instructions of block
+static bool append_value(Graph* graph, size_t block, size_t value)
+{
+  IrBlock* target = &graph->blocks[block];
+  size_t* values = grow(graph, target->values, &target->capacity, target->count, sizeof(size_t));
+
+  if(values == NULL)
+    return false;
+  target->values = values;
+  target->values[target->count++] = value;
+  return true;
+}
+
+// Adds predecessor to block
+static bool add_predecessor(Graph* graph, size_t block, size_t predecessor)
+{
+  IrBlock* target = &graph->blocks[block];
+  size_t* predecessors = grow(graph, target->predecessors, &target->predecessor_capacity, target->predecessor_count,
+                              sizeof(size_t));
+
+  if(predecessors == NULL)
+    return false;
+  target->predecessors = predecessors;
+  target->predecessors[target->predecessor_count++] = predecessor;
+  return true;
+}
+
+// Adds an empty block and returns its index (NO_INDEX if memory ran out)
+static size_t add_block(Graph* graph, size_t start, size_t end)
+{
+  IrBlock* blocks = grow(graph, graph->blocks, &graph->block_capacity, graph->block_count, sizeof(IrBlock));
+  size_t index = graph->block_count;
+
+  if(blocks == NULL)
+    return NO_INDEX;
+  graph->blocks = blocks;
+  graph->blocks[index] = (IrBlock){ start, end, NULL, 0, 0, NO_INDEX, NO_INDEX, NO_INDEX, NULL, 0, 0, NULL, 0, 0,
+                                    NO_INDEX, NO_INDEX, NO_INDEX, 0, 0, false, false };
+  graph->block_count++;
+  return index;
+}
+
+// Returns the exit of block
+static size_t get_exit(const Graph* graph, size_t block)
+{
+  return graph->blocks[block].values[graph->blocks[block].count - 1];
+}
+
+// Returns true if the value is a load of an identifier
+static bool is_load(Opcode oc)
+{
+  return oc == OP_GET || oc == OP_LDL;
+}
+
+// Returns true if the value is a store to an identifier
+static bool is_store(Opcode oc)
+{
+  return oc == OP_ASN || oc == OP_STL;
+}
+
+// Returns true if opcode ends a block
+static bool is_exit(Opcode oc)
+{
+  return is_jump_operation(oc) || !falls_through(oc);
+}
+
+// Returns true if the value is an operation without side effects other than failing
+static bool is_operation(Opcode oc)
+{
+  return oc == OP_TST || is_unary_operation(oc) || (is_binary_operation(oc) && oc != OP_ASN);
+}
+
+// Returns true if the value leaves something on the stack
+static bool produces_value(const IrValue* value)
+{
+  return value->opcode == OP_NOP || value->opcode == OP_PSH || value->opcode == OP_CAL || is_load(value->opcode)
+         || is_operation(value->opcode);
+}
+
+// Returns true if computing the value may raise a run-time error
+static bool may_fail(const IrValue* value)
+{
+  if(value->opcode == OP_GET)
+    return !value->is_safe;
+  return value->opcode == OP_CAL || (is_operation(value->opcode) && value->opcode != OP_TST && !value->is_total);
+}
+
+// Returns key of the identifier a load or store accesses
+static size_t get_variable_key(Opcode oc, uint16_t slot)
+{
+  return oc == OP_LDL || oc == OP_STL ? slot : MAX_LOCAL_AMOUNT + slot;
+}
+
+// Returns the value used in place of value
+static size_t resolve(const Graph* graph, size_t value)
+{
+  while(graph->values[value].replacement != NO_INDEX)
+    value = graph->values[value].replacement;
+  return value;
+}
+
+// Returns true if block is inside loop
+static bool in_loop(const Graph* graph, size_t block, size_t loop)
+{
+  for(size_t l = graph->blocks[block].loop; l != NO_INDEX; l = graph->loops[l].parent)
+  {
+    if(l == loop)
+      return true;
+  }
+  return false;
+}
+
+// Returns true if block a dominates block b
+static bool dominates(const Graph* graph, size_t a, size_t b)
+{
+  while(b != a && graph->blocks[b].idom != b)
+    b = graph->blocks[b].idom;
+  return b == a;
+}
+
+// Returns the number of stack entries an instruction of the region pops, or SIZE_MAX if the optimizer cannot lift it
+static size_t get_pops(const Chunk* chunk, Opcode oc, const Byte* operands)
+{
+  switch(oc)
+  {
+    case OP_END:
+    case OP_GET:
+    case OP_JMP:
+    case OP_LDL:
+    case OP_LOP:
+    case OP_PSH:
+      return 0;
+    case OP_ASN:
+    case OP_JMC:
+    case OP_JMF:
+    case OP_JMT:
+    case OP_JMZ:
+    case OP_LNZ:
+    case OP_LOZ:
+    case OP_POP:
+    case OP_RET:
+    case OP_STL:
+    case OP_TST:
+      return 1;
+    case OP_LNE:
+    case OP_LOE:
+      return 2;
+    case OP_CAL:
+    case OP_TCL:
+      return read_short(operands) < chunk->function_count ? chunk->functions[read_short(operands)].arity : SIZE_MAX;
+    default:
+      if(is_unary_operation(oc))
+        return 1;
+      return is_binary_operation(oc) ? 2 : SIZE_MAX;
+  }
+}
+
+// Returns the opcode of the value lifted from an instruction. Jumps lose their direction, which lowering picks again.
+static Opcode get_lifted_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_LNZ: return OP_JMC;
+    case OP_LOP: return OP_JMP;
+    case OP_LOZ: return OP_JMZ;
+    default:     return oc;
+  }
+}
+
+// Splits the region into blocks at jump targets and after exits, and records where each exit leads. Block 0 is an
+// empty entry block, so the first block of code may be the target of a loop.
+static bool find_blocks(Graph* graph, size_t body, size_t* block_at)
+{
+  const Chunk* chunk = graph->chunk;
+  size_t size = graph->end - graph->start;
+  bool* starts = calloc(size + 1, sizeof(bool));
+  bool* instructions = calloc(size + 1, sizeof(bool));
+  size_t last = 0;
+  bool found = false;
+
+  if(starts == NULL || instructions == NULL)
+    goto done;
+  starts[body - graph->start] = true;
+  for(size_t offset = body; offset < graph->end; offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+  {
+    Opcode oc = (Opcode)chunk->code[offset];
+    size_t next = offset + 1 + get_operand_length(oc);
+    if(next > graph->end || get_pops(chunk, oc, &chunk->code[offset + 1]) == SIZE_MAX)
+      goto done;
+    instructions[offset - graph->start] = true;
+    if(is_jump_operation(oc))
+    {
+      size_t target = get_jump_target(chunk, offset);
+      if(target < body || target >= graph->end)
+        goto done;
+      starts[target - graph->start] = true;
+    }
+    if(is_exit(oc) && next < graph->end)
+      starts[next - graph->start] = true;
+  }
+  for(size_t offset = body; offset < graph->end; offset++)
+  {
+    if(starts[offset - graph->start] && !instructions[offset - graph->start])
+      goto done; // jump into an instruction
+  }
+
+  if(add_block(graph, body, body) == NO_INDEX)
+    goto done;
+  graph->blocks[0].target = 1;
+  for(size_t offset = body; offset < graph->end; offset++)
+  {
+    size_t block = 0;
+    block_at[offset - graph->start] = NO_INDEX;
+    if(!starts[offset - graph->start])
+      continue;
+    block = add_block(graph, offset, graph->end);
+    if(block == NO_INDEX)
+      goto done;
+    if(block > 1)
+      graph->blocks[block - 1].end = offset;
+    block_at[offset - graph->start] = block;
+  }
+
+  // Exits lead to their target and, unless they always jump, to the following block
+  for(size_t block = 1; block < graph->block_count; block++)
+  {
+    IrBlock* current = &graph->blocks[block];
+    Opcode oc = OP_NOP;
+    for(size_t offset = current->start; offset < current->end;
+        offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+      last = offset;
+    oc = (Opcode)chunk->code[last];
+    if(is_jump_operation(oc))
+      current->target = block_at[get_jump_target(chunk, last) - graph->start];
+    if(falls_through(oc))
+    {
+      if(block + 1 == graph->block_count)
+        goto done; // execution would run past the end of the region
+      if(is_jump_operation(oc))
+        current->next = block + 1;
+      else
+        current->target = block + 1;
+    }
+    if((oc == OP_JMF || oc == OP_JMT) && current->target == current->next)
+      goto done;
+  }
+  found = true;
+
+done:
+  free(starts);
+  free(instructions);
+  return found;
+}
+
+// Numbers the blocks reached from the entry block in reverse post-order and records the predecessors of each
+static bool order_blocks(Graph* graph)
+{
+  size_t* stack = malloc(graph->block_count * sizeof(size_t));
+  size_t* steps = calloc(graph->block_count, sizeof(size_t));
+  size_t* post = malloc(graph->block_count * sizeof(size_t));
+  size_t height = 0;
+  size_t post_count = 0;
+  bool ordered = false;
+
+  if(stack == NULL || steps == NULL || post == NULL)
+    goto done;
+  graph->order = malloc(graph->block_count * sizeof(size_t));
+  if(graph->order == NULL)
+    goto done;
+  graph->blocks[0].is_reached = true;
+  stack[height++] = 0;
+  while(height > 0)
+  {
+    size_t block = stack[height - 1];
+    size_t successor = NO_INDEX;
+    if(steps[block] == 0)
+      successor = graph->blocks[block].target;
+    else if(steps[block] == 1)
+      successor = graph->blocks[block].next;
+    else
+    {
+      post[post_count++] = block;
+      height--;
+      continue;
+    }
+    steps[block]++;
+    if(successor != NO_INDEX && !graph->blocks[successor].is_reached)
+    {
+      graph->blocks[successor].is_reached = true;
+      stack[height++] = successor;
+    }
+  }
+  for(size_t i = 0; i < post_count; i++)
+  {
+    size_t block = post[post_count - 1 - i];
+    graph->order[i] = block;
+    graph->blocks[block].order = i;
+  }
+  graph->order_count = post_count;
+  for(size_t i = 0; i < post_count; i++)
+  {
+    const IrBlock* block = &graph->blocks[graph->order[i]];
+    size_t target = block->target;
+    size_t next = block->next;
+    if(target != NO_INDEX && !add_predecessor(graph, target, graph->order[i]))
+      goto done;
+    if(next != NO_INDEX && !add_predecessor(graph, next, graph->order[i]))
+      goto done;
+  }
+  ordered = true;
+
+done:
+  free(stack);
+  free(steps);
+  free(post);
+  return ordered;
+}
+
+// Returns the number of entries control leaves predecessor towards block with (OP_JMF and OP_JMT push a Bool when
+// they jump)
+static size_t get_edge_height(const Graph* graph, size_t predecessor, size_t block)
+{
+  const IrBlock* from = &graph->blocks[predecessor];
+  Opcode oc = graph->values[get_exit(graph, predecessor)].opcode;
+
+  return from->height + ((oc == OP_JMF || oc == OP_JMT) && from->target == block ? 1 : 0);
+}
+
+// Sets up the stack control enters block with from the blocks before it. Entries that differ between them (only
+// the top one, where && and || join) become the parameter of the block.
+static bool enter_block(Graph* graph, size_t block, size_t* stack, size_t* height)
+{
+  const IrBlock* current = &graph->blocks[block];
+  bool is_first = true;
+  bool is_joined = false;
+
+  *height = 0;
+  for(size_t i = 0; i < current->predecessor_count; i++)
+  {
+    size_t predecessor = current->predecessors[i];
+    const IrBlock* from = &graph->blocks[predecessor];
+    size_t edge_height = 0;
+    if(!from->is_lifted)
+      continue; // a jump back, checked once its block is lifted
+    edge_height = get_edge_height(graph, predecessor, block);
+    if(is_first)
+    {
+      for(size_t j = 0; j < from->height; j++)
+        stack[j] = from->stack[j];
+      if(edge_height > from->height)
+        stack[from->height] = IMPLICIT_BOOL;
+      *height = edge_height;
+      is_first = false;
+      continue;
+    }
+    if(edge_height != *height)
+      return false;
+    for(size_t j = 0; j + 1 < *height; j++)
+    {
+      if(stack[j] != from->stack[j])
+        return false;
+    }
+    if(*height > 0 && (edge_height > from->height || stack[*height - 1] != from->stack[*height - 1]))
+      is_joined = true;
+  }
+  for(size_t j = 0; j + 1 < *height; j++)
+  {
+    if(stack[j] == IMPLICIT_BOOL)
+      return false;
+  }
+  if(*height > 0 && (is_joined || stack[*height - 1] == IMPLICIT_BOOL))
+  {
+    size_t parameter = add_value(graph, OP_NOP, 0, graph->chunk->lines[graph->blocks[block].start], block);
+    if(parameter == NO_INDEX)
+      return false;
+    graph->blocks[block].parameter = parameter;
+    stack[*height - 1] = parameter;
+  }
+  graph->blocks[block].depth = *height;
+  return true;
+}
+
+// Assigns a dense index to the identifier of a load or store
+static void register_variable(Graph* graph, size_t value)
+{
+  IrValue* load_or_store = &graph->values[value];
+  size_t key = get_variable_key(load_or_store->opcode, load_or_store->operand);
+
+  if(graph->variables[key] == NO_INDEX)
+  {
+    graph->variables[key] = graph->variable_count;
+    graph->variable_keys[graph->variable_count++] = key;
+  }
+  load_or_store->variable = graph->variables[key];
+  return;
+}
+
+// Lifts the instructions of block, replacing stack slots by the values computed into them
+static bool lift_block(Graph* graph, size_t block, size_t* stack)
+{
+  const Chunk* chunk = graph->chunk;
+  size_t height = 0;
+  size_t exit = NO_INDEX;
+  size_t* remaining = NULL;
+
+  if(!enter_block(graph, block, stack, &height))
+    return false;
+  for(size_t offset = graph->blocks[block].start; offset < graph->blocks[block].end;
+      offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+  {
+    Opcode oc = (Opcode)chunk->code[offset];
+    const Byte* operands = &chunk->code[offset + 1];
+    size_t pops = get_pops(chunk, oc, operands);
+    uint16_t operand = 0;
+    size_t value = NO_INDEX;
+    if(height < pops)
+      return false;
+    if(oc == OP_POP)
+    {
+      height--;
+      continue;
+    }
+    if(oc == OP_LDL || oc == OP_STL)
+      operand = operands[0];
+    else if(oc == OP_ASN || oc == OP_CAL || oc == OP_GET || oc == OP_PSH || oc == OP_TCL)
+      operand = read_short(operands);
+    value = add_value(graph, get_lifted_opcode(oc), operand, chunk->lines[offset], oc == OP_PSH ? NO_INDEX : block);
+    if(value == NO_INDEX)
+      return false;
+    for(size_t i = height - pops; i < height; i++)
+    {
+      if(!add_argument(graph, value, stack[i]))
+        return false;
+    }
+    height -= pops;
+    if(is_load(oc) || is_store(oc))
+      register_variable(graph, value);
+    if(oc != OP_PSH && !append_value(graph, block, value))
+      return false;
+    if(produces_value(&graph->values[value]))
+      stack[height++] = value;
+    if(is_exit(oc))
+      exit = value;
+  }
+  if(exit == NO_INDEX)
+  {
+    size_t end = graph->blocks[block].end;
+    exit = add_value(graph, OP_JMP, 0, chunk->lines[end > graph->blocks[block].start ? end - 1 : end], block);
+    if(exit == NO_INDEX || !append_value(graph, block, exit))
+      return false;
+  }
+  if(height > 0)
+  {
+    remaining = malloc(height * sizeof(size_t));
+    if(remaining == NULL)
+      return false;
+    memcpy(remaining, stack, height * sizeof(size_t));
+  }
+  graph->blocks[block].stack = remaining;
+  graph->blocks[block].height = height;
+  graph->blocks[block].is_lifted = true;
+
+  // Control only jumps back at statement boundaries, where the stack is empty
+  for(size_t i = 0; i < 2; i++)
+  {
+    size_t successor = i == 0 ? graph->blocks[block].target : graph->blocks[block].next;
+    if(successor == NO_INDEX || successor > block)
+      continue;
+    if(graph->blocks[successor].depth != 0 || get_edge_height(graph, block, successor) != 0)
+      return false;
+  }
+  return true;
+}
+
+// Lifts every reached block in offset order, so the stack a block starts with is known from the blocks before it,
+// and passes the top of the stack to blocks starting with a parameter
+static bool lift_blocks(Graph* graph)
+{
+  size_t* stack = malloc((graph->end - graph->start + 2) * sizeof(size_t));
+  bool lifted = stack != NULL;
+
+  for(size_t block = 0; lifted && block < graph->block_count; block++)
+  {
+    if(graph->blocks[block].is_reached)
+      lifted = lift_block(graph, block, stack);
+  }
+  free(stack);
+  for(size_t block = 0; lifted && block < graph->block_count; block++)
+  {
+    const IrBlock* current = &graph->blocks[block];
+    size_t exit = 0;
+    IrValue old_exit;
+    if(!current->is_reached)
+      continue;
+    exit = get_exit(graph, block);
+    old_exit = graph->values[exit];
+    if(current->next != NO_INDEX && graph->blocks[current->next].parameter != NO_INDEX)
+      return false;
+    if(current->target == NO_INDEX || graph->blocks[current->target].parameter == NO_INDEX)
+      continue;
+    if(old_exit.opcode == OP_JMF || old_exit.opcode == OP_JMT)
+      continue;
+    if(old_exit.opcode != OP_JMP || current->height == 0)
+      return false;
+    exit = add_value(graph, OP_JMP, 0, old_exit.line, block);
+    if(exit == NO_INDEX || !add_argument(graph, exit, current->stack[current->height - 1]))
+      return false;
+    graph->blocks[block].values[graph->blocks[block].count - 1] = exit;
+  }
+  return lifted;
+}
+
+// Returns the nearest common dominator of blocks a and b
+static size_t intersect(const Graph* graph, size_t a, size_t b)
+{
+  while(a != b)
+  {
+    while(graph->blocks[a].order > graph->blocks[b].order)
+      a = graph->blocks[a].idom;
+    while(graph->blocks[b].order > graph->blocks[a].order)
+      b = graph->blocks[b].idom;
+  }
+  return a;
+}
+
+// Finds the immediate dominator of every reached block (Cooper, Harvey and Kennedy)
+static void find_dominators(Graph* graph)
+{
+  bool changed = true;
+
+  graph->blocks[0].idom = 0;
+  while(changed)
+  {
+    changed = false;
+    for(size_t i = 1; i < graph->order_count; i++)
+    {
+      IrBlock* block = &graph->blocks[graph->order[i]];
+      size_t idom = NO_INDEX;
+      for(size_t j = 0; j < block->predecessor_count; j++)
+      {
+        size_t predecessor = block->predecessors[j];
+        if(graph->blocks[predecessor].idom == NO_INDEX)
+          continue;
+        idom = idom == NO_INDEX ? predecessor : intersect(graph, idom, predecessor);
+      }
+      if(idom != block->idom)
+      {
+        block->idom = idom;
+        changed = true;
+      }
+    }
+  }
+  return;
+}
+
+// Orders loops by decreasing size
+static int compare_loops(const void* a, const void* b)
+{
+  size_t size_a = ((const IrLoop*)a)->size;
+  size_t size_b = ((const IrLoop*)b)->size;
+
+  return size_a < size_b ? 1 : (size_a > size_b ? -1 : 0);
+}
+
+// Finds the natural loop of every block that a jump back from a block it dominates enters, and the innermost loop
+// of each block
+static bool find_loops(Graph* graph)
+{
+  bool* in_body = calloc(graph->block_count, sizeof(bool));
+  size_t* pending = malloc(graph->block_count * sizeof(size_t));
+  bool found = false;
+
+  graph->loops = malloc(graph->block_count * sizeof(IrLoop));
+  if(in_body == NULL || pending == NULL || graph->loops == NULL)
+    goto done;
+  for(size_t i = 0; i < graph->order_count; i++)
+  {
+    size_t header = graph->order[i];
+    const IrBlock* block = &graph->blocks[header];
+    IrLoop loop = { header, NO_INDEX, NULL, 0, 0, 0 };
+    size_t pending_count = 0;
+    for(size_t j = 0; j < block->predecessor_count; j++)
+    {
+      size_t latch = block->predecessors[j];
+      if(dominates(graph, header, latch) && !in_body[latch] && latch != header)
+      {
+        in_body[latch] = true;
+        pending[pending_count++] = latch;
+      }
+      else if(latch == header)
+        in_body[header] = true;
+    }
+    if(pending_count == 0 && !in_body[header])
+      continue;
+    in_body[header] = true;
+    loop.blocks = malloc(graph->block_count * sizeof(size_t));
+    if(loop.blocks == NULL)
+      goto done;
+    loop.blocks[loop.size++] = header;
+    while(pending_count > 0)
+    {
+      size_t member = pending[--pending_count];
+      const IrBlock* current = &graph->blocks[member];
+      loop.blocks[loop.size++] = member;
+      for(size_t j = 0; j < current->predecessor_count; j++)
+      {
+        if(!in_body[current->predecessors[j]])
+        {
+          in_body[current->predecessors[j]] = true;
+          pending[pending_count++] = current->predecessors[j];
+        }
+      }
+    }
+    for(size_t j = 0; j < loop.size; j++)
+      in_body[loop.blocks[j]] = false;
+    graph->loops[graph->loop_count++] = loop;
+  }
+
+  // Enclosing loops are larger, so they claim their blocks first
+  qsort(graph->loops, graph->loop_count, sizeof(IrLoop), compare_loops);
+  for(size_t l = 0; l < graph->loop_count; l++)
+  {
+    IrLoop* loop = &graph->loops[l];
+    loop->parent = graph->blocks[loop->header].loop;
+    for(size_t j = 0; j < loop->size; j++)
+      graph->blocks[loop->blocks[j]].loop = l;
+  }
+  found = true;
+
+done:
+  free(in_body);
+  free(pending);
+  return found;
+}
+
+// Returns hash of the content of a constant
+static size_t hash_constant(const Object* object)
+{
+  size_t hash = (size_t)object->datatype;
+  uint64_t bits = 0;
+
+  switch(object->datatype)
+  {
+    case CCT_TYPE_BOOL:    return hash * 31 + (size_t)object->value.boolval;
+    case CCT_TYPE_BYTE:    return hash * 31 + (size_t)object->value.byteval;
+    case CCT_TYPE_NUMBER:  return hash * 31 + (size_t)object->value.numval;
+    case CCT_TYPE_BIGNUM:  return hash * 31 + (size_t)object->value.bignumval;
+    case CCT_TYPE_DECIMAL:
+      memcpy(&bits, &object->value.decimalval, sizeof(bits));
+      return hash * 31 + (size_t)bits;
+    case CCT_TYPE_STRING:
+      for(size_t i = 0; i < object->value.strobj.length; i++)
+        hash = hash * 31 + (size_t)(unsigned char)object->value.strobj.strval[i];
+      return hash;
+    default:
+      return hash;
+  }
+}
+
+// Returns true if two constants have the same type and value
+static bool is_same_constant(const Object* a, const Object* b)
+{
+  if(a->datatype != b->datatype)
+    return false;
+  switch(a->datatype)
+  {
+    case CCT_TYPE_BOOL:    return a->value.boolval == b->value.boolval;
+    case CCT_TYPE_BYTE:    return a->value.byteval == b->value.byteval;
+    case CCT_TYPE_NUMBER:  return a->value.numval == b->value.numval;
+    case CCT_TYPE_BIGNUM:  return a->value.bignumval == b->value.bignumval;
+    case CCT_TYPE_DECIMAL: return memcmp(&a->value.decimalval, &b->value.decimalval, sizeof(Decimal)) == 0;
+    case CCT_TYPE_STRING:
+      return a->value.strobj.length == b->value.strobj.length
+             && memcmp(a->value.strobj.strval, b->value.strobj.strval, a->value.strobj.length) == 0;
+    default:               return true;
+  }
+}
+
+// Returns the first constant value with the same content as object or NO_INDEX
+static size_t find_constant(const Graph* graph, const Numbering* numbering, const Object* object)
+{
+  size_t bucket = hash_constant(object) & numbering->bucket_mask;
+
+  for(size_t other = numbering->constants[bucket]; other != NO_INDEX; other = numbering->constant_next[other])
+  {
+    if(is_same_constant(graph->chunk->constants[graph->values[other].operand], object))
+      return other;
+  }
+  return NO_INDEX;
+}
+
+// Gives the constant value the number of the first constant with the same content
+static void number_constant(Graph* graph, Numbering* numbering, size_t value)
+{
+  const Object* object = graph->chunk->constants[graph->values[value].operand];
+  size_t bucket = hash_constant(object) & numbering->bucket_mask;
+  size_t other = find_constant(graph, numbering, object);
+
+  if(other != NO_INDEX)
+  {
+    graph->values[value].number = other;
+    return;
+  }
+  numbering->constant_next[value] = numbering->constants[bucket];
+  numbering->constants[bucket] = value;
+  return;
+}
+
+// Returns the bucket of a value table key
+static size_t hash_key(const Numbering* numbering, size_t kind, size_t left, size_t right)
+{
+  return ((kind * 31 + left) * 31 + right) & numbering->bucket_mask;
+}
+
+// Returns the number recorded for a key or NO_INDEX
+static size_t find_number(const Numbering* numbering, size_t kind, size_t left, size_t right)
+{
+  for(size_t i = numbering->buckets[hash_key(numbering, kind, left, right)]; i != NO_INDEX;
+      i = numbering->entries[i].next)
+  {
+    const NumberEntry* entry = &numbering->entries[i];
+    if(entry->kind == kind && entry->left == left && entry->right == right)
+      return entry->number;
+  }
+  return NO_INDEX;
+}
+
+// Records the number of a key until value numbering leaves the current dominator subtree
+static bool add_number(Graph* graph, Numbering* numbering, size_t kind, size_t left, size_t right, size_t number)
+{
+  size_t bucket = hash_key(numbering, kind, left, right);
+  NumberEntry* entries = grow(graph, numbering->entries, &numbering->entry_capacity, numbering->entry_count,
+                              sizeof(NumberEntry));
+
+  if(entries == NULL)
+    return false;
+  numbering->entries = entries;
+  numbering->entries[numbering->entry_count] = (NumberEntry){ kind, left, right, number, numbering->buckets[bucket] };
+  numbering->buckets[bucket] = numbering->entry_count++;
+  return true;
+}
+
+// Gives an identifier a new version (and records whether it is defined) until value numbering leaves the current
+// dominator subtree
+static bool set_variable(Graph* graph, Numbering* numbering, size_t variable, bool is_new, bool is_defined)
+{
+  VariableState* undo = grow(graph, numbering->undo, &numbering->undo_capacity, numbering->undo_count,
+                             sizeof(VariableState));
+
+  if(undo == NULL)
+    return false;
+  numbering->undo = undo;
+  numbering->undo[numbering->undo_count++] = (VariableState){ variable, numbering->versions[variable],
+                                                              numbering->is_defined[variable] };
+  if(is_new)
+    numbering->versions[variable] = ++numbering->version_count;
+  numbering->is_defined[variable] = numbering->is_defined[variable] || is_defined;
+  return true;
+}
+
+// Gives every identifier assigned on a path from the immediate dominator of block to block a new version
+static bool kill_variables(Graph* graph, Numbering* numbering, size_t block)
+{
+  const IrBlock* current = &graph->blocks[block];
+  size_t pending_count = 0;
+
+  if(block == 0 || (current->predecessor_count == 1 && current->predecessors[0] == current->idom))
+    return true;
+  numbering->visit++;
+  numbering->visits[current->idom] = numbering->visit;
+  for(size_t i = 0; i < current->predecessor_count; i++)
+  {
+    size_t predecessor = current->predecessors[i];
+    if(numbering->visits[predecessor] != numbering->visit)
+    {
+      numbering->visits[predecessor] = numbering->visit;
+      numbering->pending[pending_count++] = predecessor;
+    }
+  }
+  while(pending_count > 0)
+  {
+    const IrBlock* member = &graph->blocks[numbering->pending[--pending_count]];
+    for(size_t i = 0; i < member->count; i++)
+    {
+      const IrValue* store = &graph->values[member->values[i]];
+      if(is_store(store->opcode) && !set_variable(graph, numbering, store->variable, true, false))
+        return false;
+    }
+    for(size_t i = 0; i < member->predecessor_count; i++)
+    {
+      size_t predecessor = member->predecessors[i];
+      if(numbering->visits[predecessor] != numbering->visit)
+      {
+        numbering->visits[predecessor] = numbering->visit;
+        numbering->pending[pending_count++] = predecessor;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns the constant a value number stands for or NULL
+static Object* get_constant(const Graph* graph, size_t number)
+{
+  if(graph->values[number].opcode != OP_PSH)
+    return NULL;
+  return graph->chunk->constants[graph->values[number].operand];
+}
+
+// Computes an operation on constant operands at compile time and returns the number of the result or NO_INDEX. Like
+// constant folding in the compiler, operations that would fail at run time are left alone.
+static size_t fold_value(Graph* graph, Numbering* numbering, size_t value)
+{
+  IrValue* operation = &graph->values[value];
+  Object* operands[2] = { NULL, NULL };
+  Object* result = NULL;
+  size_t constant = 0;
+  bool folded = false;
+
+  for(size_t i = 0; i < operation->arity; i++)
+  {
+    operands[i] = get_constant(graph, graph->values[get_argument(graph, value, i)].number);
+    if(operands[i] == NULL)
+      return NO_INDEX;
+  }
+  if(operation->opcode == OP_TST)
+  {
+    result = is_truthy(operands[0]) ? vm.true_object : vm.false_object;
+    folded = true;
+  }
+  else if(operation->arity == 1)
+    folded = fold_unary(operation->opcode, &result, operands[0]);
+  else
+    folded = fold_binary(operation->opcode, &result, operands[0], operands[1]);
+  if(!folded)
+    return NO_INDEX;
+  constant = find_constant(graph, numbering, result);
+  if(constant != NO_INDEX)
+    return constant;
+  if(graph->chunk->constant_count >= MAX_CONSTANT_AMOUNT)
+    return NO_INDEX;
+  constant = add_value(graph, OP_PSH, add_constant(graph->chunk, result), graph->values[value].line, NO_INDEX);
+  if(constant == NO_INDEX)
+    return NO_INDEX;
+  number_constant(graph, numbering, constant);
+  return graph->values[constant].number;
+}
+
+// Numbers the values of block in order
+static bool number_block(Graph* graph, Numbering* numbering, size_t block)
+{
+  if(!kill_variables(graph, numbering, block))
+    return false;
+  for(size_t i = 0; i < graph->blocks[block].count; i++)
+  {
+    size_t value = graph->blocks[block].values[i];
+    IrValue* current = &graph->values[value];
+    size_t left = NO_INDEX;
+    size_t right = NO_INDEX;
+    size_t number = NO_INDEX;
+    for(size_t j = 0; j < current->arity; j++)
+      graph->arguments[current->first + j] = resolve(graph, graph->arguments[current->first + j]);
+    if(is_store(current->opcode))
+    {
+      number = graph->values[get_argument(graph, value, 0)].number;
+      if(!set_variable(graph, numbering, current->variable, true, true)
+         || !add_number(graph, numbering, LOAD_KEY, current->variable, numbering->versions[current->variable], number))
+        return false;
+      continue;
+    }
+    if(is_load(current->opcode))
+    {
+      current->is_safe = current->opcode == OP_LDL || numbering->is_defined[current->variable];
+      number = find_number(numbering, LOAD_KEY, current->variable, numbering->versions[current->variable]);
+      if(number == NO_INDEX)
+      {
+        if(!add_number(graph, numbering, LOAD_KEY, current->variable, numbering->versions[current->variable], value))
+          return false;
+      }
+      else if(get_constant(graph, number) != NULL)
+      {
+        current->replacement = number;
+        folding_hits++;
+      }
+      else
+        current->number = number;
+      if(!set_variable(graph, numbering, graph->values[value].variable, false, true))
+        return false;
+      continue;
+    }
+    if(!is_operation(current->opcode))
+      continue;
+    number = fold_value(graph, numbering, value);
+    current = &graph->values[value];
+    if(number != NO_INDEX)
+    {
+      current->replacement = number;
+      folding_hits++;
+      continue;
+    }
+    left = graph->values[get_argument(graph, value, 0)].number;
+    right = current->arity > 1 ? graph->values[get_argument(graph, value, 1)].number : NO_INDEX;
+    number = find_number(numbering, current->opcode, left, right);
+    if(number != NO_INDEX)
+    {
+      current->replacement = number;
+      numbering_hits++;
+      continue;
+    }
+    if(!add_number(graph, numbering, current->opcode, left, right, value))
+      return false;
+  }
+  return true;
+}
+
+// Numbers the values of the graph in a preorder walk of the dominator tree and replaces values by equal ones that
+// dominate them
+static bool number_values(Graph* graph)
+{
+  Numbering numbering;
+  size_t buckets = 16;
+  size_t* children = calloc(graph->block_count, sizeof(size_t));   // first child in the dominator tree + 1
+  size_t* siblings = calloc(graph->block_count, sizeof(size_t));   // next sibling + 1
+  size_t* stack = malloc(graph->block_count * sizeof(size_t));
+  size_t* entry_marks = malloc(graph->block_count * sizeof(size_t));
+  size_t* undo_marks = malloc(graph->block_count * sizeof(size_t));
+  bool* is_entered = calloc(graph->block_count, sizeof(bool));
+  size_t height = 0;
+  bool numbered = false;
+
+  while(buckets < graph->value_count * 2)
+    buckets *= 2;
+  // Folding adds at most one constant per operation
+  numbering = (Numbering){ 0 };
+  numbering.buckets = malloc(buckets * sizeof(size_t));
+  numbering.bucket_mask = buckets - 1;
+  numbering.constants = malloc(buckets * sizeof(size_t));
+  numbering.constant_next = malloc(graph->value_count * 2 * sizeof(size_t));
+  numbering.versions = calloc(graph->variable_count + 1, sizeof(size_t));
+  numbering.is_defined = calloc(graph->variable_count + 1, sizeof(bool));
+  numbering.visits = calloc(graph->block_count, sizeof(size_t));
+  numbering.pending = malloc(graph->block_count * sizeof(size_t));
+  if(children == NULL || siblings == NULL || stack == NULL || entry_marks == NULL || undo_marks == NULL
+     || is_entered == NULL || numbering.buckets == NULL || numbering.constants == NULL
+     || numbering.constant_next == NULL || numbering.versions == NULL || numbering.is_defined == NULL || numbering.visits == NULL
+     || numbering.pending == NULL)
+    goto done;
+  for(size_t i = 0; i < buckets; i++)
+  {
+    numbering.buckets[i] = NO_INDEX;
+    numbering.constants[i] = NO_INDEX;
+  }
+
+  // Constants created by folding get their numbers as they are created
+  for(size_t value = 0; value < graph->value_count; value++)
+  {
+    if(graph->values[value].opcode == OP_PSH)
+      number_constant(graph, &numbering, value);
+  }
+  for(size_t i = graph->order_count; i-- > 1;)
+  {
+    size_t block = graph->order[i];
+    size_t idom = graph->blocks[block].idom;
+    siblings[block] = children[idom];
+    children[idom] = block + 1;
+  }
+
+  stack[height++] = 0;
+  while(height > 0)
+  {
+    size_t block = stack[height - 1];
+    if(is_entered[block])
+    {
+      // Leaving the subtree of block restores the table and the identifiers
+      while(numbering.entry_count > entry_marks[block])
+      {
+        const NumberEntry* entry = &numbering.entries[--numbering.entry_count];
+        numbering.buckets[hash_key(&numbering, entry->kind, entry->left, entry->right)] = entry->next;
+      }
+      while(numbering.undo_count > undo_marks[block])
+      {
+        const VariableState* state = &numbering.undo[--numbering.undo_count];
+        numbering.versions[state->variable] = state->version;
+        numbering.is_defined[state->variable] = state->is_defined;
+      }
+      height--;
+      continue;
+    }
+    is_entered[block] = true;
+    entry_marks[block] = numbering.entry_count;
+    undo_marks[block] = numbering.undo_count;
+    if(!number_block(graph, &numbering, block))
+      goto done;
+    for(size_t child = children[block]; child != 0; child = siblings[child - 1])
+      stack[height++] = child - 1;
+  }
+  numbered = true;
+
+done:
+  free(children);
+  free(siblings);
+  free(stack);
+  free(entry_marks);
+  free(undo_marks);
+  free(is_entered);
+  free(numbering.entries);
+  free(numbering.buckets);
+  free(numbering.constants);
+  free(numbering.constant_next);
+  free(numbering.versions);
+  free(numbering.is_defined);
+  free(numbering.undo);
+  free(numbering.visits);
+  free(numbering.pending);
+  return numbered;
+}
+
+// Removes the values replaced by others from their blocks and points every argument at the value replacing it
+static void apply_replacements(Graph* graph)
+{
+  for(size_t i = 0; i < graph->argument_count; i++)
+    graph->arguments[i] = resolve(graph, graph->arguments[i]);
+  for(size_t block = 0; block < graph->block_count; block++)
+  {
+    IrBlock* current = &graph->blocks[block];
+    size_t count = 0;
+    for(size_t i = 0; i < current->count; i++)
+    {
+      if(graph->values[current->values[i]].replacement == NO_INDEX)
+        current->values[count++] = current->values[i];
+    }
+    current->count = count;
+  }
+  return;
+}
+
+// Returns the types an arithmetic operation computed in numeric type may produce. Results that leave the range of
+// an integer type widen to the next larger one and a BigNum overflow yields a decimal.
+static TypeSet get_widened_types(DataType type)
+{
+  switch(type)
+  {
+    case CCT_TYPE_BYTE:   return TYPE_BIT(CCT_TYPE_BYTE) | TYPE_BIT(CCT_TYPE_NUMBER);
+    case CCT_TYPE_NUMBER: return TYPE_BIT(CCT_TYPE_NUMBER) | TYPE_BIT(CCT_TYPE_BIGNUM);
+    case CCT_TYPE_BIGNUM: return TYPE_BIT(CCT_TYPE_BIGNUM) | TYPE_BIT(CCT_TYPE_DECIMAL);
+    default:              return TYPE_BIT(CCT_TYPE_DECIMAL);
+  }
+}
+
+// Returns the types binary opcode produces for operands of types left and right and sets is_failing if it may fail
+// for them. The rules follow the kernel tables of the VM (see instructions.c): numeric operands are promoted to the
+// larger of their types, comparisons yield a Bool and operations without a kernel fail without a result. Operators
+// not modelled here may produce anything.
+static TypeSet get_binary_types(Opcode oc, DataType left, DataType right, bool* is_failing)
+{
+  bool is_numeric = (TYPE_BIT(left) & NUMERIC_TYPES) && (TYPE_BIT(right) & NUMERIC_TYPES);
+  DataType promoted = left > right ? left : right;
+
+  switch(oc)
+  {
+    case OP_ADD:
+    case OP_MUL:
+    case OP_SUB:
+      if(is_numeric)
+        return get_widened_types(promoted);
+      *is_failing = true; // no kernel, or a string that could not be allocated
+      if((oc == OP_ADD && left == CCT_TYPE_STRING && right == CCT_TYPE_STRING)
+         || (oc == OP_MUL && (left == CCT_TYPE_STRING || right == CCT_TYPE_STRING)
+             && (left == CCT_TYPE_NUMBER || right == CCT_TYPE_NUMBER)))
+        return TYPE_BIT(CCT_TYPE_STRING);
+      return 0;
+    case OP_DIV:
+      *is_failing = true; // division by zero
+      if(!is_numeric)
+        return 0;
+      return promoted == CCT_TYPE_BYTE ? TYPE_BIT(CCT_TYPE_BYTE) : get_widened_types(promoted);
+    case OP_EQL:
+    case OP_NEQ:
+      if(is_numeric || left == right)
+        return TYPE_BIT(CCT_TYPE_BOOL);
+      *is_failing = true;
+      return 0;
+    case OP_GT:
+    case OP_GTE:
+    case OP_LT:
+    case OP_LTE:
+      if(is_numeric || (left == CCT_TYPE_STRING && right == CCT_TYPE_STRING))
+        return TYPE_BIT(CCT_TYPE_BOOL);
+      *is_failing = true;
+      return 0;
+    default:
+      *is_failing = true;
+      return ANY_TYPE;
+  }
+}
+
+// Returns the types operation value may produce from the types of its arguments and sets is_failing if it may fail
+static TypeSet get_operation_types(const Graph* graph, size_t value, bool* is_failing)
+{
+  const IrValue* operation = &graph->values[value];
+  TypeSet left = graph->values[get_argument(graph, value, 0)].types;
+  TypeSet right = operation->arity > 1 ? graph->values[get_argument(graph, value, 1)].types : 0;
+  TypeSet types = 0;
+
+  if(operation->opcode == OP_TST)
+    return TYPE_BIT(CCT_TYPE_BOOL);
+  if(operation->opcode == OP_NOT)
+  {
+    *is_failing = left != TYPE_BIT(CCT_TYPE_BOOL);
+    return TYPE_BIT(CCT_TYPE_BOOL);
+  }
+  if(operation->arity != 2)
+  {
+    *is_failing = true;
+    return ANY_TYPE;
+  }
+  for(size_t i = 0; i < DATA_TYPE_AMOUNT; i++)
+  {
+    for(size_t j = 0; j < DATA_TYPE_AMOUNT; j++)
+    {
+      if((left & TYPE_BIT(i)) && (right & TYPE_BIT(j)))
+        types |= get_binary_types(operation->opcode, (DataType)i, (DataType)j, is_failing);
+    }
+  }
+  return types;
+}
+
+// Returns the types the parameter of block may have: the shared Bool left by OP_JMF or OP_JMT or the value passed by
+// the jumps to it
+static TypeSet get_parameter_types(const Graph* graph, size_t block)
+{
+  const IrBlock* current = &graph->blocks[block];
+  TypeSet types = 0;
+
+  for(size_t i = 0; i < current->predecessor_count; i++)
+  {
+    size_t predecessor = current->predecessors[i];
+    const IrValue* exit = NULL;
+    if(!graph->blocks[predecessor].is_reached)
+      continue;
+    exit = &graph->values[get_exit(graph, predecessor)];
+    if(exit->opcode == OP_JMF || exit->opcode == OP_JMT)
+      types |= TYPE_BIT(CCT_TYPE_BOOL);
+    else if(exit->arity > 0)
+      types |= graph->values[get_argument(graph, get_exit(graph, predecessor), 0)].types;
+    else
+      return ANY_TYPE;
+  }
+  return types;
+}
+
+// Returns true if the types of identifier are inferred from the values stored to it: a local of a function that is
+// not one of its parameters. Globals may be set by the host or by any call.
+static bool is_typed_variable(const Graph* graph, size_t variable)
+{
+  size_t key = graph->variable_keys[variable];
+
+  return graph->function != NULL && key < MAX_LOCAL_AMOUNT && key >= graph->function->arity;
+}
+
+// Finds the typed locals assigned on every path to each block (the entry of each row of assigned, which has
+// variable_count + 1 entries per block). A local read before that holds the null OP_ENT reserved it with.
+static void find_assigned(const Graph* graph, bool* assigned)
+{
+  size_t row = graph->variable_count + 1;
+  bool changed = true;
+
+  for(size_t i = 0; i < graph->block_count * row; i++)
+    assigned[i] = i >= row;
+  while(changed)
+  {
+    changed = false;
+    for(size_t i = 1; i < graph->order_count; i++)
+    {
+      size_t block = graph->order[i];
+      const IrBlock* current = &graph->blocks[block];
+      for(size_t v = 0; v < graph->variable_count; v++)
+      {
+        bool is_assigned = true;
+        for(size_t p = 0; p < current->predecessor_count && is_assigned; p++)
+        {
+          const IrBlock* from = &graph->blocks[current->predecessors[p]];
+          bool is_stored = assigned[current->predecessors[p] * row + v];
+          if(!from->is_reached)
+            continue;
+          for(size_t j = 0; j < from->count && !is_stored; j++)
+          {
+            const IrValue* instruction = &graph->values[from->values[j]];
+            is_stored = instruction->opcode == OP_STL && instruction->variable == v;
+          }
+          is_assigned = is_stored;
+        }
+        if(assigned[block * row + v] && !is_assigned)
+        {
+          assigned[block * row + v] = false;
+          changed = true;
+        }
+      }
+    }
+  }
+  return;
+}
+
+// Infers the types every value may have. Constants have the type of their object, operations follow the kernel
+// rules of the VM and a typed local has the union of the types stored to it, which grows until nothing changes.
+// Operations that cannot fail are marked total, so they neither stop loop-invariant code motion nor stay behind when
+// nothing uses them. Returns false if memory ran out.
+static bool infer_types(Graph* graph)
+{
+  size_t row = graph->variable_count + 1;
+  TypeSet* variable_types = malloc(row * sizeof(TypeSet));
+  bool* assigned = malloc(graph->block_count * row * sizeof(bool));
+  bool* is_assigned = malloc(row * sizeof(bool));
+  bool changed = true;
+
+  if(variable_types == NULL || assigned == NULL || is_assigned == NULL)
+  {
+    free(variable_types);
+    free(assigned);
+    free(is_assigned);
+    return false;
+  }
+  find_assigned(graph, assigned);
+  for(size_t v = 0; v < graph->variable_count; v++)
+    variable_types[v] = is_typed_variable(graph, v) ? 0 : ANY_TYPE;
+  for(size_t value = 0; value < graph->value_count; value++)
+  {
+    IrValue* current = &graph->values[value];
+    current->types = current->opcode == OP_PSH ? TYPE_BIT(graph->chunk->constants[current->operand]->datatype) : 0;
+  }
+  while(changed)
+  {
+    changed = false;
+    for(size_t i = 0; i < graph->order_count; i++)
+    {
+      size_t block = graph->order[i];
+      const IrBlock* current = &graph->blocks[block];
+      memcpy(is_assigned, &assigned[block * row], row * sizeof(bool));
+      if(current->parameter != NO_INDEX)
+        graph->values[current->parameter].types = get_parameter_types(graph, block);
+      for(size_t j = 0; j < current->count; j++)
+      {
+        size_t value = current->values[j];
+        IrValue* instruction = &graph->values[value];
+        bool is_failing = false;
+        if(instruction->opcode == OP_LDL || instruction->opcode == OP_GET || instruction->opcode == OP_CAL)
+        {
+          instruction->types = instruction->opcode == OP_LDL ? variable_types[instruction->variable] : ANY_TYPE;
+          if(instruction->opcode == OP_LDL && !is_assigned[instruction->variable])
+            instruction->types |= TYPE_BIT(CCT_TYPE_NIL);
+        }
+        else if(instruction->opcode == OP_STL)
+        {
+          TypeSet types = variable_types[instruction->variable] | graph->values[get_argument(graph, value, 0)].types;
+          changed = changed || types != variable_types[instruction->variable];
+          variable_types[instruction->variable] = types;
+          is_assigned[instruction->variable] = true;
+        }
+        else if(is_operation(instruction->opcode))
+        {
+          instruction->types = get_operation_types(graph, value, &is_failing);
+          instruction->is_total = !is_failing;
+        }
+      }
+    }
+  }
+  free(variable_types);
+  free(assigned);
+  free(is_assigned);
+  return true;
+}
+
+// Returns the form of the binary operation value specialized for the types inferred for its operands or its opcode
+// if they are not known to be one type with a quickened form
+static Opcode get_typed_opcode(const Graph* graph, size_t value)
+{
+  const IrValue* operation = &graph->values[value];
+  TypeSet types = 0;
+
+  if(operation->arity != 2 || !is_binary_operation(operation->opcode))
+    return operation->opcode;
+  types = graph->values[get_argument(graph, value, 0)].types;
+  if(types != graph->values[get_argument(graph, value, 1)].types)
+    return operation->opcode;
+  for(size_t i = 0; i < DATA_TYPE_AMOUNT; i++)
+  {
+    if(types == TYPE_BIT(i))
+      return get_quickened_opcode(operation->opcode, (DataType)i, (DataType)i);
+  }
+  return operation->opcode;
+}
+
+// Returns true if every argument of value is available before loop runs
+static bool has_invariant_arguments(const Graph* graph, size_t value, size_t loop)
+{
+  for(size_t i = 0; i < graph->values[value].arity; i++)
+  {
+    const IrValue* argument = &graph->values[get_argument(graph, value, i)];
+    if(argument->block != NO_INDEX && !argument->is_hoisted && in_loop(graph, argument->block, loop))
+      return false;
+  }
+  return true;
+}
+
+// Inserts an empty block that runs before the header of loop whenever control enters the loop from outside
+static size_t add_preheader(Graph* graph, size_t loop)
+{
+  size_t header = graph->loops[loop].header;
+  size_t preheader = add_block(graph, graph->blocks[header].start, graph->blocks[header].start);
+  size_t exit = NO_INDEX;
+  size_t count = 0;
+
+  if(preheader == NO_INDEX)
+    return NO_INDEX;
+  exit = add_value(graph, OP_JMP, 0, graph->chunk->lines[graph->blocks[header].start], preheader);
+  if(exit == NO_INDEX || !append_value(graph, preheader, exit))
+    return NO_INDEX;
+  for(size_t i = 0; i < graph->blocks[header].predecessor_count; i++)
+  {
+    size_t predecessor = graph->blocks[header].predecessors[i];
+    IrBlock* from = &graph->blocks[predecessor];
+    if(in_loop(graph, predecessor, loop))
+    {
+      graph->blocks[header].predecessors[count++] = predecessor;
+      continue;
+    }
+    if(from->target == header)
+      from->target = preheader;
+    if(from->next == header)
+      from->next = preheader;
+    if(!add_predecessor(graph, preheader, predecessor))
+      return NO_INDEX;
+  }
+  graph->blocks[header].predecessor_count = count;
+  if(!add_predecessor(graph, header, preheader))
+    return NO_INDEX;
+  graph->blocks[preheader].target = header;
+  graph->blocks[preheader].idom = graph->blocks[header].idom;
+  graph->blocks[preheader].loop = graph->loops[loop].parent;
+  graph->blocks[preheader].is_reached = true;
+  graph->blocks[header].idom = preheader;
+
+  // The preheader is laid out right before the header, so control falls through from it into the loop
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    if(graph->layout[i] != header)
+      continue;
+    for(size_t j = graph->layout_count; j > i; j--)
+      graph->layout[j] = graph->layout[j - 1];
+    graph->layout[i] = preheader;
+    graph->layout_count++;
+    break;
+  }
+  return preheader;
+}
+
+// Hoists the invariant operations of loop that every iteration computes first to a preheader and returns their number.
+// The header and the blocks control always continues with are scanned in order until an instruction that may fail or
+// have a side effect is left in the loop, so hoisting never changes which error a program reports or what it leaves
+// behind. Stores to locals have no effect once an error unwinds the frame, so they do not stop the scan.
+static size_t hoist_loop(Graph* graph, size_t loop, bool* stored, bool* needed, size_t* candidates)
+{
+  const IrLoop* current = &graph->loops[loop];
+  size_t header = current->header;
+  size_t block = header;
+  size_t candidate_count = 0;
+  size_t hoisted = 0;
+  size_t preheader = NO_INDEX;
+  bool is_later = false;
+  bool is_stopped = false;
+
+  if(graph->blocks[header].parameter != NO_INDEX)
+    return 0;
+  for(size_t i = 0; i < current->size; i++)
+  {
+    const IrBlock* member = &graph->blocks[current->blocks[i]];
+    for(size_t j = 0; j < member->count; j++)
+    {
+      if(is_store(graph->values[member->values[j]].opcode))
+        stored[graph->values[member->values[j]].variable] = true;
+    }
+  }
+  while(!is_stopped)
+  {
+    const IrBlock* member = &graph->blocks[block];
+    size_t exit = get_exit(graph, block);
+    for(size_t i = 0; i + 1 < member->count && !is_stopped; i++)
+    {
+      size_t value = member->values[i];
+      IrValue* instruction = &graph->values[value];
+      if((is_operation(instruction->opcode) && has_invariant_arguments(graph, value, loop))
+         || (is_load(instruction->opcode) && !stored[instruction->variable]))
+      {
+        instruction->is_hoisted = true;
+        candidates[candidate_count++] = value;
+      }
+      else
+        is_stopped = instruction->opcode == OP_ASN || instruction->opcode == OP_CAL || may_fail(instruction);
+    }
+    if(is_stopped || graph->values[exit].opcode != OP_JMP || graph->values[exit].arity > 0)
+      break;
+    block = member->target;
+    if(block == header || !in_loop(graph, block, loop) || graph->blocks[block].predecessor_count != 1)
+      break;
+  }
+  for(size_t i = 0; i < current->size; i++)
+  {
+    const IrBlock* member = &graph->blocks[current->blocks[i]];
+    for(size_t j = 0; j < member->count; j++)
+    {
+      if(is_store(graph->values[member->values[j]].opcode))
+        stored[graph->values[member->values[j]].variable] = false;
+    }
+  }
+
+  // Loads only move with the operations using them, unless a failing one would otherwise stay behind a hoisted
+  // operation
+  for(size_t i = candidate_count; i-- > 0;)
+  {
+    size_t value = candidates[i];
+    IrValue* instruction = &graph->values[value];
+    bool is_kept = is_operation(instruction->opcode) || needed[value] || (may_fail(instruction) && is_later);
+    needed[value] = false;
+    if(!is_kept)
+    {
+      instruction->is_hoisted = false;
+      candidates[i] = NO_INDEX;
+      continue;
+    }
+    is_later = is_later || is_operation(instruction->opcode);
+    for(size_t j = 0; j < instruction->arity; j++)
+      needed[get_argument(graph, value, j)] = true;
+  }
+  for(size_t i = 0; i < candidate_count; i++)
+  {
+    if(candidates[i] != NO_INDEX && is_operation(graph->values[candidates[i]].opcode))
+      hoisted++;
+  }
+  for(size_t i = 0; i < candidate_count; i++)
+  {
+    if(candidates[i] == NO_INDEX)
+      continue;
+    for(size_t j = 0; j < graph->values[candidates[i]].arity; j++)
+      needed[get_argument(graph, candidates[i], j)] = false;
+  }
+  if(hoisted == 0)
+  {
+    for(size_t i = 0; i < candidate_count; i++)
+    {
+      if(candidates[i] != NO_INDEX)
+        graph->values[candidates[i]].is_hoisted = false;
+    }
+    return 0;
+  }
+
+  preheader = add_preheader(graph, loop);
+  if(preheader == NO_INDEX)
+    return 0;
+  for(size_t i = 0; i < candidate_count; i++)
+  {
+    size_t value = candidates[i];
+    IrBlock* from = NULL;
+    size_t count = 0;
+    if(value == NO_INDEX)
+      continue;
+    from = &graph->blocks[graph->values[value].block];
+    for(size_t j = 0; j < from->count; j++)
+    {
+      if(from->values[j] != value)
+        from->values[count++] = from->values[j];
+    }
+    from->count = count;
+    graph->values[value].block = preheader;
+    graph->values[value].is_hoisted = false;
+
+    // Keep the exit last
+    if(!append_value(graph, preheader, value))
+      return 0;
+    from = &graph->blocks[preheader];
+    from->values[from->count - 1] = from->values[from->count - 2];
+    from->values[from->count - 2] = value;
+  }
+  return hoisted;
+}
+
+// Hoists the invariant operations of every loop, innermost loops first, and returns their number
+static size_t hoist_invariants(Graph* graph)
+{
+  size_t value_count = graph->value_count; // preheaders add their exits
+  bool* stored = calloc(graph->variable_count + 1, sizeof(bool));
+  bool* needed = calloc(value_count, sizeof(bool));
+  size_t* candidates = malloc(value_count * sizeof(size_t));
+  size_t hoisted = 0;
+
+  if(stored != NULL && needed != NULL && candidates != NULL)
+  {
+    for(size_t l = graph->loop_count; l-- > 0 && !graph->has_error;)
+      hoisted += hoist_loop(graph, l, stored, needed, candidates);
+  }
+  free(stored);
+  free(needed);
+  free(candidates);
+  return hoisted;
+}
+
+// Counts the uses of every value in the blocks and records a user
+static void count_uses(Graph* graph)
+{
+  for(size_t value = 0; value < graph->value_count; value++)
+  {
+    graph->values[value].uses = 0;
+    graph->values[value].user = NO_INDEX;
+  }
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    const IrBlock* block = &graph->blocks[graph->layout[i]];
+    for(size_t j = 0; j < block->count; j++)
+    {
+      size_t value = block->values[j];
+      for(size_t k = 0; k < graph->values[value].arity; k++)
+      {
+        IrValue* argument = &graph->values[get_argument(graph, value, k)];
+        argument->uses++;
+        argument->user = value;
+      }
+    }
+  }
+  return;
+}
+
+// Removes loads and tests whose values nothing uses and stores to locals nothing reads. Other unused values stay,
+// since they may fail.
+static void remove_dead_values(Graph* graph)
+{
+  bool* is_read = calloc(graph->variable_count + 1, sizeof(bool));
+  bool removed = true;
+
+  if(is_read == NULL)
+    return;
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    const IrBlock* block = &graph->blocks[graph->layout[i]];
+    for(size_t j = 0; j < block->count; j++)
+    {
+      if(graph->values[block->values[j]].opcode == OP_LDL)
+        is_read[graph->values[block->values[j]].variable] = true;
+    }
+  }
+  while(removed)
+  {
+    removed = false;
+    for(size_t i = 0; i < graph->layout_count; i++)
+    {
+      IrBlock* block = &graph->blocks[graph->layout[i]];
+      size_t count = 0;
+      for(size_t j = 0; j < block->count; j++)
+      {
+        size_t value = block->values[j];
+        IrValue* current = &graph->values[value];
+        bool is_dead = current->uses == 0
+                       && (current->opcode == OP_TST || (is_load(current->opcode) && current->is_safe)
+                           || (is_operation(current->opcode) && current->is_total));
+        if(!is_dead && !(current->opcode == OP_STL && !is_read[current->variable]))
+        {
+          block->values[count++] = value;
+          continue;
+        }
+        for(size_t k = 0; k < current->arity; k++)
+          graph->values[get_argument(graph, value, k)].uses--;
+        removed = true;
+      }
+      block->count = count;
+    }
+  }
+  free(is_read);
+  return;
+}
+
+// Returns true if block does nothing but jump to another block
+static bool is_forwarder(const Graph* graph, size_t block)
+{
+  const IrBlock* current = &graph->blocks[block];
+
+  return block != 0 && current->count == 1 && current->parameter == NO_INDEX && current->target != block
+         && graph->values[current->values[0]].opcode == OP_JMP && graph->values[current->values[0]].arity == 0;
+}
+
+// Returns the block control reaches from block through blocks that only jump
+static size_t skip_forwarders(const Graph* graph, size_t block)
+{
+  for(size_t steps = 0; block != NO_INDEX && is_forwarder(graph, block) && steps < graph->layout_count; steps++)
+    block = graph->blocks[block].target;
+  return block;
+}
+
+// Points jumps to blocks that only jump at the blocks they lead to and drops those blocks from the layout (jump
+// threading)
+static void thread_jumps(Graph* graph)
+{
+  size_t count = 0;
+
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    IrBlock* block = &graph->blocks[graph->layout[i]];
+    block->target = skip_forwarders(graph, block->target);
+    block->next = skip_forwarders(graph, block->next);
+  }
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    size_t block = graph->layout[i];
+    if(!is_forwarder(graph, block) || is_forwarder(graph, skip_forwarders(graph, block))) // empty infinite loops stay
+      graph->layout[count++] = block;
+  }
+  graph->layout_count = count;
+  return;
+}
+
+// Returns true if value may stay on the stack until its only user in block runs
+static bool is_stackable(const Graph* graph, size_t value, size_t block)
+{
+  const IrValue* current = &graph->values[value];
+
+  return current->uses == 1 && current->block == block && current->opcode != OP_PSH && !is_store(current->opcode)
+         && !is_exit(current->opcode) && graph->values[current->user].block == block;
+}
+
+// Returns true if the value and the values computed in place for it can neither fail nor have an effect, so they may
+// be computed after a later instruction that does not assign an identifier
+static bool is_movable(const Graph* graph, size_t value)
+{
+  const IrValue* current = &graph->values[value];
+
+  if(current->opcode == OP_NOP || (is_load(current->opcode) && current->is_safe))
+    return true;
+  if(current->opcode != OP_TST && !(is_operation(current->opcode) && current->is_total))
+    return false;
+  for(size_t i = 0; i < current->arity; i++)
+  {
+    size_t argument = get_argument(graph, value, i);
+    if(graph->values[argument].is_inline && !is_movable(graph, argument))
+      return false;
+  }
+  return true;
+}
+
+// Returns true if all count pending values are movable
+static bool are_movable(const Graph* graph, const size_t* pending, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+  {
+    if(!is_movable(graph, pending[i]))
+      return false;
+  }
+  return true;
+}
+
+// Marks the values of block computed in place for their users. Values are simulated on a stack in block order; an
+// instruction whose arguments are on top of that stack in argument order consumes them. Any other instruction leaves
+// everything still pending to temporaries, unless all of it can move after the instruction (see is_movable()).
+static void stackify_block(Graph* graph, size_t block, size_t* pending)
+{
+  const IrBlock* current = &graph->blocks[block];
+  size_t parameter = current->parameter;
+  size_t count = 0;
+
+  if(parameter != NO_INDEX && is_stackable(graph, parameter, block))
+  {
+    pending[count++] = parameter;
+    graph->values[parameter].is_pending = true;
+  }
+  for(size_t i = 0; i < current->count; i++)
+  {
+    size_t value = current->values[i];
+    const IrValue* instruction = &graph->values[value];
+    size_t matched = 0;
+    bool is_match = true;
+    for(size_t j = 0; j < instruction->arity; j++)
+    {
+      if(graph->values[get_argument(graph, value, j)].is_pending)
+        matched++;
+    }
+    if(matched > count)
+      is_match = false;
+    else
+    {
+      size_t k = count - matched;
+      for(size_t j = 0; j < instruction->arity && is_match; j++)
+      {
+        size_t argument = get_argument(graph, value, j);
+        if(graph->values[argument].is_pending)
+          is_match = pending[k++] == argument;
+      }
+    }
+    if(is_match)
+    {
+      for(size_t j = count - matched; j < count; j++)
+      {
+        graph->values[pending[j]].is_inline = true;
+        graph->values[pending[j]].is_pending = false;
+      }
+      count -= matched;
+    }
+    if(!is_match || (!is_stackable(graph, value, block) && (is_store(instruction->opcode)
+                                                           || !are_movable(graph, pending, count))))
+    {
+      for(size_t j = 0; j < count; j++)
+        graph->values[pending[j]].is_pending = false;
+      count = 0;
+    }
+    if(is_stackable(graph, value, block))
+    {
+      pending[count++] = value;
+      graph->values[value].is_pending = true;
+    }
+  }
+
+  // The parameter is already on the stack when control enters, so it can only stay there if it is the first thing
+  // the first instruction using the stack consumes
+  if(parameter != NO_INDEX && graph->values[parameter].is_inline)
+  {
+    size_t value = parameter;
+    while(graph->values[value].is_inline)
+    {
+      size_t user = graph->values[value].user;
+      if(get_argument(graph, user, 0) != value)
+      {
+        graph->values[parameter].is_inline = false;
+        break;
+      }
+      value = user;
+    }
+  }
+  return;
+}
+
+// Numbers the values in the order of the lowered code and records the positions each loop spans
+static void assign_positions(Graph* graph)
+{
+  size_t position = 0;
+
+  for(size_t l = 0; l < graph->loop_count; l++)
+  {
+    graph->loops[l].first = SIZE_MAX;
+    graph->loops[l].last = 0;
+  }
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    IrBlock* block = &graph->blocks[graph->layout[i]];
+    size_t first = position;
+    block->layout = i;
+    if(block->parameter != NO_INDEX)
+      graph->values[block->parameter].position = position++;
+    for(size_t j = 0; j < block->count; j++)
+      graph->values[block->values[j]].position = position++;
+    for(size_t l = block->loop; l != NO_INDEX; l = graph->loops[l].parent)
+    {
+      if(first < graph->loops[l].first)
+        graph->loops[l].first = first;
+      if(position - 1 > graph->loops[l].last)
+        graph->loops[l].last = position - 1;
+    }
+  }
+  return;
+}
+
+// Returns true if the value is kept in a temporary between its computation and its uses
+static bool needs_temporary(const IrValue* value)
+{
+  return value->uses > 0 && !value->is_inline && value->opcode != OP_PSH && produces_value(value);
+}
+
+// Orders live ranges by their start
+static int compare_ranges(const void* a, const void* b)
+{
+  size_t start_a = ((const LiveRange*)a)->start;
+  size_t start_b = ((const LiveRange*)b)->start;
+
+  return start_a < start_b ? -1 : (start_a > start_b ? 1 : 0);
+}
+
+// Extends the live range of argument to its use by user. A value live in any part of a loop it is not computed in
+// stays live for the whole loop, and a value computed in a loop is live for the whole loop if it is used after it.
+static void extend_range(const Graph* graph, LiveRange* range, size_t argument, size_t user)
+{
+  const IrValue* definition = &graph->values[argument];
+  const IrValue* use = &graph->values[user];
+
+  if(use->position < definition->position)
+  {
+    range->start = 0;
+    range->end = SIZE_MAX;
+    return;
+  }
+  if(use->position > range->end)
+    range->end = use->position;
+  for(size_t l = graph->blocks[use->block].loop; l != NO_INDEX; l = graph->loops[l].parent)
+  {
+    if(!in_loop(graph, definition->block, l) && graph->loops[l].last > range->end)
+      range->end = graph->loops[l].last;
+  }
+  for(size_t l = graph->blocks[definition->block].loop; l != NO_INDEX; l = graph->loops[l].parent)
+  {
+    if(in_loop(graph, use->block, l))
+      continue;
+    if(graph->loops[l].first < range->start)
+      range->start = graph->loops[l].first;
+    if(graph->loops[l].last > range->end)
+      range->end = graph->loops[l].last;
+  }
+  return;
+}
+
+// Assigns temporaries to the values that need one by a linear scan over their live ranges, sharing a temporary
+// between values whose ranges do not overlap
+static bool allocate_temporaries(Graph* graph)
+{
+  LiveRange* ranges = malloc(graph->value_count * sizeof(LiveRange));
+  size_t* range_of = malloc(graph->value_count * sizeof(size_t));
+  size_t* ends = malloc(graph->value_count * sizeof(size_t)); // end of the range last assigned to each temporary
+  size_t range_count = 0;
+  bool allocated = false;
+
+  if(ranges == NULL || range_of == NULL || ends == NULL)
+    goto done;
+  for(size_t value = 0; value < graph->value_count; value++)
+  {
+    IrValue* current = &graph->values[value];
+    current->temporary = NO_INDEX;
+    range_of[value] = NO_INDEX;
+    if(current->block == NO_INDEX || !graph->blocks[current->block].is_reached || !needs_temporary(current))
+      continue;
+    range_of[value] = range_count;
+    ranges[range_count++] = (LiveRange){ current->position, current->position, value };
+  }
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    const IrBlock* block = &graph->blocks[graph->layout[i]];
+    for(size_t j = 0; j < block->count; j++)
+    {
+      size_t user = block->values[j];
+      for(size_t k = 0; k < graph->values[user].arity; k++)
+      {
+        size_t argument = get_argument(graph, user, k);
+        if(range_of[argument] != NO_INDEX)
+          extend_range(graph, &ranges[range_of[argument]], argument, user);
+      }
+    }
+  }
+  qsort(ranges, range_count, sizeof(LiveRange), compare_ranges);
+  graph->temporary_count = 0;
+  for(size_t i = 0; i < range_count; i++)
+  {
+    size_t temporary = 0;
+    while(temporary < graph->temporary_count && ends[temporary] > ranges[i].start)
+      temporary++;
+    if(temporary == graph->temporary_count)
+      graph->temporary_count++;
+    ends[temporary] = ranges[i].end;
+    graph->values[ranges[i].value].temporary = temporary;
+  }
+  allocated = true;
+
+done:
+  free(ranges);
+  free(range_of);
+  free(ends);
+  return allocated;
+}
+
+// Jump emitted before the offsets of all blocks are known
+typedef struct pending_jump
+{
+  size_t offset;
+  size_t block;
+} PendingJump;
+
+// State of lowering a region into a chunk
+typedef struct lowering
+{
+  Graph* graph;
+  Chunk* output;
+  uint16_t* slots;          // local or global slot of each temporary
+  PendingJump* jumps;
+  size_t jump_count;
+  size_t jump_capacity;
+} Lowering;
+
+// Emits a load from or a store to temporary
+static void emit_temporary(Lowering* lowering, size_t temporary, bool is_store, size_t line)
+{
+  if(lowering->graph->function != NULL)
+  {
+    write_opcode(lowering->output, is_store ? OP_STL : OP_LDL, line);
+    write_chunk(lowering->output, (Byte)lowering->slots[temporary], line);
+    return;
+  }
+  write_opcode(lowering->output, is_store ? OP_ASN : OP_GET, line);
+  write_short(lowering->output, lowering->slots[temporary], line);
+  return;
+}
+
+// Emits a jump to block patched once the offsets of all blocks are known
+static bool emit_jump(Lowering* lowering, Opcode oc, size_t block, size_t line)
+{
+  PendingJump* jumps = grow(lowering->graph, lowering->jumps, &lowering->jump_capacity, lowering->jump_count,
+                            sizeof(PendingJump));
+
+  if(jumps == NULL)
+    return false;
+  lowering->jumps = jumps;
+  lowering->jumps[lowering->jump_count++] = (PendingJump){ lowering->output->count, block };
+  write_opcode(lowering->output, oc, line);
+  write_short(lowering->output, 0, line);
+  return true;
+}
+
+// Emits the instruction computing value after its arguments. Arguments computed in place are emitted first,
+// constants are pushed and any other argument is loaded from its temporary.
+static void emit_value(Lowering* lowering, size_t value)
+{
+  const Graph* graph = lowering->graph;
+  const IrValue* current = &graph->values[value];
+  Opcode oc = OP_NOP;
+
+  for(size_t i = 0; i < current->arity; i++)
+  {
+    size_t argument = get_argument(graph, value, i);
+    const IrValue* operand = &graph->values[argument];
+    if(operand->opcode == OP_PSH)
+    {
+      write_opcode(lowering->output, OP_PSH, current->line);
+      write_short(lowering->output, operand->operand, current->line);
+    }
+    else if(operand->is_inline && operand->opcode != OP_NOP)
+      emit_value(lowering, argument);
+    else if(!operand->is_inline)
+      emit_temporary(lowering, operand->temporary, false, current->line);
+  }
+  if(current->opcode == OP_NOP || is_exit(current->opcode))
+    return;
+  oc = get_typed_opcode(graph, value);
+  if(oc != current->opcode)
+    typing_hits++;
+  write_opcode(lowering->output, oc, current->line);
+  if(current->opcode == OP_LDL || current->opcode == OP_STL)
+    write_chunk(lowering->output, (Byte)current->operand, current->line);
+  else if(current->opcode == OP_ASN || current->opcode == OP_CAL || current->opcode == OP_GET)
+    write_short(lowering->output, current->operand, current->line);
+  return;
+}
+
+// Returns the opcode jumping to block from the block at layout index from
+static Opcode get_jump_opcode(const Graph* graph, Opcode oc, size_t from, size_t block)
+{
+  bool backward = graph->blocks[block].layout <= from;
+
+  switch(oc)
+  {
+    case OP_JMC: return backward ? OP_LNZ : OP_JMC;
+    case OP_JMP: return backward ? OP_LOP : OP_JMP;
+    case OP_JMZ: return backward ? OP_LOZ : OP_JMZ;
+    case OP_LNE:
+    case OP_LOE: return backward ? oc : OP_NOP;
+    default:     return backward ? OP_NOP : oc;
+  }
+}
+
+// Emits the exit of the block at layout index i. Jumps to the block laid out next are left out and conditional jumps
+// are inverted to fall through to it where possible.
+static bool emit_exit(Lowering* lowering, size_t i)
+{
+  Graph* graph = lowering->graph;
+  size_t block = graph->layout[i];
+  size_t following = i + 1 < graph->layout_count ? graph->layout[i + 1] : NO_INDEX;
+  size_t exit = get_exit(graph, block);
+  const IrValue* current = &graph->values[exit];
+  Opcode oc = current->opcode;
+  size_t target = graph->blocks[block].target;
+  size_t next = graph->blocks[block].next;
+
+  emit_value(lowering, exit);
+  if(oc == OP_RET || oc == OP_TCL || oc == OP_END)
+  {
+    write_opcode(lowering->output, oc, current->line);
+    if(oc == OP_TCL)
+      write_short(lowering->output, current->operand, current->line);
+    return true;
+  }
+
+  // Control only jumps back into loops, so live ranges cover every path
+  if((target != NO_INDEX && graph->blocks[target].layout <= i && !dominates(graph, target, block))
+     || (next != NO_INDEX && graph->blocks[next].layout <= i && !dominates(graph, next, block)))
+    return false;
+  if((oc == OP_LOE || oc == OP_LNE) && get_jump_opcode(graph, oc, i, target) == OP_NOP)
+  {
+    write_opcode(lowering->output, OP_EQL, current->line);
+    oc = oc == OP_LOE ? OP_JMC : OP_JMZ;
+  }
+  if((oc == OP_JMC || oc == OP_JMZ) && target == following)
+  {
+    oc = oc == OP_JMC ? OP_JMZ : OP_JMC;
+    target = next;
+    next = following;
+  }
+  if(oc != OP_JMP || target != following)
+  {
+    oc = get_jump_opcode(graph, oc, i, target);
+    if(oc == OP_NOP || !emit_jump(lowering, oc, target, current->line))
+      return false;
+  }
+  if(next != NO_INDEX && next != following)
+    return emit_jump(lowering, get_jump_opcode(graph, OP_JMP, i, next), next, current->line);
+  return true;
+}
+
+// Emits the lowered code of the graph
+static bool emit_graph(Lowering* lowering)
+{
+  Graph* graph = lowering->graph;
+  Chunk* output = lowering->output;
+
+  if(graph->function != NULL)
+  {
+    write_opcode(output, OP_ENT, graph->chunk->lines[graph->start]);
+    write_chunk(output, (Byte)(graph->function->local_count + graph->temporary_count - graph->function->arity),
+                graph->chunk->lines[graph->start]);
+  }
+  for(size_t i = 0; i < graph->layout_count; i++)
+  {
+    IrBlock* block = &graph->blocks[graph->layout[i]];
+    block->offset = output->count;
+    if(block->parameter != NO_INDEX && !graph->values[block->parameter].is_inline)
+    {
+      const IrValue* parameter = &graph->values[block->parameter];
+      if(parameter->uses == 0)
+        write_opcode(output, OP_POP, parameter->line);
+      else
+        emit_temporary(lowering, parameter->temporary, true, parameter->line);
+    }
+    for(size_t j = 0; j + 1 < block->count; j++)
+    {
+      const IrValue* value = &graph->values[block->values[j]];
+      if(value->is_inline)
+        continue;
+      emit_value(lowering, block->values[j]);
+      if(value->temporary != NO_INDEX)
+        emit_temporary(lowering, value->temporary, true, value->line);
+      else if(produces_value(value))
+        write_opcode(output, OP_POP, value->line);
+    }
+    if(!emit_exit(lowering, i))
+      return false;
+  }
+  for(size_t i = 0; i < lowering->jump_count; i++)
+  {
+    if(!set_jump_target(output, lowering->jumps[i].offset, graph->blocks[lowering->jumps[i].block].offset))
+      return false;
+  }
+  return !output->has_error && !graph->has_error;
+}
+
+// Lowers the graph into output and returns false if the region has to be copied unchanged
+static bool lower_graph(Graph* graph, Chunk* output)
+{
+  Lowering lowering = { graph, output, NULL, NULL, 0, 0 };
+  size_t* pending = malloc((graph->value_count + 1) * sizeof(size_t));
+  bool lowered = false;
+
+  if(pending == NULL)
+    return false;
+  count_uses(graph);
+  remove_dead_values(graph);
+  thread_jumps(graph);
+  for(size_t i = 0; i < graph->layout_count; i++)
+    stackify_block(graph, graph->layout[i], pending);
+  free(pending);
+  assign_positions(graph);
+  if(!allocate_temporaries(graph))
+    return false;
+  if(graph->function != NULL && (graph->function->local_count + graph->temporary_count > MAX_LOCAL_AMOUNT
+                                 || graph->function->local_count + graph->temporary_count - graph->function->arity
+                                    > UINT8_MAX))
+    return false;
+  lowering.slots = malloc((graph->temporary_count + 1) * sizeof(uint16_t));
+  if(lowering.slots == NULL)
+    return false;
+  for(size_t t = 0; t < graph->temporary_count; t++)
+  {
+    char name[32];
+    if(graph->function != NULL)
+    {
+      lowering.slots[t] = (uint16_t)(graph->function->local_count + t);
+      continue;
+    }
+    snprintf(name, sizeof(name), "%cir%zu", HIDDEN_GLOBAL_PREFIX, t);
+    lowering.slots[t] = bind_global(graph->chunk, name);
+    if(graph->chunk->has_error)
+      goto done;
+  }
+  lowered = emit_graph(&lowering);
+
+done:
+  free(lowering.slots);
+  free(lowering.jumps);
+  return lowered;
+}
+
+// Releases the graph
+static void free_graph(Graph* graph)
+{
+  for(size_t i = 0; i < graph->block_count; i++)
+  {
+    free(graph->blocks[i].values);
+    free(graph->blocks[i].predecessors);
+    free(graph->blocks[i].stack);
+  }
+  for(size_t l = 0; l < graph->loop_count; l++)
+    free(graph->loops[l].blocks);
+  for(size_t v = 0; v < graph->variable_count; v++)
+    graph->variables[graph->variable_keys[v]] = NO_INDEX;
+  free(graph->values);
+  free(graph->arguments);
+  free(graph->blocks);
+  free(graph->order);
+  free(graph->layout);
+  free(graph->loops);
+  return;
+}
+
+// Optimizes the region of the chunk between start and end through the intermediate representation and appends the
+// result to output. Returns false if the region cannot be lifted, which leaves output unchanged.
+static bool optimize_region(Graph* graph, Chunk* output)
+{
+  size_t body = graph->start;
+  size_t mark = output->count;
+  size_t* block_at = NULL;
+  size_t cse = numbering_hits;
+  size_t folded = folding_hits;
+  size_t typed = typing_hits;
+  size_t hoisted = 0;
+  bool optimized = false;
+
+  if(graph->function != NULL)
+  {
+    if((Opcode)graph->chunk->code[graph->start] != OP_ENT)
+      return false;
+    body += 1 + get_operand_length(OP_ENT);
+  }
+  if(body >= graph->end)
+    return false;
+  block_at = malloc((graph->end - graph->start) * sizeof(size_t));
+  if(block_at == NULL || !find_blocks(graph, body, block_at) || !order_blocks(graph) || !lift_blocks(graph))
+    goto done;
+  find_dominators(graph);
+  if(!find_loops(graph) || !number_values(graph))
+    goto done;
+  apply_replacements(graph);
+  graph->layout = malloc((graph->block_count + graph->loop_count + 1) * sizeof(size_t));
+  if(graph->layout == NULL)
+    goto done;
+  for(size_t block = 0; block < graph->block_count; block++)
+  {
+    if(graph->blocks[block].is_reached)
+      graph->layout[graph->layout_count++] = block;
+  }
+  if(!infer_types(graph))
+    goto done;
+  hoisted = hoist_invariants(graph);
+  if(graph->has_error || !lower_graph(graph, output))
+    goto done;
+  optimized = true;
+
+done:
+  if(!optimized)
+  {
+    numbering_hits = cse;
+    folding_hits = folded;
+    typing_hits = typed;
+    output->count = mark;
+    output->has_error = false;
+    graph->chunk->has_error = false; // a hidden global could not be bound
+  }
+  else
+    hoisting_hits += hoisted;
+  free(block_at);
+  return optimized;
+}
+
+// Orders offsets
+static int compare_offsets(const void* a, const void* b)
+{
+  size_t offset_a = *(const size_t*)a;
+  size_t offset_b = *(const size_t*)b;
+
+  return offset_a < offset_b ? -1 : (offset_a > offset_b ? 1 : 0);
+}
+
+// Optimizes the main program and the function bodies of chunk through the SSA intermediate representation and returns
+// number of operations eliminated or hoisted out of loops
+size_t optimize_ir(Chunk* chunk)
+{
+  Chunk output;
+  size_t* variables = malloc(VARIABLE_AMOUNT * sizeof(size_t));
+  size_t* variable_keys = malloc(VARIABLE_AMOUNT * sizeof(size_t));
+  size_t* starts = malloc((chunk->function_count + 2) * sizeof(size_t));
+  size_t* new_starts = malloc((chunk->function_count + 2) * sizeof(size_t));
+  size_t* local_counts = malloc((chunk->function_count + 2) * sizeof(size_t));
+  size_t region_count = 0;
+  size_t hits = numbering_hits + folding_hits + hoisting_hits;
+  bool changed = false;
+
+  init_chunk(&output);
+  if(variables == NULL || variable_keys == NULL || starts == NULL || new_starts == NULL || local_counts == NULL)
+    goto done;
+  for(size_t i = 0; i < VARIABLE_AMOUNT; i++)
+    variables[i] = NO_INDEX;
+
+  // The main program runs up to the first function, whose code follows it
+  starts[region_count++] = 0;
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk != chunk)
+      continue;
+    if(chunk->functions[i].entry >= chunk->count)
+      goto done;
+    starts[region_count++] = chunk->functions[i].entry;
+  }
+  qsort(starts, region_count, sizeof(size_t), compare_offsets);
+  for(size_t r = 0; r < region_count; r++)
+  {
+    size_t end = r + 1 < region_count ? starts[r + 1] : chunk->count;
+    Graph graph = { 0 };
+    graph.chunk = chunk;
+    graph.start = starts[r];
+    graph.end = end;
+    graph.variables = variables;
+    graph.variable_keys = variable_keys;
+    local_counts[r] = SIZE_MAX;
+    for(size_t i = 0; i < chunk->function_count && r > 0; i++)
+    {
+      if(chunk->functions[i].chunk == chunk && chunk->functions[i].entry == graph.start)
+        graph.function = &chunk->functions[i];
+    }
+    new_starts[r] = output.count;
+    if(graph.start < end && (r == 0 || graph.function != NULL) && optimize_region(&graph, &output))
+    {
+      if(graph.function != NULL)
+        local_counts[r] = graph.function->local_count + graph.temporary_count;
+      changed = true;
+    }
+    else
+    {
+      for(size_t offset = graph.start; offset < end; offset++)
+        write_chunk(&output, chunk->code[offset], chunk->lines[offset]);
+    }
+    free_graph(&graph);
+    if(output.has_error)
+      goto done;
+  }
+  if(!changed)
+    goto done;
+
+  // Regions are rewritten in place of the old code, so function entries and frames follow them
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk != chunk)
+      continue;
+    for(size_t r = 1; r < region_count; r++)
+    {
+      if(starts[r] != chunk->functions[i].entry)
+        continue;
+      if(local_counts[r] != SIZE_MAX)
+        chunk->functions[i].local_count = local_counts[r];
+      chunk->functions[i].entry = new_starts[r];
+      break;
+    }
+  }
+  free(chunk->code);
+  free(chunk->lines);
+  chunk->code = output.code;
+  chunk->lines = output.lines;
+  chunk->count = output.count;
+  chunk->capacity = output.capacity;
+  chunk->is_verified = false;
+  output.code = NULL;
+  output.lines = NULL;
+
+done:
+  free(output.code);
+  free(output.lines);
+  free(variables);
+  free(variable_keys);
+  free(starts);
+  free(new_starts);
+  free(local_counts);
+  return numbering_hits + folding_hits + hoisting_hits - hits;
+}
+
+// Prints in debug mode how many operations each pass over the intermediate representation eliminated or hoisted
+void print_ir_hits(void)
+{
+  debug_print("Value numbering eliminated %zu redundant operations.", numbering_hits);
+  debug_print("Value numbering folded %zu operations on constants.", folding_hits);
+  debug_print("Loop-invariant code motion hoisted %zu operations.", hoisting_hits);
+  debug_print("Type inference specialized %zu operations.", typing_hits);
+  return;
+}
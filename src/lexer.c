@@ -549,6 +549,7 @@ const char* cct_token_type_to_string(ConcoctTokenType type)
     case CCT_TOKEN_SHL:              return "<<";
     case CCT_TOKEN_SHR:              return ">>";
     case CCT_TOKEN_DOT:              return ".";
+    case CCT_TOKEN_COMMA:            return ",";
     case CCT_TOKEN_LEFT_PAREN:       return "(";
     case CCT_TOKEN_RIGHT_PAREN:      return ")";
     case CCT_TOKEN_LEFT_BRACE:       return "{";
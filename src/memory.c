@@ -48,6 +48,7 @@ void init_store(void)
     return;
   }
   object_store.capacity = INITIAL_STORE_CAPACITY;
+  object_store.next_slot = 0;
   if(debug_mode)
     debug_print("Object store initialized with %zu slots.", INITIAL_STORE_CAPACITY);
   return;
@@ -69,6 +70,8 @@ void realloc_store(size_t new_size)
   if(debug_mode)
     debug_print("Object store resized from %zu to %zu slots.", object_store.capacity, new_size);
   object_store.capacity = new_size;
+  if(object_store.next_slot > new_size)
+    object_store.next_slot = new_size;
   return;
 }
 
@@ -186,14 +189,16 @@ size_t convert_gigabytes(size_t bytes)
 // Adds object to store
 void add_store_object(Object* object)
 {
-  for(size_t slot = 0; slot < get_store_capacity(); slot++)
+  // Allocation only ever fills slots from the front, so the search can resume where the last one ended
+  for(size_t slot = object_store.next_slot; slot < get_store_capacity(); slot++)
   {
     if(slot >= (size_t)round(get_store_capacity() - ((STORE_GROWTH_THRESHOLD / 100.0) * get_store_capacity())))
       realloc_store((size_t)round(get_store_capacity() + (get_store_capacity() * (STORE_GROWTH_FACTOR / 100.0))));
     if(object_store.objects[slot] == NULL)
     {
       object_store.objects[slot] = object;
-      if(debug_mode)
+      object_store.next_slot = slot + 1;
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s added to object store at slot %zu.", get_data_type(object), slot);
       return;
     }
@@ -212,7 +217,7 @@ void new_string(String* strobj, char* str)
   }
   strcpy(strobj->strval, str);
   strobj->length = strlen(str);
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Memory allocated for string with length of %zu characters: %s", strobj->length, str);
   return;
 }
@@ -220,7 +225,7 @@ void new_string(String* strobj, char* str)
 // Reallocates memory for string
 void realloc_string(String* strobj, const char* new_string)
 {
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Reallocation attempt for original string containing %zu characters: %s", strobj->length, strobj->strval);
   char* newstr = (char *)realloc(strobj->strval, strlen(new_string) + 1);
   if(newstr == NULL)
@@ -229,7 +234,7 @@ void realloc_string(String* strobj, const char* new_string)
     return;
   }
   strcpy(newstr, new_string);
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Memory successfully reallocated for string with length of %zu characters: %s", strlen(new_string), new_string);
   strobj->strval = newstr;
   strobj->length = strlen(new_string);
@@ -240,7 +245,7 @@ void realloc_string(String* strobj, const char* new_string)
 void free_string(String* strobj)
 {
   free(strobj->strval);
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("String freed.");
   strobj->length = 0;
   return;
@@ -259,7 +264,7 @@ Object* new_object(char* value)
   object->is_flagged = false;
   object->is_global = false;
   object->const_name = NULL;
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Object of type %s created with value: %s", get_data_type(object), value);
   add_store_object(object);
   return object;
@@ -278,7 +283,7 @@ Object* new_global(char* value)
   object->is_flagged = false;
   object->is_global = true;
   object->const_name = NULL;
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Global object of type %s created with value: %s", get_data_type(object), value);
   add_store_object(object);
   return object;
@@ -297,7 +302,7 @@ Object* new_constant(char* value, char* name)
   object->is_flagged = true;   // constants are never garbage collected
   object->is_global = false;
   object->const_name = name;
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Constant object of type %s created with value: %s", get_data_type(object), value);
   add_store_object(object);
   return object;
@@ -316,43 +321,43 @@ Object* new_object_by_type(void* data, DataType datatype)
   {
     case CCT_TYPE_NIL:
       object->datatype = datatype;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: null", get_type(datatype), stdout);
       break;
     case CCT_TYPE_STRING:
       object->datatype = datatype;
       new_string(&object->value.strobj, data);
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %s", get_type(datatype), (char *)data, stdout);
       break;
     case CCT_TYPE_BOOL:
       object->datatype = datatype;
       object->value.boolval = *(Bool *)data;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %s", get_type(datatype), *(Bool *)data ? "true" : "false", stdout);
       break;
     case CCT_TYPE_BYTE:
       object->datatype = datatype;
       object->value.byteval = *(Byte *)data;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %u", get_type(datatype), *(Byte *)data);
       break;
     case CCT_TYPE_NUMBER:
       object->datatype = datatype;
       object->value.numval = *(Number *)data;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %" PRId32, get_type(datatype), *(Number *)data);
       break;
     case CCT_TYPE_BIGNUM:
       object->datatype = datatype;
       object->value.bignumval = *(BigNum *)data;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %" PRId64, get_type(datatype), *(BigNum *)data);
       break;
     case CCT_TYPE_DECIMAL:
       object->datatype = datatype;
       object->value.decimalval = *(Decimal *)data;
-      if(debug_mode)
+      if(UNLIKELY(debug_mode))
         debug_print("Object of type %s created with value: %f", get_type(datatype), *(Decimal *)data);
       break;
     default:
@@ -376,7 +381,7 @@ void free_object(Object** object)
     free_string(&(*object)->value.strobj);
   free(*object);
   *object = NULL;
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Object freed.");
   return;
 }
@@ -401,7 +406,7 @@ Object* clone_object(Object* object)
       return NULL;
     }
   }
-  if(debug_mode)
+  if(UNLIKELY(debug_mode))
     debug_print("Object of type %s cloned.", get_data_type(object));
   add_store_object(new_object);
 
@@ -535,6 +540,7 @@ size_t collect_garbage(void)
       collect_count++;
     }
   }
+  object_store.next_slot = 0;
   size_difference = old_store_size - get_store_objects_size();
   if(debug_mode)
   {
@@ -44,6 +44,7 @@ ConcoctParser* cct_new_parser(ConcoctLexer* lexer)
   parser->current_token = cct_next_token(lexer);
   parser->error_line = 0;
   parser->error = NULL;
+  parser->pending = NULL;
   return parser;
 }
 
@@ -112,6 +113,7 @@ ConcoctNodeTree* cct_parse_program(ConcoctParser* parser)
   tree->root = cct_new_node(tree, cct_new_token(CCT_TOKEN_NEWLINE, 0), NULL);
   parser->tree = tree;
 
+  cct_parser_skip_new_lines(parser);
   while(parser->current_token.type != CCT_TOKEN_EOF)
   {
     stat = cct_parse_stat(parser);
@@ -119,6 +121,7 @@ ConcoctNodeTree* cct_parse_program(ConcoctParser* parser)
       return tree;
     if(tree->root != NULL)
       cct_node_add_child(tree->root, stat);
+    cct_parser_skip_new_lines(parser);
   }
   return tree;
 }
@@ -134,7 +137,50 @@ void cct_parser_skip_new_lines(ConcoctParser* parser)
 }
 
 /*
-Parses an expression consisting of one token
+Parses the argument list of a call to the function named by identifier. The current token is the opening parenthesis
+
+  call (function name)
+  -expr1
+  ..
+  -exprN
+*/
+ConcoctNode* cct_parse_call(ConcoctParser* parser, const ConcoctNode* identifier)
+{
+  ConcoctNode* call = cct_new_node(parser->tree, parser->current_token, identifier->text);
+
+  if(call == NULL)
+  {
+    fprintf(stderr, "Call node is NULL!\n");
+    return NULL;
+  }
+
+  cct_next_parser_token(parser);
+  if(parser->current_token.type == CCT_TOKEN_RIGHT_PAREN)
+  {
+    cct_next_parser_token(parser);
+    return call;
+  }
+  while(1)
+  {
+    ConcoctNode* argument = cct_parse_expr(parser);
+    if(argument == NULL)
+      return NULL;
+    cct_node_add_child(call, argument);
+    if(parser->current_token.type == CCT_TOKEN_RIGHT_PAREN)
+      break;
+    if(parser->current_token.type != CCT_TOKEN_COMMA)
+    {
+      cct_set_parser_error(parser, "Expected ',' or ')'");
+      return NULL;
+    }
+    cct_next_parser_token(parser);
+  }
+  cct_next_parser_token(parser);
+  return call;
+}
+
+/*
+Parses an expression consisting of one token, or a call
 
   expr
 */
@@ -142,6 +188,13 @@ ConcoctNode* cct_parse_single_expr(ConcoctParser* parser)
 {
   ConcoctNode* node;
 
+  // The identifier of an expression statement was read before the statement turned out to be an expression
+  if(parser->pending != NULL)
+  {
+    node = parser->pending;
+    parser->pending = NULL;
+    return node;
+  }
   switch(parser->current_token.type)
   {
     case CCT_TOKEN_INT:
@@ -159,6 +212,8 @@ ConcoctNode* cct_parse_single_expr(ConcoctParser* parser)
         return NULL;
       }
       cct_next_parser_token(parser);
+      if(node->token.type == CCT_TOKEN_IDENTIFIER && parser->current_token.type == CCT_TOKEN_LEFT_PAREN)
+        return cct_parse_call(parser, node);
       return node;
     case CCT_TOKEN_LEFT_PAREN:
       cct_next_parser_token(parser);
@@ -214,6 +269,9 @@ ConcoctNode* cct_parse_unary_expr(ConcoctParser* parser)
 {
   ConcoctNode* op_node;
 
+  // The current token follows a pending identifier, so it is a binary operator
+  if(parser->pending != NULL)
+    return cct_parse_primary_expr(parser);
   switch(parser->current_token.type)
   {
     case CCT_TOKEN_SUB:
@@ -801,6 +859,75 @@ ConcoctNode* cct_parse_compound_stat(ConcoctParser* parser)
   return compound_stat;
 }
 
+/*
+Parses a function declaration
+
+  func (function name)
+  -parameter1
+  ..
+  -parameterN
+  -compound stat
+*/
+ConcoctNode* cct_parse_func_stat(ConcoctParser* parser)
+{
+  ConcoctNode* func_stat = NULL;
+  ConcoctToken func_token = parser->current_token;
+
+  cct_next_parser_token(parser);
+  if(parser->current_token.type != CCT_TOKEN_IDENTIFIER)
+  {
+    cct_set_parser_error(parser, "Expected a function name");
+    return NULL;
+  }
+  func_stat = cct_new_node(parser->tree, func_token, parser->lexer->token_text);
+  if(func_stat == NULL)
+  {
+    fprintf(stderr, "Function statement node is NULL!\n");
+    return NULL;
+  }
+
+  cct_next_parser_token(parser);
+  if(parser->current_token.type != CCT_TOKEN_LEFT_PAREN)
+  {
+    cct_set_parser_error(parser, "Expected '('");
+    return NULL;
+  }
+  cct_next_parser_token(parser);
+  while(parser->current_token.type != CCT_TOKEN_RIGHT_PAREN)
+  {
+    if(parser->current_token.type != CCT_TOKEN_IDENTIFIER)
+    {
+      cct_set_parser_error(parser, "Expected a parameter name");
+      return NULL;
+    }
+    ConcoctNode* parameter = cct_new_node(parser->tree, parser->current_token, parser->lexer->token_text);
+    if(parameter == NULL)
+      return NULL;
+    cct_node_add_child(func_stat, parameter);
+    cct_next_parser_token(parser);
+    if(parser->current_token.type == CCT_TOKEN_COMMA)
+      cct_next_parser_token(parser);
+    else if(parser->current_token.type != CCT_TOKEN_RIGHT_PAREN)
+    {
+      cct_set_parser_error(parser, "Expected ',' or ')'");
+      return NULL;
+    }
+  }
+  cct_next_parser_token(parser);
+
+  cct_parser_skip_new_lines(parser);
+  if(parser->current_token.type != CCT_TOKEN_LEFT_BRACE)
+  {
+    cct_set_parser_error(parser, "Expected '{'");
+    return NULL;
+  }
+  ConcoctNode* body = cct_parse_compound_stat(parser);
+  if(body == NULL)
+    return NULL;
+  cct_node_add_child(func_stat, body);
+  return func_stat;
+}
+
 /*
 Parses 'break' or 'continue'
 
@@ -833,7 +960,8 @@ ConcoctNode* cct_parse_return(ConcoctParser* parser)
 
 /*
 Parses an assign statement. Note that the node has the assign token as the root,
-with the identifier and expression as children
+with the identifier and expression as children. A call statement is parsed like a call expression,
+and any other statement starting with an identifier is parsed as an expression statement
 
   assign
   -identifier
@@ -845,6 +973,9 @@ ConcoctNode* cct_parse_assign(ConcoctParser* parser)
   cct_next_parser_token(parser);
   ConcoctNode* assign_op_node;
 
+  if(parser->current_token.type == CCT_TOKEN_LEFT_PAREN)
+    return cct_parse_call(parser, id_node);
+
   switch(parser->current_token.type)
   {
     case CCT_TOKEN_ASSIGN:
@@ -857,8 +988,8 @@ ConcoctNode* cct_parse_assign(ConcoctParser* parser)
       assign_op_node = cct_new_node(parser->tree, parser->current_token, NULL);
       break;
     default:
-      cct_set_parser_error(parser, "Expected an assignment");
-      return NULL;
+      parser->pending = id_node;
+      return cct_parse_expr(parser);
   }
   cct_node_add_child(assign_op_node, id_node);
 
@@ -883,11 +1014,27 @@ ConcoctNode* cct_parse_stat(ConcoctParser* parser)
     case CCT_TOKEN_WHILE:      return cct_parse_while_stat(parser);
     case CCT_TOKEN_DO:         return cct_parse_do_while_stat(parser);
     case CCT_TOKEN_FOR:        return cct_parse_for_stat(parser);
+    case CCT_TOKEN_FUNC:       return cct_parse_func_stat(parser);
     case CCT_TOKEN_LEFT_BRACE: return cct_parse_compound_stat(parser);
     case CCT_TOKEN_BREAK:
     case CCT_TOKEN_CONTINUE:   return cct_parse_one_word_stat(parser);
     case CCT_TOKEN_RETURN:     return cct_parse_return(parser);
     case CCT_TOKEN_IDENTIFIER: return cct_parse_assign(parser);
+    // Expression statements
+    case CCT_TOKEN_INT:
+    case CCT_TOKEN_FLOAT:
+    case CCT_TOKEN_CHAR:
+    case CCT_TOKEN_STRING:
+    case CCT_TOKEN_TRUE:
+    case CCT_TOKEN_FALSE:
+    case CCT_TOKEN_NULL:
+    case CCT_TOKEN_LEFT_PAREN:
+    case CCT_TOKEN_SUB:
+    case CCT_TOKEN_ADD:
+    case CCT_TOKEN_NOT:
+    case CCT_TOKEN_INC:
+    case CCT_TOKEN_DEC:
+    case CCT_TOKEN_BIN_NOT:    return cct_parse_expr(parser);
     default:
       cct_set_parser_error(parser, "Expected a statement");
       return NULL;
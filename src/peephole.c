@@ -0,0 +1,740 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>          // SIZE_MAX, UINT16_MAX
+#include <stdlib.h>          // calloc(), free(), malloc()
+#include "debug.h"           // debug_print()
+#include "peephole.h"
+#include "vm/instructions.h" // get_binary_kernel(), is_truthy()
+#include "vm/opcodes.h"      // falls_through(), get_generic_opcode(), get_operand_length(), get_quickened_opcode(),
+                             // is_jump_operation(), is_loop_operation()
+
+bool fusion_mode = true;
+bool peephole_mode = true;
+
+/*
+ * Sequences are chosen from opcode profiles (see profile.h) of typical programs:
+ *
+ *   GET x, PSH k, <op>, ASN x  ->  GOPK x, k, <op>
+ *   PSH k, ASN x               ->  SETK x, k
+ *   PSH k, LT, JMZ             ->  JNLK k
+ *   PSH k, LT, LNZ             ->  LLTK k
+ *   PSH k, <op>                ->  <op>K k
+ *   GET a, GET b               ->  GET2 a, b
+ *
+ * Every fused form is shorter than the sequence it replaces, so the chunk is rewritten in place. The input offset
+ * must therefore be advanced before a fused instruction overwrites the sequence it replaces. A sequence is only
+ * fused when no jump lands after its first instruction, and jump offsets are remapped to the rewritten
+ * instruction positions once the chunk has been compacted.
+ */
+
+// Returns superinstruction taking a constant right operand for binary opcode or OP_NOP if there is none
+static Opcode get_constant_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADD: return OP_ADDK;
+    case OP_DIV: return OP_DIVK;
+    case OP_EQL: return OP_EQLK;
+    case OP_GT:  return OP_GTK;
+    case OP_GTE: return OP_GTEK;
+    case OP_LT:  return OP_LTK;
+    case OP_LTE: return OP_LTEK;
+    case OP_MOD: return OP_MODK;
+    case OP_MUL: return OP_MULK;
+    case OP_NEQ: return OP_NEQK;
+    case OP_SUB: return OP_SUBK;
+    default:     return OP_NOP;
+  }
+}
+
+// Returns opcode at offset or OP_NOP if offset is past the end of chunk
+static Opcode opcode_at(const Chunk* chunk, size_t offset)
+{
+  if(offset >= chunk->count)
+    return OP_NOP;
+  return (Opcode)chunk->code[offset];
+}
+
+// Returns offset of the instruction following the one at offset
+static size_t next_offset(const Chunk* chunk, size_t offset)
+{
+  return offset + 1 + get_operand_length((Opcode)chunk->code[offset]);
+}
+
+// Returns true if a jump lands on any instruction after the first one in [start, end)
+static bool is_split(const bool* targets, size_t start, size_t end)
+{
+  for(size_t offset = start + 1; offset < end; offset++)
+  {
+    if(targets[offset])
+      return true;
+  }
+  return false;
+}
+
+// Writes a byte at the output offset and advances it
+static void put_byte(Chunk* chunk, size_t* output, Byte byte, size_t line)
+{
+  chunk->code[*output] = byte;
+  chunk->lines[*output] = line;
+  (*output)++;
+  return;
+}
+
+// Writes a 16-bit operand at the output offset and advances it
+static void put_short(Chunk* chunk, size_t* output, uint16_t value, size_t line)
+{
+  put_byte(chunk, output, (Byte)(value & 0xFF), line);
+  put_byte(chunk, output, (Byte)((value >> 8) & 0xFF), line);
+  return;
+}
+
+// Rewrites common instruction sequences in chunk as superinstructions and returns number of fusions
+size_t fuse_superinstructions(Chunk* chunk)
+{
+  size_t input = 0;
+  size_t output = 0;
+  size_t fusions = 0;
+  // Jump targets and the output offset each instruction moved to (indexed by input offset), and the input target of
+  // each copied jump (indexed by output offset)
+  bool* targets = calloc(chunk->count + 1, sizeof(bool));
+  size_t* moved = malloc((chunk->count + 1) * sizeof(size_t));
+  size_t* jumps = malloc(chunk->count * sizeof(size_t));
+
+  if(targets == NULL || moved == NULL || jumps == NULL)
+  {
+    free(targets);
+    free(moved);
+    free(jumps);
+    return 0;
+  }
+  for(size_t offset = 0; offset < chunk->count; offset = next_offset(chunk, offset))
+  {
+    size_t target = 0;
+    if(!is_jump_operation((Opcode)chunk->code[offset]))
+      continue;
+    target = get_jump_target(chunk, offset);
+    if(target > chunk->count)
+      goto done; // leave malformed chunks for the verifier to reject
+    targets[target] = true;
+  }
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk != chunk)
+      continue;
+    if(chunk->functions[i].entry >= chunk->count)
+      goto done;
+    targets[chunk->functions[i].entry] = true; // calls land on function entries like jumps do
+  }
+
+  while(input < chunk->count)
+  {
+    Opcode oc = (Opcode)chunk->code[input];
+    size_t line = chunk->lines[input];
+    size_t second = next_offset(chunk, input);
+    Opcode oc2 = opcode_at(chunk, second);
+
+    moved[input] = output;
+    if(targets[second])
+      oc2 = OP_NOP; // a jump lands between the two instructions
+
+    if(oc == OP_GET && oc2 == OP_PSH)
+    {
+      // GET x, PSH k, <op>, ASN x
+      size_t third = next_offset(chunk, second);
+      Opcode oc3 = opcode_at(chunk, third);
+      size_t fourth = third + 1;
+      uint16_t key = read_short(&chunk->code[input + 1]);
+
+      oc3 = get_generic_opcode(oc3); // GOPK has no quickened forms
+      if(get_binary_kernel(oc3) != NULL && opcode_at(chunk, fourth) == OP_ASN
+         && read_short(&chunk->code[fourth + 1]) == key && !is_split(targets, input, fourth + 1))
+      {
+        uint16_t constant = read_short(&chunk->code[second + 1]);
+        input = next_offset(chunk, fourth);
+        put_byte(chunk, &output, (Byte)OP_GOPK, line);
+        put_short(chunk, &output, key, line);
+        put_short(chunk, &output, constant, line);
+        put_byte(chunk, &output, (Byte)oc3, line);
+        fusions++;
+        continue;
+      }
+    }
+
+    if(oc == OP_PSH && oc2 == OP_ASN)
+    {
+      uint16_t constant = read_short(&chunk->code[input + 1]);
+      uint16_t key = read_short(&chunk->code[second + 1]);
+      input = next_offset(chunk, second);
+      put_byte(chunk, &output, (Byte)OP_SETK, line);
+      put_short(chunk, &output, key, line);
+      put_short(chunk, &output, constant, line);
+      fusions++;
+      continue;
+    }
+
+    if(oc == OP_PSH && get_generic_opcode(oc2) == OP_LT)
+    {
+      // PSH k, LT, JMZ or LNZ (loop conditions). The fused form compares numbers itself, so quickening is dropped.
+      size_t third = next_offset(chunk, second);
+      Opcode oc3 = opcode_at(chunk, third);
+
+      if((oc3 == OP_JMZ || oc3 == OP_LNZ) && !is_split(targets, input, third + 1))
+      {
+        uint16_t constant = read_short(&chunk->code[input + 1]);
+        jumps[output] = get_jump_target(chunk, third);
+        input = next_offset(chunk, third);
+        put_byte(chunk, &output, (Byte)(oc3 == OP_JMZ ? OP_JNLK : OP_LLTK), line);
+        put_short(chunk, &output, 0, line); // jump offset, remapped below
+        put_short(chunk, &output, constant, line);
+        fusions++;
+        continue;
+      }
+    }
+
+    if(oc == OP_PSH && get_constant_opcode(get_generic_opcode(oc2)) != OP_NOP)
+    {
+      uint16_t constant = read_short(&chunk->code[input + 1]);
+      DataType type = chunk->constants[constant]->datatype;
+      Opcode fused = get_constant_opcode(get_generic_opcode(oc2));
+      // A form quickened by the SSA optimizer proved both operands have the type of the constant
+      if(oc2 != get_generic_opcode(oc2))
+        fused = get_quickened_opcode(fused, type, type);
+      input = next_offset(chunk, second);
+      put_byte(chunk, &output, (Byte)fused, line);
+      put_short(chunk, &output, constant, line);
+      fusions++;
+      continue;
+    }
+
+    if(oc == OP_GET && oc2 == OP_GET)
+    {
+      uint16_t key1 = read_short(&chunk->code[input + 1]);
+      uint16_t key2 = read_short(&chunk->code[second + 1]);
+      input = next_offset(chunk, second);
+      put_byte(chunk, &output, (Byte)OP_GET2, line);
+      put_short(chunk, &output, key1, line);
+      put_short(chunk, &output, key2, line);
+      fusions++;
+      continue;
+    }
+
+    // Copy instruction unchanged
+    if(is_jump_operation(oc))
+      jumps[output] = get_jump_target(chunk, input);
+    while(input < second && input < chunk->count)
+    {
+      put_byte(chunk, &output, chunk->code[input], chunk->lines[input]);
+      input++;
+    }
+  }
+  moved[chunk->count] = output;
+
+  // Fusion only shrinks code, so every remapped jump distance still fits its operand
+  for(size_t offset = 0; offset < output; offset = next_offset(chunk, offset))
+  {
+    if(is_jump_operation((Opcode)chunk->code[offset]))
+      set_jump_target(chunk, offset, moved[jumps[offset]]);
+  }
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk == chunk)
+      chunk->functions[i].entry = moved[chunk->functions[i].entry];
+  }
+  chunk->count = output;
+
+done:
+  free(targets);
+  free(moved);
+  free(jumps);
+  return fusions;
+}
+
+/*
+ * The optimizer decodes a chunk into a list of instructions and applies the rules in the table below to every live
+ * instruction until none of them changes anything. It then removes the instructions that no path from the start of
+ * the chunk or from a function entry reaches, and repeats both steps until the list is stable. Finally it encodes
+ * the list back into the chunk.
+ *
+ * Rules delete instructions by marking them dead. A jump to a dead instruction lands on the next live one, so a rule
+ * may delete the first instruction of the sequence it matches but none after it that a jump lands on. Jumps are
+ * encoded in the direction of their final target (JMP/LOP, JMC/LNZ, JMZ/LOZ). Removing code never lengthens a jump,
+ * so only rules that retarget jumps check the distance.
+ */
+
+// Instruction of the chunk being optimized
+typedef struct instruction
+{
+  size_t offset;  // offset before optimization
+  size_t target;  // index of the instruction a jump lands on
+  Opcode opcode;
+  bool is_dead;
+  bool is_target; // a jump or call may land on it
+} Instruction;
+
+// Chunk being optimized
+typedef struct optimizer
+{
+  Chunk* chunk;
+  Instruction* instructions;
+  size_t count;
+} Optimizer;
+
+// Peephole rule: rewrites the sequence starting with the live instruction at index and returns true if it changed
+typedef bool (*Rule)(Optimizer* optimizer, size_t index);
+
+// Entry of the rule table with the number of times the rule applied
+typedef struct peephole_rule
+{
+  const char* name;
+  Rule apply;
+  size_t hits;
+} PeepholeRule;
+
+// Returns index of the first live instruction at or after index (count if there is none)
+static size_t resolve(const Optimizer* optimizer, size_t index)
+{
+  while(index < optimizer->count && optimizer->instructions[index].is_dead)
+    index++;
+  return index;
+}
+
+// Returns index of the live instruction following the one at index (count if there is none)
+static size_t next_live(const Optimizer* optimizer, size_t index)
+{
+  return resolve(optimizer, index + 1);
+}
+
+// Returns opcode of the live instruction at index or OP_NOP past the end of the chunk
+static Opcode opcode_of(const Optimizer* optimizer, size_t index)
+{
+  return index < optimizer->count ? optimizer->instructions[index].opcode : OP_NOP;
+}
+
+// Returns true if index is past the end of the chunk or a jump may land on the instruction there
+static bool is_landing(const Optimizer* optimizer, size_t index)
+{
+  return index >= optimizer->count || optimizer->instructions[index].is_target;
+}
+
+// Marks the instruction at index dead. Jumps landing on it now land on the instruction after it.
+static void kill(Optimizer* optimizer, size_t index)
+{
+  size_t next = 0;
+
+  optimizer->instructions[index].is_dead = true;
+  next = next_live(optimizer, index);
+  if(optimizer->instructions[index].is_target && next < optimizer->count)
+    optimizer->instructions[next].is_target = true;
+  return;
+}
+
+// Returns true if opcode is a conditional branch that pops a truth value and jumps in either direction
+static bool is_branch(Opcode oc)
+{
+  return oc == OP_JMC || oc == OP_JMZ || oc == OP_LNZ || oc == OP_LOZ;
+}
+
+// Returns the form of a jump opcode that jumps back (backward is true) or forward, or OP_NOP if there is none
+static Opcode get_directed_opcode(Opcode oc, bool backward)
+{
+  switch(oc)
+  {
+    case OP_JMC:
+    case OP_LNZ: return backward ? OP_LNZ : OP_JMC;
+    case OP_JMP:
+    case OP_LOP: return backward ? OP_LOP : OP_JMP;
+    case OP_JMZ:
+    case OP_LOZ: return backward ? OP_LOZ : OP_JMZ;
+    default:     return is_loop_operation(oc) == backward ? oc : OP_NOP;
+  }
+}
+
+// Returns true if a jump from the instruction at from to the one at to fits its operand. Distances are measured
+// before optimization, which only shrinks them.
+static bool jump_fits(const Optimizer* optimizer, size_t from, size_t to)
+{
+  size_t next = optimizer->instructions[from].offset + 1 + get_operand_length(optimizer->instructions[from].opcode);
+  size_t target = to < optimizer->count ? optimizer->instructions[to].offset : optimizer->chunk->count;
+
+  return (target > next ? target - next : next - target) <= UINT16_MAX;
+}
+
+// Returns true if opcode always leaves a Bool on the stack
+static bool pushes_bool(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_EQL:
+    case OP_EQLK:
+    case OP_GT:
+    case OP_GTE:
+    case OP_GTEK:
+    case OP_GTK:
+    case OP_LT:
+    case OP_LTE:
+    case OP_LTEK:
+    case OP_LTK:
+    case OP_NEQ:
+    case OP_NEQK:
+    case OP_NOT:
+    case OP_SLE:
+    case OP_SLN:
+    case OP_TST:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// NOP  ->  (nothing)
+static bool remove_nop(Optimizer* optimizer, size_t index)
+{
+  if(optimizer->instructions[index].opcode != OP_NOP)
+    return false;
+  kill(optimizer, index);
+  return true;
+}
+
+// PSH k, POP or LDL n, POP  ->  (nothing)
+static bool remove_push_pop(Optimizer* optimizer, size_t index)
+{
+  Opcode oc = optimizer->instructions[index].opcode;
+  size_t pop = next_live(optimizer, index);
+
+  if((oc != OP_PSH && oc != OP_LDL) || opcode_of(optimizer, pop) != OP_POP || is_landing(optimizer, pop))
+    return false;
+  kill(optimizer, index);
+  kill(optimizer, pop);
+  return true;
+}
+
+// <Bool>, NOT, NOT  ->  <Bool> (NOT rejects anything but a Bool, so this only applies after an instruction that
+// always leaves one)
+static bool remove_double_not(Optimizer* optimizer, size_t index)
+{
+  size_t first = next_live(optimizer, index);
+  size_t second = next_live(optimizer, first);
+
+  if(!pushes_bool(optimizer->instructions[index].opcode) || opcode_of(optimizer, first) != OP_NOT
+     || opcode_of(optimizer, second) != OP_NOT || is_landing(optimizer, first) || is_landing(optimizer, second))
+    return false;
+  kill(optimizer, first);
+  kill(optimizer, second);
+  return true;
+}
+
+// <Bool>, NOT, JMC/JMZ/LNZ/LOZ  ->  <Bool>, JMZ/JMC/LOZ/LNZ
+static bool invert_branch(Optimizer* optimizer, size_t index)
+{
+  size_t negation = next_live(optimizer, index);
+  size_t branch = next_live(optimizer, negation);
+  Instruction* instruction = NULL;
+
+  if(!pushes_bool(optimizer->instructions[index].opcode) || opcode_of(optimizer, negation) != OP_NOT
+     || !is_branch(opcode_of(optimizer, branch)) || is_landing(optimizer, negation) || is_landing(optimizer, branch))
+    return false;
+  kill(optimizer, negation);
+  instruction = &optimizer->instructions[branch];
+  switch(instruction->opcode)
+  {
+    case OP_JMC: instruction->opcode = OP_JMZ; break;
+    case OP_JMZ: instruction->opcode = OP_JMC; break;
+    case OP_LNZ: instruction->opcode = OP_LOZ; break;
+    default:     instruction->opcode = OP_LNZ; break;
+  }
+  return true;
+}
+
+// PSH k, JMC/JMZ/LNZ/LOZ  ->  JMP/LOP if the branch is taken on k and nothing otherwise
+static bool fold_constant_branch(Optimizer* optimizer, size_t index)
+{
+  const Instruction* push = &optimizer->instructions[index];
+  size_t branch = next_live(optimizer, index);
+  Opcode oc = opcode_of(optimizer, branch);
+  const Object* constant = NULL;
+
+  if(push->opcode != OP_PSH || !is_branch(oc) || is_landing(optimizer, branch))
+    return false;
+  constant = optimizer->chunk->constants[read_short(&optimizer->chunk->code[push->offset + 1])];
+  kill(optimizer, index);
+  if(is_truthy(constant) == (oc == OP_JMC || oc == OP_LNZ))
+    optimizer->instructions[branch].opcode = is_loop_operation(oc) ? OP_LOP : OP_JMP;
+  else
+    kill(optimizer, branch);
+  return true;
+}
+
+// Jump to JMP/LOP  ->  jump to the target of the JMP/LOP
+static bool thread_jump(Optimizer* optimizer, size_t index)
+{
+  Instruction* jump = &optimizer->instructions[index];
+  size_t landing = 0;
+  size_t target = 0;
+
+  if(!is_jump_operation(jump->opcode))
+    return false;
+  landing = resolve(optimizer, jump->target);
+  if(landing == index || (opcode_of(optimizer, landing) != OP_JMP && opcode_of(optimizer, landing) != OP_LOP))
+    return false;
+  target = resolve(optimizer, optimizer->instructions[landing].target);
+  if(target == landing || target == resolve(optimizer, jump->target)
+     || get_directed_opcode(jump->opcode, target <= index) == OP_NOP || !jump_fits(optimizer, index, target))
+    return false;
+  jump->target = target;
+  if(target < optimizer->count)
+    optimizer->instructions[target].is_target = true;
+  return true;
+}
+
+// JMP/LOP to the next instruction  ->  (nothing), and JMC/JMZ/LNZ/LOZ to it  ->  POP
+static bool remove_jump_to_next(Optimizer* optimizer, size_t index)
+{
+  Instruction* jump = &optimizer->instructions[index];
+
+  if((jump->opcode != OP_JMP && jump->opcode != OP_LOP && !is_branch(jump->opcode))
+     || resolve(optimizer, jump->target) != next_live(optimizer, index))
+    return false;
+  if(is_branch(jump->opcode))
+    jump->opcode = OP_POP;
+  else
+    kill(optimizer, index);
+  return true;
+}
+
+// Rules in the order they are tried on each instruction
+static PeepholeRule rules[] =
+{
+  { "nop", remove_nop, 0 },
+  { "push-pop", remove_push_pop, 0 },
+  { "double-not", remove_double_not, 0 },
+  { "not-branch", invert_branch, 0 },
+  { "constant-branch", fold_constant_branch, 0 },
+  { "jump-to-jump", thread_jump, 0 },
+  { "jump-to-next", remove_jump_to_next, 0 }
+};
+
+// Number of unreachable instructions removed
+static size_t unreachable_hits = 0;
+
+// Marks the instructions no path reaches dead and returns their number. Paths start at the first instruction, at
+// OP_END (which stays the last instruction of the main program) and at the entries of the functions of the chunk.
+static size_t remove_unreachable(Optimizer* optimizer, const size_t* entries, size_t entry_count)
+{
+  bool* reached = calloc(optimizer->count, sizeof(bool));
+  size_t* pending = malloc((optimizer->count + entry_count + 2) * sizeof(size_t));
+  size_t pending_count = 0;
+  size_t removed = 0;
+
+  if(reached == NULL || pending == NULL)
+  {
+    free(reached);
+    free(pending);
+    return 0;
+  }
+  pending[pending_count++] = 0;
+  for(size_t i = 0; i < entry_count; i++)
+    pending[pending_count++] = entries[i];
+  for(size_t i = 0; i < optimizer->count; i++)
+  {
+    if(!optimizer->instructions[i].is_dead && optimizer->instructions[i].opcode == OP_END)
+      pending[pending_count++] = i;
+  }
+
+  // Every instruction is pushed at most once after the roots, when it is first reached
+  while(pending_count > 0)
+  {
+    size_t index = resolve(optimizer, pending[--pending_count]);
+    const Instruction* instruction = NULL;
+    if(index == optimizer->count || reached[index])
+      continue;
+    reached[index] = true;
+    instruction = &optimizer->instructions[index];
+    if(is_jump_operation(instruction->opcode))
+    {
+      size_t target = resolve(optimizer, instruction->target);
+      if(target < optimizer->count && !reached[target])
+        pending[pending_count++] = target;
+    }
+    if(falls_through(instruction->opcode))
+    {
+      size_t next = next_live(optimizer, index);
+      if(next < optimizer->count && !reached[next])
+        pending[pending_count++] = next;
+    }
+  }
+  for(size_t i = 0; i < optimizer->count; i++)
+  {
+    if(!optimizer->instructions[i].is_dead && !reached[i])
+    {
+      kill(optimizer, i);
+      removed++;
+    }
+  }
+  free(reached);
+  free(pending);
+  return removed;
+}
+
+// Writes the live instructions back to the chunk and remaps jumps and function entries
+static void encode_instructions(Optimizer* optimizer, size_t* new_offsets)
+{
+  Chunk* chunk = optimizer->chunk;
+  size_t output = 0;
+
+  for(size_t i = 0; i < optimizer->count; i++)
+  {
+    new_offsets[i] = output;
+    if(!optimizer->instructions[i].is_dead)
+      output += 1 + get_operand_length(optimizer->instructions[i].opcode);
+  }
+  new_offsets[optimizer->count] = output;
+
+  // Code only shrinks, so each instruction is read before anything is written over it
+  for(size_t i = 0; i < optimizer->count; i++)
+  {
+    Instruction* instruction = &optimizer->instructions[i];
+    size_t length = get_operand_length(instruction->opcode);
+    size_t line = chunk->lines[instruction->offset];
+    size_t offset = new_offsets[i];
+    if(instruction->is_dead)
+      continue;
+    chunk->code[offset] = (Byte)instruction->opcode;
+    chunk->lines[offset] = line;
+    for(size_t j = 1; j <= length; j++)
+    {
+      chunk->code[offset + j] = chunk->code[instruction->offset + j];
+      chunk->lines[offset + j] = line;
+    }
+    if(is_jump_operation(instruction->opcode))
+    {
+      size_t target = resolve(optimizer, instruction->target);
+      chunk->code[offset] = (Byte)get_directed_opcode(instruction->opcode, target <= i);
+      set_jump_target(chunk, offset, new_offsets[target]);
+    }
+  }
+  chunk->count = output;
+  return;
+}
+
+// Applies the peephole rules and dead-code elimination to chunk and returns number of instructions removed
+size_t optimize_chunk(Chunk* chunk)
+{
+  Optimizer optimizer = { chunk, NULL, 0 };
+  size_t* indexes = malloc((chunk->count + 1) * sizeof(size_t)); // instruction index of each offset
+  size_t* entries = malloc((chunk->function_count + 1) * sizeof(size_t));
+  size_t entry_count = 0;
+  size_t removed = 0;
+  size_t unreachable = 0;
+  bool changed = true;
+
+  optimizer.instructions = malloc((chunk->count + 1) * sizeof(Instruction));
+  if(indexes == NULL || entries == NULL || optimizer.instructions == NULL)
+    goto done;
+  for(size_t offset = 0; offset <= chunk->count; offset++)
+    indexes[offset] = SIZE_MAX;
+  for(size_t offset = 0; offset < chunk->count; offset = next_offset(chunk, offset))
+  {
+    if(next_offset(chunk, offset) > chunk->count)
+      goto done; // leave malformed chunks for the verifier to reject
+    indexes[offset] = optimizer.count;
+    optimizer.instructions[optimizer.count++] = (Instruction){ offset, 0, (Opcode)chunk->code[offset], false, false };
+  }
+  indexes[chunk->count] = optimizer.count;
+  for(size_t i = 0; i < optimizer.count; i++)
+  {
+    Instruction* instruction = &optimizer.instructions[i];
+    size_t target = 0;
+    if(!is_jump_operation(instruction->opcode))
+      continue;
+    target = get_jump_target(chunk, instruction->offset);
+    if(target > chunk->count || indexes[target] == SIZE_MAX)
+      goto done;
+    instruction->target = indexes[target];
+    if(instruction->target < optimizer.count)
+      optimizer.instructions[instruction->target].is_target = true;
+  }
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk != chunk)
+      continue;
+    if(chunk->functions[i].entry >= chunk->count)
+      goto done;
+    entries[entry_count] = indexes[chunk->functions[i].entry];
+    optimizer.instructions[entries[entry_count++]].is_target = true;
+  }
+
+  while(changed)
+  {
+    changed = false;
+    for(size_t i = resolve(&optimizer, 0); i < optimizer.count; i = next_live(&optimizer, i))
+    {
+      for(size_t r = 0; r < sizeof(rules) / sizeof(rules[0]); r++)
+      {
+        if(rules[r].apply(&optimizer, i))
+        {
+          rules[r].hits++;
+          changed = true;
+          if(optimizer.instructions[i].is_dead)
+            break;
+        }
+      }
+    }
+    unreachable = remove_unreachable(&optimizer, entries, entry_count);
+    unreachable_hits += unreachable;
+    changed = changed || unreachable > 0;
+  }
+
+  for(size_t i = 0; i < optimizer.count; i++)
+  {
+    if(optimizer.instructions[i].is_dead)
+      removed++;
+  }
+  encode_instructions(&optimizer, indexes);
+  entry_count = 0;
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk == chunk)
+      chunk->functions[i].entry = indexes[resolve(&optimizer, entries[entry_count++])];
+  }
+
+done:
+  free(indexes);
+  free(entries);
+  free(optimizer.instructions);
+  return removed;
+}
+
+// Prints in debug mode how often each peephole rule applied and how many unreachable instructions were removed
+void print_peephole_hits(void)
+{
+  for(size_t r = 0; r < sizeof(rules) / sizeof(rules[0]); r++)
+    debug_print("Peephole rule %s applied %zu times.", rules[r].name, rules[r].hits);
+  debug_print("Dead-code elimination removed %zu unreachable instructions.", unreachable_hits);
+  return;
+}
@@ -25,59 +25,55 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <stdio.h>  // fprintf(), stderr
-#include <stdlib.h> // EXIT_FAILURE
+#include <stdlib.h> // free(), malloc(), realloc()
 #include "debug.h"
 #include "stack.h"
 
+// Initializes stack
 void init_stack(Stack* stack)
 {
   stack->count = 0;
   stack->top = -1;
-  if(debug_mode)
-    debug_print("Stack initialized with %zu slots.", MAX_STACK_CAPACITY);
-  return;
-}
-
-// Returns object at top of stack without removal
-void* peek(const Stack* stack)
-{
-  if(stack->top == -1)
+  stack->capacity = INITIAL_STACK_CAPACITY;
+  stack->objects = malloc(stack->capacity * sizeof(void*));
+  if(stack->objects == NULL)
   {
-    if(debug_mode)
-      debug_print("peek() called on empty stack!");
-    return NULL;
+    fprintf(stderr, "Unable to allocate memory for stack.\n");
+    stack->capacity = 0;
   }
   if(debug_mode)
-    debug_print("peek() called on stack for object of type %s. Stack currently contains %zu objects.", get_data_type(stack->objects[stack->top]), stack->count);
-  return stack->objects[stack->top];
+    debug_print("Stack initialized with %zu slots.", stack->capacity);
+  return;
 }
 
-// Returns and removes object at top of stack
-void* pop(Stack* stack)
+// Frees stack
+void free_stack(Stack* stack)
 {
-  if(stack->top == -1)
-  {
-    fprintf(stderr, "Stack underflow occurred!\n");
-    return NULL;
-  }
-  stack->count--;
-  if(debug_mode)
-    debug_print("pop() called on stack for object of type %s. Stack now contains %zu objects.", get_data_type(stack->objects[stack->top]), stack->count);
-  return stack->objects[stack->top--];
+  free(stack->objects);
+  stack->objects = NULL;
+  stack->capacity = 0;
+  stack->count = 0;
+  stack->top = -1;
+  return;
 }
 
-// Pushes new object on top of stack
-void push(Stack* stack, void* object)
+// Grows stack to hold at least slots more objects and returns false if memory could not be allocated
+bool grow_stack(Stack* stack, size_t slots)
 {
-  if(stack->top >= ((int)MAX_STACK_CAPACITY - 1))
+  size_t capacity = stack->capacity == 0 ? INITIAL_STACK_CAPACITY : stack->capacity;
+  void** objects = NULL;
+
+  while(capacity - stack->count < slots)
+    capacity *= 2;
+  objects = realloc(stack->objects, capacity * sizeof(void*));
+  if(objects == NULL)
   {
     fprintf(stderr, "Stack overflow occurred!\n");
-    return;
+    return false;
   }
-  stack->count++;
-  stack->objects[++stack->top] = object;
+  stack->objects = objects;
+  stack->capacity = capacity;
   if(debug_mode)
-    debug_print("push() called on stack for object of type %s. Stack now contains %zu objects.", get_data_type(stack->objects[stack->top]), stack->count);
-  return;
+    debug_print("Stack grown to %zu slots.", capacity);
+  return true;
 }
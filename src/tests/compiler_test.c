@@ -0,0 +1,1180 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>   // assert()
+#include <stdbool.h>  // bool, false, true
+#include <stdio.h>    // FILE, fclose(), fopen(), fread(), remove(), rewind(), snprintf(), sprintf(), tmpfile()
+#include <stdlib.h>   // EXIT_FAILURE, EXIT_SUCCESS, free(), getenv(), malloc(), system()
+#include <string.h>   // memset(), strcmp(), strstr()
+#ifndef _WIN32
+#include <sys/wait.h> // WEXITSTATUS(), WIFEXITED()
+#endif // _WIN32
+#include "char_stream.h"
+#include "compiler.h" // compile(), inline_mode, register_mode
+#include "concoct.h"  // UNUSED()
+#include "hash_map.h"
+#include "ir.h"       // ir_mode
+#include "lexer.h"
+#include "memory.h"   // get_store_used_slots(), new_object()
+#include "parser.h"
+#include "peephole.h"   // fusion_mode, peephole_mode
+#include "vm/aot.h"
+#include "vm/chunk.h"
+#include "vm/jit.h"
+#include "vm/profile.h"  // get_operation_counts(), profile_mode, stack_traffic, traffic_mode
+#include "vm/verifier.h"
+#include "vm/vm.h"
+
+// Files of the program built by the AOT executable test (in the working directory)
+#define AOT_TEST_NAME "compiler_test_aot"
+#ifdef _WIN32
+#define EXECUTABLE_SUFFIX ".exe"
+#define NULL_DEVICE "NUL"
+#define PATH_SEPARATOR "\\"
+#else
+#define EXECUTABLE_SUFFIX ""
+#define NULL_DEVICE "/dev/null"
+#define PATH_SEPARATOR "/"
+#endif // _WIN32
+
+// Compiles source into chunk
+bool compile_source(const char* source, Chunk* chunk)
+{
+  ConcoctCharStream* char_stream = cct_new_string_char_stream(source);
+  ConcoctLexer* lexer = cct_new_lexer(char_stream);
+  ConcoctParser* parser = cct_new_parser(lexer);
+  ConcoctNodeTree* tree = cct_parse_program(parser);
+  bool compiled = false;
+
+  init_chunk(chunk);
+  compiled = parser->error == NULL && compile(tree, chunk);
+  assert(!compiled || chunk->is_verified); // compiler output always passes verification
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  return compiled;
+}
+
+// Compiles source into program
+bool compile_program_source(const char* source, Program* program)
+{
+  ConcoctCharStream* char_stream = cct_new_string_char_stream(source);
+  ConcoctLexer* lexer = cct_new_lexer(char_stream);
+  ConcoctParser* parser = cct_new_parser(lexer);
+  ConcoctNodeTree* tree = cct_parse_program(parser);
+  bool compiled = false;
+
+  init_program(program);
+  compiled = parser->error == NULL && compile_program(tree, program);
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  return compiled;
+}
+
+// Compiles and interprets source using map for identifier bindings
+bool run_source(const char* source, ConcoctHashMap* map)
+{
+  Chunk chunk;
+  bool passed = false;
+
+  if(compile_source(source, &chunk))
+    passed = interpret(&chunk, map) == RUN_SUCCESS;
+  free_chunk(&chunk);
+  return passed;
+}
+
+// Returns number bound to identifier
+Number get_number(const ConcoctHashMap* map, const char* name)
+{
+  Object* object = cct_hash_map_get(map, name);
+  assert(object != NULL && object->datatype == CCT_TYPE_NUMBER);
+  return object->value.numval;
+}
+
+void test_expressions(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Object* object = NULL;
+
+  assert(run_source("x = 5 + 3 * 2\ny = 10 - 3\nz = 2 ** 10\nq = 17 % 5\n", map));
+  assert(get_number(map, "x") == 11);
+  assert(get_number(map, "y") == 7);
+  assert(get_number(map, "z") == 1024);
+  assert(get_number(map, "q") == 2);
+
+  // Operands of non-commutative operators keep their source order
+  assert(run_source("d = 100 / 4 / 5\nw = (x - y * 3) * -2\n", map));
+  assert(get_number(map, "d") == 5);
+  assert(get_number(map, "w") == 20);
+  assert(run_source("func mix(a, b, c) {\n  t = a - b\n  return t / (c - a) - b % c * (a - c)\n}\nm = mix(2, 12, 7)\n", map));
+  assert(get_number(map, "m") == 23);
+
+  assert(run_source("s = 1\ns += 2\ns *= 3\ns -= 4\ns **= 2\n", map));
+  assert(get_number(map, "s") == 25);
+
+  assert(run_source("b = x > y\nt = \"con\" + \"coct\"\n", map));
+  object = cct_hash_map_get(map, "b");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == true);
+  object = cct_hash_map_get(map, "t");
+  assert(object != NULL && strcmp(object->value.strobj.strval, "concoct") == 0);
+  UNUSED(object);
+
+  // Runtime errors are reported instead of executing the rest of the program
+  assert(!run_source("u = undefined + 1\n", map));
+  assert(cct_hash_map_get(map, "u") == NULL);
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Branches and loops run inside a single interpret() call
+void test_control_flow(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+
+  assert(run_source("s = 0\ni = 0\nwhile i < 10 {\n  s += i\n  i += 1\n}\n", map));
+  assert(get_number(map, "s") == 45);
+  assert(get_number(map, "i") == 10);
+
+  // The loop body never runs when the condition is false up front, but a do-while body runs once
+  assert(run_source("a = 0\nwhile a > 0 { a = 7 }\nb = 0\ndo { b += 1 } while b < 0\n", map));
+  assert(get_number(map, "a") == 0);
+  assert(get_number(map, "b") == 1);
+
+  // if/else chains, with null, zero and "" as false conditions
+  assert(run_source("c = 1\nif null { c = 2 } else if 0 { c = 3 } else if \"\" { c = 4 } else { c = 5 }\n"
+                    "if 2.5 { d = 6 }\n", map));
+  assert(get_number(map, "c") == 5);
+  assert(get_number(map, "d") == 6);
+
+  // for-in counts up to its bound, and break and continue leave or skip iterations of the innermost loop
+  assert(run_source("t = 0\nfor j in 5 {\n  if j == 3 { continue }\n  t += j\n}\n"
+                    "n = 0\ndo {\n  n += 2\n  if n > 7 { break }\n} while true\n", map));
+  assert(get_number(map, "t") == 7);
+  assert(get_number(map, "j") == 5);
+  assert(get_number(map, "n") == 8);
+
+  // Nested loops and equality conditions between identifiers (OP_LOE/OP_LNE)
+  assert(run_source("p = 0\nfor x in 4 {\n  for y in x { p += y }\n}\nq = 1\nr = 6\nwhile q != r { q += 1 }\n"
+                    "u = 0\nv = 0\ndo {\n  u += 1\n  if u < 3 { v = u }\n} while u == v\n", map));
+  assert(get_number(map, "p") == 4);
+  assert(get_number(map, "q") == 6);
+  assert(get_number(map, "u") == 3);
+  // Loop bounds are hidden globals, which never reach the map
+  assert(cct_hash_map_get(map, "$for0") == NULL && cct_hash_map_get(map, "$for1") == NULL);
+
+  assert(!run_source("break\n", map));
+
+  // && and || skip their right operand once the left one decides the result, which is a shared Bool object
+  assert(run_source("e = false && undefined\nf = true || undefined\ng = 1 && \"x\"\nh = 0 || \"\"\n", map));
+  assert(cct_hash_map_get(map, "e") == vm.false_object);
+  assert(cct_hash_map_get(map, "f") == vm.true_object);
+  assert(cct_hash_map_get(map, "g") == vm.true_object);
+  assert(cct_hash_map_get(map, "h") == vm.false_object);
+  assert(!run_source("k = true && undefined\n", map));
+
+  // Conditions branch on each operand instead of computing a Bool
+  assert(run_source("m = 0\nw = 0\nwhile m < 10 && w != 4 {\n  m += 1\n  if m % 2 == 0 || m == 1 { w += 1 }\n}\n"
+                    "if m > 100 || w > 1 && !(m > 6) { z = 1 } else { z = 2 }\n", map));
+  assert(get_number(map, "m") == 6);
+  assert(get_number(map, "w") == 4);
+  assert(get_number(map, "z") == 1);
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Functions run on frames of the operand stack with their parameters and assigned identifiers in local slots
+void test_functions(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Object* object = NULL;
+  size_t frames = 0;
+  size_t objects = 0;
+
+  assert(run_source("func fib(n) {\n  if n < 2 { return n }\n  return fib(n - 1) + fib(n - 2)\n}\nf = fib(15)\n"
+                    "a = ack(2, 3)\n"
+                    "func ack(m, n) {\n  if m == 0 { return n + 1 }\n  if n == 0 { return ack(m - 1, 1) }\n"
+                    "  return ack(m - 1, ack(m, n - 1))\n}\n", map));
+  assert(get_number(map, "f") == 610);
+  assert(get_number(map, "a") == 9);
+
+  // Assignments inside a function bind locals, reads of other identifiers see globals, and falling off the end
+  // returns null
+  assert(run_source("g = 10\nt = 5\nfunc sum(k) {\n  t = 0\n  for i in k { t += i * g }\n  return t\n}\n"
+                    "func nothing() { t = 1 }\ns = sum(4)\nnothing()\nn = nothing()\n", map));
+  assert(get_number(map, "s") == 60);
+  assert(get_number(map, "t") == 5);
+  assert(cct_hash_map_get(map, "i") == NULL);
+  object = cct_hash_map_get(map, "n");
+  assert(object != NULL && object->datatype == CCT_TYPE_NIL);
+  UNUSED(object);
+
+  // The value of a final expression statement is returned, and other expression statements discard theirs
+  assert(run_source("func add(a, b) {\n  t = a\n  a + b\n}\nfunc half(x) {\n  x / 2\n  x\n}\n"
+                    "p = add(5, 3)\nq = half(6)\np * 2\n", map));
+  assert(get_number(map, "p") == 8 && get_number(map, "q") == 6);
+  assert(!run_source("func fails(x) {\n  x / 0\n  x\n}\nfails(1)\n", map));
+
+  // Deep recursion grows the frame stack and the operand stack
+  assert(run_source("func depth(d) {\n  if d == 0 { return 0 }\n  return 1 + depth(d - 1)\n}\nr = depth(5000)\n", map));
+  assert(get_number(map, "r") == 5000);
+
+  // Tail calls, returned or in the final expression, reuse the frame of the returning function, so tail recursion
+  // runs in constant space even across functions with different numbers of locals
+  frames = vm.frame_capacity;
+  objects = vm.sp->capacity;
+  assert(run_source("func total(k, acc) {\n  if k == 0 { return acc }\n  return total(k - 1, acc + 2)\n}\n"
+                    "func even(k) {\n  if k == 0 { return true }\n  return odd(k - 1)\n}\n"
+                    "func odd(k) {\n  m = k\n  if m == 0 { return false }\n  even(m - 1)\n}\n"
+                    "u = total(100000, 0)\nv = even(100001)\n", map));
+  assert(get_number(map, "u") == 200000);
+  object = cct_hash_map_get(map, "v");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == false);
+  assert(vm.frame_capacity == frames && vm.sp->capacity == objects);
+  UNUSED(frames);
+  UNUSED(objects);
+
+  // Calls are checked against the declarations at compile time, and a runtime error unwinds every frame
+  assert(!run_source("func one(x) { return x }\nb = one(1, 2)\n", map));
+  assert(!run_source("c = missing()\n", map));
+  assert(!run_source("return 1\n", map));
+  assert(!run_source("func twice() { return 1 }\nfunc twice() { return 2 }\n", map));
+  assert(!run_source("if true { func inner() { return 1 } }\n", map));
+  assert(!run_source("func bad(x) { return x + undefined }\ne = bad(1)\n", map));
+  assert(cct_hash_map_get(map, "e") == NULL && vm.frame_count == 0);
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Instructions specialize for the operand types they see and revert to the generic form on a type miss
+void test_quickening(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+  Object* object = NULL;
+
+  assert(compile_source("y = x + 1\nz = x * x\n", &chunk));
+  assert(chunk.code[3] == OP_ADDK && chunk.code[14] == OP_MUL);
+
+  assert(run_source("x = 6\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(chunk.code[3] == OP_ADDKN && chunk.code[14] == OP_MULN);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "y") == 7);
+  assert(get_number(map, "z") == 36);
+
+  // A decimal misses the number guards: the generic kernels compute the result and the instructions revert
+  assert(run_source("x = 1.5\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(chunk.code[3] == OP_ADDK && chunk.code[14] == OP_MUL);
+  object = cct_hash_map_get(map, "z");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 2.25);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(chunk.code[14] == OP_MULD);
+  UNUSED(object);
+
+  free_chunk(&chunk);
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Hot chunks run as native code, which deoptimizes to the interpreter when a type guard fails
+void test_jit(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Program program;
+  Chunk chunk;
+  Object* object = NULL;
+  size_t used = 0;
+
+  if(!jit_available())
+  {
+    cct_delete_hash_map(map);
+    return;
+  }
+  jit_mode = true;
+
+  // A loop moves to native code at a back-edge once the chunk is hot, even in a chunk that runs only once
+  assert(compile_source("s = 0\ni = 0\nwhile i < 2000 {\n  s += i * 2\n  i += 1\n}\nt = s > 9000 && i == 2000\n",
+                        &chunk));
+  assert(interpret(&chunk, map) == RUN_SUCCESS && chunk.native != NULL);
+  assert(get_number(map, "s") == 3998000);
+  object = cct_hash_map_get(map, "t");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == true);
+  free_chunk(&chunk);
+
+  // Programs run each chunk once. Calls leave the native code of the loop, which continues at the next back-edge.
+  inline_mode = false;
+  assert(compile_program_source("func f(x) { return x % 3 }\nn = 0\nfor i in 3000 { n += f(i) }\n", &program));
+  assert(run_program(&program, map) == RUN_SUCCESS && program.chunks[0]->native != NULL);
+  assert(get_number(map, "n") == 3000);
+  free_program(&program);
+  inline_mode = true;
+
+  // The number guards of the native code fail for a decimal and the interpreter finishes the run generically
+  jit_threshold = 2;
+  assert(compile_source("y = x + 1\nz = x * x\n", &chunk));
+  assert(run_source("x = 6\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS && interpret(&chunk, map) == RUN_SUCCESS);
+  assert(chunk.native != NULL && chunk.code[3] == OP_ADDKN);
+  assert(run_source("x = 1.5\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS && chunk.native == NULL && chunk.code[3] == OP_ADDK);
+  object = cct_hash_map_get(map, "z");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 2.25);
+  UNUSED(object);
+
+  // Runtime errors in native code are reported like interpreted ones
+  assert(run_source("x = \"text\"\n", map));
+  assert(interpret(&chunk, map) == RUN_ERROR);
+  free_chunk(&chunk);
+
+  // Native code computes results that never escape into scratch objects, like the lean loop
+  assert(compile_source("y = (x + 1) * (x - 1) + x\nb = x * 2 > x + 3\n", &chunk));
+  assert(run_source("x = 6\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS && interpret(&chunk, map) == RUN_SUCCESS && chunk.native != NULL);
+  used = get_store_used_slots();
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_store_used_slots() - used == 2);
+  assert(get_number(map, "y") == 41);
+  UNUSED(used);
+  free_chunk(&chunk);
+
+  jit_threshold = JIT_THRESHOLD;
+  jit_mode = false;
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Translates source to C in buffer and returns false if the program could not be translated
+bool translate_source(const char* source, char* buffer, size_t size)
+{
+  ConcoctCharStream* char_stream = cct_new_string_char_stream(source);
+  ConcoctLexer* lexer = cct_new_lexer(char_stream);
+  ConcoctParser* parser = cct_new_parser(lexer);
+  ConcoctNodeTree* tree = cct_parse_program(parser);
+  FILE* output = tmpfile();
+  Program program;
+  bool translated = false;
+  size_t length = 0;
+
+  assert(output != NULL);
+  init_program(&program);
+  assert(parser->error == NULL && compile_program(tree, &program));
+  translated = translate_program(&program, "test.cct", output);
+  rewind(output);
+  length = fread(buffer, 1, size - 1, output);
+  buffer[length] = '\0';
+  fclose(output);
+  free_program(&program);
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  return translated;
+}
+
+// Translates source to the C file path and returns false if it cannot be translated
+bool translate_source_file(const char* source, const char* path)
+{
+  ConcoctCharStream* char_stream = cct_new_string_char_stream(source);
+  ConcoctLexer* lexer = cct_new_lexer(char_stream);
+  ConcoctParser* parser = cct_new_parser(lexer);
+  ConcoctNodeTree* tree = cct_parse_program(parser);
+  FILE* output = fopen(path, "w");
+  Program program;
+  bool translated = false;
+
+  assert(output != NULL);
+  init_program(&program);
+  assert(parser->error == NULL && compile_program(tree, &program));
+  translated = translate_program(&program, "test.cct", output);
+  translated = fclose(output) == 0 && translated;
+  free_program(&program);
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  return translated;
+}
+
+// Returns true if the system C compiler (CC or cc) can be run
+bool has_c_compiler(void)
+{
+  const char* compiler = getenv("CC");
+  char command[256];
+
+  if(compiler == NULL || compiler[0] == '\0')
+    compiler = "cc";
+  snprintf(command, sizeof(command), "%s --version >" NULL_DEVICE " 2>&1", compiler);
+  return system(command) == 0;
+}
+
+// Runs executable with its standard error written to error_path and returns its exit status, or -1 if it did not
+// exit normally
+int run_executable(const char* executable, const char* error_path)
+{
+  char command[256];
+  int status = 0;
+
+  snprintf(command, sizeof(command), "." PATH_SEPARATOR "%s 2>%s", executable, error_path);
+  status = system(command);
+#ifdef _WIN32
+  return status;
+#else
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif // _WIN32
+}
+
+// Reads the file at path into buffer
+void read_file(const char* path, char* buffer, size_t size)
+{
+  FILE* file = fopen(path, "r");
+  size_t length = 0;
+
+  assert(file != NULL);
+  length = fread(buffer, 1, size - 1, file);
+  buffer[length] = '\0';
+  fclose(file);
+  return;
+}
+
+// Translated programs build with the runtime library and run like the interpreter
+void test_aot_executable(void)
+{
+  char output[256];
+
+  if(!has_c_compiler())
+  {
+    fprintf(stderr, "No C compiler found, skipping the AOT executable test.\n");
+    return;
+  }
+  // The loop has to compute the right sum or the division by zero fails the program
+  assert(translate_source_file("s = 0\ni = 0\nwhile i < 100 {\n  s += i * 2\n  i += 1\n}\nz = 0\n"
+                               "if s != 9900 {\n  s = 1 / z\n}\n", AOT_TEST_NAME ".c"));
+  assert(build_executable(AOT_TEST_NAME ".c", AOT_TEST_NAME EXECUTABLE_SUFFIX));
+  assert(run_executable(AOT_TEST_NAME EXECUTABLE_SUFFIX, AOT_TEST_NAME ".err") == EXIT_SUCCESS);
+  read_file(AOT_TEST_NAME ".err", output, sizeof(output));
+  assert(output[0] == '\0');
+
+  // Runtime errors are reported with their line and fail the program
+  assert(translate_source_file("n = 5\nd = n - 5\nr = 10 / d\n", AOT_TEST_NAME ".c"));
+  assert(build_executable(AOT_TEST_NAME ".c", AOT_TEST_NAME EXECUTABLE_SUFFIX));
+  assert(run_executable(AOT_TEST_NAME EXECUTABLE_SUFFIX, AOT_TEST_NAME ".err") == EXIT_FAILURE);
+  read_file(AOT_TEST_NAME ".err", output, sizeof(output));
+  assert(strstr(output, "Runtime error on line 3!") != NULL);
+
+  remove(AOT_TEST_NAME ".c");
+  remove(AOT_TEST_NAME EXECUTABLE_SUFFIX);
+  remove(AOT_TEST_NAME ".err");
+  return;
+}
+
+// Ahead-of-time translation keeps typed straight-line values in C locals and calls the runtime for the rest
+void test_aot(void)
+{
+  const size_t size = 65536;
+  char* buffer = malloc(size);
+
+  assert(buffer != NULL);
+  folding_mode = false; // folding would leave only constants
+  assert(translate_source("a = 1.5\nb = a * 2.0 + 0.25\nc = b > 3.0\n", buffer, size));
+  assert(strstr(buffer, "const Decimal") != NULL && strstr(buffer, "aot_box_decimal(") != NULL);
+  assert(strstr(buffer, "int main(") != NULL);
+  folding_mode = true;
+
+  // Loop bodies start from boxed globals and use the guarded runtime kernels
+  assert(translate_source("s = 0\ni = 0\nwhile i < 100 {\n  s += i * 2\n  i += 1\n}\n", buffer, size));
+  assert(strstr(buffer, "goto L") != NULL && strstr(buffer, "aot_constant_binary(") != NULL);
+
+  // Functions become C functions and self tail calls become jumps
+  assert(translate_source("func total(k, acc) {\n  if k == 0 {\n    return acc\n  }\n"
+                          "  return total(k - 1, acc + 2)\n}\n"
+                          "t = total(10, 0)\n", buffer, size));
+  assert(strstr(buffer, "static bool function_0_") != NULL && strstr(buffer, "aot_tail_call(") != NULL);
+
+  // Register-form instructions are not translated
+  register_mode = true;
+  assert(!translate_source("b = a + 2\n", buffer, size));
+  register_mode = false;
+
+  free(buffer);
+  return;
+}
+
+// Mixed operands promote to the larger numeric type and invalid combinations are rejected
+void test_promotion(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Object* object = NULL;
+
+  assert(run_source("a = 7 / 2\nb = 7 / 2.0\nc = 7.9 % 3\nd = 1 << 4\ne = 6 & 3.5\n", map));
+  assert(get_number(map, "a") == 3);
+  object = cct_hash_map_get(map, "b");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 3.5);
+  object = cct_hash_map_get(map, "c");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 1.0);
+  assert(get_number(map, "d") == 16);
+  object = cct_hash_map_get(map, "e");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 2.0);
+
+  assert(run_source("f = 2.5 >= 2\ng = \"ab\" * 3\nh = 0 * \"ab\"\nn = \"1\" + \"2\"\ni = \"abc\" == \"abc\"\n", map));
+  object = cct_hash_map_get(map, "f");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == true);
+  object = cct_hash_map_get(map, "g");
+  assert(object != NULL && strcmp(object->value.strobj.strval, "ababab") == 0);
+  object = cct_hash_map_get(map, "h");
+  assert(object != NULL && strcmp(object->value.strobj.strval, "") == 0);
+  object = cct_hash_map_get(map, "n");
+  assert(object != NULL && object->datatype == CCT_TYPE_STRING && strcmp(object->value.strobj.strval, "12") == 0);
+  object = cct_hash_map_get(map, "i");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == true);
+  UNUSED(object);
+
+  assert(!run_source("j = 5 % 0\n", map));
+  assert(!run_source("k = 1 + true\n", map));
+  assert(!run_source("l = \"ab\" - 1\n", map));
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Integer results that overflow their type widen instead of wrapping
+void test_widening(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+  Object* object = NULL;
+
+  assert(run_source("a = 2147483646 + 2\nb = 3 ** 4\nc = 2 ** 62\nd = 2 ** 64\ne = 2 ** -1\n", map));
+  object = cct_hash_map_get(map, "a");
+  assert(object != NULL && object->datatype == CCT_TYPE_BIGNUM && object->value.bignumval == 2147483648);
+  assert(get_number(map, "b") == 81);
+  object = cct_hash_map_get(map, "c");
+  assert(object != NULL && object->datatype == CCT_TYPE_BIGNUM && object->value.bignumval == (BigNum)1 << 62);
+  object = cct_hash_map_get(map, "d");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 18446744073709551616.0);
+  object = cct_hash_map_get(map, "e");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 0.5);
+
+  assert(run_source("f = c * 4\ng = -2147483646 - 3\n", map));
+  object = cct_hash_map_get(map, "f");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 18446744073709551616.0);
+  object = cct_hash_map_get(map, "g");
+  assert(object != NULL && object->datatype == CCT_TYPE_BIGNUM && object->value.bignumval == -2147483649);
+
+  // Quickened number kernels widen as well
+  assert(run_source("x = 65536\n", map));
+  assert(compile_source("y = x * x\n", &chunk));
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  // A chunk compiled to native code on its first run keeps the generic form
+  assert(chunk.code[5] == OP_MULN || (jit_mode && chunk.native != NULL && chunk.code[5] == OP_MUL));
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  object = cct_hash_map_get(map, "y");
+  assert(object != NULL && object->datatype == CCT_TYPE_BIGNUM && object->value.bignumval == 4294967296);
+  UNUSED(object);
+
+  free_chunk(&chunk);
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Returns number of instructions with opcode oc in chunk
+size_t count_opcode(const Chunk* chunk, Opcode oc)
+{
+  size_t count = 0;
+
+  for(size_t offset = 0; offset < chunk->count; offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+  {
+    if(chunk->code[offset] == oc)
+      count++;
+  }
+  return count;
+}
+
+// Operations on constants are computed by the compiler, which also propagates globals holding a constant
+void test_folding(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+  Object* object = NULL;
+
+  assert(compile_source("x = 60 * 60 * 24\ny = x / 8 + 0.5\n", &chunk));
+  assert(chunk.code[0] == OP_SETK && chunk.code[5] == OP_SETK && chunk.constant_count == 2);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "x") == 86400);
+  object = cct_hash_map_get(map, "y");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 10800.5);
+  free_chunk(&chunk);
+
+  // Operations that fail are left to the instruction, which reports the error on its own line
+  assert(compile_source("a = 1\n\nb = a / 0\n", &chunk));
+  assert(chunk.code[5] == OP_PSH && chunk.code[8] == OP_DIVK && chunk.lines[8] == 3);
+  assert(interpret(&chunk, map) == RUN_ERROR);
+  free_chunk(&chunk);
+  assert(compile_source("c = 1 << 100000000000\n", &chunk) && count_opcode(&chunk, OP_SETK) == 0);
+  assert(interpret(&chunk, map) == RUN_ERROR);
+  free_chunk(&chunk);
+  assert(!run_source("d = 8 >> (a - 2)\n", map) && cct_hash_map_get(map, "d") == NULL);
+  assert(run_source("e = 8 >> (a + 1)\n", map) && get_number(map, "e") == 2);
+
+  // Long strings are built by the instruction when it runs instead of at compile time
+  assert(compile_source("f = \"ab\" * 3\ng = \"ab\" * 3000\nh = 0\nif h > 1 { h = \"abcdefgh\" * 200000000 }\n",
+                        &chunk));
+  assert(chunk.code[0] == OP_SETK && count_opcode(&chunk, OP_SETK) == 2);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  object = cct_hash_map_get(map, "g");
+  assert(object != NULL && object->datatype == CCT_TYPE_STRING && object->value.strobj.length == 6000);
+  free_chunk(&chunk);
+
+  // Globals assigned again by a later statement are only known up to it
+  assert(run_source("n = 1\nm = n + 1\nwhile n < 5 { n += m }\nr = n * 2\n", map));
+  assert(get_number(map, "m") == 2 && get_number(map, "r") == 10);
+  assert(!run_source("t = 2 > 1 && s\n", map));
+  assert(run_source("s = 0\nt = 2 > 1 && s\nu = !(2 > 1) || 3\n", map));
+  assert(cct_hash_map_get(map, "t") == vm.false_object && cct_hash_map_get(map, "u") == vm.true_object);
+
+  // Register-form operands fold into a single RK constant
+  register_mode = true;
+  assert(compile_source("z = 2 * 3 + w\n", &chunk));
+  assert(chunk.code[0] == OP_RGET && chunk.code[4] == OP_RADD && chunk.code[6] == REGISTER_AMOUNT);
+  free_chunk(&chunk);
+  register_mode = false;
+
+  UNUSED(object);
+  cct_delete_hash_map(map);
+  return;
+}
+
+// The peephole optimizer removes redundant instructions and code no path reaches
+void test_peephole(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Object* object = NULL;
+  Chunk chunk;
+
+  // Constant loop conditions and jumps to jumps leave a single loop instruction
+  assert(compile_source("n = 0\nwhile true {\n  n += 1\n  if !(n < 3) { break }\n  continue\n}\n"
+                        "if false { q = 1 }\nc = !(!(n > 1))\n", &chunk));
+  assert(count_opcode(&chunk, OP_NOT) == 0 && count_opcode(&chunk, OP_JMP) == 0 && count_opcode(&chunk, OP_PSH) == 0);
+  assert(count_opcode(&chunk, OP_LLTK) == 1 && count_opcode(&chunk, OP_SETK) == 1);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "n") == 3 && cct_hash_map_get(map, "q") == NULL);
+  free_chunk(&chunk);
+
+  // Code after return is unreachable, including the implicit return at the end of the function
+  assert(compile_source("func f(x) {\n  if x > 1 {\n    return x\n  } else {\n    return 0\n  }\n  x = 5\n}\n"
+                        "y = f(4)\nz = f(1)\n", &chunk));
+  assert(count_opcode(&chunk, OP_RET) == 2 && count_opcode(&chunk, OP_STL) == 0 && count_opcode(&chunk, OP_JMP) == 0);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "y") == 4 && get_number(map, "z") == 0);
+  free_chunk(&chunk);
+
+  // Errors are still reported by the instructions that remain
+  assert(!run_source("a = 0\nwhile true {\n  a += 1\n  if a > 2 { b = a / 0 }\n}\n", map));
+
+  // Comparisons with a constant fuse with the jump that tests them, for any type OP_LT accepts
+  assert(compile_source("i = 0\nd = 0.5\nwhile i < 10 { i += 1 }\nwhile d < 2.0 { d *= 2.0 }\nif i < 5 { i = 0 }\n",
+                        &chunk));
+  assert(count_opcode(&chunk, OP_LLTK) == 2 && count_opcode(&chunk, OP_JNLK) == 1 && count_opcode(&chunk, OP_LT) == 0);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  object = cct_hash_map_get(map, "d");
+  assert(get_number(map, "i") == 10 && object != NULL && object->value.decimalval == 2.0);
+  free_chunk(&chunk);
+  assert(!run_source("s = \"a\"\nwhile s < 3 { s = 1 }\n", map));
+
+  UNUSED(object);
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Calls of small leaf functions compile to the expression they return, which then folds like any other
+void test_inlining(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+
+  assert(compile_source("func add(a, b) { return a + b }\nx = 5\ny = add(x, 3)\nz = add(add(x, 1), add(2, y))\n", &chunk));
+  assert(count_opcode(&chunk, OP_CAL) == 0 && count_opcode(&chunk, OP_SETK) == 3);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "y") == 8 && get_number(map, "z") == 16);
+  free_chunk(&chunk);
+
+  // Arguments are evaluated once, parameters never read their caller's locals and recursion stays a call
+  assert(compile_source("func sq(n) { return n * n }\nfunc f(k) { return sq(k + 1) + sq(k) }\n"
+                        "func g(a) { return a + t }\nfunc h(t) { return g(1) }\n"
+                        "func fib(n) {\n  if n < 2 { return n }\n  return fib(n - 1) + fib(n - 2)\n}\n"
+                        "t = 10\nu = f(2)\nv = h(0)\nw = fib(10)\n", &chunk));
+  assert(count_opcode(&chunk, OP_CAL) == 6 && count_opcode(&chunk, OP_TCL) == 1);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "u") == 13 && get_number(map, "v") == 11 && get_number(map, "w") == 55);
+  free_chunk(&chunk);
+
+  // Arguments that can fail keep reporting their errors first and from left to right
+  assert(compile_source("func sub(a, b) { return b - a }\nfunc add(a, b) { return a + b }\n"
+                        "func sq(n) { return n * n }\nq = sub(x + \"s\", y / 0)\nr = add(sq(t), t / 2)\n", &chunk));
+  assert(count_opcode(&chunk, OP_CAL) == 1 && count_opcode(&chunk, OP_SUB) == 1 && count_opcode(&chunk, OP_MUL) == 2);
+  free_chunk(&chunk);
+
+  inline_mode = false;
+  assert(compile_source("func add(a, b) { return a + b }\ny = add(1, 2)\n", &chunk));
+  assert(count_opcode(&chunk, OP_CAL) == 1);
+  free_chunk(&chunk);
+  inline_mode = true;
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// -O2 optimizes through the SSA intermediate representation without changing results or errors
+void test_ir(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Object* object = NULL;
+  Chunk chunk;
+  size_t loop = 0;
+  size_t product = 0;
+
+  ir_mode = true;
+
+  // Common subexpressions are computed once and kept in a temporary local
+  assert(compile_source("func f(a, b) {\n  return (a * b + 1) * (a * b + 2)\n}\nx = f(3, 4)\n", &chunk));
+  assert(count_opcode(&chunk, OP_MUL) == 2 && chunk.functions[0].local_count == 3);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "x") == 182);
+  free_chunk(&chunk);
+
+  // Loop-invariant operations run once before the loop, and locals known to hold a constant fold away with their
+  // stores
+  assert(compile_source("func g(n, k) {\n  s = 0\n  i = 0\n  while i < n {\n    s += k * k\n    i += 1\n  }\n"
+                        "  return s\n}\ny = g(10, 3)\nfunc h(a) {\n  k = 8\n  return a * (k * 4)\n}\nz = h(2)\n",
+                        &chunk));
+  for(size_t offset = 0; offset < chunk.count; offset += 1 + get_operand_length((Opcode)chunk.code[offset]))
+  {
+    if(chunk.code[offset] == OP_LNZ)
+      loop = get_jump_target(&chunk, offset);
+    if(chunk.code[offset] == OP_MUL && product == 0)
+      product = offset;
+  }
+  assert(product != 0 && product < loop && count_opcode(&chunk, OP_MUL) == 1 && count_opcode(&chunk, OP_STL) == 5);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_number(map, "y") == 90 && get_number(map, "z") == 64);
+  free_chunk(&chunk);
+  UNUSED(loop);
+  UNUSED(product);
+
+  // Hoisted operations only run if the loop body does, and errors stay in source order
+  assert(run_source("z = 0\nw = 1\nwhile w < 0 { w = 5 / z }\nfor i in z { w = 5 / z }\n", map));
+  assert(get_number(map, "w") == 1);
+  assert(!run_source("func e(n) {\n  t = 0\n  for i in n { t += undefined + n * 2 }\n  return t\n}\nv = e(3)\n", map));
+  assert(cct_hash_map_get(map, "v") == NULL);
+
+  // Temporaries of the main program are hidden globals, and the value joined by && stays on the stack
+  assert(run_source("a = 3\nb = 4\nq = 0\nfor i in 10 { q += a * b + a * b / 2 }\nc = q > 5 && q < 500\n", map));
+  assert(get_number(map, "q") == 180 && cct_hash_map_get(map, "c") == vm.true_object);
+  assert(run_source("m = q\nwhile m > 100 { m -= 7 }\np = (m * q + 1) * (m * q + 2)\n", map));
+  assert(get_number(map, "p") == 298650242 && cct_hash_map_get(map, "$ir0") == NULL);
+
+  // Operations on operands of proven types are emitted quickened. A local read where it may not be assigned yet can
+  // still be null, so operations on it stay generic.
+  assert(compile_source("func f(n) {\n  x = 1.5\n  for i in n { x = x * 0.5 + x }\n  return x\n}\nr = f(3)\n"
+                        "func g(n) {\n  if n > 0 { y = 2.0 }\n  return y * 2.0\n}\nt = g(1)\n", &chunk));
+  assert(count_opcode(&chunk, OP_MULKD) == 1 && count_opcode(&chunk, OP_ADDD) == 1);
+  assert(count_opcode(&chunk, OP_MULK) == 1 && count_opcode(&chunk, OP_LT) == 2);
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  object = cct_hash_map_get(map, "r");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 5.0625);
+  object = cct_hash_map_get(map, "t");
+  assert(object != NULL && object->datatype == CCT_TYPE_DECIMAL && object->value.decimalval == 4.0);
+  free_chunk(&chunk);
+  UNUSED(object);
+
+  ir_mode = false;
+  cct_delete_hash_map(map);
+  return;
+}
+
+// The verifier accepts compiled code, records its stack depth and rejects malformed code, which still runs checked
+void test_verification(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+  Chunk other;
+  uint16_t constant = 0;
+  uint16_t slot = 0;
+
+  assert(compile_source("v = a + (b * (c - 4))\n", &chunk));
+  assert(chunk.max_stack == (fusion_mode ? 3 : 4));
+  free_chunk(&chunk);
+
+  // Unbalanced stack
+  init_chunk(&chunk);
+  constant = add_constant(&chunk, new_object("1"));
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, constant, 1);
+  write_opcode(&chunk, OP_END, 1);
+  assert(!verify_chunk(&chunk));
+  free_chunk(&chunk);
+
+  // Stack underflow: runs on the checked loop and fails instead of reading below the stack
+  init_chunk(&chunk);
+  constant = add_constant(&chunk, new_object("1"));
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, constant, 1);
+  write_opcode(&chunk, OP_ADD, 1);
+  write_opcode(&chunk, OP_POP, 1);
+  write_opcode(&chunk, OP_END, 1);
+  assert(!verify_chunk(&chunk));
+  assert(interpret(&chunk, map) == RUN_ERROR);
+  free_chunk(&chunk);
+
+  // Constant index outside the pool, truncated operands and a missing OP_END
+  init_chunk(&chunk);
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, 7, 1);
+  write_opcode(&chunk, OP_POP, 1);
+  write_opcode(&chunk, OP_END, 1);
+  assert(!verify_chunk(&chunk));
+  chunk.count = 2;
+  assert(!verify_chunk(&chunk));
+  free_chunk(&chunk);
+  init_chunk(&chunk);
+  write_opcode(&chunk, OP_NOP, 1);
+  assert(!verify_chunk(&chunk));
+  free_chunk(&chunk);
+
+  // Jumps must land on an instruction start inside the chunk with the same stack depth on every path
+  init_chunk(&chunk);
+  constant = add_constant(&chunk, new_object("1"));
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, constant, 1);
+  write_opcode(&chunk, OP_JMZ, 1);
+  write_short(&chunk, 0, 1);
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, constant, 1);
+  write_opcode(&chunk, OP_POP, 1);
+  write_opcode(&chunk, OP_END, 1);
+  assert(verify_chunk(&chunk) && chunk.max_stack == 1);
+  chunk.code[4] = 1; // into the operands of PSH
+  assert(!verify_chunk(&chunk));
+  chunk.code[4] = 3; // to POP with an empty stack
+  assert(!verify_chunk(&chunk));
+  chunk.code[3] = OP_LOP;
+  chunk.code[4] = 7; // before the start of the chunk
+  assert(!verify_chunk(&chunk));
+  assert(interpret(&chunk, map) == RUN_ERROR);
+  free_chunk(&chunk);
+
+  // Globals resolve to one slot shared by every chunk and only slots bound by the chunk are accepted
+  init_chunk(&chunk);
+  init_chunk(&other);
+  slot = bind_global(&chunk, "g");
+  assert(bind_global(&other, "g") == slot && chunk.global_count == 1);
+  constant = add_constant(&chunk, new_object("1"));
+  write_opcode(&chunk, OP_PSH, 1);
+  write_short(&chunk, constant, 1);
+  write_opcode(&chunk, OP_ASN, 1);
+  write_short(&chunk, slot, 1);
+  write_opcode(&chunk, OP_GET, 1);
+  write_short(&chunk, slot, 1);
+  write_opcode(&chunk, OP_POP, 1);
+  write_opcode(&chunk, OP_END, 1);
+  assert(verify_chunk(&chunk));
+  assert(interpret(&chunk, map) == RUN_SUCCESS && get_number(map, "g") == 1);
+  assert(bind_global(&other, "g2") != slot);
+  chunk.code[7] = (Byte)(vm.global_count - 1); // GET of a slot the chunk never bound
+  chunk.code[8] = (Byte)((vm.global_count - 1) >> 8);
+  assert(!verify_chunk(&chunk));
+  free_chunk(&other);
+  free_chunk(&chunk);
+
+  // Locals stay inside the frame of their function and only functions return
+  assert(compile_source("func f(a, b) {\n  c = a\n  return c + b\n}\nx = f(1, 2)\n", &chunk));
+  assert(chunk.function_count == 1 && chunk.functions[0].local_count == 3);
+  assert(chunk.functions[0].max_stack == 5);
+  assert(chunk.code[chunk.functions[0].entry] == OP_ENT && chunk.code[chunk.functions[0].entry + 1] == 1);
+  chunk.code[chunk.functions[0].entry + 3] = 3; // LDL past the last local
+  assert(!verify_chunk(&chunk));
+  chunk.code[chunk.functions[0].entry + 3] = 0;
+  assert(verify_chunk(&chunk));
+  chunk.code[chunk.functions[0].entry - 1] = OP_RET; // RET in place of OP_END of the main program
+  assert(!verify_chunk(&chunk));
+  free_chunk(&chunk);
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Results only read by the instruction that pops them are computed into scratch objects instead of the object store
+void test_escape(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  Chunk chunk;
+  Object* object = NULL;
+  size_t marked = 0;
+  size_t used = 0;
+
+  // Every operation but the two whose results are assigned
+  assert(compile_source("y = (x + 1) * (x - 1) + x\nb = x * 2 > x + 3\n", &chunk));
+  for(size_t offset = 0; offset < chunk.count; offset++)
+    marked += chunk.unescaped[offset] ? 1 : 0;
+  assert(marked == 5);
+
+  assert(run_source("x = 6\n", map));
+  assert(interpret(&chunk, map) == RUN_SUCCESS); // quickens
+  used = get_store_used_slots();
+  assert(interpret(&chunk, map) == RUN_SUCCESS);
+  assert(get_store_used_slots() - used == 2);
+  assert(get_number(map, "y") == 41);
+  object = cct_hash_map_get(map, "b");
+  assert(object != NULL && object->datatype == CCT_TYPE_BOOL && object->value.boolval == true);
+  UNUSED(object);
+  UNUSED(used);
+
+  free_chunk(&chunk);
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Runs source once on the profiling loop and returns the instructions it executed and their traffic
+OperationCounts profile_source(const char* source, ConcoctHashMap* map)
+{
+  OperationCounts counts;
+  bool ran = false;
+
+  profile_mode = true;
+  select_dispatch();
+  init_profile();
+  ran = run_source(source, map);
+  counts = get_operation_counts();
+  free_profile();
+  profile_mode = false;
+  select_dispatch();
+  assert(ran);
+  UNUSED(ran);
+  return counts;
+}
+
+// Runs source twice, the second time on the counting copy of the lean loop, and returns the stack traffic counted
+StackTraffic count_source_traffic(const char* source, ConcoctHashMap* map)
+{
+  Chunk chunk;
+  StackTraffic traffic;
+  bool ran = compile_source(source, &chunk) && interpret(&chunk, map) == RUN_SUCCESS; // quickens
+
+  memset(&stack_traffic, 0, sizeof(stack_traffic));
+  traffic_mode = true;
+  select_dispatch();
+  ran = ran && interpret(&chunk, map) == RUN_SUCCESS;
+  traffic = stack_traffic;
+  traffic_mode = false;
+  select_dispatch();
+  free_chunk(&chunk);
+  assert(ran);
+  UNUSED(ran);
+  return traffic;
+}
+
+// The profiling loop counts stack and memory traffic, which register instructions trade for loads and stores, and the
+// counting lean loop shows the pushes and pops that caching the top of the stack saves
+void test_profile(void)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  OperationCounts counts;
+  StackTraffic traffic;
+
+  assert(run_source("a = 6\nb = 7\n", map));
+  fusion_mode = false;
+  // GET a, GET b, MUL, GET a, ADD, ASN c, END
+  counts = profile_source("c = a * b + a\n", map);
+  assert(counts.instructions == 7 && counts.pushes == 5 && counts.pops == 5);
+  assert(counts.loads == 3 && counts.stores == 1);
+  register_mode = true;
+  // Three RGETs, RMUL and RADD each write a register, and RASN copies one to c
+  counts = profile_source("c = a * b + a\n", map);
+  assert(counts.instructions == 7 && counts.pushes == 0 && counts.pops == 0);
+  assert(counts.loads == 8 && counts.stores == 6);
+  register_mode = false;
+
+  // Caching the top of the stack leaves a and b in tos until the next load spills them
+  cache_mode = false;
+  traffic = count_source_traffic("c = a * b + a\n", map);
+  assert(traffic.pushes == 5 && traffic.pops == 5 && traffic.spills == 0);
+  cache_mode = true;
+  traffic = count_source_traffic("c = a * b + a\n", map);
+  assert(traffic.pushes == 2 && traffic.pops == 2 && traffic.spills == 2);
+  fusion_mode = true;
+  assert(get_number(map, "c") == 48);
+  UNUSED(counts);
+  UNUSED(traffic);
+
+  cct_delete_hash_map(map);
+  return;
+}
+
+// Programs larger than a module chunk compile into several chunks that run in order, deep expressions grow the stack
+// past its initial capacity and many distinct globals stay cheap to bind and verify
+void test_large_program(void)
+{
+  const size_t statements = 6000;
+  const size_t depth = 300;
+  const size_t globals = 30000;
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  ConcoctCharStream* char_stream = NULL;
+  ConcoctLexer* lexer = NULL;
+  ConcoctParser* parser = NULL;
+  ConcoctNodeTree* tree = NULL;
+  Program program;
+  char* source = malloc(statements * 16 + depth * 8 + 32);
+  size_t length = 0;
+
+  assert(source != NULL);
+  length += (size_t)sprintf(source + length, "n = 0\n");
+  for(size_t i = 1; i < statements; i++)
+    length += (size_t)sprintf(source + length, "n += %zu\n", i % 7);
+  length += (size_t)sprintf(source + length, "d = ");
+  for(size_t i = 0; i < depth; i++)
+    length += (size_t)sprintf(source + length, "1 + (");
+  length += (size_t)sprintf(source + length, "0");
+  for(size_t i = 0; i < depth; i++)
+    source[length++] = ')';
+  source[length++] = '\n';
+  source[length] = '\0';
+
+  char_stream = cct_new_string_char_stream(source);
+  lexer = cct_new_lexer(char_stream);
+  parser = cct_new_parser(lexer);
+  tree = cct_parse_program(parser);
+  init_program(&program);
+  assert(parser->error == NULL && compile_program(tree, &program));
+  assert(program.count > 1);
+  assert(run_program(&program, map) == RUN_SUCCESS);
+  assert(get_number(map, "n") == 17997);
+  assert(get_number(map, "d") == (Number)depth);
+
+  // A module that already ran can be unloaded without affecting the rest of the program
+  assert(unload_chunk(&program, 0));
+  assert(program.chunks[0] == NULL && run_program(&program, map) == RUN_SUCCESS);
+  free_program(&program);
+
+  // The first module holds the functions, so it stays loaded while later modules call them
+  length = (size_t)sprintf(source, "func inc(x) { return x + 1 }\nn = 0\n");
+  for(size_t i = 1; i < statements; i++)
+    length += (size_t)sprintf(source + length, "n += 1\n");
+  sprintf(source + length, "m = inc(n)\n");
+  inline_mode = false;
+  assert(compile_program_source(source, &program) && program.count > 1);
+  inline_mode = true;
+  assert(!unload_chunk(&program, 0) && program.chunks[0] != NULL);
+  assert(run_program(&program, map) == RUN_SUCCESS && get_number(map, "m") == (Number)statements);
+  for(size_t i = program.count - 1; i > 0; i--)
+    assert(unload_chunk(&program, i));
+  assert(unload_chunk(&program, 0));
+  free_program(&program);
+
+  // Later modules bind the globals of the first one, and neither that nor verification scans the globals of a chunk
+  free(source);
+  source = malloc(globals * 24 + 32);
+  assert(source != NULL);
+  length = 0;
+  for(size_t i = 0; i < globals; i++)
+    length += (size_t)sprintf(source + length, "wide%zu = %zu\n", i, i);
+  sprintf(source + length, "last = wide%zu + 1\n", globals - 1);
+  assert(compile_program_source(source, &program) && program.count > 1);
+  assert(program.chunks[program.count - 1]->global_count > program.chunks[0]->global_count);
+  assert(run_program(&program, map) == RUN_SUCCESS && get_number(map, "last") == (Number)globals);
+  free_program(&program);
+
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  free(source);
+  cct_delete_hash_map(map);
+  return;
+}
+
+int main(void)
+{
+  init_vm();
+  register_mode = false;
+  fusion_mode = false;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  folding_mode = false;
+  peephole_mode = false;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  folding_mode = true;
+  peephole_mode = true;
+  fusion_mode = true;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  register_mode = true;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  register_mode = false;
+  cache_mode = false;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  cache_mode = true;
+  jit_mode = true;
+  jit_threshold = 1;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  test_promotion();
+  test_widening();
+  jit_mode = false;
+  jit_threshold = JIT_THRESHOLD;
+  ir_mode = true;
+  test_expressions();
+  test_control_flow();
+  test_functions();
+  ir_mode = false;
+  test_quickening();
+  test_jit();
+  test_aot();
+  test_aot_executable();
+  test_folding();
+  test_peephole();
+  test_inlining();
+  test_ir();
+  test_promotion();
+  test_widening();
+  test_verification();
+  test_escape();
+  test_profile();
+  test_large_program();
+  stop_vm();
+
+  return 0;
+}
@@ -28,61 +28,81 @@
 #include "debug.h"
 #include "hash_map.h"
 #include "memory.h"
+#include "vm/chunk.h"
 #include "vm/vm.h"
 
+// Emits a push of constant object
+static void emit_push(Chunk* chunk, Object* object)
+{
+  write_opcode(chunk, OP_PSH, 1);
+  write_short(chunk, add_constant(chunk, object), 1);
+  return;
+}
+
 int main(void)
 {
-  Object* object = NULL;
+  Chunk chunk;
   void* vptr = NULL;
-  BigNum numval = -8675309;
+  uint16_t name = 0;
+  BigNum numval = -5552424;
   ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
   debug_mode = true;
   init_vm();
+  init_chunk(&chunk);
 
-  vm.instructions[14] = OP_XCG;
-  vm.instructions[13] = OP_LOD;
-  vm.instructions[12] = OP_STR;
-  vm.instructions[11] = OP_MOV;
+  emit_push(&chunk, new_object("5"));
+  emit_push(&chunk, new_object("2"));
+  write_opcode(&chunk, OP_POW, 1);
+  emit_push(&chunk, new_object("99"));
+  write_opcode(&chunk, OP_DEC, 1);
+  emit_push(&chunk, new_object("5"));
+  emit_push(&chunk, new_object("2"));
+  write_opcode(&chunk, OP_MUL, 1);
+  emit_push(&chunk, new_object("10"));
+  emit_push(&chunk, new_object("3"));
+  write_opcode(&chunk, OP_SUB, 1);
+  emit_push(&chunk, new_object("2"));
+  emit_push(&chunk, new_object("3"));
+  write_opcode(&chunk, OP_ADD, 1);
+  write_opcode(&chunk, OP_NOP, 1);
+  emit_push(&chunk, new_object("35.5"));
+  write_opcode(&chunk, OP_NEG, 1);
+  emit_push(&chunk, new_object("true"));
+  emit_push(&chunk, new_object("true"));
+  write_opcode(&chunk, OP_AND, 1);
+  emit_push(&chunk, new_object("32"));
+  emit_push(&chunk, new_object("8"));
+  write_opcode(&chunk, OP_XOR, 1);
   vptr = &numval;
-  object = new_object_by_type(vptr, CCT_TYPE_BIGNUM);
-  vm.rp[R1] = object;
-  vm.rp[RS] = object;
-  vm.instructions[10] = OP_RET;
-  numval = -5552424;
-  vptr = &numval;
-  push(vm.sp, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-  vm.instructions[9] = OP_BNT;
-  push(vm.sp, new_object("217"));
-  push(vm.sp, new_object("107"));
-  push(vm.sp, new_object("32"));
-  vm.instructions[8] = OP_XOR;
-  push(vm.sp, new_object("32"));
-  push(vm.sp, new_object("8"));
-  vm.instructions[7] = OP_AND;
-  push(vm.sp, new_object("true"));
-  push(vm.sp, new_object("true"));
-  vm.instructions[6] = OP_NEG;
-  push(vm.sp, new_object("35.5"));
-  vm.instructions[5] = OP_NOP;
-  vm.instructions[4] = OP_ADD;
-  push(vm.sp, new_object("2"));
-  push(vm.sp, new_object("3"));
-  vm.instructions[3] = OP_SUB;
-  push(vm.sp, new_object("10"));
-  push(vm.sp, new_object("3"));
-  vm.instructions[2] = OP_MUL;
-  push(vm.sp, new_object("5"));
-  push(vm.sp, new_object("2"));
-  vm.instructions[1] = OP_DEC;
-  push(vm.sp, new_object("99"));
-  vm.instructions[0] = OP_POW;
-  push(vm.sp, new_object("5"));
-  push(vm.sp, new_object("2"));
-  vm.instructions[15] = OP_CLR;
-  vm.instructions[16] = OP_CLS;
-  vm.instructions[17] = OP_END;
+  emit_push(&chunk, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
+  write_opcode(&chunk, OP_BNT, 1);
+
+  // Register operations: R1 = top of stack, RS = R1, swap R1 and R2, then push RS back
+  write_opcode(&chunk, OP_LOD, 2);
+  write_chunk(&chunk, R1, 2);
+  write_opcode(&chunk, OP_MOV, 2);
+  write_chunk(&chunk, RS, 2);
+  write_chunk(&chunk, R1, 2);
+  write_opcode(&chunk, OP_XCG, 2);
+  write_chunk(&chunk, R1, 2);
+  write_chunk(&chunk, R2, 2);
+  write_opcode(&chunk, OP_STR, 2);
+  write_chunk(&chunk, RS, 2);
+
+  // Bind the top of the stack to a global and read it back
+  name = bind_global(&chunk, "answer");
+  write_opcode(&chunk, OP_ASN, 3);
+  write_short(&chunk, name, 3);
+  write_opcode(&chunk, OP_GET, 3);
+  write_short(&chunk, name, 3);
+  write_opcode(&chunk, OP_CLR, 4);
+  write_opcode(&chunk, OP_CLS, 4);
+  write_opcode(&chunk, OP_END, 4);
+  print_chunk(&chunk, "interpret test");
 
-  interpret(map);
+  if(interpret(&chunk, map) != RUN_SUCCESS)
+    return 1;
+  free_chunk(&chunk);
   cct_delete_hash_map(map);
   stop_vm();
 
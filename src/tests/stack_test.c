@@ -465,10 +465,10 @@ int main(void)
   print_object_value(pop(pstack));
 
   puts("\nTesting string object addition of: \"Greetings, \" + \"Concocter!\"");
-  object = new_object("Concocter!");
-  push(pstack, object);
   object = new_object("Greetings, ");
   push(pstack, object);
+  object = new_object("Concocter!");
+  push(pstack, object);
   op_add(pstack);
   puts("Result:");
   print_object_value(pop(pstack));
@@ -485,6 +485,17 @@ int main(void)
   puts("Executing NOP...");
   OP_NOOP;
 
+  puts("\nGrowing stack past its initial capacity...");
+  if(!reserve_stack(pstack, INITIAL_STACK_CAPACITY * 4))
+    return 1;
+  for(size_t i = 0; i < INITIAL_STACK_CAPACITY * 4; i++)
+    push(pstack, object);
+  printf("Stack holds %zu objects in %zu slots.\n", pstack->count, pstack->capacity);
+  if(pstack->count != INITIAL_STACK_CAPACITY * 4 || peek(pstack) != object)
+    return 1;
+  op_cls(pstack);
+
+  free_stack(pstack);
   free_store();
 
   return 0;
@@ -0,0 +1,283 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>   // bool, false, true
+#include <stdio.h>     // printf()
+#include <string.h>    // memset()
+#include "char_stream.h"
+#include "compiler.h"  // compile(), folding_mode, register_mode
+#include "hash_map.h"
+#include "ir.h"        // ir_mode
+#include "lexer.h"
+#include "memory.h"    // collect_garbage()
+#include "parser.h"
+#include "peephole.h"    // fusion_mode
+#include "seconds.h"   // gettimeofday(), microdelta()
+#include "vm/chunk.h"
+#include "vm/jit.h"     // jit_available(), jit_mode
+#include "vm/profile.h" // get_operation_counts(), profile_mode, stack_traffic, traffic_mode
+#include "vm/vm.h"      // select_dispatch()
+
+// Number of times each program (or loop iteration) runs per round and number of rounds (fastest round is reported)
+static const size_t BENCHMARK_ITERATIONS = 20000;
+static const size_t BENCHMARK_ROUNDS = 5;
+
+typedef struct benchmark
+{
+  const char* name;
+  const char* source;
+  size_t iterations; // loop iterations or calls per run of source (1 for straight-line code)
+} Benchmark;
+
+typedef struct execution_mode
+{
+  const char* name;
+  bool use_registers;  // register_mode
+  bool use_fusion;     // fusion_mode
+  bool use_quickening; // quicken_mode
+  bool use_caching;    // cache_mode
+  bool use_jit;        // jit_mode (skipped where native code is unavailable)
+  bool use_ir;         // ir_mode
+} ExecutionMode;
+
+// Instruction forms compared for each program
+static const ExecutionMode modes[] =
+{
+  { "stack",     false, false, false, false, false, false },
+  { "fused",     false, true,  false, false, false, false },
+  { "register",  true,  false, false, false, false, false },
+  { "quickened", false, true,  true,  false, false, false },
+  { "cached",    false, true,  true,  true,  false, false },
+  { "ssa",       false, true,  true,  true,  false, true },
+  { "jit",       false, true,  true,  true,  true,  false }
+};
+
+// Expression-heavy programs followed by loops, whose times are per iteration, and recursive functions, whose times
+// are per call (each must fit in a single chunk)
+static const Benchmark benchmarks[] =
+{
+  { "arithmetic", "a = 3\nb = 4\nc = a * a + b * b - (a + b) * 2\n", 1 },
+  { "polynomial", "x = 7\ny = x * x * x + 2 * x * x - 5 * x + 1\n", 1 },
+  { "comparison", "i = 10\nj = 20\nk = i * 2 == j\nm = i + j > j - i\n", 1 },
+  { "compound",   "s = 1\ns += 2\ns *= 3\ns -= 4\ns /= 5\n", 1 },
+  { "decimal",    "r = 2.5\narea = 3.14159 * r * r\nc = 2.0 * 3.14159 * r\n", 1 },
+  { "integer",    "n = 12\nm = n * 3 - 7\nk = m * m + n * 2 - 1\nt = k > m\nu = k - m * 4 <= n\n", 1 },
+  { "power",      "b = 3\np = b ** 13 + 2 ** 40 - b ** 2\n", 1 },
+  { "guards",     "a = 5\nb = 0\nv = a < 0 || a > 9 || b != 0\nw = a > 0 && b == 0 && (a < 9 || b > 9)\n", 1 },
+  { "while",      "i = 0\ns = 0\nwhile i < 1000 {\n  s += i\n  i += 1\n}\n", 1000 },
+  { "do-while",   "i = 1000\ndo { i -= 1 } while i\n", 1000 },
+  { "for-in",     "s = 0\nfor i in 1000 { s += i * 2 }\n", 1000 },
+  { "branch",     "e = 0\no = 0\nfor i in 1000 {\n  if i % 2 == 0 { e += 1 } else { o += 1 }\n}\n", 1000 },
+  { "nested",     "s = 0\nfor i in 40 {\n  for j in 25 { s += j }\n}\n", 1000 },
+  { "invariant",  "func f(n, k) {\n  s = 0\n  for i in n { s += (k * 3 + 1) * (k * 3 + 1) + i }\n  return s\n}\n"
+                  "t = f(1000, 7)\n", 1000 },
+  { "fib",        "func fib(n) {\n  if n < 2 { return n }\n  return fib(n - 1) + fib(n - 2)\n}\nf = fib(15)\n", 1973 },
+  { "ackermann",  "func ack(m, n) {\n  if m == 0 { return n + 1 }\n  if n == 0 { return ack(m - 1, 1) }\n"
+                  "  return ack(m - 1, ack(m, n - 1))\n}\na = ack(3, 3)\n", 2432 },
+  { "tail-call",  "func sum(k, s) {\n  if k == 0 { return s }\n  return sum(k - 1, s + k)\n}\nt = sum(1000, 0)\n", 1001 }
+};
+
+// Compiles source into chunk
+static bool compile_source(const char* source, Chunk* chunk)
+{
+  ConcoctCharStream* char_stream = cct_new_string_char_stream(source);
+  ConcoctLexer* lexer = cct_new_lexer(char_stream);
+  ConcoctParser* parser = cct_new_parser(lexer);
+  ConcoctNodeTree* tree = cct_parse_program(parser);
+  bool compiled = false;
+
+  init_chunk(chunk);
+  if(parser->error == NULL)
+    compiled = compile(tree, chunk);
+  else
+    fprintf(stderr, "Parsing error: [%zu] %s\n", parser->error_line, parser->error);
+  cct_delete_parser(parser);
+  cct_delete_char_stream(char_stream);
+  cct_delete_node_tree(tree);
+  return compiled;
+}
+
+// Returns number of instructions in chunk
+static size_t count_instructions(const Chunk* chunk)
+{
+  size_t count = 0;
+  for(size_t offset = 0; offset < chunk->count; offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+    count++;
+  return count;
+}
+
+// Returns number of runs of a program with the given iterations per run that add up to about BENCHMARK_ITERATIONS
+static size_t get_runs(size_t iterations)
+{
+  size_t runs = BENCHMARK_ITERATIONS / iterations;
+  return runs == 0 ? 1 : runs;
+}
+
+// Interprets chunk until about BENCHMARK_ITERATIONS iterations have run and returns elapsed seconds
+static double run_chunk(Chunk* chunk, ConcoctHashMap* map, size_t iterations)
+{
+  struct timeval start;
+  struct timeval stop;
+
+  gettimeofday(&start, NULL);
+  for(size_t i = 0; i < get_runs(iterations); i++)
+  {
+    if(interpret(chunk, map) != RUN_SUCCESS)
+      return -1.0;
+  }
+  gettimeofday(&stop, NULL);
+  return microdelta(start.tv_sec, start.tv_usec, &stop);
+}
+
+// Frees objects created while running, keeping the constant pool of chunk alive, and returns how many were freed
+static size_t collect_results(Chunk* chunk)
+{
+  for(size_t i = 0; i < chunk->constant_count; i++)
+    chunk->constants[i]->is_flagged = true;
+  return collect_garbage();
+}
+
+// Runs chunk for several rounds and returns the fastest round in seconds. Stores the number of objects the garbage
+// collector freed after a round in collected.
+static double measure_chunk(Chunk* chunk, size_t iterations, size_t* collected)
+{
+  double best = -1.0;
+
+  for(size_t round = 0; round < BENCHMARK_ROUNDS; round++)
+  {
+    ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+    double seconds = run_chunk(chunk, map, iterations);
+    cct_delete_hash_map(map);
+    *collected = collect_results(chunk);
+    if(seconds < 0.0)
+      return -1.0;
+    if(best < 0.0 || seconds < best)
+      best = seconds;
+  }
+  return best;
+}
+
+// Runs chunk once on the profiling interpreter loop and stores the instructions it executed and the loads and
+// stores of constants, variables and registers they made in counts. These depend on the instructions alone, so the
+// cached and jit modes count the same as quickened.
+static bool count_operations(Chunk* chunk, OperationCounts* counts)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  RunCode status = RUN_SUCCESS;
+
+  profile_mode = true;
+  select_dispatch();
+  init_profile();
+  status = interpret(chunk, map);
+  *counts = get_operation_counts();
+  free_profile();
+  profile_mode = false;
+  select_dispatch();
+  cct_delete_hash_map(map);
+  collect_results(chunk);
+  return status == RUN_SUCCESS;
+}
+
+// Runs chunk once on the counting copy of the lean loop and stores the objects it actually pushed onto and popped
+// from the operand stack in traffic. This is where caching the top of the stack saves work.
+static bool count_traffic(Chunk* chunk, StackTraffic* traffic)
+{
+  ConcoctHashMap* map = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  RunCode status = RUN_SUCCESS;
+
+  memset(&stack_traffic, 0, sizeof(stack_traffic));
+  traffic_mode = true;
+  select_dispatch();
+  status = interpret(chunk, map);
+  *traffic = stack_traffic;
+  traffic_mode = false;
+  select_dispatch();
+  cct_delete_hash_map(map);
+  collect_results(chunk);
+  return status == RUN_SUCCESS;
+}
+
+// Compiles benchmark in the given mode, measures it and prints one result row
+static bool measure(const Benchmark* benchmark, const ExecutionMode* mode)
+{
+  Chunk chunk;
+  OperationCounts counts;
+  StackTraffic traffic;
+  double seconds = 0.0;
+  size_t collected = 0;
+  double runs = 0.0;
+  double iterations = (double)benchmark->iterations;
+  bool counted = false;
+
+  register_mode = mode->use_registers;
+  fusion_mode = mode->use_fusion;
+  quicken_mode = mode->use_quickening;
+  cache_mode = mode->use_caching;
+  jit_mode = mode->use_jit;
+  ir_mode = mode->use_ir;
+  if(jit_mode && !jit_available())
+    return true;
+  if(!compile_source(benchmark->source, &chunk))
+    return false;
+  seconds = measure_chunk(&chunk, benchmark->iterations, &collected);
+  counted = count_operations(&chunk, &counts) && count_traffic(&chunk, &traffic);
+  runs = (double)(get_runs(benchmark->iterations) * benchmark->iterations);
+  printf("%-12s %-10s %6zu %6zu %12.1f %10.2f %8.1f", benchmark->name, mode->name, count_instructions(&chunk),
+         chunk.count, seconds * 1000000000.0 / runs, (double)collected / runs,
+         (double)counts.instructions / iterations);
+  // Native code moves its operands without the interpreter loop, so it has no traffic to count
+  if(mode->use_jit)
+    printf(" %7s %7s %7s", "-", "-", "-");
+  else
+    printf(" %7.1f %7.1f %7.1f", (double)traffic.pushes / iterations, (double)traffic.pops / iterations,
+           (double)traffic.spills / iterations);
+  printf(" %7.1f %7.1f\n", (double)counts.loads / iterations, (double)counts.stores / iterations);
+  free_chunk(&chunk);
+  return seconds >= 0.0 && counted;
+}
+
+int main(void)
+{
+  bool passed = true;
+
+  init_vm();
+  // Folding would compile the straight-line programs to constant stores and leave nothing to compare
+  folding_mode = false;
+  printf("Best of %zu rounds, %zu runs per round.\n", BENCHMARK_ROUNDS, BENCHMARK_ITERATIONS);
+  printf("Instructions executed, operand stack pushes, pops and spills of the cached top of the stack, and loads and\n"
+         "stores of constants, variables and registers are per run.\n\n");
+  printf("%-12s %-10s %6s %6s %12s %10s %8s %7s %7s %7s %7s %7s\n", "program", "mode", "insns", "bytes", "ns/run",
+         "objs/run", "exec", "pushes", "pops", "spills", "loads", "stores");
+  for(size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+  {
+    for(size_t j = 0; j < sizeof(modes) / sizeof(modes[0]); j++)
+      passed = measure(&benchmarks[i], &modes[j]) && passed;
+  }
+  stop_vm();
+
+  return passed ? 0 : 1;
+}
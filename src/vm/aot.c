@@ -0,0 +1,1184 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>            // EINTR, errno
+#include <inttypes.h>         // PRId32, PRId64
+#include <math.h>             // isinf(), isnan()
+#include <stdarg.h>           // va_end(), va_list, va_start()
+#include <stdint.h>           // INT32_MAX, INT32_MIN, INT64_MIN, uint16_t
+#include <stdio.h>            // FILE, fprintf(), fputc(), snprintf(), stderr, vfprintf()
+#include <stdlib.h>           // calloc(), free(), getenv()
+#include <string.h>           // memmove(), strcmp(), strcpy(), strlen(), strtok()
+#ifdef _WIN32
+#include <process.h>          // _P_WAIT, _spawnvp()
+#else
+#include <sys/types.h>        // pid_t
+#include <sys/wait.h>         // WEXITSTATUS(), WIFEXITED(), waitpid()
+#include <unistd.h>           // _exit(), execvp(), fork()
+#endif // _WIN32
+#include "memory.h"           // new_object_by_type()
+#include "stack.h"
+#include "vm/aot.h"
+#include "vm/instructions.h"
+#include "vm/vm.h"
+
+// Maximum number of unboxed values kept above vm.sp and of globals and locals remembered in a basic block
+#define MAX_VALUES ((size_t)32)
+#define MAX_BINDINGS ((size_t)32)
+#define MAX_EXPRESSION_LENGTH ((size_t)48)
+#define MAX_STATEMENT_LENGTH (MAX_EXPRESSION_LENGTH * 4)
+
+// Maximum number of words in CC
+#define MAX_COMPILER_WORDS ((size_t)16)
+
+// Where the runtime was built, unless the build did not say (CONCOCT_INCLUDE_DIR and CONCOCT_RUNTIME_LIBRARY override
+// both at run time)
+#ifndef AOT_INCLUDE_DIR
+#define AOT_INCLUDE_DIR NULL
+#endif
+#ifndef AOT_RUNTIME_LIBRARY
+#define AOT_RUNTIME_LIBRARY NULL
+#endif
+
+// Integers wider than this may already be BigNums at runtime, which changes the kernel the interpreter picks
+#define NUMBER_BITS 31
+
+// Initializes the VM and binds the global slots of the program in order
+void aot_start(const char* const* global_names, size_t global_count)
+{
+  Chunk chunk;
+
+  init_vm();
+  // Slots are allocated in order of first use, so binding the names in slot order reproduces the translated slots
+  init_chunk(&chunk);
+  for(size_t i = 0; i < global_count; i++)
+    bind_global(&chunk, global_names[i]);
+  free_chunk(&chunk);
+  return;
+}
+
+// Reports a runtime error on line and returns false
+bool aot_error(size_t line)
+{
+  fprintf(stderr, "Runtime error on line %zu!\n", line);
+  return false;
+}
+
+// Reports division by zero during operation on line and returns false
+bool aot_division_by_zero(const char* operation, size_t line)
+{
+  fprintf(stderr, "Operand 2 is 0 (zero) during %s operation.\n", operation);
+  return aot_error(line);
+}
+
+// Boxes an integer computed from Numbers (Number if it fits and BigNum otherwise, like the Number kernels)
+Object* aot_box_integer(BigNum value)
+{
+  Number numval = 0;
+
+  if(value >= INT32_MIN && value <= INT32_MAX)
+  {
+    numval = (Number)value;
+    return new_object_by_type(&numval, CCT_TYPE_NUMBER);
+  }
+  return new_object_by_type(&value, CCT_TYPE_BIGNUM);
+}
+
+// Boxes a decimal
+Object* aot_box_decimal(Decimal value)
+{
+  return new_object_by_type(&value, CCT_TYPE_DECIMAL);
+}
+
+// Reserves the stack of a call to a function with max_stack slots and counts the call against MAX_CALL_DEPTH
+bool aot_enter(size_t max_stack)
+{
+  if(vm.frame_count >= MAX_CALL_DEPTH)
+  {
+    fprintf(stderr, "Maximum call depth of %zu exceeded!\n", MAX_CALL_DEPTH);
+    return false;
+  }
+  if(!reserve_stack(vm.sp, max_stack))
+    return false;
+  vm.frame_count++;
+  return true;
+}
+
+// Replaces the running function with a callee taking arity arguments (the locals of its frame start at base)
+void aot_tail_call(size_t base, size_t arity)
+{
+  memmove(&vm.sp->objects[base], &vm.sp->objects[vm.sp->count - arity], arity * sizeof(Object*));
+  vm.sp->count = base + arity;
+  vm.sp->top = (ptrdiff_t)vm.sp->count - 1;
+  return;
+}
+
+// Pops the return value, drops the frame starting at base and pushes the value in place of the arguments
+void aot_return(size_t base)
+{
+  Object* result = pop_unchecked(vm.sp);
+
+  vm.sp->count = base;
+  vm.sp->top = (ptrdiff_t)base - 1;
+  push(vm.sp, result);
+  return;
+}
+
+// Pops two operands and applies number_kernel to two Numbers, decimal_kernel to two Decimals (either may be NULL)
+// and kernel otherwise, like a quickened instruction
+RunCode aot_binary(BinaryKernel number_kernel, BinaryKernel decimal_kernel, BinaryKernel kernel)
+{
+  Object* operand2 = pop_unchecked(vm.sp);
+  Object* operand1 = vm.sp->objects[vm.sp->top];
+  BinaryKernel selected = kernel;
+  Object* result = NULL;
+
+  if(operand1->datatype == operand2->datatype)
+  {
+    if(operand1->datatype == CCT_TYPE_NUMBER && number_kernel != NULL)
+      selected = number_kernel;
+    else if(operand1->datatype == CCT_TYPE_DECIMAL && decimal_kernel != NULL)
+      selected = decimal_kernel;
+  }
+  if(selected(&result, operand1, operand2) == RUN_ERROR)
+    return RUN_ERROR;
+  vm.sp->objects[vm.sp->top] = result;
+  return RUN_SUCCESS;
+}
+
+// Applies typed_kernel to the top of the stack and constant if it has the type of constant and kernel otherwise.
+// The result replaces the top of the stack.
+RunCode aot_constant_binary(Object* constant, BinaryKernel typed_kernel, BinaryKernel kernel)
+{
+  Object* operand1 = vm.sp->objects[vm.sp->top];
+  Object* result = NULL;
+
+  if((operand1->datatype == constant->datatype ? typed_kernel : kernel)(&result, operand1, constant) == RUN_ERROR)
+    return RUN_ERROR;
+  vm.sp->objects[vm.sp->top] = result;
+  return RUN_SUCCESS;
+}
+
+// Type of a value kept unboxed in a C local
+typedef enum value_type
+{
+  VALUE_INTEGER, // BigNum holding a Number or the widened result of Number arithmetic
+  VALUE_DECIMAL,
+  VALUE_BOOL
+} ValueType;
+
+// Value of a stack slot, global or local known at translation time
+typedef struct value
+{
+  ValueType type;
+  int bits;                               // integers: the magnitude is below 2^bits
+  char expression[MAX_EXPRESSION_LENGTH]; // C expression of the unboxed value
+  char object[MAX_EXPRESSION_LENGTH];     // C expression of an object holding the value or empty
+} Value;
+
+// Global or local whose value is known until the end of the basic block
+typedef struct binding
+{
+  bool is_global;
+  uint16_t index; // global slot or local slot
+  Value value;
+} Binding;
+
+typedef struct translator
+{
+  FILE* output;
+  const Program* program;
+  const Chunk* chunk;
+  size_t chunk_index;
+  size_t entry;                   // entry of the function being translated or SIZE_MAX for the top level
+  bool* targets;                  // offsets of chunk that are jumped to
+  Value values[MAX_VALUES];       // unboxed values above vm.sp (bottom first)
+  size_t value_count;
+  Binding bindings[MAX_BINDINGS];
+  size_t binding_count;
+  size_t temporaries;             // number of C locals declared by the function being translated
+} Translator;
+
+// Binary stack operation and the C operator of its unboxed form
+typedef enum operation_kind
+{
+  KIND_ARITHMETIC, // +, -, * (integers widen like the Number kernels)
+  KIND_DIVISION,   // / (rejects a zero divisor)
+  KIND_MODULO,     // % (integers only, rejects a zero divisor)
+  KIND_COMPARISON, // <, <=, >, >=
+  KIND_EQUALITY,   // ==, != (also defined for two Bools)
+  KIND_GENERIC     // always runs its instruction function
+} OperationKind;
+
+typedef struct operation
+{
+  Opcode opcode;
+  Opcode constant_opcode; // fused PSH + <op> form or opcode if there is none
+  const char* name;       // op_<name>() and <name>_objects()
+  const char* operator;
+  OperationKind kind;
+  bool has_number_kernel;  // <name>_numbers() exists
+  bool has_decimal_kernel; // <name>_decimals() exists
+} Operation;
+
+static const Operation operations[] =
+{
+  { OP_ADD, OP_ADDK, "add", "+", KIND_ARITHMETIC, true, true },
+  { OP_SUB, OP_SUBK, "sub", "-", KIND_ARITHMETIC, true, true },
+  { OP_MUL, OP_MULK, "mul", "*", KIND_ARITHMETIC, true, true },
+  { OP_DIV, OP_DIVK, "div", "/", KIND_DIVISION, false, true },
+  { OP_MOD, OP_MODK, "mod", "%", KIND_MODULO, false, false },
+  { OP_EQL, OP_EQLK, "eql", "==", KIND_EQUALITY, true, false },
+  { OP_NEQ, OP_NEQK, "neq", "!=", KIND_EQUALITY, true, false },
+  { OP_GT, OP_GTK, "gt", ">", KIND_COMPARISON, true, true },
+  { OP_GTE, OP_GTEK, "gte", ">=", KIND_COMPARISON, true, true },
+  { OP_LT, OP_LTK, "lt", "<", KIND_COMPARISON, true, true },
+  { OP_LTE, OP_LTEK, "lte", "<=", KIND_COMPARISON, true, true },
+  { OP_AND, OP_AND, "and", "&&", KIND_GENERIC, false, false },
+  { OP_OR, OP_OR, "or", "||", KIND_GENERIC, false, false },
+  { OP_POW, OP_POW, "pow", "**", KIND_GENERIC, false, false },
+  { OP_BND, OP_BND, "bnd", "&", KIND_GENERIC, false, false },
+  { OP_BOR, OP_BOR, "bor", "|", KIND_GENERIC, false, false },
+  { OP_XOR, OP_XOR, "xor", "^", KIND_GENERIC, false, false },
+  { OP_SHL, OP_SHL, "shl", "<<", KIND_GENERIC, false, false },
+  { OP_SHR, OP_SHR, "shr", ">>", KIND_GENERIC, false, false },
+  { OP_SLE, OP_SLE, "sle", "$=", KIND_GENERIC, false, false },
+  { OP_SLN, OP_SLN, "sln", "$!", KIND_GENERIC, false, false }
+};
+
+// Returns the operation of a stack-form or constant-form binary opcode (NULL if it is neither)
+static const Operation* find_operation(Opcode oc, bool* is_constant)
+{
+  for(size_t i = 0; i < sizeof(operations) / sizeof(operations[0]); i++)
+  {
+    if(operations[i].opcode == oc || operations[i].constant_opcode == oc)
+    {
+      *is_constant = operations[i].opcode != oc;
+      return &operations[i];
+    }
+  }
+  return NULL;
+}
+
+// Writes formatted C code
+static void emit(Translator* translator, const char* format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(translator->output, format, args);
+  va_end(args);
+  return;
+}
+
+// Returns the number of bits of the magnitude of value
+static int get_bits(BigNum value)
+{
+  int bits = 0;
+  uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+
+  while(magnitude != 0)
+  {
+    bits++;
+    magnitude >>= 1;
+  }
+  return bits;
+}
+
+// Describes constant as an unboxed value and returns false if its type is not kept unboxed
+static bool get_constant_value(const Translator* translator, uint16_t index, Value* value)
+{
+  const Object* constant = translator->chunk->constants[index];
+  BigNum integer = 0;
+
+  snprintf(value->object, MAX_EXPRESSION_LENGTH, "constants_%zu[%u]", translator->chunk_index, index);
+  switch(constant->datatype)
+  {
+    case CCT_TYPE_BOOL:
+      value->type = VALUE_BOOL;
+      snprintf(value->expression, MAX_EXPRESSION_LENGTH, "%s", constant->value.boolval ? "true" : "false");
+      return true;
+    case CCT_TYPE_NUMBER:
+    case CCT_TYPE_BIGNUM:
+      integer = constant->datatype == CCT_TYPE_NUMBER ? constant->value.numval : constant->value.bignumval;
+      value->type = VALUE_INTEGER;
+      // A BigNum stays a BigNum whatever its value, so only its comparisons and decimal arithmetic are unboxed
+      value->bits = constant->datatype == CCT_TYPE_NUMBER ? get_bits(integer) : 64;
+      if(integer == INT64_MIN)
+        snprintf(value->expression, MAX_EXPRESSION_LENGTH, "INT64_MIN");
+      else
+        snprintf(value->expression, MAX_EXPRESSION_LENGTH, "INT64_C(%" PRId64 ")", integer);
+      return true;
+    case CCT_TYPE_DECIMAL:
+      if(isnan(constant->value.decimalval) || isinf(constant->value.decimalval))
+        return false;
+      value->type = VALUE_DECIMAL;
+      // Hexadecimal floating constants round-trip exactly
+      snprintf(value->expression, MAX_EXPRESSION_LENGTH, "%a", constant->value.decimalval);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the C type of an unboxed value
+static const char* get_c_type(ValueType type)
+{
+  switch(type)
+  {
+    case VALUE_INTEGER: return "BigNum";
+    case VALUE_DECIMAL: return "Decimal";
+    default:            return "Bool";
+  }
+}
+
+// Writes the C expression of an object holding value, boxing it if there is none yet
+static void emit_object(Translator* translator, const Value* value)
+{
+  if(value->object[0] != '\0')
+    emit(translator, "%s", value->object);
+  else if(value->type == VALUE_INTEGER)
+    emit(translator, "aot_box_integer(%s)", value->expression);
+  else if(value->type == VALUE_DECIMAL)
+    emit(translator, "aot_box_decimal(%s)", value->expression);
+  else
+    emit(translator, "(%s ? vm.true_object : vm.false_object)", value->expression);
+  return;
+}
+
+// Boxes value into a C local unless an object already holds it
+static void box_value(Translator* translator, Value* value)
+{
+  if(value->object[0] != '\0')
+    return;
+  emit(translator, "  Object* const o%zu = ", translator->temporaries);
+  emit_object(translator, value);
+  emit(translator, ";\n");
+  snprintf(value->object, MAX_EXPRESSION_LENGTH, "o%zu", translator->temporaries++);
+  return;
+}
+
+// Pushes the unboxed values to vm.sp, so the stack holds every operand again
+static void flush_values(Translator* translator)
+{
+  for(size_t i = 0; i < translator->value_count; i++)
+  {
+    emit(translator, "  push(vm.sp, ");
+    emit_object(translator, &translator->values[i]);
+    emit(translator, ");\n");
+  }
+  translator->value_count = 0;
+  return;
+}
+
+// Keeps value unboxed on top of the stack
+static void push_value(Translator* translator, const Value* value)
+{
+  if(translator->value_count == MAX_VALUES)
+    flush_values(translator);
+  translator->values[translator->value_count++] = *value;
+  return;
+}
+
+// Returns the binding of a global or local or NULL if its value is unknown
+static Binding* find_binding(Translator* translator, bool is_global, uint16_t index)
+{
+  for(size_t i = 0; i < translator->binding_count; i++)
+  {
+    if(translator->bindings[i].is_global == is_global && translator->bindings[i].index == index)
+      return &translator->bindings[i];
+  }
+  return NULL;
+}
+
+// Forgets the value of a global or local
+static void unbind(Translator* translator, bool is_global, uint16_t index)
+{
+  Binding* binding = find_binding(translator, is_global, index);
+
+  if(binding != NULL)
+    *binding = translator->bindings[--translator->binding_count];
+  return;
+}
+
+// Remembers the value of a global or local until the end of the basic block
+static void bind(Translator* translator, bool is_global, uint16_t index, const Value* value)
+{
+  Binding* binding = find_binding(translator, is_global, index);
+
+  if(binding == NULL)
+  {
+    if(translator->binding_count == MAX_BINDINGS)
+      return;
+    binding = &translator->bindings[translator->binding_count++];
+  }
+  binding->is_global = is_global;
+  binding->index = index;
+  binding->value = *value;
+  return;
+}
+
+// Declares a C local holding expression and describes it as result
+static void declare_temporary(Translator* translator, ValueType type, int bits, const char* expression, Value* result)
+{
+  emit(translator, "  const %s t%zu = %s;\n", get_c_type(type), translator->temporaries, expression);
+  result->type = type;
+  result->bits = bits;
+  snprintf(result->expression, MAX_EXPRESSION_LENGTH, "t%zu", translator->temporaries++);
+  result->object[0] = '\0';
+  return;
+}
+
+// Emits the unboxed form of operation on value1 and value2 into result and returns false if the types of the
+// operands are not known well enough to match the kernel the interpreter would pick
+static bool translate_unboxed_binary(Translator* translator, const Operation* operation, const Value* value1,
+                                     const Value* value2, size_t line, Value* result)
+{
+  bool is_decimal = value1->type == VALUE_DECIMAL || value2->type == VALUE_DECIMAL;
+  bool is_number = value1->type == VALUE_INTEGER && value2->type == VALUE_INTEGER
+                   && value1->bits <= NUMBER_BITS && value2->bits <= NUMBER_BITS;
+  bool is_bool = value1->type == VALUE_BOOL && value2->type == VALUE_BOOL;
+  char expression[MAX_STATEMENT_LENGTH];
+  const char* cast1 = is_decimal && value1->type == VALUE_INTEGER ? "(Decimal)" : "";
+  const char* cast2 = is_decimal && value2->type == VALUE_INTEGER ? "(Decimal)" : "";
+  int bits = value1->bits > value2->bits ? value1->bits : value2->bits;
+
+  // Numeric operands other than Bools (mixed integers and decimals promote to decimal)
+  if(!is_bool && (value1->type == VALUE_BOOL || value2->type == VALUE_BOOL))
+    return false;
+  snprintf(expression, sizeof(expression), "%s%s %s %s%s", cast1, value1->expression, operation->operator, cast2,
+           value2->expression);
+  switch(operation->kind)
+  {
+    case KIND_EQUALITY:
+      if(is_bool)
+      {
+        declare_temporary(translator, VALUE_BOOL, 0, expression, result);
+        return true;
+      }
+      // Fall through
+    case KIND_COMPARISON:
+      if(is_bool)
+        return false;
+      declare_temporary(translator, VALUE_BOOL, 0, expression, result);
+      return true;
+    case KIND_ARITHMETIC:
+      if(is_decimal)
+        declare_temporary(translator, VALUE_DECIMAL, 0, expression, result);
+      else if(is_number)
+        declare_temporary(translator, VALUE_INTEGER,
+                          operation->opcode == OP_MUL ? value1->bits + value2->bits : bits + 1, expression, result);
+      else
+        return false;
+      return true;
+    case KIND_DIVISION:
+    case KIND_MODULO:
+      if(!(is_number || (is_decimal && operation->kind == KIND_DIVISION)))
+        return false;
+      // Integer division by a literal zero always fails, and C compilers warn about it, so the kernels report it
+      if(strcmp(value2->expression, "INT64_C(0)") == 0)
+        return false;
+      emit(translator, "  if(%s == 0)\n    return aot_division_by_zero(\"%s\", %zu);\n", value2->expression,
+           operation->kind == KIND_DIVISION ? "DIV" : "MOD", line);
+      // The quotient and remainder of two Numbers are no larger than the dividend
+      declare_temporary(translator, is_decimal ? VALUE_DECIMAL : VALUE_INTEGER, value1->bits, expression, result);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Translates a stack-form binary operation
+static void translate_binary(Translator* translator, const Operation* operation, size_t line)
+{
+  Value result;
+
+  if(translator->value_count >= 2
+     && translate_unboxed_binary(translator, operation, &translator->values[translator->value_count - 2],
+                                 &translator->values[translator->value_count - 1], line, &result))
+  {
+    translator->value_count -= 2;
+    push_value(translator, &result);
+    return;
+  }
+  flush_values(translator);
+  if(operation->has_number_kernel || operation->has_decimal_kernel)
+    emit(translator, "  CHECK(aot_binary(%s%s, %s%s, %s_objects), %zu);\n",
+         operation->has_number_kernel ? operation->name : "NULL", operation->has_number_kernel ? "_numbers" : "",
+         operation->has_decimal_kernel ? operation->name : "NULL", operation->has_decimal_kernel ? "_decimals" : "",
+         operation->name, line);
+  else
+    emit(translator, "  CHECK(op_%s(vm.sp), %zu);\n", operation->name, line);
+  return;
+}
+
+// Translates a binary operation with a constant right operand
+static void translate_constant_binary(Translator* translator, const Operation* operation, uint16_t index,
+                                      size_t line)
+{
+  Value constant;
+  Value result;
+  DataType type = CCT_TYPE_NIL;
+
+  if(translator->value_count >= 1 && get_constant_value(translator, index, &constant)
+     && translate_unboxed_binary(translator, operation, &translator->values[translator->value_count - 1], &constant,
+                                 line, &result))
+  {
+    translator->values[translator->value_count - 1] = result;
+    return;
+  }
+  flush_values(translator);
+  type = translator->chunk->constants[index]->datatype;
+  if((type == CCT_TYPE_NUMBER && operation->has_number_kernel)
+     || (type == CCT_TYPE_DECIMAL && operation->has_decimal_kernel))
+    emit(translator, "  CHECK(aot_constant_binary(constants_%zu[%u], %s_%s, %s_objects), %zu);\n",
+         translator->chunk_index, index, operation->name, type == CCT_TYPE_NUMBER ? "numbers" : "decimals",
+         operation->name, line);
+  else
+    emit(translator, "  CHECK(op_const_binary(vm.sp, constants_%zu[%u], %s_objects), %zu);\n",
+         translator->chunk_index, index, operation->name, line);
+  return;
+}
+
+// Assigns the top of the stack to a global or local
+static void translate_store(Translator* translator, bool is_global, uint16_t index)
+{
+  Value* value = NULL;
+  char destination[MAX_EXPRESSION_LENGTH];
+
+  if(is_global)
+    snprintf(destination, sizeof(destination), "vm.globals[%u]", index);
+  else
+    snprintf(destination, sizeof(destination), "vm.sp->objects[base + %u]", index);
+  if(translator->value_count == 0)
+  {
+    emit(translator, "  %s = pop_unchecked(vm.sp);\n", destination);
+    unbind(translator, is_global, index);
+    return;
+  }
+  value = &translator->values[--translator->value_count];
+  box_value(translator, value);
+  emit(translator, "  %s = %s;\n", destination, value->object);
+  bind(translator, is_global, index, value);
+  return;
+}
+
+// Pushes a global or local
+static void translate_load(Translator* translator, bool is_global, uint16_t index, size_t line)
+{
+  const Binding* binding = find_binding(translator, is_global, index);
+
+  if(binding != NULL)
+  {
+    push_value(translator, &binding->value);
+    return;
+  }
+  flush_values(translator);
+  if(is_global)
+    emit(translator, "  CHECK(op_get(vm.sp, vm.globals, %u), %zu);\n", index, line);
+  else
+    emit(translator, "  push(vm.sp, vm.sp->objects[base + %u]);\n", index);
+  return;
+}
+
+// Pops the condition of a conditional jump into the C expression of its truth value (MAX_STATEMENT_LENGTH bytes)
+static void pop_condition(Translator* translator, char* condition)
+{
+  const Value* value = NULL;
+
+  if(translator->value_count > 0 && translator->values[translator->value_count - 1].type == VALUE_BOOL)
+  {
+    value = &translator->values[--translator->value_count];
+    snprintf(condition, MAX_STATEMENT_LENGTH, "%s", value->expression);
+    flush_values(translator);
+    return;
+  }
+  flush_values(translator);
+  snprintf(condition, MAX_STATEMENT_LENGTH, "is_truthy(pop_unchecked(vm.sp))");
+  return;
+}
+
+// Returns the index of chunk in the program being translated
+static size_t find_chunk(const Translator* translator, const Chunk* chunk)
+{
+  for(size_t i = 0; i < translator->program->count; i++)
+  {
+    if(translator->program->chunks[i] == chunk)
+      return i;
+  }
+  return SIZE_MAX;
+}
+
+// Translates the instruction at offset and returns false if it has no C translation
+static bool translate_instruction(Translator* translator, size_t offset)
+{
+  const Chunk* chunk = translator->chunk;
+  const Byte* operands = &chunk->code[offset + 1];
+  Opcode oc = get_generic_opcode((Opcode)chunk->code[offset]);
+  size_t line = chunk->lines[offset];
+  size_t target = is_jump_operation(oc) ? get_jump_target(chunk, offset) : 0;
+  const Operation* operation = NULL;
+  const Function* function = NULL;
+  const Binding* binding = NULL;
+  bool is_constant = false;
+  char condition[MAX_STATEMENT_LENGTH];
+  Value value1;
+  Value value2;
+  Value result;
+
+  operation = find_operation(oc, &is_constant);
+  if(operation != NULL)
+  {
+    if(is_constant)
+      translate_constant_binary(translator, operation, read_short(operands), line);
+    else
+      translate_binary(translator, operation, line);
+    return true;
+  }
+  switch(oc)
+  {
+    case OP_CMP:
+    case OP_EXT:
+    case OP_NOP:
+    case OP_NUL:
+    case OP_SYS:
+      return true;
+    case OP_PSH:
+      if(get_constant_value(translator, read_short(operands), &value1))
+      {
+        push_value(translator, &value1);
+        return true;
+      }
+      flush_values(translator);
+      emit(translator, "  push(vm.sp, constants_%zu[%u]);\n", translator->chunk_index, read_short(operands));
+      return true;
+    case OP_POP:
+      if(translator->value_count > 0)
+        translator->value_count--;
+      else
+        emit(translator, "  pop_unchecked(vm.sp);\n");
+      return true;
+    case OP_GET:
+      translate_load(translator, true, read_short(operands), line);
+      return true;
+    case OP_GET2:
+      translate_load(translator, true, read_short(operands), line);
+      translate_load(translator, true, read_short(operands + 2), line);
+      return true;
+    case OP_ASN:
+      translate_store(translator, true, read_short(operands));
+      return true;
+    case OP_SETK:
+      emit(translator, "  vm.globals[%u] = constants_%zu[%u];\n", read_short(operands), translator->chunk_index,
+           read_short(operands + 2));
+      if(get_constant_value(translator, read_short(operands + 2), &value1))
+        bind(translator, true, read_short(operands), &value1);
+      else
+        unbind(translator, true, read_short(operands));
+      return true;
+    case OP_GOPK:
+      binding = find_binding(translator, true, read_short(operands));
+      operation = find_operation((Opcode)operands[4], &is_constant);
+      if(binding != NULL && operation != NULL && get_constant_value(translator, read_short(operands + 2), &value2))
+      {
+        value1 = binding->value;
+        if(translate_unboxed_binary(translator, operation, &value1, &value2, line, &result))
+        {
+          push_value(translator, &result);
+          translate_store(translator, true, read_short(operands));
+          return true;
+        }
+      }
+      flush_values(translator);
+      if(operation == NULL)
+        return false;
+      emit(translator, "  CHECK(op_gopk(vm.globals, %u, constants_%zu[%u], %s_objects), %zu);\n",
+           read_short(operands), translator->chunk_index, read_short(operands + 2), operation->name, line);
+      unbind(translator, true, read_short(operands));
+      return true;
+    case OP_LDL:
+      if(translator->entry == SIZE_MAX)
+        return false;
+      translate_load(translator, false, operands[0], line);
+      return true;
+    case OP_STL:
+      if(translator->entry == SIZE_MAX)
+        return false;
+      translate_store(translator, false, operands[0]);
+      return true;
+    case OP_NOT:
+      if(translator->value_count > 0 && translator->values[translator->value_count - 1].type == VALUE_BOOL)
+      {
+        snprintf(condition, sizeof(condition), "!%s", translator->values[translator->value_count - 1].expression);
+        declare_temporary(translator, VALUE_BOOL, 0, condition, &translator->values[translator->value_count - 1]);
+        return true;
+      }
+      flush_values(translator);
+      emit(translator, "  CHECK(op_not(vm.sp), %zu);\n", line);
+      return true;
+    case OP_NEG:
+      // NEG makes positive values negative and leaves the others alone
+      if(translator->value_count > 0 && translator->values[translator->value_count - 1].type != VALUE_BOOL
+         && (translator->values[translator->value_count - 1].type == VALUE_DECIMAL
+             || translator->values[translator->value_count - 1].bits <= NUMBER_BITS))
+      {
+        value1 = translator->values[translator->value_count - 1];
+        snprintf(condition, sizeof(condition), "%s > 0 ? -%s : %s", value1.expression, value1.expression,
+                 value1.expression);
+        declare_temporary(translator, value1.type, value1.bits, condition,
+                          &translator->values[translator->value_count - 1]);
+        return true;
+      }
+      flush_values(translator);
+      emit(translator, "  CHECK(op_neg(vm.sp), %zu);\n", line);
+      return true;
+    case OP_BNT:
+    case OP_DEC:
+    case OP_INC:
+    case OP_POS:
+      flush_values(translator);
+      emit(translator, "  CHECK(op_%s(vm.sp), %zu);\n",
+           oc == OP_BNT ? "bnt" : oc == OP_DEC ? "dec" : oc == OP_INC ? "inc" : "pos", line);
+      return true;
+    case OP_TST:
+      if(translator->value_count > 0 && translator->values[translator->value_count - 1].type == VALUE_BOOL)
+        return true;
+      flush_values(translator);
+      emit(translator, "  vm.sp->objects[vm.sp->top] = is_truthy(vm.sp->objects[vm.sp->top]) ? vm.true_object "
+           ": vm.false_object;\n");
+      return true;
+    case OP_JMP:
+    case OP_LOP:
+      flush_values(translator);
+      emit(translator, "  goto L%zu;\n", target);
+      return true;
+    case OP_JMC:
+    case OP_JMZ:
+    case OP_LNZ:
+    case OP_LOZ:
+      pop_condition(translator, condition);
+      emit(translator, "  if(%s%s)\n    goto L%zu;\n", oc == OP_JMZ || oc == OP_LOZ ? "!" : "", condition, target);
+      return true;
+    case OP_JMF:
+    case OP_JMT:
+      pop_condition(translator, condition);
+      emit(translator, "  if(%s%s)\n  {\n    push(vm.sp, vm.%s_object);\n    goto L%zu;\n  }\n",
+           oc == OP_JMF ? "!" : "", condition, oc == OP_JMF ? "false" : "true", target);
+      return true;
+    case OP_LOE:
+    case OP_LNE:
+      if(translator->value_count >= 2
+         && translate_unboxed_binary(translator, find_operation(OP_EQL, &is_constant),
+                                     &translator->values[translator->value_count - 2],
+                                     &translator->values[translator->value_count - 1], line, &result))
+      {
+        translator->value_count -= 2;
+        flush_values(translator);
+        emit(translator, "  if(%s%s)\n    goto L%zu;\n", oc == OP_LNE ? "!" : "", result.expression, target);
+        return true;
+      }
+      flush_values(translator);
+      emit(translator, "  {\n    Object* operand2 = pop_unchecked(vm.sp);\n"
+           "    Object* operand1 = pop_unchecked(vm.sp);\n"
+           "    Object* result = NULL;\n\n    CHECK(eql_objects(&result, operand1, operand2), %zu);\n"
+           "    if(%sresult->value.boolval)\n      goto L%zu;\n  }\n", line, oc == OP_LNE ? "!" : "", target);
+      return true;
+    case OP_JNLK:
+    case OP_LLTK:
+      // Translated as PSH k, LT, JMZ or LNZ, so typed operands compare unboxed
+      translate_constant_binary(translator, find_operation(OP_LT, &is_constant), read_short(operands + 2), line);
+      pop_condition(translator, condition);
+      emit(translator, "  if(%s%s)\n    goto L%zu;\n", oc == OP_JNLK ? "!" : "", condition, target);
+      return true;
+    case OP_CAL:
+    case OP_TCL:
+      flush_values(translator);
+      translator->binding_count = 0;
+      function = &chunk->functions[read_short(operands)];
+      if(oc == OP_CAL)
+      {
+        emit(translator, "  if(!aot_enter(%zu))\n    return aot_error(%zu);\n", function->max_stack, line);
+        emit(translator, "  if(!function_%zu_%zu(vm.sp->count - %zu))\n    return false;\n  vm.frame_count--;\n",
+             find_chunk(translator, function->chunk), function->entry, function->arity);
+        return true;
+      }
+      if(translator->entry == SIZE_MAX)
+        return false;
+      emit(translator, "  aot_tail_call(base, %zu);\n", function->arity);
+      if(function->chunk == chunk && function->entry == translator->entry)
+        emit(translator, "  goto L%zu;\n", function->entry);
+      else
+        emit(translator, "  if(!reserve_stack(vm.sp, %zu))\n    return aot_error(%zu);\n"
+             "  return function_%zu_%zu(base);\n", function->max_stack, line, find_chunk(translator, function->chunk),
+             function->entry);
+      return true;
+    case OP_ENT:
+      if(operands[0] > 0)
+        emit(translator, "  for(Byte i = 0; i < %u; i++)\n    push(vm.sp, vm.null_object);\n", operands[0]);
+      return true;
+    case OP_RET:
+      if(translator->entry == SIZE_MAX)
+        return false;
+      flush_values(translator);
+      emit(translator, "  aot_return(base);\n  return true;\n");
+      return true;
+    case OP_END:
+    case OP_HLT:
+      if(translator->entry != SIZE_MAX)
+        return false;
+      flush_values(translator);
+      emit(translator, "  return true;\n");
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Translates the instructions of chunk from start up to end into the body of a C function
+static bool translate_body(Translator* translator, size_t start, size_t end)
+{
+  const Chunk* chunk = translator->chunk;
+  Opcode oc = OP_NOP;
+  size_t target = 0;
+
+  translator->value_count = 0;
+  translator->binding_count = 0;
+  translator->temporaries = 0;
+  for(size_t offset = start; offset < end; offset += 1 + get_operand_length(oc))
+  {
+    oc = (Opcode)chunk->code[offset];
+    if(is_jump_operation(oc))
+    {
+      target = get_jump_target(chunk, offset);
+      if(target < start || target >= end)
+        return false;
+      translator->targets[target] = true;
+    }
+    if(oc == OP_TCL && chunk->functions[read_short(&chunk->code[offset + 1])].chunk == chunk
+       && chunk->functions[read_short(&chunk->code[offset + 1])].entry == translator->entry)
+      translator->targets[translator->entry] = true;
+  }
+  for(size_t offset = start; offset < end; offset += 1 + get_operand_length(oc))
+  {
+    oc = (Opcode)chunk->code[offset];
+    if(translator->targets[offset])
+    {
+      // Control flow merges here, so every value is back on vm.sp and nothing is known about globals or locals
+      flush_values(translator);
+      translator->binding_count = 0;
+      emit(translator, "L%zu:;\n", offset);
+    }
+    emit(translator, "  // %s\n", get_mnemonic(oc));
+    if(!translate_instruction(translator, offset))
+    {
+      fprintf(stderr, "Unable to translate %s on line %zu to C.\n", get_mnemonic(oc), chunk->lines[offset]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects the function entries of chunk in ascending order and returns their number
+static size_t get_entries(const Chunk* chunk, size_t* entries)
+{
+  size_t count = 0;
+  size_t entry = 0;
+  size_t j = 0;
+
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk != chunk)
+      continue;
+    entry = chunk->functions[i].entry;
+    for(j = 0; j < count && entries[j] < entry; j++)
+      ;
+    if(j < count && entries[j] == entry)
+      continue;
+    memmove(&entries[j + 1], &entries[j], (count - j) * sizeof(size_t));
+    entries[j] = entry;
+    count++;
+  }
+  return count;
+}
+
+// Writes a C string literal
+static void emit_string(Translator* translator, const char* string)
+{
+  fputc('"', translator->output);
+  for(const char* c = string; *c != '\0'; c++)
+  {
+    if(*c == '"' || *c == '\\' || *c == '?') // ? would start a trigraph
+      fprintf(translator->output, "\\%c", *c);
+    else if((unsigned char)*c < ' ' || (unsigned char)*c > '~')
+      fprintf(translator->output, "\\%03o", (unsigned char)*c);
+    else
+      fputc(*c, translator->output);
+  }
+  fputc('"', translator->output);
+  return;
+}
+
+// Writes the statement creating a constant of chunk
+static void emit_constant(Translator* translator, size_t chunk_index, size_t index, const Object* constant)
+{
+  Decimal decimalval = 0.0;
+
+  emit(translator, "  constants_%zu[%zu] = ", chunk_index, index);
+  switch(constant->datatype)
+  {
+    case CCT_TYPE_BOOL:
+      emit(translator, "new_object_by_type(&(Bool){ %s }, CCT_TYPE_BOOL);\n",
+           constant->value.boolval ? "true" : "false");
+      break;
+    case CCT_TYPE_BYTE:
+      emit(translator, "new_object_by_type(&(Byte){ %u }, CCT_TYPE_BYTE);\n", constant->value.byteval);
+      break;
+    case CCT_TYPE_NUMBER:
+      emit(translator, "new_object_by_type(&(Number){ %" PRId32 " }, CCT_TYPE_NUMBER);\n", constant->value.numval);
+      break;
+    case CCT_TYPE_BIGNUM:
+      if(constant->value.bignumval == INT64_MIN)
+        emit(translator, "new_object_by_type(&(BigNum){ INT64_MIN }, CCT_TYPE_BIGNUM);\n");
+      else
+        emit(translator, "new_object_by_type(&(BigNum){ INT64_C(%" PRId64 ") }, CCT_TYPE_BIGNUM);\n",
+             constant->value.bignumval);
+      break;
+    case CCT_TYPE_DECIMAL:
+      decimalval = constant->value.decimalval;
+      if(isnan(decimalval))
+        emit(translator, "new_object_by_type(&(Decimal){ NAN }, CCT_TYPE_DECIMAL);\n");
+      else if(isinf(decimalval))
+        emit(translator, "new_object_by_type(&(Decimal){ %sHUGE_VAL }, CCT_TYPE_DECIMAL);\n",
+             decimalval < 0 ? "-" : "");
+      else
+        emit(translator, "new_object_by_type(&(Decimal){ %a }, CCT_TYPE_DECIMAL);\n", decimalval);
+      break;
+    case CCT_TYPE_STRING:
+      emit(translator, "new_object_by_type(");
+      emit_string(translator, constant->value.strobj.strval);
+      emit(translator, ", CCT_TYPE_STRING);\n");
+      break;
+    default:
+      emit(translator, "new_object_by_type(NULL, CCT_TYPE_NIL);\n");
+      break;
+  }
+  return;
+}
+
+// Writes the C translation of program to output and returns false if an instruction cannot be translated
+bool translate_program(const Program* program, const char* source_name, FILE* output)
+{
+  Translator translator;
+  const Chunk* chunk = NULL;
+  size_t* entries = NULL;
+  size_t entry_count = 0;
+  bool translated = true;
+
+  translator.output = output;
+  translator.program = program;
+  emit(&translator, "// Translated from %s by concoct -c\n\n", source_name);
+  emit(&translator, "#include <math.h>   // HUGE_VAL, NAN\n#include <stdint.h> // INT64_C(), INT64_MIN\n"
+       "#include <stdlib.h> // EXIT_FAILURE, EXIT_SUCCESS\n#include \"memory.h\"\n#include \"stack.h\"\n"
+       "#include \"vm/aot.h\"\n#include \"vm/instructions.h\"\n#include \"vm/vm.h\"\n\n");
+  emit(&translator, "#define CHECK(run, line) \\\n  do \\\n  { \\\n    if((run) == RUN_ERROR) \\\n"
+       "      return aot_error(line); \\\n  } while(0)\n\n");
+  emit(&translator, "static const char* const global_names[] = { ");
+  for(size_t i = 0; i < vm.global_count; i++)
+  {
+    emit_string(&translator, vm.global_names[i]);
+    emit(&translator, ", ");
+  }
+  emit(&translator, "NULL };\n");
+
+  // Declarations of constants and functions
+  for(size_t i = 0; i < program->count; i++)
+  {
+    chunk = program->chunks[i];
+    if(chunk == NULL)
+      continue;
+    if(!chunk->is_verified)
+    {
+      fprintf(stderr, "Only verified chunks can be translated to C.\n");
+      return false;
+    }
+    emit(&translator, "static Object* constants_%zu[%zu];\n", i, chunk->constant_count > 0 ? chunk->constant_count : 1);
+    for(size_t j = 0; j < chunk->function_count; j++)
+    {
+      if(chunk->functions[j].chunk == chunk)
+        emit(&translator, "static bool function_%zu_%zu(size_t base); // %s\n", i, chunk->functions[j].entry,
+             chunk->functions[j].name != NULL ? chunk->functions[j].name : "");
+    }
+  }
+
+  // Bodies of the top level of each chunk and of its functions
+  for(size_t i = 0; translated && i < program->count; i++)
+  {
+    chunk = program->chunks[i];
+    if(chunk == NULL)
+      continue;
+    entries = calloc(chunk->function_count + 1, sizeof(size_t));
+    translator.targets = calloc(chunk->count, sizeof(bool));
+    if(entries == NULL || translator.targets == NULL)
+    {
+      fprintf(stderr, "Unable to allocate memory for translation.\n");
+      free(entries);
+      free(translator.targets);
+      return false;
+    }
+    translator.chunk = chunk;
+    translator.chunk_index = i;
+    entry_count = get_entries(chunk, entries);
+    entries[entry_count] = chunk->count;
+    emit(&translator, "\nstatic bool run_chunk_%zu(void)\n{\n  if(!reserve_stack(vm.sp, %zu))\n    return false;\n", i,
+         chunk->max_stack);
+    translator.entry = SIZE_MAX;
+    translated = translate_body(&translator, 0, entries[0]);
+    emit(&translator, "}\n");
+    for(size_t j = 0; translated && j < entry_count; j++)
+    {
+      emit(&translator, "\nstatic bool function_%zu_%zu(size_t base)\n{\n", i, entries[j]);
+      translator.entry = entries[j];
+      translated = translate_body(&translator, entries[j], entries[j + 1]);
+      emit(&translator, "}\n");
+    }
+    free(entries);
+    free(translator.targets);
+  }
+  if(!translated)
+    return false;
+
+  emit(&translator, "\nint main(void)\n{\n  bool success = true;\n\n  aot_start(global_names, %zu);\n",
+       vm.global_count);
+  for(size_t i = 0; i < program->count; i++)
+  {
+    chunk = program->chunks[i];
+    for(size_t j = 0; chunk != NULL && j < chunk->constant_count; j++)
+      emit_constant(&translator, i, j, chunk->constants[j]);
+  }
+  for(size_t i = 0; i < program->count; i++)
+  {
+    if(program->chunks[i] != NULL)
+      emit(&translator, "  success = success && run_chunk_%zu();\n", i);
+  }
+  emit(&translator, "  stop_vm();\n  return success ? EXIT_SUCCESS : EXIT_FAILURE;\n}\n");
+  return !ferror(output);
+}
+
+// Returns the value of the environment variable name if it is set and fallback (which may be NULL) otherwise
+static const char* get_setting(const char* name, const char* fallback)
+{
+  const char* value = getenv(name);
+
+  return value != NULL && value[0] != '\0' ? value : fallback;
+}
+
+// Runs the program arguments[0] with arguments without going through a shell and returns its exit status, or -1 if
+// it could not be started or did not exit normally
+static int run_program_arguments(char* const* arguments)
+{
+#ifdef _WIN32
+  return (int)_spawnvp(_P_WAIT, arguments[0], (const char* const*)arguments);
+#else
+  int status = 0;
+  pid_t child = fork();
+
+  if(child < 0)
+    return -1;
+  if(child == 0)
+  {
+    execvp(arguments[0], arguments);
+    _exit(127);
+  }
+  while(waitpid(child, &status, 0) < 0)
+  {
+    if(errno != EINTR)
+      return -1;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif // _WIN32
+}
+
+// Compiles the C file source with the system C compiler (CC or cc) and links it against the runtime into
+// executable. Returns false if neither the environment nor this build says where the runtime is or the compiler
+// failed.
+bool build_executable(const char* source, const char* executable)
+{
+  const char* include_dir = get_setting("CONCOCT_INCLUDE_DIR", AOT_INCLUDE_DIR);
+  const char* library = get_setting("CONCOCT_RUNTIME_LIBRARY", AOT_RUNTIME_LIBRARY);
+  char* arguments[MAX_COMPILER_WORDS + 9];
+  const char* setting = NULL;
+  char* compiler = NULL;
+  size_t count = 0;
+  int status = 0;
+
+  if(include_dir == NULL || library == NULL)
+  {
+    fprintf(stderr, "This build of Concoct does not know where its runtime library is. Set CONCOCT_INCLUDE_DIR and "
+                    "CONCOCT_RUNTIME_LIBRARY.\n");
+    return false;
+  }
+  // CC may name a compiler with options or a wrapper, so it is split into words like make does
+  setting = get_setting("CC", "cc");
+  compiler = malloc(strlen(setting) + 1);
+  if(compiler == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory for compiler command.\n");
+    return false;
+  }
+  strcpy(compiler, setting);
+  for(char* word = strtok(compiler, " \t"); word != NULL; word = strtok(NULL, " \t"))
+  {
+    if(count == MAX_COMPILER_WORDS)
+    {
+      fprintf(stderr, "CC has more than %zu words.\n", MAX_COMPILER_WORDS);
+      free(compiler);
+      return false;
+    }
+    arguments[count++] = word;
+  }
+  if(count == 0)
+    arguments[count++] = "cc";
+  arguments[count++] = "-O2";
+  arguments[count++] = "-I";
+  arguments[count++] = (char*)include_dir;
+  arguments[count++] = "-o";
+  arguments[count++] = (char*)executable;
+  arguments[count++] = (char*)source;
+  arguments[count++] = (char*)library;
+#ifndef _WIN32
+  arguments[count++] = "-lm";
+#endif // _WIN32
+  arguments[count] = NULL;
+  status = run_program_arguments(arguments);
+  free(compiler);
+  if(status != 0)
+  {
+    fprintf(stderr, "C compiler failed to build %s.\n", executable);
+    return false;
+  }
+  return true;
+}
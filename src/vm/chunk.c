@@ -0,0 +1,408 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>     // SIZE_MAX, UINT16_MAX
+#include <stdio.h>      // fprintf(), printf(), puts(), stderr
+#include <stdlib.h>     // free(), realloc()
+#include <string.h>     // memset()
+#include "vm/chunk.h"
+#include "vm/jit.h"   // free_native()
+#include "vm/vm.h"    // REGISTER_AMOUNT, vm
+
+// Initializes chunk
+void init_chunk(Chunk* chunk)
+{
+  chunk->count = 0;
+  chunk->capacity = 0;
+  chunk->code = NULL;
+  chunk->lines = NULL;
+  chunk->constant_count = 0;
+  chunk->constant_capacity = 0;
+  chunk->constants = NULL;
+  chunk->function_count = 0;
+  chunk->function_capacity = 0;
+  chunk->functions = NULL;
+  chunk->global_count = 0;
+  chunk->global_capacity = 0;
+  chunk->globals = NULL;
+  chunk->global_map_size = 0;
+  chunk->global_map = NULL;
+  chunk->has_error = false;
+  chunk->is_verified = false;
+  chunk->max_stack = 0;
+  chunk->unescaped = NULL;
+  chunk->hotness = 0;
+  chunk->native = NULL;
+  chunk->native_size = 0;
+  chunk->native_entries = NULL;
+  chunk->importers = 0;
+  return;
+}
+
+// Releases chunk contents (constants remain owned by the object store)
+void free_chunk(Chunk* chunk)
+{
+  free(chunk->code);
+  free(chunk->lines);
+  free(chunk->constants);
+  free(chunk->functions);
+  free(chunk->globals);
+  free(chunk->global_map);
+  free(chunk->unescaped);
+  free_native(chunk);
+  init_chunk(chunk);
+  return;
+}
+
+// Doubles the code capacity of chunk and returns false if memory could not be allocated
+static bool grow_code(Chunk* chunk)
+{
+  size_t capacity = chunk->capacity == 0 ? INITIAL_CHUNK_CAPACITY : chunk->capacity * 2;
+  Byte* code = realloc(chunk->code, capacity * sizeof(Byte));
+  size_t* lines = NULL;
+
+  if(code == NULL)
+    return false;
+  chunk->code = code;
+  lines = realloc(chunk->lines, capacity * sizeof(size_t));
+  if(lines == NULL)
+    return false;
+  chunk->lines = lines;
+  chunk->capacity = capacity;
+  return true;
+}
+
+// Appends a byte to chunk
+void write_chunk(Chunk* chunk, Byte byte, size_t line)
+{
+  if(chunk->has_error)
+    return;
+  if(chunk->count == chunk->capacity && !grow_code(chunk))
+  {
+    fprintf(stderr, "Unable to allocate memory for instructions (%zu bytes)!\n", chunk->count);
+    chunk->has_error = true;
+    return;
+  }
+  chunk->code[chunk->count] = byte;
+  chunk->lines[chunk->count] = line;
+  chunk->count++;
+  chunk->is_verified = false;
+  if(chunk->native != NULL)
+    free_native(chunk); // native code points into the instructions
+  return;
+}
+
+// Appends an opcode to chunk
+void write_opcode(Chunk* chunk, Opcode oc, size_t line)
+{
+  write_chunk(chunk, (Byte)oc, line);
+  return;
+}
+
+// Appends a 16-bit operand to chunk
+void write_short(Chunk* chunk, uint16_t value, size_t line)
+{
+  write_chunk(chunk, (Byte)(value & 0xFF), line);
+  write_chunk(chunk, (Byte)((value >> 8) & 0xFF), line);
+  return;
+}
+
+// Adds object to constant pool and returns its index
+uint16_t add_constant(Chunk* chunk, Object* object)
+{
+  size_t capacity = 0;
+  Object** constants = NULL;
+
+  if(chunk->constant_count == chunk->constant_capacity)
+  {
+    capacity = chunk->constant_capacity == 0 ? INITIAL_CONSTANT_CAPACITY : chunk->constant_capacity * 2;
+    if(capacity > MAX_CONSTANT_AMOUNT)
+      capacity = MAX_CONSTANT_AMOUNT;
+    if(chunk->constant_count < capacity)
+      constants = realloc(chunk->constants, capacity * sizeof(Object*));
+    if(constants == NULL)
+    {
+      if(!chunk->has_error)
+        fprintf(stderr, "Constant pool is full (%zu constants)!\n", chunk->constant_count);
+      chunk->has_error = true;
+      return 0;
+    }
+    chunk->constants = constants;
+    chunk->constant_capacity = capacity;
+  }
+  chunk->constants[chunk->constant_count] = object;
+  return (uint16_t)chunk->constant_count++;
+}
+
+// Adds function to the function table and returns its index
+uint16_t add_function(Chunk* chunk, const Function* function)
+{
+  size_t capacity = 0;
+  Function* functions = NULL;
+
+  if(chunk->function_count == chunk->function_capacity)
+  {
+    capacity = chunk->function_capacity == 0 ? 8 : chunk->function_capacity * 2;
+    if(capacity > MAX_FUNCTION_AMOUNT)
+      capacity = MAX_FUNCTION_AMOUNT;
+    if(chunk->function_count < capacity)
+      functions = realloc(chunk->functions, capacity * sizeof(Function));
+    if(functions == NULL)
+    {
+      if(!chunk->has_error)
+        fprintf(stderr, "Function table is full (%zu functions)!\n", chunk->function_count);
+      chunk->has_error = true;
+      return 0;
+    }
+    chunk->functions = functions;
+    chunk->function_capacity = capacity;
+  }
+  chunk->functions[chunk->function_count] = *function;
+  return (uint16_t)chunk->function_count++;
+}
+
+// Records that chunk uses the global slot
+void add_global(Chunk* chunk, uint16_t slot)
+{
+  size_t capacity = 0;
+  uint16_t* globals = NULL;
+  bool* map = NULL;
+
+  if(uses_global(chunk, slot))
+    return;
+  // The map covers every slot up to the highest one used, so membership is a lookup rather than a scan of globals
+  if(slot >= chunk->global_map_size)
+  {
+    capacity = chunk->global_map_size == 0 ? 64 : chunk->global_map_size * 2;
+    if(capacity <= slot)
+      capacity = (size_t)slot + 1;
+    map = realloc(chunk->global_map, capacity * sizeof(bool));
+    if(map == NULL)
+    {
+      fprintf(stderr, "Unable to allocate memory for %zu global slots!\n", capacity);
+      chunk->has_error = true;
+      return;
+    }
+    memset(map + chunk->global_map_size, 0, (capacity - chunk->global_map_size) * sizeof(bool));
+    chunk->global_map = map;
+    chunk->global_map_size = capacity;
+  }
+  if(chunk->global_count == chunk->global_capacity)
+  {
+    capacity = chunk->global_capacity == 0 ? 8 : chunk->global_capacity * 2;
+    globals = realloc(chunk->globals, capacity * sizeof(uint16_t));
+    if(globals == NULL)
+    {
+      fprintf(stderr, "Unable to allocate memory for %zu global slots!\n", capacity);
+      chunk->has_error = true;
+      return;
+    }
+    chunk->globals = globals;
+    chunk->global_capacity = capacity;
+  }
+  chunk->globals[chunk->global_count++] = slot;
+  chunk->global_map[slot] = true;
+  return;
+}
+
+// Returns offset targeted by the jump instruction at offset or SIZE_MAX if it would leave the start of chunk
+size_t get_jump_target(const Chunk* chunk, size_t offset)
+{
+  size_t next = offset + 1 + get_operand_length((Opcode)chunk->code[offset]);
+  size_t distance = read_short(&chunk->code[offset + 1]);
+
+  if(!is_loop_operation((Opcode)chunk->code[offset]))
+    return next + distance;
+  return distance > next ? SIZE_MAX : next - distance;
+}
+
+// Points the jump instruction at offset to target and returns false if the distance does not fit its operand
+bool set_jump_target(Chunk* chunk, size_t offset, size_t target)
+{
+  size_t next = offset + 1 + get_operand_length((Opcode)chunk->code[offset]);
+  size_t distance = is_loop_operation((Opcode)chunk->code[offset]) ? next - target : target - next;
+
+  if((is_loop_operation((Opcode)chunk->code[offset]) ? target > next : target < next) || distance > UINT16_MAX)
+    return false;
+  chunk->code[offset + 1] = (Byte)(distance & 0xFF);
+  chunk->code[offset + 2] = (Byte)((distance >> 8) & 0xFF);
+  return true;
+}
+
+// Prints a constant operand
+static void print_constant(const Chunk* chunk, uint16_t index)
+{
+  printf("#%u ", index);
+  if(index < chunk->constant_count)
+    print_object_value(chunk->constants[index]);
+  else
+    puts("(invalid constant)");
+  return;
+}
+
+// Prints a global slot operand followed by the name of the global
+static void print_global(uint16_t slot)
+{
+  if(slot < vm.global_count)
+    printf("G%u %s", slot, vm.global_names[slot]);
+  else
+    printf("G%u (invalid global)", slot);
+  return;
+}
+
+// Prints an RK operand as a register (Rn) or a constant index (#n)
+static void print_rk(Byte rk)
+{
+  if(rk < REGISTER_AMOUNT)
+    printf("R%u", rk);
+  else
+    printf("#%u", rk - REGISTER_AMOUNT);
+  return;
+}
+
+// Prints a single instruction and returns offset of the next instruction
+size_t print_instruction(const Chunk* chunk, size_t offset)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  const Byte* operands = &chunk->code[offset + 1];
+
+  printf("%04zu [%zu] %-8s", offset, chunk->lines[offset], get_mnemonic(oc));
+  switch(oc)
+  {
+    case OP_ASN:
+    case OP_GET:
+      printf(" ");
+      print_global(read_short(operands));
+      puts("");
+      break;
+    case OP_PSH:
+      printf(" ");
+      print_constant(chunk, read_short(operands));
+      break;
+    case OP_GET2:
+      printf(" ");
+      print_global(read_short(operands));
+      printf(", ");
+      print_global(read_short(&operands[2]));
+      puts("");
+      break;
+    case OP_SETK:
+      printf(" ");
+      print_global(read_short(operands));
+      printf(" <- ");
+      print_constant(chunk, read_short(&operands[2]));
+      break;
+    case OP_GOPK:
+      printf(" ");
+      print_global(read_short(operands));
+      printf(" %s= ", get_mnemonic((Opcode)operands[4]));
+      print_constant(chunk, read_short(&operands[2]));
+      break;
+    case OP_RASN:
+      printf(" R%u -> ", operands[2]);
+      print_global(read_short(operands));
+      puts("");
+      break;
+    case OP_RGET:
+      printf(" R%u <- ", operands[0]);
+      print_global(read_short(&operands[1]));
+      puts("");
+      break;
+    case OP_RLDK:
+      printf(" R%u <- ", operands[0]);
+      print_constant(chunk, read_short(&operands[1]));
+      break;
+    case OP_LOD:
+    case OP_STR:
+      printf(" R%u\n", operands[0]);
+      break;
+    case OP_CAL:
+    case OP_TCL:
+      if(read_short(operands) < chunk->function_count)
+        printf(" #%u %s\n", read_short(operands), chunk->functions[read_short(operands)].name);
+      else
+        printf(" #%u (invalid function)\n", read_short(operands));
+      break;
+    case OP_ENT:
+      printf(" %u\n", operands[0]);
+      break;
+    case OP_LDL:
+    case OP_STL:
+      printf(" L%u\n", operands[0]);
+      break;
+    case OP_MOV:
+    case OP_XCG:
+      printf(" R%u, R%u\n", operands[0], operands[1]);
+      break;
+    case OP_JNLK:
+    case OP_LLTK:
+      printf(" %c%u -> %04zu, ", is_loop_operation(oc) ? '-' : '+', read_short(operands),
+             get_jump_target(chunk, offset));
+      print_constant(chunk, read_short(&operands[2]));
+      break;
+    default:
+      if(is_jump_operation(oc))
+      {
+        printf(" %c%u -> %04zu\n", is_loop_operation(oc) ? '-' : '+', read_short(operands), get_jump_target(chunk, offset));
+        break;
+      }
+      if(is_constant_operation(oc))
+      {
+        printf(" ");
+        print_constant(chunk, read_short(operands));
+        break;
+      }
+      if(is_register_operation(oc))
+      {
+        printf(" R%u, ", operands[0]);
+        print_rk(operands[1]);
+        printf(", ");
+        print_rk(operands[2]);
+      }
+      puts("");
+      break;
+  }
+  return offset + 1 + get_operand_length(oc);
+}
+
+// Prints all instructions in chunk
+void print_chunk(const Chunk* chunk, const char* name)
+{
+  printf("== %s (%zu bytes, %zu constants, %zu functions, %zu globals) ==\n", name, chunk->count,
+         chunk->constant_count, chunk->function_count, chunk->global_count);
+  for(size_t offset = 0; offset < chunk->count;)
+  {
+    for(size_t i = 0; i < chunk->function_count; i++)
+    {
+      if(chunk->functions[i].chunk == chunk && chunk->functions[i].entry == offset)
+        printf("-- %s (%zu parameters, %zu locals) --\n", chunk->functions[i].name, chunk->functions[i].arity,
+               chunk->functions[i].local_count);
+    }
+    offset = print_instruction(chunk, offset);
+  }
+  return;
+}
@@ -25,74 +25,52 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <limits.h>           // CHAR_BIT
 #include <math.h>            // pow()
 #include <stdio.h>           // fprintf(), stderr
 #include <stdlib.h>          // malloc()
-#include <string.h>          // strcat(), strcmp()
+#include <string.h>          // memcpy(), strcat(), strcmp()
 #include "concoct.h"
 #include "debug.h"
 #include "memory.h"
 #include "vm/instructions.h"
 #include "vm/vm.h"
 
-// Validates unary operand
-RunCode unary_operand_check(const Object* operand, char* operator)
-{
-  if(operand->datatype == CCT_TYPE_NIL)
-  {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"null\"!\n", operator);
-    return RUN_ERROR;
-  }
-  if(operand->datatype == CCT_TYPE_BOOL)
-  {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"boolean\"!\n", operator);
-    return RUN_ERROR;
-  }
-  if(operand->datatype == CCT_TYPE_STRING)
-  {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"string\"!\n", operator);
-    return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
+// Longest string built at compile time by folding a concatenation or repetition
+#define MAX_FOLDED_STRING_LENGTH ((size_t)4096)
 
-// Validates binary operands
-RunCode binary_operand_check(const Object* operand1, const Object* operand2, char* operator)
+// Returns truth value of a condition (null, false, zero and the empty string are false)
+bool is_truthy(const Object* object)
 {
-  if(operand1->datatype == CCT_TYPE_NIL || operand2->datatype == CCT_TYPE_NIL)
-  {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"null\"!\n", operator);
-    return RUN_ERROR;
-  }
-  if(operand1->datatype == CCT_TYPE_BOOL || operand2->datatype == CCT_TYPE_BOOL)
+  switch(object->datatype)
   {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"boolean\"!\n", operator);
-    return RUN_ERROR;
-  }
-  if(operand1->datatype == CCT_TYPE_STRING || operand2->datatype == CCT_TYPE_STRING)
-  {
-    fprintf(stderr, "Invalid operation (%s) for object of type \"string\"!\n", operator);
-    return RUN_ERROR;
+    case CCT_TYPE_NIL:     return false;
+    case CCT_TYPE_BOOL:    return object->value.boolval;
+    case CCT_TYPE_BYTE:    return object->value.byteval != 0;
+    case CCT_TYPE_NUMBER:  return object->value.numval != 0;
+    case CCT_TYPE_BIGNUM:  return object->value.bignumval != 0;
+    case CCT_TYPE_DECIMAL: return object->value.decimalval != 0.0;
+    case CCT_TYPE_STRING:  return object->value.strobj.length != 0;
+    default:               return false;
   }
-  return RUN_SUCCESS;
 }
 
-// Validates binary operands for operations that allow a pair of strings (+ and *)
-RunCode binary_operand_check_str(const Object* operand1, const Object* operand2, char* operator)
+// Validates unary operand
+RunCode unary_operand_check(const Object* operand, char* operator)
 {
-  if(operand1->datatype == CCT_TYPE_NIL || operand2->datatype == CCT_TYPE_NIL)
+  if(operand->datatype == CCT_TYPE_NIL)
   {
     fprintf(stderr, "Invalid operation (%s) for object of type \"null\"!\n", operator);
     return RUN_ERROR;
   }
-  if(operand1->datatype == CCT_TYPE_BOOL || operand2->datatype == CCT_TYPE_BOOL)
+  if(operand->datatype == CCT_TYPE_BOOL)
   {
     fprintf(stderr, "Invalid operation (%s) for object of type \"boolean\"!\n", operator);
     return RUN_ERROR;
   }
-  if((operand1->datatype == CCT_TYPE_STRING && (operand2->datatype != CCT_TYPE_NUMBER && operand2->datatype != CCT_TYPE_STRING)) || (operand2->datatype == CCT_TYPE_STRING && (operand1->datatype != CCT_TYPE_NUMBER && operand1->datatype != CCT_TYPE_STRING)))
+  if(operand->datatype == CCT_TYPE_STRING)
   {
-    fprintf(stderr, "Invalid binary operation (%s) for object of type \"string\"!\n", operator);
+    fprintf(stderr, "Invalid operation (%s) for object of type \"string\"!\n", operator);
     return RUN_ERROR;
   }
   return RUN_SUCCESS;
@@ -165,6 +143,11 @@ RunCode op_str(Object** rp, Stack* stack, Byte src_reg)
 RunCode op_xcg(Object** rp, Byte reg1, Byte reg2)
 {
   Object* tmp = NULL;
+  if(reg1 >= REGISTER_AMOUNT || reg2 >= REGISTER_AMOUNT)
+  {
+    fprintf(stderr, "Invalid register during XCG operation.\n");
+    return RUN_ERROR;
+  }
   tmp = rp[reg1];
   rp[reg1] = rp[reg2];
   rp[reg2] = tmp;
@@ -179,47 +162,81 @@ RunCode op_pop(Stack* stack, const Object* object)
   return RUN_SUCCESS;
 }
 
-// Push
-RunCode op_psh(Stack* stack, char* value)
+// Push (constant)
+RunCode op_psh(Stack* stack, Object* constant)
 {
-  Object* operand = new_object(value);
-  if(operand == NULL)
+  if(constant == NULL)
   {
     fprintf(stderr, "Operand is NULL during PSH operation.\n");
     return RUN_ERROR;
   }
-  push(stack, operand);
+  push(stack, constant);
   return RUN_SUCCESS;
 }
 
-// Assign (=)
-RunCode op_asn(Stack* stack, ConcoctHashMap* map)
+// Get (push value of global)
+RunCode op_get(Stack* stack, Object* const* globals, uint16_t slot)
 {
-  Object* key = pop(stack); // identifier used as a key
-  Object* val = pop(stack); // value
-  if(key == NULL || key->datatype != CCT_TYPE_STRING)
+  if(globals[slot] == NULL)
   {
-    fprintf(stderr, "Identifier is not a string that can be used as a key during ASN operation.\n");
+    fprintf(stderr, "Undefined identifier \"%s\" during GET operation.\n", vm.global_names[slot]);
     return RUN_ERROR;
   }
+  push(stack, globals[slot]);
+  return RUN_SUCCESS;
+}
+
+// Assign (=)
+RunCode op_asn(Stack* stack, Object** globals, uint16_t slot)
+{
+  Object* val = pop(stack); // value
   if(val == NULL)
   {
     fprintf(stderr, "Value is NULL during ASN operation.\n");
     return RUN_ERROR;
   }
-  cct_hash_map_set(map, key->value.strobj.strval, val);
-  if(debug_mode)
-    print_object_value((Object *)cct_hash_map_get(map, key->value.strobj.strval));
-  key->is_flagged = true; // throw away the key since we have it in the map
+  globals[slot] = val;
+  return RUN_SUCCESS;
+}
+
+// Register get (load value of global into register)
+RunCode op_rget(Object** rp, Object* const* globals, Byte dst_reg, uint16_t slot)
+{
+  if(dst_reg >= REGISTER_AMOUNT)
+  {
+    fprintf(stderr, "Invalid register during RGET operation.\n");
+    return RUN_ERROR;
+  }
+  if(globals[slot] == NULL)
+  {
+    fprintf(stderr, "Undefined identifier \"%s\" during RGET operation.\n", vm.global_names[slot]);
+    return RUN_ERROR;
+  }
+  rp[dst_reg] = globals[slot];
+  return RUN_SUCCESS;
+}
+
+// Register assign (bind global to register value)
+RunCode op_rasn(Object** rp, Object** globals, uint16_t slot, Byte src_reg)
+{
+  if(src_reg >= REGISTER_AMOUNT)
+  {
+    fprintf(stderr, "Invalid register during RASN operation.\n");
+    return RUN_ERROR;
+  }
+  if(rp[src_reg] == NULL)
+  {
+    fprintf(stderr, "Value is NULL during RASN operation.\n");
+    return RUN_ERROR;
+  }
+  globals[slot] = rp[src_reg];
   return RUN_SUCCESS;
 }
 
 // Logical and (&&)
-RunCode op_and(Stack* stack)
+RunCode and_objects(Object** result, Object* operand1, Object* operand2)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-  Bool result = false;
+  Bool boolval = false;
   void* vptr = NULL;
 
   if(operand1 == NULL)
@@ -240,9 +257,9 @@ RunCode op_and(Stack* stack)
     return RUN_ERROR;
   }
 
-  result = *(Bool *)get_object_value(operand1) && *(Bool *)get_object_value(operand2);
-  vptr = &result;
-  push(stack, new_object_by_type(vptr, CCT_TYPE_BOOL));
+  boolval = *(Bool *)get_object_value(operand1) && *(Bool *)get_object_value(operand2);
+  vptr = &boolval;
+  *result = new_object_by_type(vptr, CCT_TYPE_BOOL);
 
   return RUN_SUCCESS;
 }
@@ -275,11 +292,9 @@ RunCode op_not(Stack* stack)
 }
 
 // Logical or (||)
-RunCode op_or(Stack* stack)
+RunCode or_objects(Object** result, Object* operand1, Object* operand2)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-  Bool result = false;
+  Bool boolval = false;
   void* vptr = NULL;
 
   if(operand1 == NULL)
@@ -300,377 +315,16 @@ RunCode op_or(Stack* stack)
     return RUN_ERROR;
   }
 
-  result = *(Bool *)get_object_value(operand1) || *(Bool *)get_object_value(operand2);
-  vptr = &result;
-  push(stack, new_object_by_type(vptr, CCT_TYPE_BOOL));
-
-  return RUN_SUCCESS;
-}
-
-// Equal to (==)
-RunCode op_eql(Stack* stack)
-{
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during EQL operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during EQL operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand1->datatype == CCT_TYPE_NIL && operand2->datatype == CCT_TYPE_NIL)
-  {
-    push(stack, new_object("true"));
-    return RUN_SUCCESS;
-  }
-
-  if(operand1->datatype == CCT_TYPE_BOOL && operand2->datatype == CCT_TYPE_BOOL)
-  {
-    if(operand1->value.boolval == operand2->value.boolval)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(strcmp(operand1->value.strobj.strval, operand2->value.strobj.strval) == 0)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) == *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) == *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) == *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) == *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (==)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) == *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) == *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) == *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) == *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (==)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) == *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) == *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) == *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) == *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (==)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) == *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) == *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) == *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) == *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (==)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (==)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
-
-// Not equal to (!=)
-RunCode op_neq(Stack* stack)
-{
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during NEQ operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during NEQ operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand1->datatype == CCT_TYPE_NIL && operand2->datatype == CCT_TYPE_NIL)
-  {
-    push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  if(operand1->datatype == CCT_TYPE_BOOL && operand2->datatype == CCT_TYPE_BOOL)
-  {
-    if(operand1->value.boolval != operand2->value.boolval)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(strcmp(operand1->value.strobj.strval, operand2->value.strobj.strval) != 0)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
+  boolval = *(Bool *)get_object_value(operand1) || *(Bool *)get_object_value(operand2);
+  vptr = &boolval;
+  *result = new_object_by_type(vptr, CCT_TYPE_BOOL);
 
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) != *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) != *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) != *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) != *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (!=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) != *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) != *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) != *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) != *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (!=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) != *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) != *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) != *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) != *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (!=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) != *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) != *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) != *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) != *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (!=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (!=)!\n");
-      return RUN_ERROR;
-  }
   return RUN_SUCCESS;
 }
 
 // String length equal to ($=)
-RunCode op_sle(Stack* stack)
+RunCode sle_objects(Object** result, Object* operand1, Object* operand2)
 {
-  const Object* operand1 = pop(stack);
-  const Object* operand2 = pop(stack);
-
   if(operand1 == NULL)
   {
     fprintf(stderr, "Operand 1 is NULL during SEQ operation.\n");
@@ -686,9 +340,9 @@ RunCode op_sle(Stack* stack)
   if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
   {
     if(operand1->value.strobj.length == operand2->value.strobj.length)
-      push(stack, new_object("true"));
+      *result = new_object("true");
     else
-      push(stack, new_object("false"));
+      *result = new_object("false");
     return RUN_SUCCESS;
   }
   else
@@ -699,11 +353,8 @@ RunCode op_sle(Stack* stack)
 }
 
 // String length not equal to ($!)
-RunCode op_sln(Stack* stack)
+RunCode sln_objects(Object** result, Object* operand1, Object* operand2)
 {
-  const Object* operand1 = pop(stack);
-  const Object* operand2 = pop(stack);
-
   if(operand1 == NULL)
   {
     fprintf(stderr, "Operand 1 is NULL during SNE operation.\n");
@@ -719,9 +370,9 @@ RunCode op_sln(Stack* stack)
   if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
   {
     if(operand1->value.strobj.length != operand2->value.strobj.length)
-      push(stack, new_object("true"));
+      *result = new_object("true");
     else
-      push(stack, new_object("false"));
+      *result = new_object("false");
     return RUN_SUCCESS;
   }
   else
@@ -731,735 +382,67 @@ RunCode op_sln(Stack* stack)
   }
 }
 
-// Greater than (>)
-RunCode op_gt(Stack* stack)
+// Negative
+RunCode op_neg(Stack* stack)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during GT operation.\n");
-    return RUN_ERROR;
-  }
+  Object* operand = pop(stack);
+  Number numval = 0;
+  BigNum bignumval = 0;
+  Decimal decimalval = 0.0;
+  void* vptr = NULL;
 
-  if(operand2 == NULL)
+  if(operand == NULL)
   {
-    fprintf(stderr, "Operand 2 is NULL during GT operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(binary_operand_check_str(operand1, operand2, ">") == RUN_ERROR)
+    fprintf(stderr, "Operand is NULL during NEG operation.\n");
     return RUN_ERROR;
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(operand1->value.strobj.length > operand2->value.strobj.length)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
   }
 
-  switch(operand1->datatype)
+  switch(operand->datatype)
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) > *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) > *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) > *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) > *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>)!\n");
-          return RUN_ERROR;
-      }
-      break;
     case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) > *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) > *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) > *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) > *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>)!\n");
-          return RUN_ERROR;
-      }
+      numval = *(Number *)get_object_value(operand);
+      if(numval > 0)
+        numval *= -1;
+      vptr = &numval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
       break;
     case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) > *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) > *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) > *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) > *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>)!\n");
-          return RUN_ERROR;
-      }
+      bignumval = *(BigNum *)get_object_value(operand);
+      if(bignumval > 0)
+        bignumval *= -1;
+      vptr = &bignumval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
       break;
     case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) > *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) > *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) > *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) > *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>)!\n");
-          return RUN_ERROR;
-      }
+      decimalval = *(Decimal *)get_object_value(operand);
+      if(decimalval > 0)
+        decimalval *= -1;
+      vptr = &decimalval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
       break;
     default:
-      fprintf(stderr, "Invalid operand type encountered during operation (>)!\n");
+      fprintf(stderr, "Invalid operand type encountered during NEG operation!\n");
       return RUN_ERROR;
   }
   return RUN_SUCCESS;
 }
 
-// Greater than or equal to (>=)
-RunCode op_gte(Stack* stack)
+// Positive
+RunCode op_pos(Stack* stack)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during GTE operation.\n");
-    return RUN_ERROR;
-  }
+  Object* operand = pop(stack);
+  Number numval = 0;
+  BigNum bignumval = 0;
+  Decimal decimalval = 0.0;
+  void* vptr = NULL;
 
-  if(operand2 == NULL)
+  if(operand == NULL)
   {
-    fprintf(stderr, "Operand 2 is NULL during GTE operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(binary_operand_check_str(operand1, operand2, ">=") == RUN_ERROR)
+    fprintf(stderr, "Operand is NULL during POS operation.\n");
     return RUN_ERROR;
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(operand1->value.strobj.length >= operand2->value.strobj.length)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
   }
 
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) >= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) >= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) >= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) >= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) >= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) >= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) >= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) >= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) >= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) >= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) >= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) >= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) >= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) >= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) >= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) >= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (>=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (>=)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
-
-// Less than (<)
-RunCode op_lt(Stack* stack)
-{
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during LT operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during LT operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(binary_operand_check_str(operand1, operand2, "<") == RUN_ERROR)
-    return RUN_ERROR;
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(operand1->value.strobj.length < operand2->value.strobj.length)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) < *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) < *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) < *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) < *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) < *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) < *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) < *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) < *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) < *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) < *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) < *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) < *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) < *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) < *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) < *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) < *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (<)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
-
-// Less than or equal to (<=)
-RunCode op_lte(Stack* stack)
-{
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during LTE operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during LTE operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(binary_operand_check_str(operand1, operand2, "<=") == RUN_ERROR)
-    return RUN_ERROR;
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING)
-  {
-    if(operand1->value.strobj.length <= operand2->value.strobj.length)
-      push(stack, new_object("true"));
-    else
-      push(stack, new_object("false"));
-    return RUN_SUCCESS;
-  }
-
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Byte *)get_object_value(operand1) <= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Byte *)get_object_value(operand1) <= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Byte *)get_object_value(operand1) <= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Byte *)get_object_value(operand1) <= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Number *)get_object_value(operand1) <= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Number *)get_object_value(operand1) <= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Number *)get_object_value(operand1) <= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Number *)get_object_value(operand1) <= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(BigNum *)get_object_value(operand1) <= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(BigNum *)get_object_value(operand1) <= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(BigNum *)get_object_value(operand1) <= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(BigNum *)get_object_value(operand1) <= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          if(*(Decimal *)get_object_value(operand1) <= *(Byte *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_NUMBER:
-          if(*(Decimal *)get_object_value(operand1) <= *(Number *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_BIGNUM:
-          if(*(Decimal *)get_object_value(operand1) <= *(BigNum *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        case CCT_TYPE_DECIMAL:
-          if(*(Decimal *)get_object_value(operand1) <= *(Decimal *)get_object_value(operand2))
-            push(stack, new_object("true"));
-          else
-            push(stack, new_object("false"));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (<=)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (<=)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
-
-// Negative
-RunCode op_neg(Stack* stack)
-{
-  Object* operand = pop(stack);
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
-
-  if(operand == NULL)
-  {
-    fprintf(stderr, "Operand is NULL during NEG operation.\n");
-    return RUN_ERROR;
-  }
-
-  switch(operand->datatype)
-  {
-    case CCT_TYPE_NUMBER:
-      numval = *(Number *)get_object_value(operand);
-      if(numval > 0)
-        numval *= -1;
-      vptr = &numval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-      break;
-    case CCT_TYPE_BIGNUM:
-      bignumval = *(BigNum *)get_object_value(operand);
-      if(bignumval > 0)
-        bignumval *= -1;
-      vptr = &bignumval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-      break;
-    case CCT_TYPE_DECIMAL:
-      decimalval = *(Decimal *)get_object_value(operand);
-      if(decimalval > 0)
-        decimalval *= -1;
-      vptr = &decimalval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during NEG operation!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
-}
-
-// Positive
-RunCode op_pos(Stack* stack)
-{
-  Object* operand = pop(stack);
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
-
-  if(operand == NULL)
-  {
-    fprintf(stderr, "Operand is NULL during POS operation.\n");
-    return RUN_ERROR;
-  }
-
-  switch(operand->datatype)
+  switch(operand->datatype)
   {
     case CCT_TYPE_NUMBER:
       numval = *(Number *)get_object_value(operand);
@@ -1593,1577 +576,1129 @@ RunCode op_inc(Stack* stack)
   return RUN_SUCCESS;
 }
 
-// Addition (+)
-RunCode op_add(Stack* stack)
+// Bitwise not/ones' complement (~)
+RunCode op_bnt(Stack* stack)
 {
-  Object* operand1 = pop(stack); // augend
-  Object* operand2 = pop(stack); // addend
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  char* addstr = NULL;
-  void* vptr = NULL;
-
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during ADD operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during ADD operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(binary_operand_check_str(operand1, operand2, "+") == RUN_ERROR)
-    return RUN_ERROR;
-
-  if(operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_STRING) // string concatenation
-  {
-    addstr = malloc(operand1->value.strobj.length + operand2->value.strobj.length + 1);
-    if(addstr == NULL)
-    {
-      fprintf(stderr, "Unable to allocate memory for string during ADD operation.\n");
-      return RUN_ERROR;
-    }
-    strcpy(addstr, operand1->value.strobj.strval);
-    push(stack, new_object(strcat(addstr, operand2->value.strobj.strval)));
-    free(addstr);
-  }
-  else
-  {
-    switch(operand1->datatype)
-    {
-      case CCT_TYPE_BYTE:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            byteval = *(Byte *)get_object_value(operand1) + *(Byte *)get_object_value(operand2);
-            vptr = &byteval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-            break;
-          case CCT_TYPE_NUMBER:
-            numval = *(Byte *)get_object_value(operand1) + *(Number *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(Byte *)get_object_value(operand1) + *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Byte *)get_object_value(operand1) + *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (+)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_NUMBER:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            numval = *(Number *)get_object_value(operand1) + *(Byte *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_NUMBER:
-            numval = *(Number *)get_object_value(operand1) + *(Number *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(Number *)get_object_value(operand1) + *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Number *)get_object_value(operand1) + *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (+)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_BIGNUM:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            bignumval = *(BigNum *)get_object_value(operand1) + *(Byte *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_NUMBER:
-            bignumval = *(BigNum *)get_object_value(operand1) + *(Number *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(BigNum *)get_object_value(operand1) + *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(BigNum *)get_object_value(operand1) + *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (+)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_DECIMAL:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            decimalval = *(Decimal *)get_object_value(operand1) + *(Byte *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_NUMBER:
-            decimalval = *(Decimal *)get_object_value(operand1) + *(Number *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_BIGNUM:
-            decimalval = *(Decimal *)get_object_value(operand1) + *(BigNum *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Decimal *)get_object_value(operand1) + *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (+)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      default:
-        fprintf(stderr, "Invalid operand type encountered during operation (+)!\n");
-        return RUN_ERROR;
-    }
-  }
-  return RUN_SUCCESS;
-}
+  Object* operand = pop(stack);
 
-// Subtraction (-)
-RunCode op_sub(Stack* stack)
-{
-  Object* operand1 = pop(stack); // minuend
-  Object* operand2 = pop(stack); // subtrahend
   Byte byteval = 0;
   Number numval = 0;
   BigNum bignumval = 0;
   Decimal decimalval = 0.0;
   void* vptr = NULL;
 
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during SUB operation.\n");
-    return RUN_ERROR;
-  }
-
-  if(operand2 == NULL)
+  if(operand == NULL)
   {
-    fprintf(stderr, "Operand 2 is NULL during SUB operation.\n");
+    fprintf(stderr, "Operand is NULL during BNT operation.\n");
     return RUN_ERROR;
   }
 
-  if(binary_operand_check(operand1, operand2, "-") == RUN_ERROR)
+  if(unary_operand_check(operand, "~") == RUN_ERROR)
     return RUN_ERROR;
 
-  switch(operand1->datatype)
+  switch(operand->datatype)
   {
     case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) - *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) - *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) - *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Byte *)get_object_value(operand1) - *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (-)!\n");
-          return RUN_ERROR;
-      }
+      byteval = *(Byte *)get_object_value(operand);
+      byteval = ~byteval;
+      vptr = &byteval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
       break;
     case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) - *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) - *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) - *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Number *)get_object_value(operand1) - *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (-)!\n");
-          return RUN_ERROR;
-      }
+      numval = *(Number *)get_object_value(operand);
+      numval = ~numval;
+      vptr = &numval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
       break;
     case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) - *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) - *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) - *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(BigNum *)get_object_value(operand1) - *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (-)!\n");
-          return RUN_ERROR;
-      }
+      bignumval = *(BigNum *)get_object_value(operand);
+      bignumval = ~bignumval;
+      vptr = &bignumval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
       break;
     case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = *(Decimal *)get_object_value(operand1) - *(Byte *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = *(Decimal *)get_object_value(operand1) - *(Number *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = *(Decimal *)get_object_value(operand1) - *(BigNum *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Decimal *)get_object_value(operand1) - *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (-)!\n");
-          return RUN_ERROR;
-      }
+      decimalval = *(Decimal *)get_object_value(operand);
+      decimalval = ~(Number)decimalval;
+      vptr = &decimalval;
+      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
       break;
     default:
-      fprintf(stderr, "Invalid operand type encountered during operation (-)!\n");
+      fprintf(stderr, "Invalid operand type encountered during operation (~)!\n");
       return RUN_ERROR;
   }
   return RUN_SUCCESS;
 }
 
-// Division (/)
-RunCode op_div(Stack* stack)
-{
-  Object* operand1 = pop(stack); // dividend
-  Object* operand2 = pop(stack); // divisor
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
-  Bool div_by_zero = false;
+/*
+ * Numeric promotion
+ *
+ * Numeric operands are promoted along the lattice Byte < Number < BigNum < Decimal. A binary operation on two
+ * numeric operands is computed in the larger of their two types, which is also the type of an arithmetic result.
+ * The kernel macros below generate each operator once per promoted type, and every operator dispatches through a
+ * table indexed by the type tags of both operands. Empty table entries mark invalid operand combinations.
+ *
+ * Integer kernels compute in BigNum and narrow the result to the promoted type. Modulo and the bitwise operators
+ * truncate decimal operands to BigNum and return a decimal.
+ *
+ * Addition, subtraction, multiplication, division and exponentiation never wrap: a result that does not fit the
+ * promoted type widens to the narrowest integer type holding it, and a BigNum overflow yields a decimal. Byte and
+ * Number operands cannot overflow a BigNum, so their kernels only range check the exact result. BigNum kernels use
+ * the compiler's overflow builtins where available.
+ */
 
-  if(operand1 == NULL)
+typedef const BinaryKernel KernelTable[DATA_TYPE_AMOUNT][DATA_TYPE_AMOUNT];
+
+// Returns numeric operand as BigNum (decimals are truncated)
+static inline BigNum integer_value(const Object* operand)
+{
+  switch(operand->datatype)
   {
-    fprintf(stderr, "Operand 1 is NULL during DIV operation.\n");
-    return RUN_ERROR;
+    case CCT_TYPE_BYTE:   return operand->value.byteval;
+    case CCT_TYPE_NUMBER: return operand->value.numval;
+    case CCT_TYPE_BIGNUM: return operand->value.bignumval;
+    default:              return (BigNum)operand->value.decimalval;
   }
+}
 
-  if(operand2 == NULL)
+// Returns numeric operand as Decimal
+static inline Decimal decimal_value(const Object* operand)
+{
+  switch(operand->datatype)
   {
-    fprintf(stderr, "Operand 2 is NULL during DIV operation.\n");
-    return RUN_ERROR;
+    case CCT_TYPE_BYTE:   return operand->value.byteval;
+    case CCT_TYPE_NUMBER: return operand->value.numval;
+    case CCT_TYPE_BIGNUM: return (Decimal)operand->value.bignumval;
+    default:              return operand->value.decimalval;
   }
+}
+
+// Stores a scalar (Bool, Byte, Number, BigNum or Decimal) value of datatype in scratch or, if scratch is NULL, in a
+// new object of the store (see get_scratch())
+static inline Object* store_scalar(Object* scratch, void* data, DataType datatype)
+{
+  if(scratch == NULL)
+    return new_object_by_type(data, datatype);
+  scratch->datatype = datatype;
+  switch(datatype)
+  {
+    case CCT_TYPE_BOOL:   scratch->value.boolval = *(Bool*)data; break;
+    case CCT_TYPE_BYTE:   scratch->value.byteval = *(Byte*)data; break;
+    case CCT_TYPE_NUMBER: scratch->value.numval = *(Number*)data; break;
+    case CCT_TYPE_BIGNUM: scratch->value.bignumval = *(BigNum*)data; break;
+    default:              scratch->value.decimalval = *(Decimal*)data; break;
+  }
+  return scratch;
+}
+
+// Stores integer value as datatype in scratch or a new object (see store_scalar()), widening to the narrowest larger
+// integer type if it does not fit
+static inline Object* store_integer(Object* scratch, BigNum value, DataType datatype)
+{
+  Byte byteval = 0;
+  Number numval = 0;
+  Decimal decimalval = 0.0;
 
-  switch(operand2->datatype)
+  if(datatype == CCT_TYPE_DECIMAL)
   {
-    case CCT_TYPE_BYTE:
-      if(*(Byte *)get_object_value(operand2) == 0)
-        div_by_zero = true;
-      break;
-    case CCT_TYPE_NUMBER:
-      if(*(Number *)get_object_value(operand2) == 0)
-        div_by_zero = true;
-      break;
-    case CCT_TYPE_BIGNUM:
-      if(*(BigNum *)get_object_value(operand2) == 0)
-        div_by_zero = true;
-      break;
-    case CCT_TYPE_DECIMAL:
-      if(*(Decimal *)get_object_value(operand2) == 0.0)
-        div_by_zero = true;
-      break;
-    default:
-      break;
+    decimalval = (Decimal)value;
+    return store_scalar(scratch, &decimalval, CCT_TYPE_DECIMAL);
   }
-  if(div_by_zero)
+  if(datatype == CCT_TYPE_BYTE && value >= 0 && value <= UINT8_MAX)
   {
-    fprintf(stderr, "Operand 2 is 0 (zero) during DIV operation.\n");
-    return RUN_ERROR;
+    byteval = (Byte)value;
+    return store_scalar(scratch, &byteval, CCT_TYPE_BYTE);
   }
+  if(datatype != CCT_TYPE_BIGNUM && value >= INT32_MIN && value <= INT32_MAX)
+  {
+    numval = (Number)value;
+    return store_scalar(scratch, &numval, CCT_TYPE_NUMBER);
+  }
+  return store_scalar(scratch, &value, CCT_TYPE_BIGNUM);
+}
 
-  if(binary_operand_check(operand1, operand2, "/") == RUN_ERROR)
-    return RUN_ERROR;
+// Creates an object of datatype for integer value, widening to the narrowest larger integer type if it does not fit
+static inline Object* new_integer(BigNum value, DataType datatype)
+{
+  return store_integer(NULL, value, datatype);
+}
+
+// Adds two BigNums into value and returns true on overflow
+static inline bool add_overflows(BigNum a, BigNum b, BigNum* value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_add_overflow(a, b, value);
+#else
+  if((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+    return true;
+  *value = a + b;
+  return false;
+#endif
+}
+
+// Subtracts two BigNums into value and returns true on overflow
+static inline bool sub_overflows(BigNum a, BigNum b, BigNum* value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_sub_overflow(a, b, value);
+#else
+  if((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b))
+    return true;
+  *value = a - b;
+  return false;
+#endif
+}
+
+// Multiplies two BigNums into value and returns true on overflow
+static inline bool mul_overflows(BigNum a, BigNum b, BigNum* value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_mul_overflow(a, b, value);
+#else
+  if(a > 0 ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+           : (b > 0 ? a < INT64_MIN / b : (a != 0 && b < INT64_MAX / a)))
+    return true;
+  *value = a * b;
+  return false;
+#endif
+}
+
+// Raises base to a non-negative exponent by squaring into value and returns true on overflow
+static inline bool pow_overflows(BigNum base, BigNum exponent, BigNum* value)
+{
+  BigNum power = 1;
 
-  switch(operand1->datatype)
+  while(exponent > 0)
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) / *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) / *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) / *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Byte *)get_object_value(operand1) / *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (/)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) / *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) / *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) / *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Number *)get_object_value(operand1) / *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (/)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) / *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) / *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) / *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(BigNum *)get_object_value(operand1) / *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (/)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = *(Decimal *)get_object_value(operand1) / *(Byte *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = *(Decimal *)get_object_value(operand1) / *(Number *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = *(Decimal *)get_object_value(operand1) / *(BigNum *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Decimal *)get_object_value(operand1) / *(Decimal *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (/)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (/)!\n");
-      return RUN_ERROR;
+    if((exponent & 1) && mul_overflows(power, base, &power))
+      return true;
+    exponent >>= 1;
+    if(exponent > 0 && mul_overflows(base, base, &base))
+      return true;
   }
-  return RUN_SUCCESS;
+  *value = power;
+  return false;
 }
 
-// Multiplication (*)
-RunCode op_mul(Stack* stack)
+// Reports division by zero
+static RunCode divide_by_zero(const char* operation)
 {
-  Object* operand1 = pop(stack); // multiplier
-  Object* operand2 = pop(stack); // multiplicand
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
+  fprintf(stderr, "Operand 2 is 0 (zero) during %s operation.\n", operation);
+  return RUN_ERROR;
+}
+
+// Returns true if shift count operand is within the width of the BigNum a shift is computed in. Decimal counts are
+// checked before truncation, so huge values never reach an out-of-range conversion.
+static inline bool is_shift_count(const Object* operand)
+{
+  Decimal count = decimal_value(operand);
+  return count >= 0.0 && count < (Decimal)(sizeof(BigNum) * CHAR_BIT);
+}
+
+// Reports a negative or too large shift count
+static RunCode shift_out_of_range(const Object* operand, const char* operation)
+{
+  fprintf(stderr, "Operand 2 (%g) is out of range (0 to %zu) during %s operation.\n", (double)decimal_value(operand),
+          sizeof(BigNum) * CHAR_BIT - 1, operation);
+  return RUN_ERROR;
+}
+
+// Kernel computing expression of BigNum a and b as ctype
+#define INTEGER_KERNEL(name, ctype, datatype, expression) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    BigNum a = integer_value(operand1); \
+    BigNum b = integer_value(operand2); \
+    ctype value = (ctype)(expression); \
+    *result = new_object_by_type(&value, datatype); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel shifting BigNum a by b with expression as ctype after rejecting a count outside the width of a BigNum
+#define SHIFT_KERNEL(name, ctype, datatype, expression, operation) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    BigNum a = 0; \
+    BigNum b = 0; \
+    ctype value = 0; \
+    if(UNLIKELY(!is_shift_count(operand2))) \
+      return shift_out_of_range(operand2, operation); \
+    a = integer_value(operand1); \
+    b = integer_value(operand2); \
+    value = (ctype)(expression); \
+    *result = new_object_by_type(&value, datatype); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel computing exact expression of BigNum a and b as datatype or a wider integer type
+#define WIDENING_KERNEL(name, datatype, operator) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    *result = new_integer(integer_value(operand1) operator integer_value(operand2), datatype); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel computing BigNum a operator b with checked, falling back to a decimal on overflow
+#define CHECKED_KERNEL(name, checked, operator) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    BigNum a = integer_value(operand1); \
+    BigNum b = integer_value(operand2); \
+    BigNum value = 0; \
+    Decimal decimalval = 0.0; \
+    if(LIKELY(!checked(a, b, &value))) \
+    { \
+      *result = new_object_by_type(&value, CCT_TYPE_BIGNUM); \
+      return RUN_SUCCESS; \
+    } \
+    decimalval = (Decimal)a operator (Decimal)b; \
+    *result = new_object_by_type(&decimalval, CCT_TYPE_DECIMAL); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel computing expression of BigNum a and b as datatype or a wider integer type after rejecting a zero divisor
+#define INTEGER_DIVISION_KERNEL(name, datatype, expression, operation) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    BigNum a = integer_value(operand1); \
+    BigNum b = integer_value(operand2); \
+    if(b == 0) \
+      return divide_by_zero(operation); \
+    *result = new_integer(expression, datatype); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel raising BigNum a to b by squaring as datatype or a wider integer type (decimal for negative b or overflow)
+#define POWER_KERNEL(name, datatype) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    BigNum a = integer_value(operand1); \
+    BigNum b = integer_value(operand2); \
+    BigNum value = 0; \
+    Decimal decimalval = 0.0; \
+    if(LIKELY(b >= 0 && !pow_overflows(a, b, &value))) \
+    { \
+      *result = new_integer(value, datatype); \
+      return RUN_SUCCESS; \
+    } \
+    decimalval = pow((Decimal)a, (Decimal)b); \
+    *result = new_object_by_type(&decimalval, CCT_TYPE_DECIMAL); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel computing expression of Decimal a and b as Decimal
+#define DECIMAL_KERNEL(name, expression) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    Decimal a = decimal_value(operand1); \
+    Decimal b = decimal_value(operand2); \
+    Decimal value = (expression); \
+    *result = new_object_by_type(&value, CCT_TYPE_DECIMAL); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernel computing boolean expression of a and b loaded by loader as ctype
+#define COMPARISON_KERNEL(name, ctype, loader, expression) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    ctype a = loader(operand1); \
+    ctype b = loader(operand2); \
+    Bool boolval = (expression); \
+    *result = new_object_by_type(&boolval, CCT_TYPE_BOOL); \
+    return RUN_SUCCESS; \
+  }
+
+// Kernels of an arithmetic operator for each numeric type
+#define ARITHMETIC_KERNELS(op, operator) \
+  WIDENING_KERNEL(op##_as_byte, CCT_TYPE_BYTE, operator) \
+  WIDENING_KERNEL(op##_as_number, CCT_TYPE_NUMBER, operator) \
+  CHECKED_KERNEL(op##_as_bignum, op##_overflows, operator) \
+  DECIMAL_KERNEL(op##_as_decimal, a operator b)
+
+// Kernels of an integer operator for each numeric type (decimal operands are truncated)
+#define INTEGER_KERNELS(op, expression) \
+  INTEGER_KERNEL(op##_as_byte, Byte, CCT_TYPE_BYTE, expression) \
+  INTEGER_KERNEL(op##_as_number, Number, CCT_TYPE_NUMBER, expression) \
+  INTEGER_KERNEL(op##_as_bignum, BigNum, CCT_TYPE_BIGNUM, expression) \
+  INTEGER_KERNEL(op##_as_decimal, Decimal, CCT_TYPE_DECIMAL, expression)
+
+// Kernels of a shift operator for each numeric type (decimal operands are truncated)
+#define SHIFT_KERNELS(op, expression, operation) \
+  SHIFT_KERNEL(op##_as_byte, Byte, CCT_TYPE_BYTE, expression, operation) \
+  SHIFT_KERNEL(op##_as_number, Number, CCT_TYPE_NUMBER, expression, operation) \
+  SHIFT_KERNEL(op##_as_bignum, BigNum, CCT_TYPE_BIGNUM, expression, operation) \
+  SHIFT_KERNEL(op##_as_decimal, Decimal, CCT_TYPE_DECIMAL, expression, operation)
+
+// Kernels of a comparison operator for each numeric type (integer types compare alike as BigNum)
+#define COMPARISON_KERNELS(op, operator) \
+  COMPARISON_KERNEL(op##_as_integer, BigNum, integer_value, a operator b) \
+  COMPARISON_KERNEL(op##_as_decimal, Decimal, decimal_value, a operator b)
+
+// Table entries selecting the kernel of the promoted type for every pair of numeric operand types
+#define PROMOTED_ENTRIES(byte_kernel, number_kernel, bignum_kernel, decimal_kernel) \
+  [CCT_TYPE_BYTE][CCT_TYPE_BYTE] = byte_kernel, \
+  [CCT_TYPE_BYTE][CCT_TYPE_NUMBER] = number_kernel, \
+  [CCT_TYPE_BYTE][CCT_TYPE_BIGNUM] = bignum_kernel, \
+  [CCT_TYPE_BYTE][CCT_TYPE_DECIMAL] = decimal_kernel, \
+  [CCT_TYPE_NUMBER][CCT_TYPE_BYTE] = number_kernel, \
+  [CCT_TYPE_NUMBER][CCT_TYPE_NUMBER] = number_kernel, \
+  [CCT_TYPE_NUMBER][CCT_TYPE_BIGNUM] = bignum_kernel, \
+  [CCT_TYPE_NUMBER][CCT_TYPE_DECIMAL] = decimal_kernel, \
+  [CCT_TYPE_BIGNUM][CCT_TYPE_BYTE] = bignum_kernel, \
+  [CCT_TYPE_BIGNUM][CCT_TYPE_NUMBER] = bignum_kernel, \
+  [CCT_TYPE_BIGNUM][CCT_TYPE_BIGNUM] = bignum_kernel, \
+  [CCT_TYPE_BIGNUM][CCT_TYPE_DECIMAL] = decimal_kernel, \
+  [CCT_TYPE_DECIMAL][CCT_TYPE_BYTE] = decimal_kernel, \
+  [CCT_TYPE_DECIMAL][CCT_TYPE_NUMBER] = decimal_kernel, \
+  [CCT_TYPE_DECIMAL][CCT_TYPE_BIGNUM] = decimal_kernel, \
+  [CCT_TYPE_DECIMAL][CCT_TYPE_DECIMAL] = decimal_kernel
+
+// Table entries of an operator generated by ARITHMETIC_KERNELS() or INTEGER_KERNELS()
+#define ARITHMETIC_ENTRIES(op) PROMOTED_ENTRIES(op##_as_byte, op##_as_number, op##_as_bignum, op##_as_decimal)
+
+// Table entries of an operator generated by COMPARISON_KERNELS()
+#define COMPARISON_ENTRIES(op) PROMOTED_ENTRIES(op##_as_integer, op##_as_integer, op##_as_integer, op##_as_decimal)
+
+// Table entries mapping left operand type left to kernel for every numeric right operand type
+#define ROW_ENTRIES(left, kernel) \
+  [left][CCT_TYPE_BYTE] = kernel, \
+  [left][CCT_TYPE_NUMBER] = kernel, \
+  [left][CCT_TYPE_BIGNUM] = kernel, \
+  [left][CCT_TYPE_DECIMAL] = kernel
+
+// Table entries of a shift operator whose result keeps the type of its left operand
+#define SHIFT_ENTRIES(op) \
+  ROW_ENTRIES(CCT_TYPE_BYTE, op##_as_byte), \
+  ROW_ENTRIES(CCT_TYPE_NUMBER, op##_as_number), \
+  ROW_ENTRIES(CCT_TYPE_BIGNUM, op##_as_bignum), \
+  ROW_ENTRIES(CCT_TYPE_DECIMAL, op##_as_decimal)
+
+ARITHMETIC_KERNELS(add, +)
+ARITHMETIC_KERNELS(sub, -)
+ARITHMETIC_KERNELS(mul, *)
+INTEGER_DIVISION_KERNEL(div_as_byte, CCT_TYPE_BYTE, a / b, "DIV")
+INTEGER_DIVISION_KERNEL(div_as_number, CCT_TYPE_NUMBER, a / b, "DIV")
+INTEGER_DIVISION_KERNEL(mod_as_byte, CCT_TYPE_BYTE, a % b, "MOD")
+INTEGER_DIVISION_KERNEL(mod_as_number, CCT_TYPE_NUMBER, a % b, "MOD")
+INTEGER_DIVISION_KERNEL(mod_as_bignum, CCT_TYPE_BIGNUM, b == -1 ? 0 : a % b, "MOD")
+INTEGER_DIVISION_KERNEL(mod_as_decimal, CCT_TYPE_DECIMAL, b == -1 ? 0 : a % b, "MOD")
+POWER_KERNEL(pow_as_byte, CCT_TYPE_BYTE)
+POWER_KERNEL(pow_as_number, CCT_TYPE_NUMBER)
+POWER_KERNEL(pow_as_bignum, CCT_TYPE_BIGNUM)
+DECIMAL_KERNEL(pow_as_decimal, pow(a, b))
+INTEGER_KERNELS(bnd, a & b)
+INTEGER_KERNELS(bor, a | b)
+INTEGER_KERNELS(xor, a ^ b)
+SHIFT_KERNELS(shl, (BigNum)((uint64_t)a << b), "SHL")
+SHIFT_KERNELS(shr, a >> b, "SHR")
+COMPARISON_KERNELS(eql, ==)
+COMPARISON_KERNELS(neq, !=)
+COMPARISON_KERNELS(gt, >)
+COMPARISON_KERNELS(gte, >=)
+COMPARISON_KERNELS(lt, <)
+COMPARISON_KERNELS(lte, <=)
+
+// BigNum division (rejects a zero divisor and returns a decimal for the one overflowing quotient)
+static RunCode div_as_bignum(Object** result, Object* operand1, Object* operand2)
+{
+  BigNum a = integer_value(operand1);
+  BigNum b = integer_value(operand2);
   Decimal decimalval = 0.0;
-  char* multstr = NULL;
-  void* vptr = NULL;
 
-  if(operand1 == NULL)
+  if(b == 0)
+    return divide_by_zero("DIV");
+  if(UNLIKELY(b == -1 && a == INT64_MIN))
   {
-    fprintf(stderr, "Operand 1 is NULL during MUL operation.\n");
-    return RUN_ERROR;
+    decimalval = -(Decimal)a;
+    *result = new_object_by_type(&decimalval, CCT_TYPE_DECIMAL);
+    return RUN_SUCCESS;
   }
+  a /= b;
+  *result = new_object_by_type(&a, CCT_TYPE_BIGNUM);
+  return RUN_SUCCESS;
+}
 
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during MUL operation.\n");
-    return RUN_ERROR;
-  }
+// Decimal division (rejects a zero divisor)
+static RunCode div_as_decimal(Object** result, Object* operand1, Object* operand2)
+{
+  Decimal decimalval = decimal_value(operand2);
 
-  if(binary_operand_check_str(operand1, operand2, "*") == RUN_ERROR)
-    return RUN_ERROR;
+  if(decimalval == 0.0)
+    return divide_by_zero("DIV");
+  decimalval = decimal_value(operand1) / decimalval;
+  *result = new_object_by_type(&decimalval, CCT_TYPE_DECIMAL);
+  return RUN_SUCCESS;
+}
 
-  // string multiplication
-  if((operand1->datatype == CCT_TYPE_STRING && operand2->datatype == CCT_TYPE_NUMBER) || (operand1->datatype == CCT_TYPE_NUMBER && operand2->datatype == CCT_TYPE_STRING))
-  {
-    if(operand1->datatype == CCT_TYPE_STRING)
-    {
-      multstr = malloc(operand1->value.strobj.length * *(Number *)get_object_value(operand2) + *(Number *)get_object_value(operand2));
-      if(multstr == NULL)
-      {
-        fprintf(stderr, "Unable to allocate memory for string during MUL operation.\n");
-        return RUN_ERROR;
-      }
-      strcpy(multstr, operand1->value.strobj.strval);
-      // start counter at 1 since we already called strcpy() above to null terminate multstr
-      for(int i = 1; i < abs(*(Number *)get_object_value(operand2)); i++)
-        strcat(multstr, operand1->value.strobj.strval);
-    }
-    else
-    {
-      multstr = malloc(operand2->value.strobj.length * *(Number *)get_object_value(operand1) + *(Number *)get_object_value(operand1));
-      if(multstr == NULL)
-      {
-        fprintf(stderr, "Unable to allocate memory for string during MUL operation.\n");
-        return RUN_ERROR;
-      }
-      strcpy(multstr, operand2->value.strobj.strval);
-      // start counter at 1 since we already called strcpy() above to null terminate multstr
-      for(int i = 1; i < abs(*(Number *)get_object_value(operand1)); i++)
-        strcat(multstr, operand2->value.strobj.strval);
-    }
-    push(stack, new_object(multstr));
-    free(multstr);
-  }
-  else
-  {
-    switch(operand1->datatype)
-    {
-      case CCT_TYPE_BYTE:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            byteval = *(Byte *)get_object_value(operand1) * *(Byte *)get_object_value(operand2);
-            vptr = &byteval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-            break;
-          case CCT_TYPE_NUMBER:
-            numval = *(Byte *)get_object_value(operand1) * *(Number *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(Byte *)get_object_value(operand1) * *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Byte *)get_object_value(operand1) * *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (*)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_NUMBER:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            numval = *(Number *)get_object_value(operand1) * *(Byte *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_NUMBER:
-            numval = *(Number *)get_object_value(operand1) * *(Number *)get_object_value(operand2);
-            vptr = &numval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(Number *)get_object_value(operand1) * *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Number *)get_object_value(operand1) * *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (*)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_BIGNUM:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            bignumval = *(BigNum *)get_object_value(operand1) * *(Byte *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_NUMBER:
-            bignumval = *(BigNum *)get_object_value(operand1) * *(Number *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_BIGNUM:
-            bignumval = *(BigNum *)get_object_value(operand1) * *(BigNum *)get_object_value(operand2);
-            vptr = &bignumval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(BigNum *)get_object_value(operand1) * *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (*)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      case CCT_TYPE_DECIMAL:
-        switch(operand2->datatype)
-        {
-          case CCT_TYPE_BYTE:
-            decimalval = *(Decimal *)get_object_value(operand1) * *(Byte *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_NUMBER:
-            decimalval = *(Decimal *)get_object_value(operand1) * *(Number *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_BIGNUM:
-            decimalval = *(Decimal *)get_object_value(operand1) * *(BigNum *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          case CCT_TYPE_DECIMAL:
-            decimalval = *(Decimal *)get_object_value(operand1) * *(Decimal *)get_object_value(operand2);
-            vptr = &decimalval;
-            push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-            break;
-          default:
-            fprintf(stderr, "Invalid operand type encountered during operation (*)!\n");
-            return RUN_ERROR;
-        }
-        break;
-      default:
-        fprintf(stderr, "Invalid operand type encountered during operation (*)!\n");
-        return RUN_ERROR;
-    }
+// Kernel comparing the lengths of two strings
+#define LENGTH_KERNEL(name, operator) \
+  static RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    Bool boolval = operand1->value.strobj.length operator operand2->value.strobj.length; \
+    *result = new_object_by_type(&boolval, CCT_TYPE_BOOL); \
+    return RUN_SUCCESS; \
   }
+
+LENGTH_KERNEL(gt_lengths, >)
+LENGTH_KERNEL(gte_lengths, >=)
+LENGTH_KERNEL(lt_lengths, <)
+LENGTH_KERNEL(lte_lengths, <=)
+
+// Returns true for two nulls
+static RunCode eql_nils(Object** result, Object* operand1, Object* operand2)
+{
+  Bool boolval = true;
+
+  UNUSED(operand1);
+  UNUSED(operand2);
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
   return RUN_SUCCESS;
 }
 
-// Modulo (%)
-// Note: Modulo operates on integers. Decimal numbers are truncated.
-RunCode op_mod(Stack* stack)
+// Returns false for two nulls
+static RunCode neq_nils(Object** result, Object* operand1, Object* operand2)
 {
-  Object* operand1 = pop(stack); // dividend
-  Object* operand2 = pop(stack); // divisor
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  Bool boolval = false;
 
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during MOD operation.\n");
-    return RUN_ERROR;
-  }
+  UNUSED(operand1);
+  UNUSED(operand2);
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
+  return RUN_SUCCESS;
+}
 
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during MOD operation.\n");
-    return RUN_ERROR;
-  }
+// Compares two booleans for equality
+static RunCode eql_bools(Object** result, Object* operand1, Object* operand2)
+{
+  Bool boolval = operand1->value.boolval == operand2->value.boolval;
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
+  return RUN_SUCCESS;
+}
 
-  if(binary_operand_check(operand1, operand2, "%") == RUN_ERROR)
-    return RUN_ERROR;
+// Compares two booleans for inequality
+static RunCode neq_bools(Object** result, Object* operand1, Object* operand2)
+{
+  Bool boolval = operand1->value.boolval != operand2->value.boolval;
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
+  return RUN_SUCCESS;
+}
 
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) % *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) % *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) % *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(Byte *)get_object_value(operand1) % (BigNum)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (%%)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) % *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) % *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) % *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(Number *)get_object_value(operand1) % (BigNum)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (%%)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) % *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) % *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) % *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(BigNum *)get_object_value(operand1) % (BigNum)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (%%)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = (Decimal)((BigNum)(*(Decimal *)get_object_value(operand1)) % *(Byte *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = (Decimal)((BigNum)(*(Decimal *)get_object_value(operand1)) % *(Number *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = (Decimal)((BigNum)(*(Decimal *)get_object_value(operand1)) % *(BigNum *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)((BigNum)(*(Decimal *)get_object_value(operand1)) % (BigNum)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (%%)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (%%)!\n");
-      return RUN_ERROR;
-  }
+// Compares two strings for equality
+static RunCode eql_strings(Object** result, Object* operand1, Object* operand2)
+{
+  Bool boolval = strcmp(operand1->value.strobj.strval, operand2->value.strobj.strval) == 0;
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
   return RUN_SUCCESS;
 }
 
-// Exponentiation (**)
-RunCode op_pow(Stack* stack)
+// Compares two strings for inequality
+static RunCode neq_strings(Object** result, Object* operand1, Object* operand2)
 {
-  Object* operand1 = pop(stack); // base
-  Object* operand2 = pop(stack); // exponent/power to raise by
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  Bool boolval = strcmp(operand1->value.strobj.strval, operand2->value.strobj.strval) != 0;
+  *result = new_object_by_type(&boolval, CCT_TYPE_BOOL);
+  return RUN_SUCCESS;
+}
 
-  if(operand1 == NULL)
+// Repeats string operand the number of times given by the number operand (string multiplication)
+static RunCode repeat_string(Object** result, Object* operand1, Object* operand2)
+{
+  const String* string = operand1->datatype == CCT_TYPE_STRING ? &operand1->value.strobj : &operand2->value.strobj;
+  Number count = operand1->datatype == CCT_TYPE_NUMBER ? operand1->value.numval : operand2->value.numval;
+  char* multstr = NULL;
+
+  count = abs(count);
+  multstr = malloc(string->length * (size_t)count + 1);
+  if(multstr == NULL)
   {
-    fprintf(stderr, "Operand 1 is NULL during POW operation.\n");
+    fprintf(stderr, "Unable to allocate memory for string during MUL operation.\n");
     return RUN_ERROR;
   }
+  multstr[0] = '\0';
+  for(Number i = 0; i < count; i++)
+    memcpy(multstr + string->length * (size_t)i, string->strval, string->length + 1);
+  *result = new_object_by_type(multstr, CCT_TYPE_STRING);
+  free(multstr);
+  return RUN_SUCCESS;
+}
 
-  if(operand2 == NULL)
+static KernelTable add_table = { ARITHMETIC_ENTRIES(add), [CCT_TYPE_STRING][CCT_TYPE_STRING] = concat_strings };
+static KernelTable sub_table = { ARITHMETIC_ENTRIES(sub) };
+static KernelTable mul_table =
+{
+  ARITHMETIC_ENTRIES(mul),
+  [CCT_TYPE_NUMBER][CCT_TYPE_STRING] = repeat_string,
+  [CCT_TYPE_STRING][CCT_TYPE_NUMBER] = repeat_string
+};
+static KernelTable div_table = { ARITHMETIC_ENTRIES(div) };
+static KernelTable mod_table = { ARITHMETIC_ENTRIES(mod) };
+static KernelTable pow_table = { ARITHMETIC_ENTRIES(pow) };
+static KernelTable bnd_table = { ARITHMETIC_ENTRIES(bnd) };
+static KernelTable bor_table = { ARITHMETIC_ENTRIES(bor) };
+static KernelTable xor_table = { ARITHMETIC_ENTRIES(xor) };
+static KernelTable shl_table = { SHIFT_ENTRIES(shl) };
+static KernelTable shr_table = { SHIFT_ENTRIES(shr) };
+static KernelTable eql_table =
+{
+  COMPARISON_ENTRIES(eql),
+  [CCT_TYPE_NIL][CCT_TYPE_NIL] = eql_nils,
+  [CCT_TYPE_BOOL][CCT_TYPE_BOOL] = eql_bools,
+  [CCT_TYPE_STRING][CCT_TYPE_STRING] = eql_strings
+};
+static KernelTable neq_table =
+{
+  COMPARISON_ENTRIES(neq),
+  [CCT_TYPE_NIL][CCT_TYPE_NIL] = neq_nils,
+  [CCT_TYPE_BOOL][CCT_TYPE_BOOL] = neq_bools,
+  [CCT_TYPE_STRING][CCT_TYPE_STRING] = neq_strings
+};
+static KernelTable gt_table = { COMPARISON_ENTRIES(gt), [CCT_TYPE_STRING][CCT_TYPE_STRING] = gt_lengths };
+static KernelTable gte_table = { COMPARISON_ENTRIES(gte), [CCT_TYPE_STRING][CCT_TYPE_STRING] = gte_lengths };
+static KernelTable lt_table = { COMPARISON_ENTRIES(lt), [CCT_TYPE_STRING][CCT_TYPE_STRING] = lt_lengths };
+static KernelTable lte_table = { COMPARISON_ENTRIES(lte), [CCT_TYPE_STRING][CCT_TYPE_STRING] = lte_lengths };
+
+#undef INTEGER_KERNEL
+#undef SHIFT_KERNEL
+#undef WIDENING_KERNEL
+#undef CHECKED_KERNEL
+#undef INTEGER_DIVISION_KERNEL
+#undef POWER_KERNEL
+#undef DECIMAL_KERNEL
+#undef COMPARISON_KERNEL
+#undef ARITHMETIC_KERNELS
+#undef INTEGER_KERNELS
+#undef SHIFT_KERNELS
+#undef COMPARISON_KERNELS
+#undef PROMOTED_ENTRIES
+#undef ARITHMETIC_ENTRIES
+#undef COMPARISON_ENTRIES
+#undef ROW_ENTRIES
+#undef SHIFT_ENTRIES
+#undef LENGTH_KERNEL
+
+// Applies the kernel that table selects for the types of both operands
+static RunCode apply_kernel(KernelTable table, Object** result, Object* operand1, Object* operand2,
+                            const char* operation, const char* operator)
+{
+  BinaryKernel kernel = NULL;
+
+  if(UNLIKELY(operand1 == NULL))
   {
-    fprintf(stderr, "Operand 2 is NULL during POW operation.\n");
+    fprintf(stderr, "Operand 1 is NULL during %s operation.\n", operation);
     return RUN_ERROR;
   }
-
-  if(binary_operand_check(operand1, operand2, "**") == RUN_ERROR)
+  if(UNLIKELY(operand2 == NULL))
+  {
+    fprintf(stderr, "Operand 2 is NULL during %s operation.\n", operation);
     return RUN_ERROR;
-
-  switch(operand1->datatype)
+  }
+  kernel = table[operand1->datatype][operand2->datatype];
+  if(UNLIKELY(kernel == NULL))
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = (Byte)(pow(*(Byte *)get_object_value(operand1), *(Byte *)get_object_value(operand2)));
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = (Number)(pow(*(Byte *)get_object_value(operand1), *(Number *)get_object_value(operand2)));
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = (BigNum)(pow(*(Byte *)get_object_value(operand1), (double)(*(BigNum *)get_object_value(operand2))));
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = pow(*(Byte *)get_object_value(operand1), *(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (**)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = (Number)(pow(*(Number *)get_object_value(operand1), *(Byte *)get_object_value(operand2)));
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = (Number)(pow(*(Number *)get_object_value(operand1), *(Number *)get_object_value(operand2)));
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = (Number)(pow(*(Number *)get_object_value(operand1), (double)(*(BigNum *)get_object_value(operand2))));
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = pow(*(Number *)get_object_value(operand1), *(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (**)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = (BigNum)(pow((double)(*(BigNum *)get_object_value(operand1)), *(Byte *)get_object_value(operand2)));
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = (BigNum)(pow((double)(*(BigNum *)get_object_value(operand1)), *(Number *)get_object_value(operand2)));
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = (BigNum)(pow((double)(*(BigNum *)get_object_value(operand1)), (double)(*(BigNum *)get_object_value(operand2))));
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(pow((double)(*(BigNum *)get_object_value(operand1)), *(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (**)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = pow(*(Decimal *)get_object_value(operand1), *(Byte *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = pow(*(Decimal *)get_object_value(operand1), *(Number *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = pow(*(Decimal *)get_object_value(operand1), (double)(*(BigNum *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = pow(*(Decimal *)get_object_value(operand1), *(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (**)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (**)!\n");
-      return RUN_ERROR;
+    fprintf(stderr, "Invalid operation (%s) for objects of type \"%s\" and \"%s\"!\n", operator,
+            get_data_type(operand1), get_data_type(operand2));
+    return RUN_ERROR;
   }
-  return RUN_SUCCESS;
+  return kernel(result, operand1, operand2);
+}
+
+// Equal to (==)
+RunCode eql_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(eql_table, result, operand1, operand2, "EQL", "==");
+}
+
+// Not equal to (!=)
+RunCode neq_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(neq_table, result, operand1, operand2, "NEQ", "!=");
+}
+
+// Greater than (>)
+RunCode gt_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(gt_table, result, operand1, operand2, "GT", ">");
+}
+
+// Greater than or equal to (>=)
+RunCode gte_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(gte_table, result, operand1, operand2, "GTE", ">=");
+}
+
+// Less than (<)
+RunCode lt_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(lt_table, result, operand1, operand2, "LT", "<");
+}
+
+// Less than or equal to (<=)
+RunCode lte_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(lte_table, result, operand1, operand2, "LTE", "<=");
+}
+
+// Addition (+)
+RunCode add_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(add_table, result, operand1, operand2, "ADD", "+");
+}
+
+// Subtraction (-)
+RunCode sub_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(sub_table, result, operand1, operand2, "SUB", "-");
+}
+
+// Division (/)
+RunCode div_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(div_table, result, operand1, operand2, "DIV", "/");
+}
+
+// Multiplication (*)
+RunCode mul_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(mul_table, result, operand1, operand2, "MUL", "*");
+}
+
+// Modulo (%)
+// Note: Modulo operates on integers. Decimal numbers are truncated.
+RunCode mod_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(mod_table, result, operand1, operand2, "MOD", "%");
+}
+
+// Exponentiation (**)
+RunCode pow_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(pow_table, result, operand1, operand2, "POW", "**");
 }
 
 // Bitwise and (&)
-RunCode op_bnd(Stack* stack)
+RunCode bnd_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(bnd_table, result, operand1, operand2, "BND", "&");
+}
+
+// Bitwise or (|)
+RunCode bor_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(bor_table, result, operand1, operand2, "BOR", "|");
+}
+
+// Bitwise exclusive or (^)
+RunCode xor_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(xor_table, result, operand1, operand2, "XOR", "^");
+}
+
+// Bit shift left (<<)
+RunCode shl_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(shl_table, result, operand1, operand2, "SHL", "<<");
+}
+
+// Bit shift right (>>)
+RunCode shr_objects(Object** result, Object* operand1, Object* operand2)
+{
+  return apply_kernel(shr_table, result, operand1, operand2, "SHR", ">>");
+}
+
+// Pops the right and left operands, applies kernel and pushes the result
+static RunCode stack_binary(Stack* stack, BinaryKernel kernel)
 {
-  Object* operand1 = pop(stack);
   Object* operand2 = pop(stack);
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  Object* operand1 = pop(stack);
+  Object* result = NULL;
 
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during BND operation.\n");
+  if(kernel(&result, operand1, operand2) == RUN_ERROR)
     return RUN_ERROR;
-  }
+  push(stack, result);
+  return RUN_SUCCESS;
+}
 
-  if(operand2 == NULL)
+// Register form of a binary operation (dst_reg = operand1 <op> operand2)
+RunCode op_reg_binary(Object** rp, Byte dst_reg, Object* operand1, Object* operand2, BinaryKernel kernel)
+{
+  if(dst_reg >= REGISTER_AMOUNT)
   {
-    fprintf(stderr, "Operand 2 is NULL during BND operation.\n");
+    fprintf(stderr, "Invalid destination register during register operation.\n");
     return RUN_ERROR;
   }
+  return kernel(&rp[dst_reg], operand1, operand2);
+}
 
-  if(binary_operand_check(operand1, operand2, "&") == RUN_ERROR)
-    return RUN_ERROR;
+/*
+ * Typed kernels used by quickened instructions. The type guard of the calling instruction ensures both operands
+ * have the named type, so these skip the operand checks and type switches of the generic kernels above.
+ *
+ * On entry *result is NULL or the scratch object of the result's stack slot, which the caller passes when the
+ * verifier proved the result never escapes (see get_scratch()). Scalar results are stored in it instead of a new
+ * object. It may also be one of the operands, so every operand is read before it is written.
+ */
+#define TYPED_ARITHMETIC_KERNEL(name, ctype, field, datatype, operator) \
+  RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    ctype value = operand1->value.field operator operand2->value.field; \
+    *result = store_scalar(*result, &value, datatype); \
+    return RUN_SUCCESS; \
+  }
+
+// Number results that leave the Number range widen to BigNum like the generic kernels
+#define TYPED_WIDENING_KERNEL(name, operator) \
+  RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    *result = store_integer(*result, (BigNum)operand1->value.numval operator operand2->value.numval, \
+                            CCT_TYPE_NUMBER); \
+    return RUN_SUCCESS; \
+  }
+
+#define TYPED_COMPARISON_KERNEL(name, field, operator) \
+  RunCode name(Object** result, Object* operand1, Object* operand2) \
+  { \
+    Bool boolval = operand1->value.field operator operand2->value.field; \
+    *result = store_scalar(*result, &boolval, CCT_TYPE_BOOL); \
+    return RUN_SUCCESS; \
+  }
+
+TYPED_WIDENING_KERNEL(add_numbers, +)
+TYPED_WIDENING_KERNEL(sub_numbers, -)
+TYPED_WIDENING_KERNEL(mul_numbers, *)
+TYPED_COMPARISON_KERNEL(eql_numbers, numval, ==)
+TYPED_COMPARISON_KERNEL(neq_numbers, numval, !=)
+TYPED_COMPARISON_KERNEL(gt_numbers, numval, >)
+TYPED_COMPARISON_KERNEL(gte_numbers, numval, >=)
+TYPED_COMPARISON_KERNEL(lt_numbers, numval, <)
+TYPED_COMPARISON_KERNEL(lte_numbers, numval, <=)
+TYPED_ARITHMETIC_KERNEL(add_decimals, Decimal, decimalval, CCT_TYPE_DECIMAL, +)
+TYPED_ARITHMETIC_KERNEL(sub_decimals, Decimal, decimalval, CCT_TYPE_DECIMAL, -)
+TYPED_ARITHMETIC_KERNEL(mul_decimals, Decimal, decimalval, CCT_TYPE_DECIMAL, *)
+TYPED_COMPARISON_KERNEL(gt_decimals, decimalval, >)
+TYPED_COMPARISON_KERNEL(gte_decimals, decimalval, >=)
+TYPED_COMPARISON_KERNEL(lt_decimals, decimalval, <)
+TYPED_COMPARISON_KERNEL(lte_decimals, decimalval, <=)
+
+#undef TYPED_ARITHMETIC_KERNEL
+#undef TYPED_WIDENING_KERNEL
+#undef TYPED_COMPARISON_KERNEL
+
+// Divides two decimals (quickened DIV)
+RunCode div_decimals(Object** result, Object* operand1, Object* operand2)
+{
+  Decimal decimalval = 0.0;
 
-  switch(operand1->datatype)
+  if(operand2->value.decimalval == 0.0)
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) & *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) & *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) & *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Byte *)get_object_value(operand1) & (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (&)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) & *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) & *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) & *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Number *)get_object_value(operand1) & (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (&)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) & *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) & *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) & *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(BigNum *)get_object_value(operand1) & (Number)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (&)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) & *(Byte *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) & *(Number *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = (Decimal)((Number)(*(Decimal *)get_object_value(operand1)) & *(BigNum *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) & (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (&)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (&)!\n");
-      return RUN_ERROR;
+    fprintf(stderr, "Operand 2 is 0 (zero) during DIV operation.\n");
+    return RUN_ERROR;
   }
+  decimalval = operand1->value.decimalval / operand2->value.decimalval;
+  *result = store_scalar(*result, &decimalval, CCT_TYPE_DECIMAL);
   return RUN_SUCCESS;
 }
 
-// Bitwise or (|)
-RunCode op_bor(Stack* stack)
+// Concatenates two strings (quickened ADD). Strings own their characters, so the result is always a new object.
+RunCode concat_strings(Object** result, Object* operand1, Object* operand2)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  char* addstr = malloc(operand1->value.strobj.length + operand2->value.strobj.length + 1);
 
-  if(operand1 == NULL)
+  if(addstr == NULL)
   {
-    fprintf(stderr, "Operand 1 is NULL during BOR operation.\n");
+    fprintf(stderr, "Unable to allocate memory for string during ADD operation.\n");
     return RUN_ERROR;
   }
+  strcpy(addstr, operand1->value.strobj.strval);
+  *result = new_object_by_type(strcat(addstr, operand2->value.strobj.strval), CCT_TYPE_STRING);
+  free(addstr);
+  return RUN_SUCCESS;
+}
 
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during BOR operation.\n");
-    return RUN_ERROR;
-  }
+// Binary operation with a constant right operand (fused PSH + <op>)
+RunCode op_const_binary(Stack* stack, Object* constant, BinaryKernel kernel)
+{
+  Object* operand1 = pop(stack);
+  Object* result = NULL;
 
-  if(binary_operand_check(operand1, operand2, "|") == RUN_ERROR)
+  if(kernel(&result, operand1, constant) == RUN_ERROR)
     return RUN_ERROR;
+  push(stack, result);
+  return RUN_SUCCESS;
+}
 
-  switch(operand1->datatype)
+// Set global to constant (fused PSH + ASN)
+RunCode op_setk(Object** globals, uint16_t slot, Object* constant)
+{
+  if(constant == NULL)
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) | *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) | *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) | *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Byte *)get_object_value(operand1) | (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (|)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) | *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) | *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) | *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Number *)get_object_value(operand1) | (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (|)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) | *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) | *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) | *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(BigNum *)get_object_value(operand1) | (Number)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (|)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) | *(Byte *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) | *(Number *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = (Decimal)((Number)(*(Decimal *)get_object_value(operand1)) | *(BigNum *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) | (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (|)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (|)!\n");
-      return RUN_ERROR;
+    fprintf(stderr, "Value is NULL during SETK operation.\n");
+    return RUN_ERROR;
   }
+  globals[slot] = constant;
   return RUN_SUCCESS;
 }
 
-// Bitwise xor (^)
-RunCode op_xor(Stack* stack)
+// Update global with a constant operand (fused GET + PSH + <op> + ASN)
+RunCode op_gopk(Object** globals, uint16_t slot, Object* constant, BinaryKernel kernel)
 {
-  Object* operand1 = pop(stack);
-  Object* operand2 = pop(stack);
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  Object* result = NULL;
 
-  if(operand1 == NULL)
+  if(kernel == NULL)
   {
-    fprintf(stderr, "Operand 1 is NULL during XOR operation.\n");
+    fprintf(stderr, "Unsupported operation during GOPK operation.\n");
     return RUN_ERROR;
   }
-
-  if(operand2 == NULL)
+  if(globals[slot] == NULL)
   {
-    fprintf(stderr, "Operand 2 is NULL during XOR operation.\n");
+    fprintf(stderr, "Undefined identifier \"%s\" during GOPK operation.\n", vm.global_names[slot]);
     return RUN_ERROR;
   }
-
-  if(binary_operand_check(operand1, operand2, "^") == RUN_ERROR)
+  if(kernel(&result, globals[slot], constant) == RUN_ERROR)
     return RUN_ERROR;
+  globals[slot] = result;
+  return RUN_SUCCESS;
+}
+
+// Compares operand with a constant as OP_LT does and stores whether it is less in is_less (OP_JNLK and OP_LLTK).
+// Numbers and decimals of the constant's type compare directly, so common loop conditions allocate no Bool.
+RunCode op_less_constant(bool* is_less, Object* operand, Object* constant)
+{
+  Object* result = NULL;
 
-  switch(operand1->datatype)
+  if(operand != NULL && operand->datatype == constant->datatype && constant->datatype == CCT_TYPE_NUMBER)
   {
-    case CCT_TYPE_BYTE:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          byteval = *(Byte *)get_object_value(operand1) ^ *(Byte *)get_object_value(operand2);
-          vptr = &byteval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Byte *)get_object_value(operand1) ^ *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Byte *)get_object_value(operand1) ^ *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Byte *)get_object_value(operand1) ^ (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (^)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_NUMBER:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          numval = *(Number *)get_object_value(operand1) ^ *(Byte *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_NUMBER:
-          numval = *(Number *)get_object_value(operand1) ^ *(Number *)get_object_value(operand2);
-          vptr = &numval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(Number *)get_object_value(operand1) ^ *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = *(Number *)get_object_value(operand1) ^ (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (^)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_BIGNUM:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          bignumval = *(BigNum *)get_object_value(operand1) ^ *(Byte *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_NUMBER:
-          bignumval = *(BigNum *)get_object_value(operand1) ^ *(Number *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_BIGNUM:
-          bignumval = *(BigNum *)get_object_value(operand1) ^ *(BigNum *)get_object_value(operand2);
-          vptr = &bignumval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Decimal)(*(BigNum *)get_object_value(operand1) ^ (Number)(*(Decimal *)get_object_value(operand2)));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (^)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    case CCT_TYPE_DECIMAL:
-      switch(operand2->datatype)
-      {
-        case CCT_TYPE_BYTE:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) ^ *(Byte *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_NUMBER:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) ^ *(Number *)get_object_value(operand2);
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_BIGNUM:
-          decimalval = (Decimal)((Number)(*(Decimal *)get_object_value(operand1)) ^ *(BigNum *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        case CCT_TYPE_DECIMAL:
-          decimalval = (Number)(*(Decimal *)get_object_value(operand1)) ^ (Number)(*(Decimal *)get_object_value(operand2));
-          vptr = &decimalval;
-          push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-          break;
-        default:
-          fprintf(stderr, "Invalid operand type encountered during operation (^)!\n");
-          return RUN_ERROR;
-      }
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (^)!\n");
-      return RUN_ERROR;
+    *is_less = operand->value.numval < constant->value.numval;
+    return RUN_SUCCESS;
+  }
+  if(operand != NULL && operand->datatype == constant->datatype && constant->datatype == CCT_TYPE_DECIMAL)
+  {
+    *is_less = operand->value.decimalval < constant->value.decimalval;
+    return RUN_SUCCESS;
   }
+  if(lt_objects(&result, operand, constant) == RUN_ERROR)
+    return RUN_ERROR;
+  *is_less = result->value.boolval;
   return RUN_SUCCESS;
 }
 
-// Bitwise not/ones' complement (~)
-RunCode op_bnt(Stack* stack)
+// Returns the value kernel of a stack-form binary opcode or NULL if it has none
+BinaryKernel get_binary_kernel(Opcode oc)
 {
-  Object* operand = pop(stack);
+  switch(oc)
+  {
+    case OP_ADD: return add_objects;
+    case OP_AND: return and_objects;
+    case OP_BND: return bnd_objects;
+    case OP_BOR: return bor_objects;
+    case OP_DIV: return div_objects;
+    case OP_EQL: return eql_objects;
+    case OP_GT:  return gt_objects;
+    case OP_GTE: return gte_objects;
+    case OP_LT:  return lt_objects;
+    case OP_LTE: return lte_objects;
+    case OP_MOD: return mod_objects;
+    case OP_MUL: return mul_objects;
+    case OP_NEQ: return neq_objects;
+    case OP_OR:  return or_objects;
+    case OP_POW: return pow_objects;
+    case OP_SHL: return shl_objects;
+    case OP_SHR: return shr_objects;
+    case OP_SLE: return sle_objects;
+    case OP_SLN: return sln_objects;
+    case OP_SUB: return sub_objects;
+    case OP_XOR: return xor_objects;
+    default:     return NULL;
+  }
+}
 
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+// Returns true if kernel builds a string from operand1 and operand2 that is too long to fold. Such strings are built
+// when the instruction runs (if it ever does) instead of at compile time and in the constant pool.
+static bool is_long_string(BinaryKernel kernel, const Object* operand1, const Object* operand2)
+{
+  const String* string = NULL;
+  Number count = 0;
+
+  if(kernel == concat_strings)
+    return operand1->value.strobj.length + operand2->value.strobj.length > MAX_FOLDED_STRING_LENGTH;
+  if(kernel != repeat_string)
+    return false;
+  string = operand1->datatype == CCT_TYPE_STRING ? &operand1->value.strobj : &operand2->value.strobj;
+  count = operand1->datatype == CCT_TYPE_NUMBER ? operand1->value.numval : operand2->value.numval;
+  if(string->length == 0)
+    return false;
+  return count > (Number)(MAX_FOLDED_STRING_LENGTH / string->length)
+         || count < -(Number)(MAX_FOLDED_STRING_LENGTH / string->length);
+}
 
-  if(operand == NULL)
-  {
-    fprintf(stderr, "Operand is NULL during BNT operation.\n");
-    return RUN_ERROR;
-  }
+// Computes operand1 <oc> operand2 for a stack-form binary opcode at compile time. Returns false without reporting
+// anything when the instruction would fail at run time, so it is left to report the error on its own line.
+bool fold_binary(Opcode oc, Object** result, Object* operand1, Object* operand2)
+{
+  const BinaryKernel* row = NULL;
+  BinaryKernel kernel = NULL;
+
+  switch(oc)
+  {
+    case OP_ADD: row = add_table[operand1->datatype]; break;
+    case OP_BND: row = bnd_table[operand1->datatype]; break;
+    case OP_BOR: row = bor_table[operand1->datatype]; break;
+    case OP_DIV: row = div_table[operand1->datatype]; break;
+    case OP_EQL: row = eql_table[operand1->datatype]; break;
+    case OP_GT:  row = gt_table[operand1->datatype]; break;
+    case OP_GTE: row = gte_table[operand1->datatype]; break;
+    case OP_LT:  row = lt_table[operand1->datatype]; break;
+    case OP_LTE: row = lte_table[operand1->datatype]; break;
+    case OP_MOD: row = mod_table[operand1->datatype]; break;
+    case OP_MUL: row = mul_table[operand1->datatype]; break;
+    case OP_NEQ: row = neq_table[operand1->datatype]; break;
+    case OP_POW: row = pow_table[operand1->datatype]; break;
+    case OP_SHL: row = shl_table[operand1->datatype]; break;
+    case OP_SHR: row = shr_table[operand1->datatype]; break;
+    case OP_SUB: row = sub_table[operand1->datatype]; break;
+    case OP_XOR: row = xor_table[operand1->datatype]; break;
+    default:     return false;
+  }
+  kernel = row[operand2->datatype];
+  if(kernel == NULL)
+    return false;
+  // Decimal division is the only one that does not truncate its divisor
+  if(kernel == div_as_decimal && decimal_value(operand2) == 0.0)
+    return false;
+  if((oc == OP_DIV || oc == OP_MOD) && kernel != div_as_decimal && integer_value(operand2) == 0)
+    return false;
+  if((oc == OP_SHL || oc == OP_SHR) && !is_shift_count(operand2))
+    return false;
+  if(is_long_string(kernel, operand1, operand2))
+    return false;
+  return kernel(result, operand1, operand2) == RUN_SUCCESS;
+}
 
-  if(unary_operand_check(operand, "~") == RUN_ERROR)
-    return RUN_ERROR;
+// Computes <oc> operand for a unary opcode at compile time. Returns false without reporting anything when the
+// instruction would fail at run time.
+bool fold_unary(Opcode oc, Object** result, Object* operand)
+{
+  void* slots[1];
+  Stack stack = { -1, 0, 1, slots };
+  RunCode rc = RUN_ERROR;
+  bool is_numeric = operand->datatype >= CCT_TYPE_BYTE && operand->datatype <= CCT_TYPE_DECIMAL;
+
+  push(&stack, operand);
+  switch(oc)
+  {
+    case OP_BNT: rc = is_numeric ? op_bnt(&stack) : RUN_ERROR; break;
+    case OP_DEC: rc = is_numeric ? op_dec(&stack) : RUN_ERROR; break;
+    case OP_INC: rc = is_numeric ? op_inc(&stack) : RUN_ERROR; break;
+    // NEG and POS reject bytes
+    case OP_NEG: rc = is_numeric && operand->datatype != CCT_TYPE_BYTE ? op_neg(&stack) : RUN_ERROR; break;
+    case OP_NOT: rc = operand->datatype == CCT_TYPE_BOOL ? op_not(&stack) : RUN_ERROR; break;
+    case OP_POS: rc = is_numeric && operand->datatype != CCT_TYPE_BYTE ? op_pos(&stack) : RUN_ERROR; break;
+    default:     break;
+  }
+  if(rc != RUN_SUCCESS)
+    return false;
+  *result = pop(&stack);
+  return true;
+}
 
-  switch(operand->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      byteval = *(Byte *)get_object_value(operand);
-      byteval = ~byteval;
-      vptr = &byteval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-      break;
-    case CCT_TYPE_NUMBER:
-      numval = *(Number *)get_object_value(operand);
-      numval = ~numval;
-      vptr = &numval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-      break;
-    case CCT_TYPE_BIGNUM:
-      bignumval = *(BigNum *)get_object_value(operand);
-      bignumval = ~bignumval;
-      vptr = &bignumval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-      break;
-    case CCT_TYPE_DECIMAL:
-      decimalval = *(Decimal *)get_object_value(operand);
-      decimalval = ~(Number)decimalval;
-      vptr = &decimalval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (~)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
+// Stack forms of the binary operations
+RunCode op_and(Stack* stack)
+{
+  return stack_binary(stack, and_objects);
 }
 
-// Bit shift left (<<)
-RunCode op_shl(Stack* stack)
+RunCode op_or(Stack* stack)
 {
-  Object* operand1 = pop(stack); // number to shift
-  Object* operand2 = pop(stack); // positions to shift
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  return stack_binary(stack, or_objects);
+}
 
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during SHL operation.\n");
-    return RUN_ERROR;
-  }
+RunCode op_eql(Stack* stack)
+{
+  return stack_binary(stack, eql_objects);
+}
 
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during SHL operation.\n");
-    return RUN_ERROR;
-  }
+RunCode op_neq(Stack* stack)
+{
+  return stack_binary(stack, neq_objects);
+}
 
-  if(binary_operand_check(operand1, operand2, "<<") == RUN_ERROR)
-    return RUN_ERROR;
+RunCode op_sle(Stack* stack)
+{
+  return stack_binary(stack, sle_objects);
+}
 
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      byteval = *(Byte *)get_object_value(operand1);
-      byteval = byteval << *(Number *)get_object_value(operand2);
-      vptr = &byteval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-      break;
-    case CCT_TYPE_NUMBER:
-      numval = *(Number *)get_object_value(operand1);
-      numval = numval << *(Number *)get_object_value(operand2);
-      vptr = &numval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-      break;
-    case CCT_TYPE_BIGNUM:
-      bignumval = *(BigNum *)get_object_value(operand1);
-      bignumval = bignumval << *(Number *)get_object_value(operand2);
-      vptr = &bignumval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-      break;
-    case CCT_TYPE_DECIMAL:
-      decimalval = *(Decimal *)get_object_value(operand1);
-      decimalval = (Number)decimalval << *(Number *)get_object_value(operand2);
-      vptr = &decimalval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (<<)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
+RunCode op_sln(Stack* stack)
+{
+  return stack_binary(stack, sln_objects);
 }
 
-// Bit shift right (>>)
-RunCode op_shr(Stack* stack)
+RunCode op_gt(Stack* stack)
 {
-  Object* operand1 = pop(stack); // number to shift
-  Object* operand2 = pop(stack); // positions to shift
-  Byte byteval = 0;
-  Number numval = 0;
-  BigNum bignumval = 0;
-  Decimal decimalval = 0.0;
-  void* vptr = NULL;
+  return stack_binary(stack, gt_objects);
+}
 
-  if(operand1 == NULL)
-  {
-    fprintf(stderr, "Operand 1 is NULL during SHR operation.\n");
-    return RUN_ERROR;
-  }
+RunCode op_gte(Stack* stack)
+{
+  return stack_binary(stack, gte_objects);
+}
 
-  if(operand2 == NULL)
-  {
-    fprintf(stderr, "Operand 2 is NULL during SHR operation.\n");
-    return RUN_ERROR;
-  }
+RunCode op_lt(Stack* stack)
+{
+  return stack_binary(stack, lt_objects);
+}
 
-  if(binary_operand_check(operand1, operand2, ">>") == RUN_ERROR)
-    return RUN_ERROR;
+RunCode op_lte(Stack* stack)
+{
+  return stack_binary(stack, lte_objects);
+}
 
-  switch(operand1->datatype)
-  {
-    case CCT_TYPE_BYTE:
-      byteval = *(Byte *)get_object_value(operand1);
-      byteval = byteval >> *(Number *)get_object_value(operand2);
-      vptr = &byteval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BYTE));
-      break;
-    case CCT_TYPE_NUMBER:
-      numval = *(Number *)get_object_value(operand1);
-      numval = numval >> *(Number *)get_object_value(operand2);
-      vptr = &numval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_NUMBER));
-      break;
-    case CCT_TYPE_BIGNUM:
-      bignumval = *(BigNum *)get_object_value(operand1);
-      bignumval = bignumval >> *(Number *)get_object_value(operand2);
-      vptr = &bignumval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_BIGNUM));
-      break;
-    case CCT_TYPE_DECIMAL:
-      decimalval = *(Decimal *)get_object_value(operand1);
-      decimalval = (Number)decimalval >> *(Number *)get_object_value(operand2);
-      vptr = &decimalval;
-      push(stack, new_object_by_type(vptr, CCT_TYPE_DECIMAL));
-      break;
-    default:
-      fprintf(stderr, "Invalid operand type encountered during operation (>>)!\n");
-      return RUN_ERROR;
-  }
-  return RUN_SUCCESS;
+RunCode op_add(Stack* stack)
+{
+  return stack_binary(stack, add_objects);
+}
+
+RunCode op_sub(Stack* stack)
+{
+  return stack_binary(stack, sub_objects);
+}
+
+RunCode op_div(Stack* stack)
+{
+  return stack_binary(stack, div_objects);
+}
+
+RunCode op_mul(Stack* stack)
+{
+  return stack_binary(stack, mul_objects);
+}
+
+RunCode op_mod(Stack* stack)
+{
+  return stack_binary(stack, mod_objects);
+}
+
+RunCode op_pow(Stack* stack)
+{
+  return stack_binary(stack, pow_objects);
+}
+
+RunCode op_bnd(Stack* stack)
+{
+  return stack_binary(stack, bnd_objects);
+}
+
+RunCode op_bor(Stack* stack)
+{
+  return stack_binary(stack, bor_objects);
+}
+
+RunCode op_xor(Stack* stack)
+{
+  return stack_binary(stack, xor_objects);
+}
+
+RunCode op_shl(Stack* stack)
+{
+  return stack_binary(stack, shl_objects);
+}
+
+RunCode op_shr(Stack* stack)
+{
+  return stack_binary(stack, shr_objects);
 }
@@ -0,0 +1,821 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>           // offsetof()
+#include <stdint.h>           // SIZE_MAX, uint32_t, uint64_t, uintptr_t
+#include <stdio.h>            // fprintf(), stderr
+#include <stdlib.h>           // calloc(), free()
+#include <string.h>           // memcpy()
+#include "concoct.h"          // UNUSED()
+#include "debug.h"            // debug_mode, debug_print()
+#include "vm/instructions.h"
+#include "vm/jit.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_SUPPORTED 1
+#include <sys/mman.h>         // mmap(), mprotect(), munmap()
+#include <unistd.h>           // sysconf()
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+/*
+ * The baseline JIT stitches one machine code template per instruction. Each template loads the instruction and one
+ * pre-decoded operand into the argument registers and calls a helper that performs the instruction on vm.sp:
+ *
+ *   mov rdi, instruction; mov rsi, operand; mov rax, helper; call rax
+ *
+ * Most helpers return NATIVE_CONTINUE, and any other status leaves the native code through a shared exit stub.
+ * Branch helpers return the truth value of the condition instead, and their template jumps straight to the native
+ * code of the target instruction. Unconditional jumps are a single jmp, so native code has no dispatch at all.
+ *
+ * Instructions that only move objects (OP_PSH, OP_POP, OP_ASN, OP_GET) and branches on Bool conditions are emitted
+ * inline against the Stack in rbx, which holds vm.sp for the whole run. Inline paths that can fail (an undefined
+ * global, a condition that is not a Bool) fall back to the helper call.
+ *
+ * Instructions without a helper (calls, register instructions, OP_END and so on) compile to an exit that sets
+ * vm.ip, and the interpreter finishes the run from there. Quickened instructions check their type guard. On a miss
+ * they revert to the generic form and deoptimize: the native code exits before touching the stack, the interpreter
+ * runs the instruction generically, and the chunk is compiled again once it is as hot again.
+ *
+ * Native code can be entered at any instruction. Its prologue jumps to the native code of the instruction passed to
+ * it (see Chunk.native_entries), so a hot loop of a program that runs only once moves to native code at its next
+ * back-edge (see run_hot_loop()). Jumps leave the interpreter's top-of-stack cache empty, so every value is in vm.sp
+ * there.
+ *
+ * Code is written to anonymous read-write pages that are remapped read-execute before they run, so no page is ever
+ * writable and executable at once.
+ */
+
+bool jit_mode = false;
+size_t jit_threshold = JIT_THRESHOLD;
+
+// Status returned by helpers (branch helpers return 0 or 1 for the condition and NATIVE_ERROR on failure)
+#define NATIVE_CONTINUE 0 // run the next instruction
+#define NATIVE_EXIT 1     // resume in the interpreter at vm.ip
+#define NATIVE_ERROR 2    // runtime error at vm.ip
+#define NATIVE_DEOPT 3    // type guard failed at vm.ip, discard the native code
+
+// Entry point of the native code of a chunk, which continues at entry (the native code of an instruction)
+typedef int (*NativeCode)(const Byte* entry);
+
+#if JIT_SUPPORTED
+// Helper called by the template of an instruction with its address and pre-decoded operand
+typedef int (*Helper)(Byte* instruction, uintptr_t operand);
+
+// Binary instruction forms run by helpers with a constant right operand or a type guard
+typedef struct binary_form
+{
+  Opcode opcode;
+  bool is_constant;    // right operand is a constant (fused PSH + <op>)
+  bool is_typed;       // quickened form guarded on type
+  DataType type;       // type of both operands (or of the left operand for constant forms)
+  BinaryKernel kernel; // kernel of the quickened form or of the generic form
+} BinaryForm;
+
+static const BinaryForm binary_forms[] =
+{
+  { OP_ADDK,  true,  false, CCT_TYPE_NIL,     add_objects },
+  { OP_DIVK,  true,  false, CCT_TYPE_NIL,     div_objects },
+  { OP_EQLK,  true,  false, CCT_TYPE_NIL,     eql_objects },
+  { OP_GTK,   true,  false, CCT_TYPE_NIL,     gt_objects },
+  { OP_GTEK,  true,  false, CCT_TYPE_NIL,     gte_objects },
+  { OP_LTK,   true,  false, CCT_TYPE_NIL,     lt_objects },
+  { OP_LTEK,  true,  false, CCT_TYPE_NIL,     lte_objects },
+  { OP_MODK,  true,  false, CCT_TYPE_NIL,     mod_objects },
+  { OP_MULK,  true,  false, CCT_TYPE_NIL,     mul_objects },
+  { OP_NEQK,  true,  false, CCT_TYPE_NIL,     neq_objects },
+  { OP_SUBK,  true,  false, CCT_TYPE_NIL,     sub_objects },
+  { OP_ADDD,  false, true,  CCT_TYPE_DECIMAL, add_decimals },
+  { OP_ADDKD, true,  true,  CCT_TYPE_DECIMAL, add_decimals },
+  { OP_ADDKN, true,  true,  CCT_TYPE_NUMBER,  add_numbers },
+  { OP_ADDN,  false, true,  CCT_TYPE_NUMBER,  add_numbers },
+  { OP_ADDS,  false, true,  CCT_TYPE_STRING,  concat_strings },
+  { OP_DIVD,  false, true,  CCT_TYPE_DECIMAL, div_decimals },
+  { OP_DIVKD, true,  true,  CCT_TYPE_DECIMAL, div_decimals },
+  { OP_EQLKN, true,  true,  CCT_TYPE_NUMBER,  eql_numbers },
+  { OP_EQLN,  false, true,  CCT_TYPE_NUMBER,  eql_numbers },
+  { OP_GTD,   false, true,  CCT_TYPE_DECIMAL, gt_decimals },
+  { OP_GTED,  false, true,  CCT_TYPE_DECIMAL, gte_decimals },
+  { OP_GTEKD, true,  true,  CCT_TYPE_DECIMAL, gte_decimals },
+  { OP_GTEKN, true,  true,  CCT_TYPE_NUMBER,  gte_numbers },
+  { OP_GTEN,  false, true,  CCT_TYPE_NUMBER,  gte_numbers },
+  { OP_GTKD,  true,  true,  CCT_TYPE_DECIMAL, gt_decimals },
+  { OP_GTKN,  true,  true,  CCT_TYPE_NUMBER,  gt_numbers },
+  { OP_GTN,   false, true,  CCT_TYPE_NUMBER,  gt_numbers },
+  { OP_LTD,   false, true,  CCT_TYPE_DECIMAL, lt_decimals },
+  { OP_LTED,  false, true,  CCT_TYPE_DECIMAL, lte_decimals },
+  { OP_LTEKD, true,  true,  CCT_TYPE_DECIMAL, lte_decimals },
+  { OP_LTEKN, true,  true,  CCT_TYPE_NUMBER,  lte_numbers },
+  { OP_LTEN,  false, true,  CCT_TYPE_NUMBER,  lte_numbers },
+  { OP_LTKD,  true,  true,  CCT_TYPE_DECIMAL, lt_decimals },
+  { OP_LTKN,  true,  true,  CCT_TYPE_NUMBER,  lt_numbers },
+  { OP_LTN,   false, true,  CCT_TYPE_NUMBER,  lt_numbers },
+  { OP_MULD,  false, true,  CCT_TYPE_DECIMAL, mul_decimals },
+  { OP_MULKD, true,  true,  CCT_TYPE_DECIMAL, mul_decimals },
+  { OP_MULKN, true,  true,  CCT_TYPE_NUMBER,  mul_numbers },
+  { OP_MULN,  false, true,  CCT_TYPE_NUMBER,  mul_numbers },
+  { OP_NEQKN, true,  true,  CCT_TYPE_NUMBER,  neq_numbers },
+  { OP_NEQN,  false, true,  CCT_TYPE_NUMBER,  neq_numbers },
+  { OP_SUBD,  false, true,  CCT_TYPE_DECIMAL, sub_decimals },
+  { OP_SUBKD, true,  true,  CCT_TYPE_DECIMAL, sub_decimals },
+  { OP_SUBKN, true,  true,  CCT_TYPE_NUMBER,  sub_numbers },
+  { OP_SUBN,  false, true,  CCT_TYPE_NUMBER,  sub_numbers }
+};
+
+// Returns the binary form of opcode or NULL if it has none
+static const BinaryForm* find_binary_form(Opcode oc)
+{
+  for(size_t i = 0; i < sizeof(binary_forms) / sizeof(binary_forms[0]); i++)
+  {
+    if(binary_forms[i].opcode == oc)
+      return &binary_forms[i];
+  }
+  return NULL;
+}
+
+// Returns the constant named by the 16-bit operand at code
+static Object* operand_constant(const Byte* code)
+{
+  return vm.chunk->constants[read_short(code)];
+}
+
+// Records where a runtime error occurred
+static int fail(Byte* instruction)
+{
+  vm.ip = instruction;
+  return NATIVE_ERROR;
+}
+
+// Leaves the native code so the interpreter runs instruction
+static int native_exit(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(operand);
+  vm.ip = instruction;
+  return NATIVE_EXIT;
+}
+
+// Push (operand is the constant)
+static int native_psh(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(instruction);
+  push(vm.sp, (Object*)operand);
+  return NATIVE_CONTINUE;
+}
+
+// Pop
+static int native_pop(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(instruction);
+  UNUSED(operand);
+  pop_unchecked(vm.sp);
+  return NATIVE_CONTINUE;
+}
+
+// Get (operand is the global slot)
+static int native_get(Byte* instruction, uintptr_t operand)
+{
+  if(op_get(vm.sp, vm.globals, (uint16_t)operand) == RUN_ERROR)
+    return fail(instruction);
+  return NATIVE_CONTINUE;
+}
+
+// Get two globals (operand holds the second slot above the first)
+static int native_get2(Byte* instruction, uintptr_t operand)
+{
+  if(op_get(vm.sp, vm.globals, (uint16_t)operand) == RUN_ERROR
+     || op_get(vm.sp, vm.globals, (uint16_t)(operand >> 16)) == RUN_ERROR)
+    return fail(instruction);
+  return NATIVE_CONTINUE;
+}
+
+// Assign (operand is the global slot)
+static int native_asn(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(instruction);
+  vm.globals[operand] = pop_unchecked(vm.sp);
+  return NATIVE_CONTINUE;
+}
+
+// Set global to constant
+static int native_setk(Byte* instruction, uintptr_t operand)
+{
+  op_setk(vm.globals, (uint16_t)operand, operand_constant(instruction + 3));
+  return NATIVE_CONTINUE;
+}
+
+// Update global with constant operand
+static int native_gopk(Byte* instruction, uintptr_t operand)
+{
+  if(op_gopk(vm.globals, (uint16_t)operand, operand_constant(instruction + 3),
+             get_binary_kernel((Opcode)instruction[5])) == RUN_ERROR)
+    return fail(instruction);
+  return NATIVE_CONTINUE;
+}
+
+// Test (replace value with its truth value)
+static int native_tst(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(instruction);
+  UNUSED(operand);
+  vm.sp->objects[vm.sp->top] = is_truthy(vm.sp->objects[vm.sp->top]) ? vm.true_object : vm.false_object;
+  return NATIVE_CONTINUE;
+}
+
+// Generic stack-form binary operation (operand is the kernel). The result goes to the scratch object of its stack
+// slot if is_unescaped is set (see Chunk.unescaped).
+static inline int run_binary(Byte* instruction, uintptr_t operand, bool is_unescaped)
+{
+  BinaryKernel kernel = (BinaryKernel)operand;
+  Object* operand2 = pop_unchecked(vm.sp);
+  Object* operand1 = pop_unchecked(vm.sp);
+  Object* result = is_unescaped ? get_scratch(vm.sp->count) : NULL;
+
+  if(kernel(&result, operand1, operand2) == RUN_ERROR)
+    return fail(instruction);
+  push(vm.sp, result);
+  return NATIVE_CONTINUE;
+}
+
+// Binary operation described by a BinaryForm (operand). Quickened forms deoptimize on a type miss before popping.
+// The result goes to the scratch object of its stack slot if is_unescaped is set.
+static inline int run_form(Byte* instruction, uintptr_t operand, bool is_unescaped)
+{
+  const BinaryForm* form = (const BinaryForm*)operand;
+  Object* operand2 = form->is_constant ? operand_constant(instruction + 1) : vm.sp->objects[vm.sp->top];
+  Object* operand1 = vm.sp->objects[vm.sp->top - (form->is_constant ? 0 : 1)];
+  Object* result = NULL;
+
+  // The constant of a quickened constant form was checked when it was quickened
+  if(form->is_typed
+     && UNLIKELY(operand1->datatype != form->type || (!form->is_constant && operand2->datatype != form->type)))
+  {
+    *instruction = (Byte)get_generic_opcode(form->opcode);
+    vm.ip = instruction;
+    return NATIVE_DEOPT;
+  }
+  if(is_unescaped)
+    result = get_scratch(vm.sp->count - (form->is_constant ? 1 : 2));
+  if(form->kernel(&result, operand1, operand2) == RUN_ERROR)
+    return fail(instruction);
+  vm.sp->top -= form->is_constant ? 0 : 1;
+  vm.sp->count -= form->is_constant ? 0 : 1;
+  vm.sp->objects[vm.sp->top] = result;
+  return NATIVE_CONTINUE;
+}
+
+// Generic stack-form binary operation whose result escapes
+static int native_binary(Byte* instruction, uintptr_t operand)
+{
+  return run_binary(instruction, operand, false);
+}
+
+// Generic stack-form binary operation whose result never escapes
+static int native_binary_unescaped(Byte* instruction, uintptr_t operand)
+{
+  return run_binary(instruction, operand, true);
+}
+
+// Binary operation described by a BinaryForm whose result escapes
+static int native_form(Byte* instruction, uintptr_t operand)
+{
+  return run_form(instruction, operand, false);
+}
+
+// Binary operation described by a BinaryForm whose result never escapes
+static int native_form_unescaped(Byte* instruction, uintptr_t operand)
+{
+  return run_form(instruction, operand, true);
+}
+
+// Pops the condition of OP_JMC, OP_JMZ, OP_LNZ and OP_LOZ and returns its truth value
+static int native_truth(Byte* instruction, uintptr_t operand)
+{
+  UNUSED(instruction);
+  UNUSED(operand);
+  return is_truthy(pop_unchecked(vm.sp)) ? 1 : 0;
+}
+
+// Returns 1 if the condition of OP_JMF or OP_JMT decides the result (leaving the shared Bool object for operand)
+// and pops it otherwise
+static int native_decide(Byte* instruction, uintptr_t operand)
+{
+  bool when = operand != 0;
+
+  UNUSED(instruction);
+  if(is_truthy(pop_unchecked(vm.sp)) != when)
+    return 0;
+  push(vm.sp, when ? vm.true_object : vm.false_object);
+  return 1;
+}
+
+// Pops the operands of OP_LOE or OP_LNE and returns 1 if they are equal
+static int native_equal(Byte* instruction, uintptr_t operand)
+{
+  Object* operand2 = pop_unchecked(vm.sp);
+  Object* operand1 = pop_unchecked(vm.sp);
+  Object* result = NULL;
+
+  UNUSED(operand);
+  if(eql_objects(&result, operand1, operand2) == RUN_ERROR)
+    return fail(instruction);
+  return result->value.boolval ? 1 : 0;
+}
+
+// Pops the left operand of OP_JNLK or OP_LLTK and returns 1 if it is less than the constant (operand)
+static int native_less(Byte* instruction, uintptr_t operand)
+{
+  bool is_less = false;
+
+  if(op_less_constant(&is_less, pop_unchecked(vm.sp), (Object*)operand) == RUN_ERROR)
+    return fail(instruction);
+  return is_less ? 1 : 0;
+}
+
+// Selects the helper for the instruction at offset, stores its pre-decoded operand and returns whether the
+// instruction branches on the helper's result (jump_when holds the result that takes the branch)
+static Helper select_helper(const Chunk* chunk, size_t offset, uintptr_t* operand, bool* branches, int* jump_when)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  const Byte* operands = &chunk->code[offset + 1];
+  const BinaryForm* form = find_binary_form(oc);
+
+  *operand = 0;
+  *branches = is_jump_operation(oc) && oc != OP_JMP && oc != OP_LOP;
+  *jump_when = oc == OP_JMZ || oc == OP_LOZ || oc == OP_LNE || oc == OP_JNLK ? 0 : 1;
+  // Results the verifier proved never escape go to scratch objects, as in the lean loop (see SCRATCH_RESULT())
+  if(form != NULL)
+  {
+    *operand = (uintptr_t)form;
+    return chunk->unescaped[offset] ? native_form_unescaped : native_form;
+  }
+  if(is_binary_operation(oc) && oc != OP_ASN)
+  {
+    *operand = (uintptr_t)get_binary_kernel(oc);
+    return chunk->unescaped[offset] ? native_binary_unescaped : native_binary;
+  }
+  switch(oc)
+  {
+    case OP_PSH:
+      *operand = (uintptr_t)chunk->constants[read_short(operands)];
+      return native_psh;
+    case OP_POP:
+      return native_pop;
+    case OP_GET:
+      *operand = read_short(operands);
+      return native_get;
+    case OP_GET2:
+      *operand = (uintptr_t)read_short(operands) | (uintptr_t)read_short(operands + 2) << 16;
+      return native_get2;
+    case OP_ASN:
+      *operand = read_short(operands);
+      return native_asn;
+    case OP_SETK:
+      *operand = read_short(operands);
+      return native_setk;
+    case OP_GOPK:
+      *operand = read_short(operands);
+      return native_gopk;
+    case OP_TST:
+      return native_tst;
+    case OP_JMC:
+    case OP_JMZ:
+    case OP_LNZ:
+    case OP_LOZ:
+      return native_truth;
+    case OP_JMF:
+    case OP_JMT:
+      *operand = oc == OP_JMT;
+      return native_decide;
+    case OP_LNE:
+    case OP_LOE:
+      return native_equal;
+    case OP_JNLK:
+    case OP_LLTK:
+      *operand = (uintptr_t)chunk->constants[read_short(operands + 2)];
+      return native_less;
+    default:
+      *branches = false;
+      return native_exit;
+  }
+}
+
+// Machine code being written to a mapped buffer. A NULL buffer only measures the code.
+typedef struct emitter
+{
+  Byte* code;
+  size_t count;
+} Emitter;
+
+// x86-64 encodings used by the templates. rbx holds vm.sp while native code runs.
+static const Byte MOV_RDI_IMM64[] = { 0x48, 0xBF };
+static const Byte MOV_RSI_IMM64[] = { 0x48, 0xBE };
+static const Byte MOV_RAX_IMM64[] = { 0x48, 0xB8 };
+static const Byte MOV_RBX_IMM64[] = { 0x48, 0xBB };
+static const Byte CALL_RAX[] = { 0xFF, 0xD0 };
+static const Byte TEST_EAX_EAX[] = { 0x85, 0xC0 };
+static const Byte TEST_RSI_RSI[] = { 0x48, 0x85, 0xF6 };
+static const Byte CMP_EAX_ERROR[] = { 0x83, 0xF8, NATIVE_ERROR };
+static const Byte INC_RCX[] = { 0x48, 0xFF, 0xC1 };
+static const Byte DEC_RCX[] = { 0x48, 0xFF, 0xC9 };
+static const Byte LEA_RAX_RCX_MINUS_1[] = { 0x48, 0x8D, 0x41, 0xFF };
+static const Byte MOV_RAX_AT_RAX[] = { 0x48, 0x8B, 0x00 };
+static const Byte STORE_RSI_AT_RDX_RCX[] = { 0x48, 0x89, 0x34, 0xCA };  // mov [rdx + rcx * 8], rsi
+static const Byte LOAD_RSI_AT_RDX_RCX[] = { 0x48, 0x8B, 0x34, 0xCA };   // mov rsi, [rdx + rcx * 8]
+static const Byte LOAD_RSI_BELOW_RDX_RCX[] = { 0x48, 0x8B, 0x74, 0xCA, 0xF8 }; // mov rsi, [rdx + rcx * 8 - 8]
+static const Byte PROLOGUE[] = { 0x53 };     // push rbx (also keeps calls 16-byte aligned)
+static const Byte JMP_RDI[] = { 0xFF, 0xE7 };  // jmp rdi (the entry argument)
+static const Byte EPILOGUE[] = { 0x5B, 0xC3 }; // pop rbx; ret
+static const Byte JE[] = { 0x0F, 0x84 };
+static const Byte JNE[] = { 0x0F, 0x85 };
+static const Byte JMP[] = { 0xE9 };
+
+static void emit_byte(Emitter* emitter, Byte byte)
+{
+  if(emitter->code != NULL)
+    emitter->code[emitter->count] = byte;
+  emitter->count++;
+  return;
+}
+
+static void emit_bytes(Emitter* emitter, const Byte* bytes, size_t length)
+{
+  for(size_t i = 0; i < length; i++)
+    emit_byte(emitter, bytes[i]);
+  return;
+}
+
+static void emit_u32(Emitter* emitter, uint32_t value)
+{
+  for(size_t i = 0; i < 4; i++)
+    emit_byte(emitter, (Byte)(value >> (8 * i)));
+  return;
+}
+
+static void emit_u64(Emitter* emitter, uint64_t value)
+{
+  for(size_t i = 0; i < 8; i++)
+    emit_byte(emitter, (Byte)(value >> (8 * i)));
+  return;
+}
+
+// Emits a jump (JMP, JE or JNE) to target and returns the offset of its displacement for patch_jump()
+static size_t emit_jump(Emitter* emitter, const Byte* jump, size_t length, size_t target)
+{
+  size_t displacement = 0;
+
+  emit_bytes(emitter, jump, length);
+  displacement = emitter->count;
+  emit_u32(emitter, (uint32_t)(int32_t)((ptrdiff_t)target - (ptrdiff_t)(displacement + 4)));
+  return displacement;
+}
+
+// Points the jump whose displacement is at offset to the current end of the code
+static void patch_jump(Emitter* emitter, size_t offset)
+{
+  uint32_t distance = (uint32_t)(emitter->count - (offset + 4));
+
+  if(emitter->code != NULL)
+  {
+    for(size_t i = 0; i < 4; i++)
+      emitter->code[offset + i] = (Byte)(distance >> (8 * i));
+  }
+  return;
+}
+
+// Emits an instruction that addresses a field of the Stack in rbx (opcode and register byte without the base)
+static void emit_stack_field(Emitter* emitter, Byte opcode, Byte reg, size_t field)
+{
+  emit_byte(emitter, 0x48);
+  emit_byte(emitter, opcode);
+  emit_byte(emitter, (Byte)(0x43 | reg << 3)); // [rbx + disp8]
+  emit_byte(emitter, (Byte)field);
+  return;
+}
+
+// Loads the stack count into rcx and the stack array into rdx
+static void emit_load_stack(Emitter* emitter)
+{
+  emit_stack_field(emitter, 0x8B, 1, offsetof(Stack, count));   // mov rcx, [rbx + count]
+  emit_stack_field(emitter, 0x8B, 2, offsetof(Stack, objects)); // mov rdx, [rbx + objects]
+  return;
+}
+
+// Stores rcx as the new stack count after a pop (top = count - 1)
+static void emit_store_popped(Emitter* emitter)
+{
+  emit_stack_field(emitter, 0x89, 1, offsetof(Stack, count)); // mov [rbx + count], rcx
+  emit_bytes(emitter, LEA_RAX_RCX_MINUS_1, sizeof(LEA_RAX_RCX_MINUS_1));
+  emit_stack_field(emitter, 0x89, 0, offsetof(Stack, top));   // mov [rbx + top], rax
+  return;
+}
+
+// Pushes rsi (rcx and rdx hold the stack count and array)
+static void emit_push_rsi(Emitter* emitter)
+{
+  emit_bytes(emitter, STORE_RSI_AT_RDX_RCX, sizeof(STORE_RSI_AT_RDX_RCX));
+  emit_stack_field(emitter, 0x89, 1, offsetof(Stack, top));   // mov [rbx + top], rcx
+  emit_bytes(emitter, INC_RCX, sizeof(INC_RCX));
+  emit_stack_field(emitter, 0x89, 1, offsetof(Stack, count)); // mov [rbx + count], rcx
+  return;
+}
+
+// Loads vm.globals into rax
+static void emit_load_globals(Emitter* emitter)
+{
+  emit_bytes(emitter, MOV_RAX_IMM64, sizeof(MOV_RAX_IMM64));
+  emit_u64(emitter, (uint64_t)(uintptr_t)&vm.globals);
+  emit_bytes(emitter, MOV_RAX_AT_RAX, sizeof(MOV_RAX_AT_RAX));
+  return;
+}
+
+// Emits mov rsi, [rax + slot * 8] (load) or mov [rax + slot * 8], rsi (store)
+static void emit_global_slot(Emitter* emitter, bool is_store, uint16_t slot)
+{
+  emit_byte(emitter, 0x48);
+  emit_byte(emitter, is_store ? 0x89 : 0x8B);
+  emit_byte(emitter, 0xB0); // [rax + disp32] with rsi
+  emit_u32(emitter, (uint32_t)slot * (uint32_t)sizeof(Object*));
+  return;
+}
+
+// Emits a call of helper with instruction and operand as arguments
+static void emit_call(Emitter* emitter, Helper helper, Byte* instruction, uintptr_t operand)
+{
+  emit_bytes(emitter, MOV_RDI_IMM64, sizeof(MOV_RDI_IMM64));
+  emit_u64(emitter, (uint64_t)(uintptr_t)instruction);
+  emit_bytes(emitter, MOV_RSI_IMM64, sizeof(MOV_RSI_IMM64));
+  emit_u64(emitter, (uint64_t)operand);
+  emit_bytes(emitter, MOV_RAX_IMM64, sizeof(MOV_RAX_IMM64));
+  emit_u64(emitter, (uint64_t)(uintptr_t)helper);
+  emit_bytes(emitter, CALL_RAX, sizeof(CALL_RAX));
+  return;
+}
+
+// Emits the inline fast path of instructions that only move objects between the stack and globals. Returns false
+// if the instruction has none. Fast paths that can fail jump to slow_jump, which is patched to the helper call.
+static bool emit_fast_path(Emitter* emitter, const Chunk* chunk, size_t offset, size_t target, size_t* slow_jump)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  const Byte* operands = &chunk->code[offset + 1];
+
+  *slow_jump = SIZE_MAX;
+  switch(oc)
+  {
+    case OP_PSH:
+      emit_load_stack(emitter);
+      emit_bytes(emitter, MOV_RSI_IMM64, sizeof(MOV_RSI_IMM64));
+      emit_u64(emitter, (uint64_t)(uintptr_t)chunk->constants[read_short(operands)]);
+      emit_push_rsi(emitter);
+      return true;
+    case OP_POP:
+      emit_stack_field(emitter, 0x8B, 1, offsetof(Stack, count)); // mov rcx, [rbx + count]
+      emit_bytes(emitter, DEC_RCX, sizeof(DEC_RCX));
+      emit_store_popped(emitter);
+      return true;
+    case OP_ASN:
+      emit_load_stack(emitter);
+      emit_bytes(emitter, DEC_RCX, sizeof(DEC_RCX));
+      emit_bytes(emitter, LOAD_RSI_AT_RDX_RCX, sizeof(LOAD_RSI_AT_RDX_RCX));
+      emit_store_popped(emitter);
+      emit_load_globals(emitter);
+      emit_global_slot(emitter, true, read_short(operands));
+      return true;
+    case OP_GET:
+      emit_load_globals(emitter);
+      emit_global_slot(emitter, false, read_short(operands));
+      emit_bytes(emitter, TEST_RSI_RSI, sizeof(TEST_RSI_RSI));
+      *slow_jump = emit_jump(emitter, JE, sizeof(JE), 0); // undefined global
+      emit_load_stack(emitter);
+      emit_push_rsi(emitter);
+      return true;
+    case OP_JMC:
+    case OP_JMZ:
+    case OP_LNZ:
+    case OP_LOZ:
+      // Bool conditions branch inline, anything else takes the helper
+      emit_load_stack(emitter);
+      emit_bytes(emitter, LOAD_RSI_BELOW_RDX_RCX, sizeof(LOAD_RSI_BELOW_RDX_RCX));
+      emit_byte(emitter, 0x83);
+      emit_byte(emitter, 0x7E); // cmp dword [rsi + disp8], imm8
+      emit_byte(emitter, (Byte)offsetof(Object, datatype));
+      emit_byte(emitter, CCT_TYPE_BOOL);
+      *slow_jump = emit_jump(emitter, JNE, sizeof(JNE), 0);
+      emit_bytes(emitter, DEC_RCX, sizeof(DEC_RCX));
+      emit_store_popped(emitter);
+      emit_byte(emitter, 0x80);
+      emit_byte(emitter, 0x7E); // cmp byte [rsi + disp8], 0
+      emit_byte(emitter, (Byte)offsetof(Object, value));
+      emit_byte(emitter, 0x00);
+      emit_jump(emitter, oc == OP_JMZ || oc == OP_LOZ ? JE : JNE, sizeof(JE), target);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Emits the template of the instruction at offset. starts maps bytecode offsets to native offsets (measuring passes
+// may leave them zero) and exit is the native offset of the exit stub.
+static void emit_instruction(Emitter* emitter, Chunk* chunk, size_t offset, const size_t* starts, size_t exit)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  size_t following = offset + 1 + get_operand_length(oc);
+  size_t target = is_jump_operation(oc) ? starts[get_jump_target(chunk, offset)] : 0;
+  uintptr_t operand = 0;
+  bool branches = false;
+  int jump_when = 0;
+  size_t slow_jump = SIZE_MAX;
+  Helper helper = NULL;
+
+  if(oc == OP_JMP || oc == OP_LOP)
+  {
+    emit_jump(emitter, JMP, sizeof(JMP), target);
+    return;
+  }
+  if(emit_fast_path(emitter, chunk, offset, target, &slow_jump))
+  {
+    if(slow_jump == SIZE_MAX)
+      return;
+    emit_jump(emitter, JMP, sizeof(JMP), following < chunk->count ? starts[following] : exit);
+    patch_jump(emitter, slow_jump);
+  }
+  helper = select_helper(chunk, offset, &operand, &branches, &jump_when);
+  emit_call(emitter, helper, &chunk->code[offset], operand);
+  if(branches)
+  {
+    emit_bytes(emitter, CMP_EAX_ERROR, sizeof(CMP_EAX_ERROR));
+    emit_jump(emitter, JE, sizeof(JE), exit);
+    emit_bytes(emitter, TEST_EAX_EAX, sizeof(TEST_EAX_EAX));
+    emit_jump(emitter, jump_when ? JNE : JE, sizeof(JE), target);
+    return;
+  }
+  emit_bytes(emitter, TEST_EAX_EAX, sizeof(TEST_EAX_EAX));
+  emit_jump(emitter, JNE, sizeof(JNE), exit);
+  return;
+}
+
+// Emits the native code of chunk (measuring it if emitter has no buffer) and returns its size
+static size_t emit_chunk(Emitter* emitter, Chunk* chunk, size_t* starts, size_t exit)
+{
+  emit_bytes(emitter, PROLOGUE, sizeof(PROLOGUE));
+  emit_bytes(emitter, MOV_RBX_IMM64, sizeof(MOV_RBX_IMM64));
+  emit_u64(emitter, (uint64_t)(uintptr_t)vm.sp);
+  emit_bytes(emitter, JMP_RDI, sizeof(JMP_RDI));
+  for(size_t offset = 0; offset < chunk->count; offset += 1 + get_operand_length((Opcode)chunk->code[offset]))
+  {
+    starts[offset] = emitter->count;
+    emit_instruction(emitter, chunk, offset, starts, exit);
+  }
+  emit_bytes(emitter, EPILOGUE, sizeof(EPILOGUE));
+  return emitter->count;
+}
+#endif // JIT_SUPPORTED
+
+// Returns true if native code can be generated for this platform (x86-64 Linux)
+bool jit_available(void)
+{
+  return JIT_SUPPORTED;
+}
+
+// Compiles chunk to native code and returns false if the platform is unsupported or memory could not be mapped
+bool compile_native(Chunk* chunk)
+{
+#if JIT_SUPPORTED
+  size_t* starts = NULL;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t length = 0;
+  size_t size = 0;
+  Emitter emitter;
+  void* code = NULL;
+
+  free_native(chunk);
+  if(!chunk->is_verified)
+    return false;
+
+  // Measure the code first. Templates have a fixed size, so the measured offsets of the instructions are final.
+  starts = calloc(chunk->count, sizeof(size_t));
+  if(starts == NULL)
+    return false;
+  emitter.code = NULL;
+  emitter.count = 0;
+  length = emit_chunk(&emitter, chunk, starts, 0);
+  size = (length + page - 1) / page * page;
+
+  code = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(code == MAP_FAILED)
+  {
+    fprintf(stderr, "Unable to map memory for native code (%zu bytes)!\n", size);
+    free(starts);
+    return false;
+  }
+  emitter.code = code;
+  emitter.count = 0;
+  emit_chunk(&emitter, chunk, starts, length - sizeof(EPILOGUE));
+
+  // Remap read-execute (W^X) before the code can run
+  if(mprotect(code, size, PROT_READ | PROT_EXEC) != 0)
+  {
+    fprintf(stderr, "Unable to make native code executable!\n");
+    munmap(code, size);
+    free(starts);
+    return false;
+  }
+  chunk->native = code;
+  chunk->native_size = size;
+  chunk->native_entries = starts;
+  if(debug_mode)
+    debug_print("Compiled chunk of %zu bytes to %zu bytes of native code.", chunk->count, length);
+  return true;
+#else
+  UNUSED(chunk);
+  return false;
+#endif // JIT_SUPPORTED
+}
+
+// Runs the native code of chunk from the instruction at vm.ip and returns the status it exits with. A chunk that
+// deoptimizes loses its native code.
+static int enter_native(Chunk* chunk)
+{
+  NativeCode code = NULL;
+  int status = NATIVE_EXIT;
+
+  memcpy(&code, &chunk->native, sizeof(code));
+  status = code((const Byte*)chunk->native + chunk->native_entries[vm.ip - chunk->code]);
+  if(status == NATIVE_DEOPT)
+  {
+    if(debug_mode)
+      debug_print("Deoptimized at offset %zu.", (size_t)(vm.ip - chunk->code));
+    free_native(chunk);
+  }
+  return status;
+}
+
+// Runs the native code of chunk and finishes in the interpreter from wherever the native code exits
+RunCode run_native(Chunk* chunk)
+{
+  size_t depth = vm.sp->count;
+  int status = enter_native(chunk);
+
+  if(status == NATIVE_ERROR)
+    fprintf(stderr, "Runtime error on line %zu!\n", chunk->lines[vm.ip - chunk->code]);
+  else if(vm.dispatch() == RUN_SUCCESS)
+    return RUN_SUCCESS;
+
+  // Drop the operands the native code left on the stack along with those of the interpreter
+  vm.sp->count = depth;
+  vm.sp->top = (ptrdiff_t)depth - 1;
+  return RUN_ERROR;
+}
+
+// Counts a loop back-edge of the main program of chunk to vm.ip and runs the loop as native code once it is hot
+RunCode run_hot_loop(Chunk* chunk)
+{
+  if(chunk->native == NULL && ++chunk->hotness < jit_threshold)
+    return RUN_SUCCESS;
+  if(chunk->native == NULL && !compile_native(chunk))
+  {
+    chunk->hotness = 0; // try again once the loop is as hot again
+    return RUN_SUCCESS;
+  }
+  // The native code exits to the interpreter at the first instruction it has no template for (a call, for example)
+  return enter_native(chunk) == NATIVE_ERROR ? RUN_ERROR : RUN_SUCCESS;
+}
+
+// Unmaps the native code of chunk
+void free_native(Chunk* chunk)
+{
+#if JIT_SUPPORTED
+  if(chunk->native != NULL)
+    munmap(chunk->native, chunk->native_size);
+#endif
+  free(chunk->native_entries);
+  chunk->native = NULL;
+  chunk->native_size = 0;
+  chunk->native_entries = NULL;
+  chunk->hotness = 0;
+  return;
+}
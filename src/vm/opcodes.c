@@ -33,64 +33,220 @@ const char* get_mnemonic(Opcode oc)
   switch(oc)
   {
     case OP_ADD: return "OP_ADD";    // add (+)
+    case OP_ADDD: return "OP_ADDD";  // add decimals (quickened ADD)
+    case OP_ADDK: return "OP_ADDK";  // add constant (fused PSH + ADD)
+    case OP_ADDKD: return "OP_ADDKD"; // add decimal constant (quickened ADDK)
+    case OP_ADDKN: return "OP_ADDKN"; // add number constant (quickened ADDK)
+    case OP_ADDN: return "OP_ADDN";  // add numbers (quickened ADD)
+    case OP_ADDS: return "OP_ADDS";  // concatenate strings (quickened ADD)
     case OP_AND: return "OP_AND";    // logical and (&&)
     case OP_ASN: return "OP_ASN";    // assign (=)
     case OP_BND: return "OP_BND";    // bitwise and (&)
     case OP_BNT: return "OP_BNT";    // bitwise not/ones' complement (~)
     case OP_BOR: return "OP_BOR";    // bitwise or (|)
-    case OP_CAL: return "OP_CAL";    // call
+    case OP_CAL: return "OP_CAL";    // call function
     case OP_CLR: return "OP_CLR";    // clear registers
     case OP_CLS: return "OP_CLS";    // clear stack
     case OP_CMP: return "OP_CMP";    // compare
     case OP_DEC: return "OP_DEC";    // decrement (--)
     case OP_DIV: return "OP_DIV";    // divide (/)
+    case OP_DIVD: return "OP_DIVD";  // divide decimals (quickened DIV)
+    case OP_DIVK: return "OP_DIVK";  // divide by constant (fused PSH + DIV)
+    case OP_DIVKD: return "OP_DIVKD"; // divide by decimal constant (quickened DIVK)
     case OP_END: return "OP_END";    // marks end of VM instructions
-    case OP_ENT: return "OP_ENT";    // entry point
+    case OP_ENT: return "OP_ENT";    // entry point (first instruction of a function)
     case OP_EQL: return "OP_EQL";    // equal to (==)
+    case OP_EQLK: return "OP_EQLK";  // equal to constant (fused PSH + EQL)
+    case OP_EQLKN: return "OP_EQLKN"; // equal to number constant (quickened EQLK)
+    case OP_EQLN: return "OP_EQLN";  // numbers equal to (quickened EQL)
     case OP_EXT: return "OP_EXT";    // exit
-    case OP_GT:  return "OP_GT";     // greater than (>)
+    case OP_GET: return "OP_GET";    // get (push value of global)
+    case OP_GET2: return "OP_GET2";  // get two globals (fused GET + GET)
+    case OP_GOPK: return "OP_GOPK";  // update global with constant operand (fused GET + PSH + <op> + ASN)
+    case OP_GT: return "OP_GT";      // greater than (>)
+    case OP_GTD: return "OP_GTD";    // decimal greater than (quickened GT)
     case OP_GTE: return "OP_GTE";    // greater than or equal to (>=)
+    case OP_GTED: return "OP_GTED";  // decimal greater than or equal to (quickened GTE)
+    case OP_GTEK: return "OP_GTEK";  // greater than or equal to constant (fused PSH + GTE)
+    case OP_GTEKD: return "OP_GTEKD"; // greater than or equal to decimal constant (quickened GTEK)
+    case OP_GTEKN: return "OP_GTEKN"; // greater than or equal to number constant (quickened GTEK)
+    case OP_GTEN: return "OP_GTEN";  // number greater than or equal to (quickened GTE)
+    case OP_GTK: return "OP_GTK";    // greater than constant (fused PSH + GT)
+    case OP_GTKD: return "OP_GTKD";  // greater than decimal constant (quickened GTK)
+    case OP_GTKN: return "OP_GTKN";  // greater than number constant (quickened GTK)
+    case OP_GTN: return "OP_GTN";    // number greater than (quickened GT)
     case OP_HLT: return "OP_HLT";    // halt
     case OP_INC: return "OP_INC";    // increment (++)
     case OP_JMC: return "OP_JMC";    // jump conditional
+    case OP_JMF: return "OP_JMF";    // jump if false, leaving false
     case OP_JMP: return "OP_JMP";    // jump
+    case OP_JMT: return "OP_JMT";    // jump if true, leaving true
     case OP_JMZ: return "OP_JMZ";    // jump zero
+    case OP_JNLK: return "OP_JNLK";  // jump if not less than constant (fused PSH + LT + JMZ)
+    case OP_LDL: return "OP_LDL";    // load local
+    case OP_LLTK: return "OP_LLTK";  // loop if less than constant (fused PSH + LT + LNZ)
     case OP_LNE: return "OP_LNE";    // loop not equal
     case OP_LNZ: return "OP_LNZ";    // loop not zero
     case OP_LOD: return "OP_LOD";    // load (from memory to register)
     case OP_LOE: return "OP_LOE";    // loop equal
     case OP_LOP: return "OP_LOP";    // loop
     case OP_LOZ: return "OP_LOZ";    // loop zero
-    case OP_LT:  return "OP_LT";     // less than (<)
+    case OP_LT: return "OP_LT";      // less than (<)
+    case OP_LTD: return "OP_LTD";    // decimal less than (quickened LT)
     case OP_LTE: return "OP_LTE";    // less than or equal to (<=)
+    case OP_LTED: return "OP_LTED";  // decimal less than or equal to (quickened LTE)
+    case OP_LTEK: return "OP_LTEK";  // less than or equal to constant (fused PSH + LTE)
+    case OP_LTEKD: return "OP_LTEKD"; // less than or equal to decimal constant (quickened LTEK)
+    case OP_LTEKN: return "OP_LTEKN"; // less than or equal to number constant (quickened LTEK)
+    case OP_LTEN: return "OP_LTEN";  // number less than or equal to (quickened LTE)
+    case OP_LTK: return "OP_LTK";    // less than constant (fused PSH + LT)
+    case OP_LTKD: return "OP_LTKD";  // less than decimal constant (quickened LTK)
+    case OP_LTKN: return "OP_LTKN";  // less than number constant (quickened LTK)
+    case OP_LTN: return "OP_LTN";    // number less than (quickened LT)
     case OP_MOD: return "OP_MOD";    // modulo (%)
+    case OP_MODK: return "OP_MODK";  // modulo constant (fused PSH + MOD)
     case OP_MOV: return "OP_MOV";    // move (from register to register)
     case OP_MUL: return "OP_MUL";    // multiply (*)
+    case OP_MULD: return "OP_MULD";  // multiply decimals (quickened MUL)
+    case OP_MULK: return "OP_MULK";  // multiply by constant (fused PSH + MUL)
+    case OP_MULKD: return "OP_MULKD"; // multiply by decimal constant (quickened MULK)
+    case OP_MULKN: return "OP_MULKN"; // multiply by number constant (quickened MULK)
+    case OP_MULN: return "OP_MULN";  // multiply numbers (quickened MUL)
     case OP_NEG: return "OP_NEG";    // negative (unary -)
     case OP_NEQ: return "OP_NEQ";    // not equal to (!=)
+    case OP_NEQK: return "OP_NEQK";  // not equal to constant (fused PSH + NEQ)
+    case OP_NEQKN: return "OP_NEQKN"; // not equal to number constant (quickened NEQK)
+    case OP_NEQN: return "OP_NEQN";  // numbers not equal to (quickened NEQ)
     case OP_NOP: return "OP_NOP";    // no op
     case OP_NOT: return "OP_NOT";    // logical not/negation (!)
     case OP_NUL: return "OP_NUL";    // null
-    case OP_OR:  return "OP_OR";     // logical or (||)
+    case OP_OR: return "OP_OR";      // logical or (||)
     case OP_POP: return "OP_POP";    // pop
     case OP_POS: return "OP_POS";    // positive
     case OP_POW: return "OP_POW";    // power/exponent (**)
     case OP_PSH: return "OP_PSH";    // push
-    case OP_RET: return "OP_RET";    // return
+    case OP_RADD: return "OP_RADD";  // register add (rA = B + C)
+    case OP_RASN: return "OP_RASN";  // register assign (global = rA)
+    case OP_RDIV: return "OP_RDIV";  // register divide (rA = B / C)
+    case OP_REQL: return "OP_REQL";  // register equal to (rA = B == C)
+    case OP_RET: return "OP_RET";    // return from function
+    case OP_RGET: return "OP_RGET";  // register get (rA = value of global)
+    case OP_RGT: return "OP_RGT";    // register greater than (rA = B > C)
+    case OP_RGTE: return "OP_RGTE";  // register greater than or equal to (rA = B >= C)
+    case OP_RLDK: return "OP_RLDK";  // register load constant (rA = constant)
+    case OP_RLT: return "OP_RLT";    // register less than (rA = B < C)
+    case OP_RLTE: return "OP_RLTE";  // register less than or equal to (rA = B <= C)
+    case OP_RMOD: return "OP_RMOD";  // register modulo (rA = B % C)
+    case OP_RMUL: return "OP_RMUL";  // register multiply (rA = B * C)
+    case OP_RNEQ: return "OP_RNEQ";  // register not equal to (rA = B != C)
+    case OP_RPOW: return "OP_RPOW";  // register power/exponent (rA = B ** C)
+    case OP_RSUB: return "OP_RSUB";  // register subtract (rA = B - C)
+    case OP_SETK: return "OP_SETK";  // set global to constant (fused PSH + ASN)
     case OP_SHL: return "OP_SHL";    // bitshift left (<<)
     case OP_SHR: return "OP_SHR";    // bitshift right (>>)
     case OP_SLE: return "OP_SLE";    // string length equal to ($=)
     case OP_SLN: return "OP_SLN";    // string length not equal to ($!)
+    case OP_STL: return "OP_STL";    // store local
     case OP_STR: return "OP_STR";    // store (to memory from register)
     case OP_SUB: return "OP_SUB";    // subtract (-)
+    case OP_SUBD: return "OP_SUBD";  // subtract decimals (quickened SUB)
+    case OP_SUBK: return "OP_SUBK";  // subtract constant (fused PSH + SUB)
+    case OP_SUBKD: return "OP_SUBKD"; // subtract decimal constant (quickened SUBK)
+    case OP_SUBKN: return "OP_SUBKN"; // subtract number constant (quickened SUBK)
+    case OP_SUBN: return "OP_SUBN";  // subtract numbers (quickened SUB)
     case OP_SYS: return "OP_SYS";    // system
-    case OP_TST: return "OP_TST";    // test
+    case OP_TCL: return "OP_TCL";    // tail call
+    case OP_TST: return "OP_TST";    // test (replace value with its truth value)
     case OP_XCG: return "OP_XCG";    // exchange/swap
     case OP_XOR: return "OP_XOR";    // bitwise exclusive or (^)
     default:     return "UNDEFINED"; // unsupported opcode
   }
 }
 
+// Returns number of operand bytes following opcode
+size_t get_operand_length(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADDK:
+    case OP_DIVK:
+    case OP_EQLK:
+    case OP_GTK:
+    case OP_GTEK:
+    case OP_LTK:
+    case OP_LTEK:
+    case OP_MODK:
+    case OP_MULK:
+    case OP_NEQK:
+    case OP_SUBK:
+    case OP_ADDKD:
+    case OP_ADDKN:
+    case OP_DIVKD:
+    case OP_EQLKN:
+    case OP_GTEKD:
+    case OP_GTEKN:
+    case OP_GTKD:
+    case OP_GTKN:
+    case OP_LTEKD:
+    case OP_LTEKN:
+    case OP_LTKD:
+    case OP_LTKN:
+    case OP_MULKD:
+    case OP_MULKN:
+    case OP_NEQKN:
+    case OP_SUBKD:
+    case OP_SUBKN:
+      return 2;            // constant index of right operand
+    case OP_ASN: return 2; // global slot
+    case OP_CAL: return 2; // function index
+    case OP_ENT: return 1; // number of locals after the parameters
+    case OP_GET: return 2; // global slot
+    case OP_GET2: return 4; // slots of both globals
+    case OP_GOPK: return 5; // global slot, constant operand and binary opcode
+    case OP_JNLK:
+    case OP_LLTK:
+      return 4;            // jump offset and constant index of right operand
+    case OP_JMC:
+    case OP_JMF:
+    case OP_JMP:
+    case OP_JMT:
+    case OP_JMZ:
+    case OP_LNE:
+    case OP_LNZ:
+    case OP_LOE:
+    case OP_LOP:
+    case OP_LOZ:
+      return 2;            // jump offset
+    case OP_LDL: return 1; // local slot
+    case OP_LOD: return 1; // destination register
+    case OP_MOV: return 2; // destination and source registers
+    case OP_PSH: return 2; // constant index
+    case OP_RADD:
+    case OP_RDIV:
+    case OP_REQL:
+    case OP_RGT:
+    case OP_RGTE:
+    case OP_RLT:
+    case OP_RLTE:
+    case OP_RMOD:
+    case OP_RMUL:
+    case OP_RNEQ:
+    case OP_RPOW:
+    case OP_RSUB:
+      return 3;            // destination register and two RK operands
+    case OP_RASN:
+    case OP_RGET:
+    case OP_RLDK:
+      return 3;            // register and global slot or constant index
+    case OP_SETK: return 4; // global slot and constant index of value
+    case OP_STL: return 1; // local slot
+    case OP_STR: return 1; // source register
+    case OP_TCL: return 2; // function index
+    case OP_XCG: return 2; // registers to exchange
+    default:     return 0;
+  }
+}
+
 // Returns true if opcode is a unary operation
 bool is_unary_operation(Opcode oc)
 {
@@ -108,6 +264,119 @@ bool is_unary_operation(Opcode oc)
   }
 }
 
+// Returns true if opcode is a register-form binary operation (rA = B <op> C)
+bool is_register_operation(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_RADD:
+    case OP_RDIV:
+    case OP_REQL:
+    case OP_RGT:
+    case OP_RGTE:
+    case OP_RLT:
+    case OP_RLTE:
+    case OP_RMOD:
+    case OP_RMUL:
+    case OP_RNEQ:
+    case OP_RPOW:
+    case OP_RSUB:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if opcode is a binary operation with a constant right operand (fused PSH + <op>)
+bool is_constant_operation(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADDK:
+    case OP_DIVK:
+    case OP_EQLK:
+    case OP_GTK:
+    case OP_GTEK:
+    case OP_LTK:
+    case OP_LTEK:
+    case OP_MODK:
+    case OP_MULK:
+    case OP_NEQK:
+    case OP_SUBK:
+    case OP_ADDKD:
+    case OP_ADDKN:
+    case OP_DIVKD:
+    case OP_EQLKN:
+    case OP_GTEKD:
+    case OP_GTEKN:
+    case OP_GTKD:
+    case OP_GTKN:
+    case OP_LTEKD:
+    case OP_LTEKN:
+    case OP_LTKD:
+    case OP_LTKN:
+    case OP_MULKD:
+    case OP_MULKN:
+    case OP_NEQKN:
+    case OP_SUBKD:
+    case OP_SUBKN:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if opcode transfers control to a jump offset (jumps and loops)
+bool is_jump_operation(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_JMC:
+    case OP_JMF:
+    case OP_JMP:
+    case OP_JMT:
+    case OP_JMZ:
+    case OP_JNLK:
+      return true;
+    default:
+      return is_loop_operation(oc);
+  }
+}
+
+// Returns true if opcode jumps back (loops)
+bool is_loop_operation(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_LLTK:
+    case OP_LNE:
+    case OP_LNZ:
+    case OP_LOE:
+    case OP_LOP:
+    case OP_LOZ:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if execution can continue with the instruction following opcode
+bool falls_through(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_END:
+    case OP_HLT:
+    case OP_JMP:
+    case OP_LOP:
+    case OP_RET:
+    case OP_TCL:
+      return false;
+    default:
+      return true;
+  }
+}
+
 // Returns true if opcode is a binary operation
 bool is_binary_operation(Opcode oc)
 {
@@ -140,3 +409,117 @@ bool is_binary_operation(Opcode oc)
       return false;
   }
 }
+
+// Returns form of generic binary opcode specialized for two numbers or oc if there is none
+static Opcode get_number_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADD:  return OP_ADDN;
+    case OP_ADDK: return OP_ADDKN;
+    case OP_EQL:  return OP_EQLN;
+    case OP_EQLK: return OP_EQLKN;
+    case OP_GT:   return OP_GTN;
+    case OP_GTE:  return OP_GTEN;
+    case OP_GTEK: return OP_GTEKN;
+    case OP_GTK:  return OP_GTKN;
+    case OP_LT:   return OP_LTN;
+    case OP_LTE:  return OP_LTEN;
+    case OP_LTEK: return OP_LTEKN;
+    case OP_LTK:  return OP_LTKN;
+    case OP_MUL:  return OP_MULN;
+    case OP_MULK: return OP_MULKN;
+    case OP_NEQ:  return OP_NEQN;
+    case OP_NEQK: return OP_NEQKN;
+    case OP_SUB:  return OP_SUBN;
+    case OP_SUBK: return OP_SUBKN;
+    default:      return oc;
+  }
+}
+
+// Returns form of generic binary opcode specialized for two decimals or oc if there is none
+static Opcode get_decimal_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADD:  return OP_ADDD;
+    case OP_ADDK: return OP_ADDKD;
+    case OP_DIV:  return OP_DIVD;
+    case OP_DIVK: return OP_DIVKD;
+    case OP_GT:   return OP_GTD;
+    case OP_GTE:  return OP_GTED;
+    case OP_GTEK: return OP_GTEKD;
+    case OP_GTK:  return OP_GTKD;
+    case OP_LT:   return OP_LTD;
+    case OP_LTE:  return OP_LTED;
+    case OP_LTEK: return OP_LTEKD;
+    case OP_LTK:  return OP_LTKD;
+    case OP_MUL:  return OP_MULD;
+    case OP_MULK: return OP_MULKD;
+    case OP_SUB:  return OP_SUBD;
+    case OP_SUBK: return OP_SUBKD;
+    default:      return oc;
+  }
+}
+
+// Returns form of generic binary opcode specialized for the given operand types or oc if there is none
+Opcode get_quickened_opcode(Opcode oc, DataType type1, DataType type2)
+{
+  if(type1 != type2)
+    return oc;
+  switch(type1)
+  {
+    case CCT_TYPE_NUMBER:
+      return get_number_opcode(oc);
+    case CCT_TYPE_DECIMAL:
+      return get_decimal_opcode(oc);
+    case CCT_TYPE_STRING:
+      return oc == OP_ADD ? OP_ADDS : oc;
+    default:
+      return oc;
+  }
+}
+
+// Returns generic form of a quickened opcode or oc if it is not quickened
+Opcode get_generic_opcode(Opcode oc)
+{
+  switch(oc)
+  {
+    case OP_ADDD:  return OP_ADD;
+    case OP_ADDKD: return OP_ADDK;
+    case OP_ADDKN: return OP_ADDK;
+    case OP_ADDN:  return OP_ADD;
+    case OP_ADDS:  return OP_ADD;
+    case OP_DIVD:  return OP_DIV;
+    case OP_DIVKD: return OP_DIVK;
+    case OP_EQLKN: return OP_EQLK;
+    case OP_EQLN:  return OP_EQL;
+    case OP_GTD:   return OP_GT;
+    case OP_GTED:  return OP_GTE;
+    case OP_GTEKD: return OP_GTEK;
+    case OP_GTEKN: return OP_GTEK;
+    case OP_GTEN:  return OP_GTE;
+    case OP_GTKD:  return OP_GTK;
+    case OP_GTKN:  return OP_GTK;
+    case OP_GTN:   return OP_GT;
+    case OP_LTD:   return OP_LT;
+    case OP_LTED:  return OP_LTE;
+    case OP_LTEKD: return OP_LTEK;
+    case OP_LTEKN: return OP_LTEK;
+    case OP_LTEN:  return OP_LTE;
+    case OP_LTKD:  return OP_LTK;
+    case OP_LTKN:  return OP_LTK;
+    case OP_LTN:   return OP_LT;
+    case OP_MULD:  return OP_MUL;
+    case OP_MULKD: return OP_MULK;
+    case OP_MULKN: return OP_MULK;
+    case OP_MULN:  return OP_MUL;
+    case OP_NEQKN: return OP_NEQK;
+    case OP_NEQN:  return OP_NEQ;
+    case OP_SUBD:  return OP_SUB;
+    case OP_SUBKD: return OP_SUBK;
+    case OP_SUBKN: return OP_SUBK;
+    case OP_SUBN:  return OP_SUB;
+    default:       return oc;
+  }
+}
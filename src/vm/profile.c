@@ -0,0 +1,261 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>      // errno
+#include <inttypes.h>   // PRIu64
+#include <stdint.h>     // uint64_t
+#include <stdio.h>      // fprintf(), printf()
+#include <stdlib.h>     // calloc(), free(), qsort()
+#include <string.h>     // memset(), strerror()
+#include "vm/profile.h"
+#include "vm/verifier.h" // get_stack_effect()
+
+bool profile_mode = false;
+bool traffic_mode = false;
+StackTraffic stack_traffic;
+
+typedef struct opcode_profile
+{
+  OperationCounts counts;
+  uint64_t* unigrams; // OPCODE_AMOUNT counters
+  uint64_t* bigrams;  // OPCODE_AMOUNT^2 counters indexed by (first, second)
+  uint64_t* trigrams; // OPCODE_AMOUNT^3 counters indexed by (first, second, third)
+  size_t history;     // number of valid entries in previous (0-2)
+  Opcode previous[2]; // last two opcodes executed, most recent last
+} OpcodeProfile;
+
+static OpcodeProfile profile;
+
+// Sequence and its count used when sorting the report
+typedef struct profile_entry
+{
+  size_t index;
+  uint64_t count;
+} ProfileEntry;
+
+// Allocates opcode counters
+void init_profile(void)
+{
+  memset(&profile.counts, 0, sizeof(profile.counts));
+  profile.history = 0;
+  profile.unigrams = calloc(OPCODE_AMOUNT, sizeof(uint64_t));
+  profile.bigrams = calloc(OPCODE_AMOUNT * OPCODE_AMOUNT, sizeof(uint64_t));
+  profile.trigrams = calloc(OPCODE_AMOUNT * OPCODE_AMOUNT * OPCODE_AMOUNT, sizeof(uint64_t));
+  if(profile.unigrams == NULL || profile.bigrams == NULL || profile.trigrams == NULL)
+  {
+    fprintf(stderr, "Error allocating memory for opcode profile: %s\n", strerror(errno));
+    free_profile();
+    profile_mode = false;
+  }
+  return;
+}
+
+// Frees opcode counters
+void free_profile(void)
+{
+  free(profile.unigrams);
+  free(profile.bigrams);
+  free(profile.trigrams);
+  profile.unigrams = NULL;
+  profile.bigrams = NULL;
+  profile.trigrams = NULL;
+  return;
+}
+
+// Forgets the previously executed opcodes so sequences do not span separate runs
+void reset_profile_history(void)
+{
+  profile.history = 0;
+  return;
+}
+
+// Counts opcode along with the bigram and trigram it completes
+void profile_opcode(Opcode oc)
+{
+  if(profile.unigrams == NULL || (size_t)oc >= OPCODE_AMOUNT)
+    return;
+  profile.counts.instructions++;
+  profile.unigrams[oc]++;
+  if(profile.history >= 1)
+    profile.bigrams[profile.previous[1] * OPCODE_AMOUNT + oc]++;
+  if(profile.history >= 2)
+    profile.trigrams[(profile.previous[0] * OPCODE_AMOUNT + profile.previous[1]) * OPCODE_AMOUNT + oc]++;
+  profile.previous[0] = profile.previous[1];
+  profile.previous[1] = oc;
+  if(profile.history < 2)
+    profile.history++;
+  return;
+}
+
+// Counts the values the instruction oc reads from and writes to constants, globals, locals and registers
+static void count_memory_traffic(Opcode oc)
+{
+  if(is_constant_operation(oc))
+  {
+    profile.counts.loads++;
+    return;
+  }
+  if(is_register_operation(oc))
+  {
+    profile.counts.loads += 2; // both RK operands
+    profile.counts.stores++;
+    return;
+  }
+  switch(oc)
+  {
+    case OP_GET:
+    case OP_JNLK:
+    case OP_LDL:
+    case OP_LLTK:
+    case OP_PSH:
+    case OP_STR:
+      profile.counts.loads++;
+      break;
+    case OP_GET2:
+      profile.counts.loads += 2;
+      break;
+    case OP_ASN:
+    case OP_LOD:
+    case OP_STL:
+      profile.counts.stores++;
+      break;
+    case OP_MOV:
+    case OP_RASN:
+    case OP_RGET:
+    case OP_RLDK:
+    case OP_SETK:
+      profile.counts.loads++;
+      profile.counts.stores++;
+      break;
+    case OP_GOPK:
+      profile.counts.loads += 2;
+      profile.counts.stores++;
+      break;
+    case OP_XCG:
+      profile.counts.loads += 2;
+      profile.counts.stores += 2;
+      break;
+    default:
+      break;
+  }
+  return;
+}
+
+// Counts the instruction at offset of chunk along with the sequences it completes and its stack and memory traffic
+void profile_instruction(const Chunk* chunk, size_t offset)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  size_t pops = 0;
+  size_t pushes = 0;
+
+  if(profile.unigrams == NULL || (size_t)oc >= OPCODE_AMOUNT)
+    return;
+  profile_opcode(oc);
+  get_stack_effect(chunk, offset, &pops, &pushes);
+  profile.counts.pops += pops;
+  profile.counts.pushes += pushes;
+  count_memory_traffic(oc);
+  return;
+}
+
+// Returns the instructions counted since init_profile() and their traffic
+OperationCounts get_operation_counts(void)
+{
+  return profile.counts;
+}
+
+// Orders entries by descending count
+static int compare_entries(const void* entry1, const void* entry2)
+{
+  uint64_t count1 = ((const ProfileEntry *)entry1)->count;
+  uint64_t count2 = ((const ProfileEntry *)entry2)->count;
+  if(count1 < count2)
+    return 1;
+  if(count1 > count2)
+    return -1;
+  return 0;
+}
+
+// Prints the most frequent sequences of a counter table (length is 1, 2 or 3 opcodes)
+static void print_table(const char* title, const uint64_t* counts, size_t length, size_t limit)
+{
+  size_t entry_count = 1;
+  size_t used = 0;
+  ProfileEntry* entries = NULL;
+
+  for(size_t i = 0; i < length; i++)
+    entry_count *= OPCODE_AMOUNT;
+  entries = malloc(entry_count * sizeof(ProfileEntry));
+  if(entries == NULL)
+  {
+    fprintf(stderr, "Error allocating memory for opcode profile report: %s\n", strerror(errno));
+    return;
+  }
+  for(size_t i = 0; i < entry_count; i++)
+  {
+    if(counts[i] == 0)
+      continue;
+    entries[used].index = i;
+    entries[used].count = counts[i];
+    used++;
+  }
+  qsort(entries, used, sizeof(ProfileEntry), compare_entries);
+
+  printf("%s:\n", title);
+  for(size_t i = 0; i < used && i < limit; i++)
+  {
+    size_t index = entries[i].index;
+    Opcode sequence[3];
+    for(size_t j = length; j > 0; j--)
+    {
+      sequence[j - 1] = (Opcode)(index % OPCODE_AMOUNT);
+      index /= OPCODE_AMOUNT;
+    }
+    printf("%12" PRIu64 " %6.2f%% ", entries[i].count, 100.0 * entries[i].count / profile.counts.instructions);
+    for(size_t j = 0; j < length; j++)
+      printf(" %s", get_mnemonic(sequence[j]));
+    puts("");
+  }
+  free(entries);
+  return;
+}
+
+// Prints the stack and memory traffic and the most frequent opcodes, bigrams and trigrams
+void print_profile(size_t limit)
+{
+  if(profile.unigrams == NULL)
+    return;
+  printf("== Opcode profile (%" PRIu64 " instructions executed) ==\n", profile.counts.instructions);
+  if(profile.counts.instructions == 0)
+    return;
+  printf("Traffic: %" PRIu64 " pushes, %" PRIu64 " pops, %" PRIu64 " loads, %" PRIu64 " stores\n",
+         profile.counts.pushes, profile.counts.pops, profile.counts.loads, profile.counts.stores);
+  print_table("Opcodes", profile.unigrams, 1, limit);
+  print_table("Bigrams", profile.bigrams, 2, limit);
+  print_table("Trigrams", profile.trigrams, 3, limit);
+  return;
+}
@@ -0,0 +1,127 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>  // fprintf(), stderr
+#include <stdlib.h> // free(), malloc(), realloc()
+#include "vm/program.h"
+
+// Initializes program
+void init_program(Program* program)
+{
+  program->count = 0;
+  program->capacity = 0;
+  program->chunks = NULL;
+  return;
+}
+
+// Frees program and all chunks it still holds
+void free_program(Program* program)
+{
+  // Chunks that import functions follow the chunk holding them
+  for(size_t i = program->count; i > 0; i--)
+    unload_chunk(program, i - 1);
+  free(program->chunks);
+  init_program(program);
+  return;
+}
+
+// Appends a new empty chunk to program and returns it (NULL if memory could not be allocated)
+Chunk* add_chunk(Program* program)
+{
+  size_t capacity = 0;
+  Chunk** chunks = NULL;
+  Chunk* chunk = NULL;
+
+  if(program->count == program->capacity)
+  {
+    capacity = program->capacity == 0 ? 4 : program->capacity * 2;
+    chunks = realloc(program->chunks, capacity * sizeof(Chunk*));
+    if(chunks == NULL)
+    {
+      fprintf(stderr, "Unable to allocate memory for program chunks.\n");
+      return NULL;
+    }
+    program->chunks = chunks;
+    program->capacity = capacity;
+  }
+  chunk = malloc(sizeof(Chunk));
+  if(chunk == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory for chunk.\n");
+    return NULL;
+  }
+  init_chunk(chunk);
+  program->chunks[program->count++] = chunk;
+  return chunk;
+}
+
+// Releases the chunks whose functions chunk imports (each once)
+static void release_imports(const Chunk* chunk)
+{
+  size_t j = 0;
+
+  for(size_t i = 0; i < chunk->function_count; i++)
+  {
+    if(chunk->functions[i].chunk == chunk)
+      continue;
+    for(j = 0; j < i && chunk->functions[j].chunk != chunk->functions[i].chunk; j++)
+      ;
+    if(j == i)
+      chunk->functions[i].chunk->importers--;
+  }
+  return;
+}
+
+// Frees the chunk at index, leaving an empty slot. Returns false and keeps the chunk if a loaded chunk still calls
+// functions compiled into it.
+bool unload_chunk(Program* program, size_t index)
+{
+  if(index >= program->count || program->chunks[index] == NULL)
+    return true;
+  if(program->chunks[index]->importers > 0)
+  {
+    fprintf(stderr, "Unable to unload chunk %zu while %zu chunks call its functions.\n", index,
+            program->chunks[index]->importers);
+    return false;
+  }
+  release_imports(program->chunks[index]);
+  free_chunk(program->chunks[index]);
+  free(program->chunks[index]);
+  program->chunks[index] = NULL;
+  return true;
+}
+
+// Interprets the chunks of program in order and stops at the first runtime error
+RunCode run_program(Program* program, ConcoctHashMap* map)
+{
+  for(size_t i = 0; i < program->count; i++)
+  {
+    if(program->chunks[i] != NULL && interpret(program->chunks[i], map) == RUN_ERROR)
+      return RUN_ERROR;
+  }
+  return RUN_SUCCESS;
+}
@@ -0,0 +1,490 @@
+/*
+ * Concoct - An imperative, dynamically-typed, interpreted, general-purpose programming language
+ * Copyright (c) 2020-2023 BlakeTheBlock and Lloyd Dilley
+ * http://concoct.ist/
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>            // SIZE_MAX
+#include <stdio.h>             // fprintf(), stderr
+#include <stdlib.h>            // calloc(), free(), malloc(), realloc()
+#include <string.h>            // memset()
+#include "debug.h"            // debug_mode, debug_print()
+#include "vm/instructions.h"  // get_binary_kernel()
+#include "vm/verifier.h"
+#include "vm/vm.h"            // REGISTER_AMOUNT, vm
+
+// Objects popped and pushed by an instruction
+typedef struct stack_effect
+{
+  size_t pops;
+  size_t pushes;
+  size_t jump_pushes; // objects pushed only when the jump is taken (OP_JMF, OP_JMT)
+} StackEffect;
+
+// Reports why chunk failed verification at offset (in debug mode) and returns false
+static bool reject(const Chunk* chunk, size_t offset, const char* reason)
+{
+  if(debug_mode)
+    debug_print("Verification of chunk failed at offset %zu (%s): %s", offset,
+                offset < chunk->count ? get_mnemonic((Opcode)chunk->code[offset]) : "end of chunk", reason);
+  return false;
+}
+
+// Returns true if index names an entry of the constant pool
+static bool is_constant(const Chunk* chunk, uint16_t index)
+{
+  return index < chunk->constant_count && chunk->constants[index] != NULL;
+}
+
+// Returns true if slot is a global slot that chunk binds while it runs
+static bool is_global(const Chunk* chunk, uint16_t slot)
+{
+  return slot < vm.global_count && uses_global(chunk, slot);
+}
+
+// Returns true if an RK operand byte names a register or an entry of the constant pool
+static bool is_rk(const Chunk* chunk, Byte rk)
+{
+  return rk < REGISTER_AMOUNT || is_constant(chunk, (uint16_t)(rk - REGISTER_AMOUNT));
+}
+
+// Returns true if index names a function whose code has been verified (or is verified along with chunk) and stores
+// the stack effect of calling it
+static bool is_callable(const Chunk* chunk, uint16_t index, StackEffect* effect)
+{
+  const Function* function = NULL;
+
+  if(index >= chunk->function_count)
+    return false;
+  function = &chunk->functions[index];
+  effect->pops = function->arity;
+  effect->pushes = 1;
+  return function->chunk != NULL && function->arity <= function->local_count
+         && function->local_count <= MAX_LOCAL_AMOUNT && (function->chunk == chunk || function->chunk->is_verified);
+}
+
+// Validates the operands of the instruction at offset and stores its stack effect
+static bool check_instruction(const Chunk* chunk, size_t offset, StackEffect* effect)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  const Byte* operands = &chunk->code[offset + 1];
+
+  effect->pops = 0;
+  effect->pushes = 0;
+  effect->jump_pushes = 0;
+  if(is_constant_operation(oc))
+  {
+    effect->pops = 1;
+    effect->pushes = 1;
+    return is_constant(chunk, read_short(operands));
+  }
+  if(is_unary_operation(oc))
+  {
+    effect->pops = 1;
+    effect->pushes = 1;
+    return true;
+  }
+  if(is_register_operation(oc))
+    return operands[0] < REGISTER_AMOUNT && is_rk(chunk, operands[1]) && is_rk(chunk, operands[2]);
+  switch(oc)
+  {
+    case OP_ASN:
+      effect->pops = 1;
+      return is_global(chunk, read_short(operands));
+    case OP_GET:
+      effect->pushes = 1;
+      return is_global(chunk, read_short(operands));
+    case OP_GET2:
+      effect->pushes = 2;
+      return is_global(chunk, read_short(operands)) && is_global(chunk, read_short(operands + 2));
+    case OP_GOPK:
+      return is_global(chunk, read_short(operands)) && is_constant(chunk, read_short(operands + 2)) &&
+             operands[4] < OPCODE_AMOUNT && get_binary_kernel((Opcode)operands[4]) != NULL;
+    case OP_SETK:
+      return is_global(chunk, read_short(operands)) && is_constant(chunk, read_short(operands + 2));
+    case OP_PSH:
+      effect->pushes = 1;
+      return is_constant(chunk, read_short(operands));
+    case OP_POP:
+    case OP_LOD:
+      effect->pops = 1;
+      return oc == OP_POP || operands[0] < REGISTER_AMOUNT;
+    case OP_STR:
+      effect->pushes = 1;
+      return operands[0] < REGISTER_AMOUNT;
+    case OP_MOV:
+    case OP_XCG:
+      return operands[0] < REGISTER_AMOUNT && operands[1] < REGISTER_AMOUNT;
+    case OP_RASN:
+      return is_global(chunk, read_short(operands)) && operands[2] < REGISTER_AMOUNT;
+    case OP_RGET:
+      return operands[0] < REGISTER_AMOUNT && is_global(chunk, read_short(operands + 1));
+    case OP_RLDK:
+      return operands[0] < REGISTER_AMOUNT && is_constant(chunk, read_short(operands + 1));
+    case OP_JMP:
+    case OP_LOP:
+      return true;
+    case OP_JMC:
+    case OP_JMZ:
+    case OP_LNZ:
+    case OP_LOZ:
+      effect->pops = 1;
+      return true;
+    case OP_JMF:
+    case OP_JMT:
+      effect->pops = 1;
+      effect->jump_pushes = 1;
+      return true;
+    case OP_LNE:
+    case OP_LOE:
+      effect->pops = 2;
+      return true;
+    case OP_JNLK:
+    case OP_LLTK:
+      effect->pops = 1;
+      return is_constant(chunk, read_short(operands + 2));
+    case OP_TST:
+      effect->pops = 1;
+      effect->pushes = 1;
+      return true;
+    case OP_CAL:
+    case OP_TCL:
+      return is_callable(chunk, read_short(operands), effect);
+    case OP_ENT:
+      return true; // locals live below the operand stack of the frame
+    case OP_LDL:
+      effect->pushes = 1;
+      return true;
+    case OP_STL:
+    case OP_RET:
+      effect->pops = 1;
+      return true;
+    case OP_CLR:
+    case OP_CLS:
+    case OP_END:
+    case OP_HLT:
+    case OP_NOP:
+      return true;
+    default:
+      break;
+  }
+  if(is_binary_operation(get_generic_opcode(oc)))
+  {
+    effect->pops = 2;
+    effect->pushes = 1;
+    return true;
+  }
+  return false; // not executable (calls carry no operands yet)
+}
+
+// Stores the number of objects the instruction at offset of chunk pops and pushes, not counting the object OP_JMF and
+// OP_JMT leave when they jump. Returns false if its operands are invalid.
+bool get_stack_effect(const Chunk* chunk, size_t offset, size_t* pops, size_t* pushes)
+{
+  StackEffect effect;
+  bool valid = check_instruction(chunk, offset, &effect);
+
+  *pops = effect.pops;
+  *pushes = effect.pushes;
+  return valid;
+}
+
+// Decodes chunk linearly, validating each instruction and marking where instructions start
+static bool check_instructions(const Chunk* chunk, bool* starts)
+{
+  size_t offset = 0;
+  size_t length = 0;
+  StackEffect effect;
+
+  while(offset < chunk->count)
+  {
+    if(chunk->code[offset] >= OPCODE_AMOUNT)
+      return reject(chunk, offset, "invalid opcode");
+    length = 1 + get_operand_length((Opcode)chunk->code[offset]);
+    if(length > chunk->count - offset)
+      return reject(chunk, offset, "operands extend past end of chunk");
+    if(!check_instruction(chunk, offset, &effect))
+      return reject(chunk, offset, "invalid or unsupported operands");
+    starts[offset] = true;
+    offset += length;
+  }
+  return true;
+}
+
+// Tracks which path (the main program or a function of the chunk) owns each instruction
+typedef struct path_state
+{
+  const bool* starts;  // instruction starts
+  size_t* depths;      // stack depth at each reached offset (SIZE_MAX if unreached)
+  size_t* owners;      // path that first reached each offset
+  size_t* pending;     // worklist of reached offsets not yet checked
+  size_t pending_count;
+} PathState;
+
+// Records the stack depth control reaches offset with and queues offset the first time it is reached
+static bool reach(const Chunk* chunk, PathState* state, size_t owner, size_t offset, size_t depth, size_t from)
+{
+  if(offset >= chunk->count)
+    return reject(chunk, from, "execution runs past the end of the chunk");
+  if(!state->starts[offset])
+    return reject(chunk, from, "jump lands inside an instruction");
+  if(state->depths[offset] == SIZE_MAX)
+  {
+    state->depths[offset] = depth;
+    state->owners[offset] = owner;
+    state->pending[state->pending_count++] = offset;
+    return true;
+  }
+  if(state->owners[offset] != owner)
+    return reject(chunk, from, "control flow crosses a function boundary");
+  if(state->depths[offset] != depth)
+    return reject(chunk, from, "stack depth differs where control flow merges");
+  return true;
+}
+
+// Checks the instruction at offset against the frame of its path (function is NULL for the main program)
+static bool check_frame(const Chunk* chunk, size_t offset, size_t start, const Function* function, size_t depth)
+{
+  Opcode oc = (Opcode)chunk->code[offset];
+  size_t locals = function == NULL ? 0 : function->local_count;
+
+  switch(oc)
+  {
+    case OP_ENT:
+      if(function == NULL || offset != start || chunk->code[offset + 1] != function->local_count - function->arity)
+        return reject(chunk, offset, "entry point does not start a function or reserves the wrong number of locals");
+      return true;
+    case OP_LDL:
+    case OP_STL:
+      if(chunk->code[offset + 1] >= locals)
+        return reject(chunk, offset, "local slot is outside the frame");
+      return true;
+    case OP_RET:
+      if(function == NULL || depth != 1)
+        return reject(chunk, offset, "return outside of a function or with an unbalanced stack");
+      return true;
+    case OP_TCL:
+      if(function == NULL || depth != chunk->functions[read_short(&chunk->code[offset + 1])].arity)
+        return reject(chunk, offset, "tail call outside of a function or with an unbalanced stack");
+      return true;
+    case OP_CLS:
+      if(function != NULL)
+        return reject(chunk, offset, "function clears the stack of its caller");
+      return true;
+    case OP_END:
+    case OP_HLT:
+      if(function != NULL || depth != 0)
+        return reject(chunk, offset, "stack is not balanced");
+      return true;
+    default:
+      if(function != NULL && offset == start)
+        return reject(chunk, offset, "function does not start with an entry point");
+      return true;
+  }
+}
+
+// Follows every path from start (the first instruction of the program or of function) and returns the maximum stack
+// depth of the path in max_depth
+static bool check_paths(const Chunk* chunk, PathState* state, size_t owner, size_t start, const Function* function,
+                        size_t* max_depth)
+{
+  size_t offset = 0;
+  size_t depth = 0;
+  StackEffect effect;
+  Opcode oc = OP_NOP;
+
+  *max_depth = 0;
+  if(!reach(chunk, state, owner, start, 0, start))
+    return false;
+  while(state->pending_count > 0)
+  {
+    offset = state->pending[--state->pending_count];
+    depth = state->depths[offset];
+    oc = (Opcode)chunk->code[offset];
+    check_instruction(chunk, offset, &effect);
+    if(oc == OP_CLS)
+      depth = 0;
+    if(!check_frame(chunk, offset, start, function, depth))
+      return false;
+    if(effect.pops > depth)
+      return reject(chunk, offset, "stack underflow");
+    depth = depth - effect.pops + effect.pushes;
+    if(depth + effect.jump_pushes > *max_depth)
+      *max_depth = depth + effect.jump_pushes;
+    if(is_jump_operation(oc) && !reach(chunk, state, owner, get_jump_target(chunk, offset), depth + effect.jump_pushes,
+                                       offset))
+      return false;
+    if(falls_through(oc) && !reach(chunk, state, owner, offset + 1 + get_operand_length(oc), depth, offset))
+      return false;
+  }
+  return true;
+}
+
+// Returns true if the instruction only reads the objects it pops. Unary operations may push their operand back and
+// every other instruction stores, returns or passes on what it pops.
+static bool only_reads(Opcode oc)
+{
+  if(is_constant_operation(oc))
+    return true;
+  switch(oc)
+  {
+    case OP_ASN:
+      return false;
+    case OP_JMC:
+    case OP_JMF:
+    case OP_JMT:
+    case OP_JMZ:
+    case OP_JNLK:
+    case OP_LLTK:
+    case OP_LNE:
+    case OP_LNZ:
+    case OP_LOE:
+    case OP_LOZ:
+    case OP_POP:
+    case OP_TST:
+      return true;
+    default:
+      return is_binary_operation(get_generic_opcode(oc));
+  }
+}
+
+// Returns true if the instruction pushes a result computed by a value kernel
+static bool computes_result(Opcode oc)
+{
+  return oc != OP_ASN && (is_constant_operation(oc) || is_binary_operation(get_generic_opcode(oc)));
+}
+
+// Marks the instructions whose result is only read by the instruction that pops it (see Chunk.unescaped). Each basic
+// block is walked in order with the producer of every object it pushed. Objects still on the stack where a block
+// ends may be popped on several paths, so their producers stay unmarked.
+static bool find_unescaped(Chunk* chunk, PathState* state)
+{
+  bool* unescaped = realloc(chunk->unescaped, chunk->count * sizeof(bool));
+  bool* targets = calloc(chunk->count, sizeof(bool));
+  size_t* producers = state->pending; // offset of the instruction that pushed each object of the block or SIZE_MAX
+  size_t height = 0;
+  size_t offset = 0;
+  size_t target = 0;
+  StackEffect effect;
+  Opcode oc = OP_NOP;
+
+  if(unescaped != NULL)
+    chunk->unescaped = unescaped;
+  if(unescaped == NULL || targets == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory to verify chunk (%zu bytes)!\n", chunk->count);
+    free(targets);
+    return false;
+  }
+  memset(unescaped, 0, chunk->count * sizeof(bool));
+  for(offset = 0; offset < chunk->count; offset += 1 + get_operand_length(oc))
+  {
+    oc = (Opcode)chunk->code[offset];
+    target = is_jump_operation(oc) ? get_jump_target(chunk, offset) : SIZE_MAX;
+    if(target < chunk->count)
+      targets[target] = true;
+  }
+
+  // Every instruction pushes at most one object per byte, so a block never pushes more than count objects
+  for(offset = 0; offset < chunk->count; offset += 1 + get_operand_length(oc))
+  {
+    oc = (Opcode)chunk->code[offset];
+    if(targets[offset] || state->depths[offset] == SIZE_MAX || oc == OP_CLS)
+      height = 0;
+    if(state->depths[offset] == SIZE_MAX)
+      continue; // unreachable
+    check_instruction(chunk, offset, &effect);
+    for(size_t i = 0; i < effect.pops && height > 0; i++)
+    {
+      height--;
+      if(producers[height] != SIZE_MAX && only_reads(oc))
+        unescaped[producers[height]] = true;
+    }
+    if(is_jump_operation(oc) || !falls_through(oc))
+      height = 0;
+    for(size_t i = 0; i < effect.pushes; i++)
+      producers[height++] = computes_result(oc) ? offset : SIZE_MAX;
+  }
+  free(targets);
+  return true;
+}
+
+// Verifies chunk and marks it safe for the unchecked interpreter loop on success
+bool verify_chunk(Chunk* chunk)
+{
+  bool* starts = NULL;
+  PathState state;
+  size_t max_depth = 0;
+  bool verified = false;
+
+  chunk->is_verified = false;
+  chunk->max_stack = 0;
+  if(chunk->has_error)
+    return reject(chunk, 0, "chunk overflowed during compilation");
+  if(chunk->count == 0)
+    return reject(chunk, 0, "execution runs past the end of the chunk");
+
+  // Each offset is queued at most once (when first reached), so the worklist never holds more than count entries
+  starts = calloc(chunk->count, sizeof(bool));
+  state.starts = starts;
+  state.depths = malloc(chunk->count * sizeof(size_t));
+  state.owners = malloc(chunk->count * sizeof(size_t));
+  state.pending = malloc(chunk->count * sizeof(size_t));
+  state.pending_count = 0;
+  if(starts == NULL || state.depths == NULL || state.owners == NULL || state.pending == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory to verify chunk (%zu bytes)!\n", chunk->count);
+    verified = false;
+    goto done;
+  }
+  for(size_t i = 0; i < chunk->count; i++)
+    state.depths[i] = SIZE_MAX;
+
+  // The main program is path 0 and function i of the chunk is path i + 1
+  verified = check_instructions(chunk, starts) && check_paths(chunk, &state, 0, 0, NULL, &max_depth);
+  for(size_t i = 0; verified && i < chunk->function_count; i++)
+  {
+    Function* function = &chunk->functions[i];
+    size_t function_depth = 0;
+    if(function->chunk != chunk)
+      continue;
+    verified = check_paths(chunk, &state, i + 1, function->entry, function, &function_depth);
+    function->max_stack = function->local_count + function_depth;
+  }
+  verified = verified && find_unescaped(chunk, &state);
+
+done:
+  free(starts);
+  free(state.depths);
+  free(state.owners);
+  free(state.pending);
+  if(!verified)
+    return false;
+
+  chunk->max_stack = max_depth;
+  chunk->is_verified = true;
+  if(debug_mode)
+    debug_print("Chunk verified with maximum stack depth of %zu.", max_depth);
+  return true;
+}
@@ -25,34 +25,39 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <errno.h>    // errno
 #include <inttypes.h> // PRIXPTR
+#include <stdint.h>   // uintptr_t
 #include <stdio.h>    // fprintf(), printf()
-#include <stdlib.h>   // malloc()
-#include <string.h>   // memset(), strcmp(), strerror()
+#include <stdlib.h>   // calloc(), free(), malloc(), realloc()
+#include <string.h>   // memmove(), memset(), strcmp(), strcpy(), strlen()
 #include "debug.h"
 #include "memory.h"
 #include "vm/instructions.h"
+#include "vm/jit.h"
 #include "vm/opcodes.h"
+#include "vm/profile.h"
 #include "vm/vm.h"
 
 VM vm;
-Opcode** IP;
+Byte** IP;
 Object** RP;
 Stack** SP;
+bool quicken_mode = true;
+bool cache_mode = true;
+
+static RunCode interpret_lean(void);
+static RunCode interpret_checked(void);
+static RunCode interpret_counted(void);
+static RunCode interpret_profiled(void);
+static RunCode interpret_traced(void);
 
 // Initializes virtual machine
 void init_vm(void)
 {
   memset(vm.registers, 0, sizeof(vm.registers));
-  vm.instructions = (Opcode *)malloc(INSTRUCTION_STORE_SIZE * sizeof(Opcode));
-  if(vm.instructions == NULL)
-  {
-    fprintf(stderr, "Error allocating memory for instruction store: %s\n", strerror(errno));
-    return;
-  }
-  clear_instructions();
-  vm.ip = vm.instructions;
+  select_dispatch();
+  vm.chunk = NULL;
+  vm.ip = NULL;
   vm.rp = vm.registers;
   vm.sp = &vm.stack;
   IP = &vm.ip;
@@ -60,44 +65,202 @@ void init_vm(void)
   SP = &vm.sp;
   init_stack(vm.sp);
   init_store();
+  vm.true_object = new_constant("true", "true");
+  vm.false_object = new_constant("false", "false");
+  vm.null_object = new_constant("null", "null");
+  vm.frames = NULL;
+  vm.frame_count = 0;
+  vm.frame_capacity = 0;
+  vm.globals = NULL;
+  vm.global_names = NULL;
+  vm.global_count = 0;
+  vm.global_capacity = 0;
+  vm.global_slots = cct_new_hash_map(INITIAL_BUCKET_AMOUNT);
+  vm.scratch = NULL;
+  vm.scratch_count = 0;
+  if(profile_mode)
+    init_profile();
   if(debug_mode)
     debug_print("VM initialized.");
   return;
 }
 
+// Selects the tracing interpreter loop in debug mode, the profiling loop in profile mode, the counting copy of the
+// lean loop in traffic mode and the lean loop otherwise
+void select_dispatch(void)
+{
+  if(debug_mode)
+    vm.dispatch = interpret_traced;
+  else if(profile_mode)
+    vm.dispatch = interpret_profiled;
+  else if(traffic_mode)
+    vm.dispatch = interpret_counted;
+  else
+    vm.dispatch = interpret_lean;
+  vm.dispatch_checked = vm.dispatch;
+  if(vm.dispatch == interpret_lean || vm.dispatch == interpret_counted)
+    vm.dispatch_checked = interpret_checked;
+  return;
+}
+
 // Stops virtual machine
 void stop_vm(void)
 {
-  free(vm.instructions);
+  if(profile_mode)
+  {
+    print_profile(PROFILE_REPORT_LIMIT);
+    free_profile();
+  }
   free_store();
+  free_stack(vm.sp);
+  free(vm.frames);
+  vm.frames = NULL;
+  vm.frame_capacity = 0;
+  cct_delete_hash_map(vm.global_slots);
+  for(size_t i = 0; i < vm.global_count; i++)
+    free(vm.global_names[i]);
+  free(vm.global_names);
+  free(vm.globals);
+  vm.global_slots = NULL;
+  vm.global_names = NULL;
+  vm.globals = NULL;
+  vm.global_count = 0;
+  vm.global_capacity = 0;
+  for(size_t i = 0; i < vm.scratch_count; i++)
+    free(vm.scratch[i]);
+  free(vm.scratch);
+  vm.scratch = NULL;
+  vm.scratch_count = 0;
   if(debug_mode)
     debug_print("VM stopped.");
   return;
 }
 
-// Clears instructions
-void clear_instructions(void)
+// Grows the call frame stack and returns false if MAX_CALL_DEPTH is reached or memory could not be allocated
+bool grow_frames(void)
 {
-  for(size_t i = 0; i < INSTRUCTION_STORE_SIZE; i++)
-    vm.instructions[i] = 0xFF;
+  size_t capacity = vm.frame_capacity == 0 ? INITIAL_FRAME_CAPACITY : vm.frame_capacity * 2;
+  Frame* frames = NULL;
+
+  if(vm.frame_capacity >= MAX_CALL_DEPTH)
+  {
+    fprintf(stderr, "Maximum call depth of %zu exceeded!\n", MAX_CALL_DEPTH);
+    return false;
+  }
+  if(capacity > MAX_CALL_DEPTH)
+    capacity = MAX_CALL_DEPTH;
+  frames = realloc(vm.frames, capacity * sizeof(Frame));
+  if(frames == NULL)
+  {
+    fprintf(stderr, "Unable to allocate memory for %zu call frames!\n", capacity);
+    return false;
+  }
+  vm.frames = frames;
+  vm.frame_capacity = capacity;
+  return true;
 }
 
-// Reverses instructions since they should be in a LIFO arrangement
-void reverse_instructions(size_t ic)
+// Allocates scratch objects up to stack slot and returns its object or NULL if memory could not be allocated. Callers
+// fall back to the object store, so running out of memory here is not an error.
+Object* grow_scratch(size_t slot)
 {
-  if(ic > 0)
+  size_t count = vm.scratch_count == 0 ? INITIAL_SCRATCH_AMOUNT : vm.scratch_count * 2;
+  Object** scratch = NULL;
+
+  if(count <= slot)
+    count = slot + 1;
+  scratch = realloc(vm.scratch, count * sizeof(Object*));
+  if(scratch == NULL)
+    return NULL;
+  vm.scratch = scratch;
+  // Each object is allocated on its own so results held in tos or on the stack stay put while the table grows
+  for(; vm.scratch_count < count; vm.scratch_count++)
   {
-    size_t i = ic - 1;
-    size_t j = 0;
-    while(i > j)
-    {
-      Opcode tmp = vm.instructions[i];
-      vm.instructions[i] = vm.instructions[j];
-      vm.instructions[j] = tmp;
-      i--;
-      j++;
-    }
+    vm.scratch[vm.scratch_count] = calloc(1, sizeof(Object));
+    if(vm.scratch[vm.scratch_count] == NULL)
+      return slot < vm.scratch_count ? vm.scratch[slot] : NULL;
+  }
+  return vm.scratch[slot];
+}
+
+// Grows the global slot table and returns false if memory could not be allocated
+static bool grow_globals(void)
+{
+  size_t capacity = vm.global_capacity == 0 ? INITIAL_GLOBAL_CAPACITY : vm.global_capacity * 2;
+  Object** globals = NULL;
+  char** names = NULL;
+
+  if(capacity > MAX_GLOBAL_AMOUNT)
+    capacity = MAX_GLOBAL_AMOUNT;
+  globals = realloc(vm.globals, capacity * sizeof(Object*));
+  if(globals == NULL)
+    return false;
+  vm.globals = globals;
+  names = realloc(vm.global_names, capacity * sizeof(char*));
+  if(names == NULL)
+    return false;
+  vm.global_names = names;
+  vm.global_capacity = capacity;
+  return true;
+}
+
+// Returns the global slot of identifier name, allocating it on first use, and records that chunk uses it
+uint16_t bind_global(Chunk* chunk, const char* name)
+{
+  uintptr_t slot = (uintptr_t)cct_hash_map_get(vm.global_slots, name);
+  char* copy = NULL;
+
+  if(slot != 0)
+  {
+    add_global(chunk, (uint16_t)(slot - 1));
+    return (uint16_t)(slot - 1);
   }
+  if(vm.global_count == MAX_GLOBAL_AMOUNT || (vm.global_count == vm.global_capacity && !grow_globals())
+     || (copy = malloc(strlen(name) + 1)) == NULL)
+  {
+    if(!chunk->has_error)
+      fprintf(stderr, "Unable to allocate a slot for global \"%s\" (%zu globals)!\n", name, vm.global_count);
+    chunk->has_error = true;
+    return 0;
+  }
+  strcpy(copy, name);
+  slot = vm.global_count++;
+  vm.globals[slot] = NULL;
+  vm.global_names[slot] = copy;
+  cct_hash_map_set(vm.global_slots, copy, (void*)(slot + 1));
+  add_global(chunk, (uint16_t)slot);
+  return (uint16_t)slot;
+}
+
+// Returns true if global slot holds a compiler temporary (see HIDDEN_GLOBAL_PREFIX)
+static inline bool is_hidden_global(uint16_t slot)
+{
+  return vm.global_names[slot][0] == HIDDEN_GLOBAL_PREFIX;
+}
+
+// Binds the global slots used by chunk to their values in map (hidden globals start out unset)
+static void load_globals(const Chunk* chunk, const ConcoctHashMap* map)
+{
+  for(size_t i = 0; i < chunk->global_count; i++)
+  {
+    uint16_t slot = chunk->globals[i];
+    vm.globals[slot] = is_hidden_global(slot) ? NULL : cct_hash_map_get(map, vm.global_names[slot]);
+  }
+  return;
+}
+
+// Stores the global slots used by chunk in map and unbinds them, so that no slot outlives the objects of a run. Hidden
+// globals are only unbound.
+static void store_globals(const Chunk* chunk, ConcoctHashMap* map)
+{
+  for(size_t i = 0; i < chunk->global_count; i++)
+  {
+    uint16_t slot = chunk->globals[i];
+    if(vm.globals[slot] != NULL && !is_hidden_global(slot))
+      cct_hash_map_set(map, vm.global_names[slot], vm.globals[slot]);
+    vm.globals[slot] = NULL;
+  }
+  return;
 }
 
 // Prints register values
@@ -207,8 +370,13 @@ void print_registers(void)
         strval = "Unknown";
         break;
     }
-    printf("IP: %s (0x%02X)\nRP: 0x%" PRIXPTR "\nSP: %.64s (%s)\n\n", get_mnemonic(**IP), **IP, (uintptr_t)*RP, strval, get_data_type(object));
+    if(*IP == NULL)
+      printf("IP: none\nRP: 0x%" PRIXPTR "\nSP: %.64s (%s)\n\n", (uintptr_t)*RP, strval, get_data_type(object));
+    else
+      printf("IP: %s (0x%02X)\nRP: 0x%" PRIXPTR "\nSP: %.64s (%s)\n\n", get_mnemonic(**IP), **IP, (uintptr_t)*RP, strval, get_data_type(object));
   }
+  else if(*IP == NULL)
+    printf("IP: none\nRP: 0x%" PRIXPTR "\nSP: empty\n\n", (uintptr_t)*RP);
   else
     printf("IP: %s (0x%02X)\nRP: 0x%" PRIXPTR "\nSP: empty\n\n", get_mnemonic(**IP), **IP, (uintptr_t)*RP);
   if(strval != NULL && (strcmp(strval, "null") != 0))
@@ -216,251 +384,112 @@ void print_registers(void)
   return;
 }
 
-// Interprets code
-RunCode interpret(ConcoctHashMap* map)
+// Resolves an RK operand byte to the register or constant it names
+static inline Object* read_rk(const Chunk* chunk, Byte rk)
 {
-  char* value = NULL;
-  Object* object = NULL;
-  Byte src_reg = R1;
-  Byte dst_reg = R0;
+  if(rk < REGISTER_AMOUNT)
+    return vm.rp[rk];
+  return chunk->constants[rk - REGISTER_AMOUNT];
+}
 
-  while(*vm.ip != OP_END)
-  {
-    if(debug_mode)
-      printf("Instruction: %s (0x%02X)\n", get_mnemonic(*vm.ip), *vm.ip);
-    switch(*vm.ip)
-    {
-      case OP_ADD:
-        op_add(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_AND:
-        op_and(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_ASN:
-        op_asn(vm.sp, map);
-        break;
-      case OP_BND:
-        op_bnd(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_BNT:
-        op_bnt(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_BOR:
-        op_bor(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_CAL:
-        break;
-      case OP_CLR:
-        op_clr(vm.rp);
-        if(debug_mode)
-          print_registers();
-        break;
-      case OP_CLS:
-        op_cls(vm.sp);
-        break;
-      case OP_CMP:
-        break;
-      case OP_DEC:
-        op_dec(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_DIV:
-        op_div(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_END:
-        if(debug_mode)
-          print_registers();
-        break;
-      case OP_ENT:
-        break;
-      case OP_EQL:
-        op_eql(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_EXT:
-        break;
-      case OP_GT:
-        op_gt(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_GTE:
-        op_gte(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_HLT:
-        stop_vm();
-        break;
-      case OP_INC:
-        op_inc(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_JMC:
-      case OP_JMP:
-      case OP_JMZ:
-      case OP_LNE:
-      case OP_LNZ:
-        break;
-      case OP_LOD:
-        op_lod(vm.rp, vm.sp, dst_reg);
-        if(debug_mode)
-          print_registers();
-        break;
-      case OP_LOE:
-      case OP_LOP:
-        break;
-      case OP_LOZ:
-        break;
-      case OP_LT:
-        op_lt(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_LTE:
-        op_lte(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_MOD:
-        op_mod(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_MOV:
-        op_mov(vm.rp, object, src_reg, dst_reg);
-        if(debug_mode)
-          print_registers();
-        break;
-      case OP_MUL:
-        op_mul(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_NEG:
-        op_neg(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_NEQ:
-        op_neq(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_NOP:
-        OP_NOOP;
-        break;
-      case OP_NOT:
-        op_not(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_NUL:
-        break;
-      case OP_OR:
-        op_or(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_POP:
-        op_pop(vm.sp, object);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_POS:
-        op_pos(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_POW:
-        op_pow(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_PSH:
-        op_psh(vm.sp, value);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_RET:
-        break;
-      case OP_SHL:
-        op_shl(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_SHR:
-        op_shr(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_SLE:
-        op_sle(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_SLN:
-        op_sln(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_STR:
-        op_str(vm.rp, vm.sp, src_reg);
-        if(debug_mode)
-        {
-          print_registers();
-          print_object_value(peek(vm.sp));
-        }
-        break;
-      case OP_SUB:
-        op_sub(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      case OP_SYS:
-        //op_sys(vm.sp);
-        //if(debug_mode)
-        //  print_object_value(pop(vm.sp));
-        break;
-      case OP_TST:
-        break;
-      case OP_XCG:
-        op_xcg(vm.rp, src_reg, dst_reg);
-        if(debug_mode)
-          print_registers();
-        break;
-      case OP_XOR:
-        op_xor(vm.sp);
-        if(debug_mode)
-          print_object_value(peek(vm.sp));
-        break;
-      default:
-        fprintf(stderr, "Illegal instruction: %s (0x%02X)\n", get_mnemonic(*vm.ip), *vm.ip);
-        return RUN_ERROR;
-    }
-    (vm.ip)++;
-  }
+// Rewrites a generic binary instruction in place to the form specialized for the types of its operands
+static inline void quicken_instruction(Byte* instruction, const Object* operand1, const Object* operand2)
+{
+  if(operand1 != NULL && operand2 != NULL)
+    *instruction = (Byte)get_quickened_opcode((Opcode)*instruction, operand1->datatype, operand2->datatype);
+  return;
+}
 
-  if(debug_mode)
-    print_registers();
+// Generate the lean interpreter loop for verified chunks
+#define DISPATCH_NAME interpret_lean
+#define DISPATCH_TRACE 0
+#define DISPATCH_PROFILE 0
+#define DISPATCH_CHECKED 0
+#define DISPATCH_COUNT 0
+#include "vm/dispatch.h"
+#undef DISPATCH_NAME
+#undef DISPATCH_TRACE
+#undef DISPATCH_PROFILE
+#undef DISPATCH_CHECKED
+#undef DISPATCH_COUNT
 
-  vm.ip = vm.instructions; // reset VM instruction pointer to beginning of instructions
-  clear_instructions();
+// Generate a copy of the lean interpreter loop that counts its operand stack traffic
+#define DISPATCH_NAME interpret_counted
+#define DISPATCH_TRACE 0
+#define DISPATCH_PROFILE 0
+#define DISPATCH_CHECKED 0
+#define DISPATCH_COUNT 1
+#include "vm/dispatch.h"
+#undef DISPATCH_NAME
+#undef DISPATCH_TRACE
+#undef DISPATCH_PROFILE
+#undef DISPATCH_CHECKED
+#undef DISPATCH_COUNT
+
+// Generate the lean interpreter loop for unverified chunks
+#define DISPATCH_NAME interpret_checked
+#define DISPATCH_TRACE 0
+#define DISPATCH_PROFILE 0
+#define DISPATCH_CHECKED 1
+#define DISPATCH_COUNT 0
+#include "vm/dispatch.h"
+#undef DISPATCH_NAME
+#undef DISPATCH_TRACE
+#undef DISPATCH_PROFILE
+#undef DISPATCH_CHECKED
+#undef DISPATCH_COUNT
+
+// Generate the profiling interpreter loop that records opcode sequence frequencies
+#define DISPATCH_NAME interpret_profiled
+#define DISPATCH_TRACE 0
+#define DISPATCH_PROFILE 1
+#define DISPATCH_CHECKED 1
+#define DISPATCH_COUNT 0
+#include "vm/dispatch.h"
+#undef DISPATCH_NAME
+#undef DISPATCH_TRACE
+#undef DISPATCH_PROFILE
+#undef DISPATCH_CHECKED
+#undef DISPATCH_COUNT
+
+// Generate the tracing interpreter loop used by debug mode
+#define DISPATCH_NAME interpret_traced
+#define DISPATCH_TRACE 1
+#define DISPATCH_PROFILE 0
+#define DISPATCH_CHECKED 1
+#define DISPATCH_COUNT 0
+#include "vm/dispatch.h"
+#undef DISPATCH_NAME
+#undef DISPATCH_TRACE
+#undef DISPATCH_PROFILE
+#undef DISPATCH_CHECKED
+#undef DISPATCH_COUNT
+
+// Interprets chunk using map for identifier bindings
+RunCode interpret(Chunk* chunk, ConcoctHashMap* map)
+{
+  RunCode status = RUN_SUCCESS;
+
+  if(chunk == NULL || chunk->count == 0)
+    return RUN_SUCCESS;
+  // Verified chunks reserve their maximum stack depth once so that the unchecked loop never checks capacity
+  if(chunk->is_verified && UNLIKELY(!reserve_stack(vm.sp, chunk->max_stack)))
+    return RUN_ERROR;
+  load_globals(chunk, map);
+  vm.chunk = chunk;
+  vm.ip = chunk->code;
+  // Native code stands in for the lean loop only, so debug and profile mode keep interpreting
+  if(jit_mode && chunk->is_verified && vm.dispatch == interpret_lean && chunk->native == NULL
+     && ++chunk->hotness >= jit_threshold)
+    compile_native(chunk);
+  if(jit_mode && chunk->native != NULL && vm.dispatch == interpret_lean)
+    status = run_native(chunk);
+  else
+    status = chunk->is_verified ? vm.dispatch() : vm.dispatch_checked();
+  store_globals(chunk, map);
+  vm.chunk = NULL;
+  vm.ip = NULL;
+  vm.frame_count = 0;
 
-  return RUN_SUCCESS;
+  return status;
 }